@@ -0,0 +1,229 @@
+/**
+ * @file bench.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#include "bench.h"
+#include "../common/print.h"
+
+#define BENCH_DEFAULT_MIN_TIME_MS      200
+#define BENCH_DEFAULT_NUM_REPETITIONS  5
+#define BENCH_MAX_NUM_REPETITIONS      31
+#define BENCH_MAX_NUM_ITERATIONS       (1L << 40)
+
+/* Static data */
+
+static const char *g_bench_filter = NULL;
+static int g_bench_min_time_ms = BENCH_DEFAULT_MIN_TIME_MS;
+static int g_bench_num_repetitions = BENCH_DEFAULT_NUM_REPETITIONS;
+
+/* Updated by the allocator wrappers (the benchmarks run on one thread) */
+static unsigned long long g_bench_num_allocs = 0;
+static unsigned long long g_bench_alloc_bytes = 0;
+
+volatile long g_bench_sink = 0;
+
+/* Static functions */
+
+static void usage(char *prog_name)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "options:\n"
+          "  -f [filter] Run only benchmarks whose name contains 'filter'.\n"
+          "  -h Display command-line options (i.e. print this message).\n"
+          "  -r [count] Repeat each measurement 'count' times and report the median (default: %d).\n"
+          "  -t [ms] Grow each measurement to at least 'ms' milliseconds (default: %d).\n"
+          "output:\n"
+          "  One JSON object per line: name, param, iterations, ns_per_op, min_ns_per_op,\n"
+          "  allocs_per_op and alloc_bytes_per_op.\n",
+          prog_name,
+          BENCH_DEFAULT_NUM_REPETITIONS,
+          BENCH_DEFAULT_MIN_TIME_MS);
+}
+
+static uint64_t bench_get_time_ns(void)
+{
+  struct timespec current_time;
+
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return ((uint64_t)current_time.tv_sec * 1000000000ULL) + current_time.tv_nsec;
+}
+
+static uint64_t bench_time_run(T_bench_func func, void *arg, long num_iterations)
+{
+  uint64_t start_time_ns = bench_get_time_ns();
+
+  func(arg, num_iterations);
+
+  return bench_get_time_ns() - start_time_ns;
+}
+
+static int bench_compare_time(const void *a, const void *b)
+{
+  uint64_t time_a = *(const uint64_t *)a;
+  uint64_t time_b = *(const uint64_t *)b;
+
+  return (time_a > time_b) - (time_a < time_b);
+}
+
+/* Allocator wrappers (linked with -Wl,--wrap); only calls from synced code are counted */
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t num, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+  g_bench_num_allocs++;
+  g_bench_alloc_bytes += size;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size)
+{
+  g_bench_num_allocs++;
+  g_bench_alloc_bytes += num * size;
+  return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  g_bench_num_allocs++;
+  g_bench_alloc_bytes += size;
+  return __real_realloc(ptr, size);
+}
+
+/* Global functions */
+
+void bench_run(const char *name, const char *param, T_bench_func func, void *arg)
+{
+  uint64_t run_time_ns[BENCH_MAX_NUM_REPETITIONS];
+  uint64_t min_time_ns = (uint64_t)g_bench_min_time_ms * 1000000ULL;
+  unsigned long long num_allocs;
+  unsigned long long alloc_bytes;
+  long num_iterations = 1;
+  long num_ops;
+  uint64_t time_ns;
+  int i;
+
+  if((g_bench_filter != NULL) && (strstr(name, g_bench_filter) == NULL)) {
+    return;
+  }
+
+  /* Warm up, then grow the run until it takes the minimum time */
+  func(arg, 1);
+  while((time_ns = bench_time_run(func, arg, num_iterations)) < min_time_ns) {
+    if(num_iterations >= BENCH_MAX_NUM_ITERATIONS) {
+      break;
+    }
+    if(time_ns < (min_time_ns / 100)) {
+      num_iterations *= 10;
+    } else {
+      num_iterations *= 2;
+    }
+  }
+
+  num_allocs = g_bench_num_allocs;
+  alloc_bytes = g_bench_alloc_bytes;
+  for(i = 0; i < g_bench_num_repetitions; i++) {
+    run_time_ns[i] = bench_time_run(func, arg, num_iterations);
+  }
+  num_allocs = g_bench_num_allocs - num_allocs;
+  alloc_bytes = g_bench_alloc_bytes - alloc_bytes;
+  num_ops = num_iterations * g_bench_num_repetitions;
+
+  qsort(run_time_ns, g_bench_num_repetitions, sizeof(run_time_ns[0]), bench_compare_time);
+
+  printf("{\"name\":\"%s\",\"param\":\"%s\",\"iterations\":%ld,\"ns_per_op\":%.2f,\"min_ns_per_op\":%.2f,"
+         "\"allocs_per_op\":%.3f,\"alloc_bytes_per_op\":%.1f}\n",
+         name,
+         param,
+         num_iterations,
+         (double)run_time_ns[g_bench_num_repetitions / 2] / num_iterations,
+         (double)run_time_ns[0] / num_iterations,
+         (double)num_allocs / num_ops,
+         (double)alloc_bytes / num_ops);
+  fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+  char *prog_name = strrchr(argv[0], '/');
+  int c;
+
+  if(prog_name)
+    prog_name++;
+  else
+    prog_name = argv[0];
+
+  while(EOF != (c = getopt(argc, argv, "f:hr:t:"))) {
+    switch(c) {
+      case 'f':
+        g_bench_filter = optarg;
+        break;
+      case 'r':
+        g_bench_num_repetitions = atoi(optarg);
+        if((g_bench_num_repetitions < 1) || (g_bench_num_repetitions > BENCH_MAX_NUM_REPETITIONS)) {
+          fprintf(stderr, "Repetition count must be between 1 and %d\n", BENCH_MAX_NUM_REPETITIONS);
+          return -1;
+        }
+        break;
+      case 't':
+        g_bench_min_time_ms = atoi(optarg);
+        if(g_bench_min_time_ms < 1) {
+          fprintf(stderr, "Minimum time must be at least 1 millisecond\n");
+          return -1;
+        }
+        break;
+      case 'h':
+        usage(prog_name);
+        return 0;
+      default:
+        usage(prog_name);
+        return -1;
+    }
+  }
+
+  /* Keep stdout for results */
+  print_set_stdout_en(0);
+  print_set_syslog_en(0);
+  print_set_max_msg_level(LOG_ERR);
+
+  bench_esmc();
+  bench_esmc_adaptor();
+  bench_control();
+  bench_hash();
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file bench.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * Microbenchmarks of synced hot paths (make bench).
+ *
+ * Each benchmark function runs its operation num_iterations times. bench_run() grows the number of
+ * iterations until a run takes the minimum time, repeats the run and prints one JSON object per line
+ * with the median time per operation and the heap allocations per operation made by synced code.
+ */
+
+typedef void (*T_bench_func)(void *arg, long num_iterations);
+
+/* Results are stored here so that the compiler cannot drop the benchmarked calls */
+extern volatile long g_bench_sink;
+
+/* Skip the benchmark unless its name matches the -f filter */
+void bench_run(const char *name, const char *param, T_bench_func func, void *arg);
+
+/* Benchmark groups */
+void bench_esmc(void);
+void bench_esmc_adaptor(void);
+void bench_control(void);
+void bench_hash(void);
+
+#endif /* BENCH_H */
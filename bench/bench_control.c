@@ -0,0 +1,150 @@
+/**
+ * @file bench_control.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+/* The control source is included to reach its static selection functions and data */
+#include "../control/control.c"
+
+#include <stdio.h>
+
+#include "bench.h"
+
+#define BENCH_CONTROL_MIN_NUM_OF_SYNCS   8
+#define BENCH_CONTROL_MAX_NUM_OF_SYNCS   4096
+
+/* Defined by the device adaptor; replaced so that the device is not accessed */
+extern T_device_adaptor_callbacks g_device_adaptor_callbacks;
+extern pthread_mutex_t g_device_adaptor_mutex;
+
+/* Static functions */
+
+static int bench_control_set_clock_priorities(int synce_dpll_idx, T_device_clock_priority_table const *table)
+{
+  (void)synce_dpll_idx;
+
+  g_bench_sink = table->num_entries;
+
+  return 0;
+}
+
+static void bench_control_calculate_rank(void *arg, long num_iterations)
+{
+  long i;
+
+  (void)arg;
+
+  for(i = 0; i < num_iterations; i++) {
+    g_bench_sink = calculate_rank(ESMC_QL_NET_OPT_1_START + (i & 7), i & 0xFF, i & 0x3F);
+  }
+}
+
+static void bench_control_update_device_priority_table(void *arg, long num_iterations)
+{
+  long i;
+
+  (void)arg;
+
+  for(i = 0; i < num_iterations; i++) {
+    control_update_device_priority_table(&g_control_data);
+  }
+}
+
+/*
+ * Build a sync table of num_syncs entries. Clock indices are unique and limited to MAX_NUM_OF_CLOCKS,
+ * so as in a real configuration only that many entries are Sync-E clock ports and the rest are
+ * monitoring ports, which selection has to skip.
+ */
+static int bench_control_create_sync_table(int num_syncs)
+{
+  const T_esmc_ql qls[] = {
+    E_esmc_ql_net_opt_1_PRC,
+    E_esmc_ql_net_opt_1_SSUA,
+    E_esmc_ql_net_opt_1_SSUB,
+    E_esmc_ql_net_opt_1_eSEC
+  };
+  T_sync_entry *sync_entry;
+  int i;
+
+  free(g_control_data.sync_table);
+
+  memset(&g_control_data, 0, sizeof(g_control_data));
+  g_control_data.net_opt = E_esmc_network_option_1;
+  g_control_data.lo_ql = E_esmc_ql_net_opt_1_SEC;
+  g_control_data.lo_pri = MAX_NUM_OF_PRIORITIES - 1;
+  g_control_data.do_not_use_ql = E_esmc_ql_net_opt_1_DNU;
+  g_control_data.num_syncs = num_syncs;
+  /* Priority table writes go through the device adaptor, as in synced */
+  g_control_data.device_ops = device_adaptor_get_ops();
+
+  g_control_data.sync_table = calloc(num_syncs, sizeof(*g_control_data.sync_table));
+  if(!g_control_data.sync_table) {
+    return -1;
+  }
+
+  for(i = 0; i < num_syncs; i++) {
+    sync_entry = &g_control_data.sync_table[i];
+    if(i < MAX_NUM_OF_CLOCKS) {
+      sync_entry->type = E_sync_type_synce;
+      sync_entry->clk_idx = i;
+    } else {
+      sync_entry->type = E_sync_type_monitoring;
+      sync_entry->clk_idx = INVALID_CLK_IDX;
+    }
+    sync_entry->config_pri = i % (MAX_NUM_OF_PRIORITIES - 1);
+    sync_entry->current_ql = qls[i % (int)(sizeof(qls) / sizeof(qls[0]))];
+    sync_entry->state = E_sync_state_normal;
+    sync_entry->rank = control_calculate_rank(&g_control_data, sync_entry);
+  }
+
+  return 0;
+}
+
+/* Global functions */
+
+void bench_control(void)
+{
+  char param[64];
+  int num_syncs;
+
+  bench_run("calculate_rank", "", bench_control_calculate_rank, NULL);
+
+  if(os_mutex_init(&g_device_adaptor_mutex) < 0) {
+    fprintf(stderr, "Failed to initialize the device adaptor mutex\n");
+    return;
+  }
+  memset(&g_device_adaptor_callbacks, 0, sizeof(g_device_adaptor_callbacks));
+  g_device_adaptor_callbacks.set_clock_priorities = bench_control_set_clock_priorities;
+
+  for(num_syncs = BENCH_CONTROL_MIN_NUM_OF_SYNCS; num_syncs <= BENCH_CONTROL_MAX_NUM_OF_SYNCS; num_syncs *= 2) {
+    if(bench_control_create_sync_table(num_syncs) < 0) {
+      fprintf(stderr, "Failed to create sync table of %d entries\n", num_syncs);
+      break;
+    }
+    snprintf(param, sizeof(param), "syncs=%d", num_syncs);
+    bench_run("control_update_device_priority_table", param, bench_control_update_device_priority_table, NULL);
+  }
+
+  free(g_control_data.sync_table);
+  memset(&g_control_data, 0, sizeof(g_control_data));
+  memset(&g_device_adaptor_callbacks, 0, sizeof(g_device_adaptor_callbacks));
+  os_mutex_deinit(&g_device_adaptor_mutex);
+}
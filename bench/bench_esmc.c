@@ -0,0 +1,148 @@
+/**
+ * @file bench_esmc.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+/* The ESMC stack source is included to reach its static QL mapping functions */
+#include "../esmc/renesas/esmc.c"
+
+#include <stdio.h>
+
+#include "bench.h"
+
+#define BENCH_ESMC_NUM_OF_QLS   (E_esmc_ql_net_opt_1_DNU - ESMC_QL_NET_OPT_1_START + 1)
+
+typedef struct {
+  T_esmc_pdu msg;
+  unsigned char src_mac_addr[ETH_ALEN];
+  T_port_ext_ql_tlv_data ext_ql_tlv_data;
+  T_esmc_ql qls[BENCH_ESMC_NUM_OF_QLS];
+  unsigned char ssm_codes[BENCH_ESMC_NUM_OF_QLS];
+  unsigned char e_ssm_codes[BENCH_ESMC_NUM_OF_QLS];
+} T_bench_esmc_data;
+
+/* Static data */
+
+static T_bench_esmc_data g_bench_esmc_data;
+
+/* Static functions */
+
+static void bench_esmc_compose_pdu(void *arg, long num_iterations)
+{
+  T_bench_esmc_data *data = arg;
+  T_esmc_ql composed_ql;
+  long i;
+
+  for(i = 0; i < num_iterations; i++) {
+    g_bench_sink = esmc_compose_pdu(&data->msg, E_esmc_pdu_type_event, data->src_mac_addr, &data->ext_ql_tlv_data, 1, &composed_ql);
+  }
+}
+
+static void bench_esmc_parse_pdu(void *arg, long num_iterations)
+{
+  T_esmc_pdu *msg = arg;
+  T_port_ext_ql_tlv_data parsed_ext_ql_tlv_data;
+  T_esmc_ql parsed_ql;
+  int enhanced_flag;
+  long i;
+
+  for(i = 0; i < num_iterations; i++) {
+    g_bench_sink = esmc_parse_pdu(msg, &enhanced_flag, &parsed_ql, &parsed_ext_ql_tlv_data);
+  }
+}
+
+static void bench_esmc_ql_to_ssm_map(void *arg, long num_iterations)
+{
+  T_bench_esmc_data *data = arg;
+  unsigned char ssm_code;
+  unsigned char e_ssm_code;
+  long i;
+
+  for(i = 0; i < num_iterations; i++) {
+    esmc_ql_to_ssm_and_e_ssm_map(E_esmc_network_option_1, data->qls[i % BENCH_ESMC_NUM_OF_QLS], &ssm_code, &e_ssm_code);
+    g_bench_sink = ssm_code;
+  }
+}
+
+static void bench_esmc_ssm_to_ql_map(void *arg, long num_iterations)
+{
+  T_bench_esmc_data *data = arg;
+  T_esmc_ql ql;
+  long i;
+
+  for(i = 0; i < num_iterations; i++) {
+    esmc_ssm_and_essm_to_ql_map(E_esmc_network_option_1,
+                                data->ssm_codes[i % BENCH_ESMC_NUM_OF_QLS],
+                                data->e_ssm_codes[i % BENCH_ESMC_NUM_OF_QLS],
+                                &ql);
+    g_bench_sink = ql;
+  }
+}
+
+/* Global functions */
+
+void bench_esmc(void)
+{
+  T_bench_esmc_data *data = &g_bench_esmc_data;
+  const unsigned char src_mac_addr[ETH_ALEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  T_esmc_pdu basic_msg;
+  T_port_ext_ql_tlv_data parsed_ext_ql_tlv_data;
+  T_esmc_ql composed_ql;
+  T_esmc_ql parsed_ql;
+  int enhanced_flag;
+  int i;
+
+  memset(data, 0, sizeof(*data));
+  memcpy(data->src_mac_addr, src_mac_addr, ETH_ALEN);
+  data->ext_ql_tlv_data.num_cascaded_eEEC = 1;
+
+  if((esmc_create_stack() < 0) ||
+     (esmc_init_stack(E_esmc_network_option_1, E_esmc_ql_net_opt_1_PRC, E_esmc_ql_net_opt_1_DNU) < 0)) {
+    fprintf(stderr, "Failed to initialize the ESMC stack\n");
+    return;
+  }
+
+  for(i = 0; i < BENCH_ESMC_NUM_OF_QLS; i++) {
+    data->qls[i] = ESMC_QL_NET_OPT_1_START + i;
+    esmc_ql_to_ssm_and_e_ssm_map(E_esmc_network_option_1, data->qls[i], &data->ssm_codes[i], &data->e_ssm_codes[i]);
+  }
+
+  bench_run("esmc_compose_pdu", "event", bench_esmc_compose_pdu, data);
+
+  /* Parse the composed PDU, and the same PDU as sent by a node without extended QL TLV support */
+  if(esmc_compose_pdu(&data->msg, E_esmc_pdu_type_event, data->src_mac_addr, &data->ext_ql_tlv_data, 1, &composed_ql) != ESMC_PDU_LEN) {
+    fprintf(stderr, "Failed to compose ESMC PDU\n");
+    return;
+  }
+  basic_msg = data->msg;
+  memset(&basic_msg.ext_ql_tlv, 0, sizeof(basic_msg.ext_ql_tlv));
+  if((esmc_parse_pdu(&data->msg, &enhanced_flag, &parsed_ql, &parsed_ext_ql_tlv_data) < 0) ||
+     (esmc_parse_pdu(&basic_msg, &enhanced_flag, &parsed_ql, &parsed_ext_ql_tlv_data) < 0)) {
+    fprintf(stderr, "Failed to parse ESMC PDU\n");
+    return;
+  }
+
+  bench_run("esmc_parse_pdu", "enhanced", bench_esmc_parse_pdu, &data->msg);
+  bench_run("esmc_parse_pdu", "basic", bench_esmc_parse_pdu, &basic_msg);
+
+  bench_run("esmc_ql_to_ssm_and_e_ssm_map", "net_opt_1", bench_esmc_ql_to_ssm_map, data);
+  bench_run("esmc_ssm_and_essm_to_ql_map", "net_opt_1", bench_esmc_ssm_to_ql_map, data);
+}
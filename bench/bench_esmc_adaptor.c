@@ -0,0 +1,107 @@
+/**
+ * @file bench_esmc_adaptor.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+/* The ESMC adaptor source is included to reach its static port number to sync index maps */
+#include "../esmc/renesas/esmc_adaptor.c"
+
+#include <stdio.h>
+
+#include "bench.h"
+
+typedef struct {
+  unsigned char mac_addr[ETH_ALEN];
+  T_port_num port_num;
+} T_bench_esmc_adaptor_lookup;
+
+/* Static functions */
+
+static void bench_esmc_adaptor_check_mac_addr(void *arg, long num_iterations)
+{
+  T_bench_esmc_adaptor_lookup *lookup = arg;
+  long i;
+
+  for(i = 0; i < num_iterations; i++) {
+    g_bench_sink = esmc_adaptor_check_mac_addr(lookup->mac_addr);
+  }
+}
+
+static void bench_esmc_adaptor_get_sync_idx(void *arg, long num_iterations)
+{
+  T_bench_esmc_adaptor_lookup *lookup = arg;
+  long i;
+
+  for(i = 0; i < num_iterations; i++) {
+    g_bench_sink = get_sync_idx_from_rx_port_num(lookup->port_num);
+  }
+}
+
+static void bench_esmc_adaptor_set_mac_addr(unsigned char mac_addr[ETH_ALEN], int idx)
+{
+  mac_addr[0] = 0x02;
+  mac_addr[1] = 0x00;
+  mac_addr[2] = 0x00;
+  mac_addr[3] = 0x00;
+  mac_addr[4] = (idx >> 8) & 0xFF;
+  mac_addr[5] = idx & 0xFF;
+}
+
+/* Global functions */
+
+void bench_esmc_adaptor(void)
+{
+  const int num_tx_ports[] = {1, 8, 32, ESMC_MAX_NUMBER_OF_PORTS};
+  T_bench_esmc_adaptor_lookup lookup;
+  char param[64];
+  int i;
+  int j;
+
+  /* MAC addresses of the local TX ports, checked for every received PDU to detect loops */
+  for(i = 0; i < (int)(sizeof(num_tx_ports) / sizeof(num_tx_ports[0])); i++) {
+    g_esmc_tx_mac_addr_num = num_tx_ports[i];
+    for(j = 0; j < g_esmc_tx_mac_addr_num; j++) {
+      bench_esmc_adaptor_set_mac_addr(g_esmc_tx_mac_addr[j], j);
+    }
+
+    /* Foreign source MAC address (the common case) */
+    bench_esmc_adaptor_set_mac_addr(lookup.mac_addr, ESMC_MAX_NUMBER_OF_PORTS);
+    snprintf(param, sizeof(param), "ports=%d,miss", num_tx_ports[i]);
+    bench_run("esmc_adaptor_check_mac_addr", param, bench_esmc_adaptor_check_mac_addr, &lookup);
+
+    bench_esmc_adaptor_set_mac_addr(lookup.mac_addr, num_tx_ports[i] - 1);
+    snprintf(param, sizeof(param), "ports=%d,hit_last", num_tx_ports[i]);
+    bench_run("esmc_adaptor_check_mac_addr", param, bench_esmc_adaptor_check_mac_addr, &lookup);
+  }
+
+  /* RX port numbers of all sync entries, looked up for every RX event */
+  clear_rx_port_num_to_sync_idx_map();
+  for(i = 0; i < MAX_NUM_OF_SYNC_ENTRIES; i++) {
+    set_rx_port_num_to_sync_idx_map(100 + i, i);
+  }
+
+  lookup.port_num = 100;
+  bench_run("get_sync_idx_from_rx_port_num", "first", bench_esmc_adaptor_get_sync_idx, &lookup);
+
+  lookup.port_num = 100 + MAX_NUM_OF_SYNC_ENTRIES - 1;
+  snprintf(param, sizeof(param), "last_of_%d", MAX_NUM_OF_SYNC_ENTRIES);
+  bench_run("get_sync_idx_from_rx_port_num", param, bench_esmc_adaptor_get_sync_idx, &lookup);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file bench_hash.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "../common/hash.h"
+
+#define BENCH_HASH_MAX_KEY_LEN   32
+
+typedef struct {
+  struct hash *ht;
+  char (*keys)[BENCH_HASH_MAX_KEY_LEN];
+  int num_keys;
+} T_bench_hash_data;
+
+/* Static functions */
+
+static void bench_hash_lookup(void *arg, long num_iterations)
+{
+  T_bench_hash_data *data = arg;
+  long i;
+
+  for(i = 0; i < num_iterations; i++) {
+    g_bench_sink = (long)hash_lookup(data->ht, data->keys[i % data->num_keys]);
+  }
+}
+
+/* Global functions */
+
+void bench_hash(void)
+{
+  const int num_keys[] = {8, 128, 4096};
+  T_bench_hash_data data;
+  char param[64];
+  int i;
+  int j;
+
+  for(i = 0; i < (int)(sizeof(num_keys) / sizeof(num_keys[0])); i++) {
+    data.num_keys = num_keys[i];
+    data.ht = hash_create();
+    data.keys = calloc(data.num_keys, sizeof(*data.keys));
+    if((data.ht == NULL) || (data.keys == NULL)) {
+      fprintf(stderr, "Failed to allocate hash table of %d keys\n", data.num_keys);
+      if(data.ht != NULL) {
+        hash_destroy(data.ht, NULL);
+      }
+      free(data.keys);
+      return;
+    }
+
+    /* Keys shaped like configuration section names, e.g. port names */
+    for(j = 0; j < data.num_keys; j++) {
+      snprintf(data.keys[j], BENCH_HASH_MAX_KEY_LEN, "eth%d", j);
+      if(hash_insert(data.ht, data.keys[j], &data) < 0) {
+        fprintf(stderr, "Failed to insert key %s\n", data.keys[j]);
+      }
+    }
+
+    snprintf(param, sizeof(param), "keys=%d", data.num_keys);
+    bench_run("hash_lookup", param, bench_hash_lookup, &data);
+
+    hash_destroy(data.ht, NULL);
+    free(data.keys);
+  }
+}
@@ -0,0 +1,379 @@
+#!/usr/bin/env python3
+#
+# @file synced_e2e.py
+# @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 2, as published
+# by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see <http://www.gnu.org/licenses/>.
+#
+
+"""End-to-end benchmark of synced over veth pairs in private network namespaces.
+
+For each port count and QL flap rate, the harness creates two network namespaces joined by N veth
+pairs, starts synced on one side and drives ESMC PDUs from the other side:
+
+  - every port receives an information PDU with QL-SSU-B once per second
+  - the first port (the best clock) toggles between QL-PRC and QL-SSU-B at the flap rate, each
+    change sent as an event PDU
+
+The time from sending a QL change to receiving the first PDU with the new QL on the second port is
+the PDU-to-TX-QL propagation latency. CPU usage, context switches (wakeups) and RSS of synced are
+read from /proc, and the internal latency stages from the Management API (get_latency_stats).
+
+The report is JSON with sorted keys and no timestamps, so reports of two releases can be diffed.
+Requires root, iproute2 and build/bin/synced and build/bin/synced_cli.
+"""
+
+import argparse
+import ctypes
+import json
+import os
+import select
+import signal
+import socket
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+CLONE_NEWNET = 0x40000000
+
+ETH_P_SLOW = 0x8809
+SLOW_PROTO_MCAST_ADDR = bytes([0x01, 0x80, 0xC2, 0x00, 0x00, 0x02])
+ESMC_PDU_LEN = 60
+ESMC_SSM_OFFSET = 27
+
+# Network option 1 SSM codes
+SSM_PRC = 0x2
+SSM_SSUB = 0x8
+
+MAX_NUM_OF_CLOCKS = 32
+MNG_IF_PORT_NUM = 2400
+STARTUP_TIMEOUT_S = 10
+
+
+def run(cmd, **kwargs):
+    return subprocess.run(cmd, check=True, **kwargs)
+
+
+def setns(fd, name):
+    libc = ctypes.CDLL(None, use_errno=True)
+    if libc.setns(fd, CLONE_NEWNET) != 0:
+        errno = ctypes.get_errno()
+        raise OSError(errno, "setns %s: %s" % (name, os.strerror(errno)))
+
+
+def esmc_pdu(src_mac_addr, ssm_code, event_flag):
+    """Return an ESMC PDU without extended QL TLV (as sent by a non-enhanced node)."""
+    pdu = SLOW_PROTO_MCAST_ADDR + src_mac_addr + ETH_P_SLOW.to_bytes(2, "big")
+    pdu += bytes([0x0A, 0x00, 0x19, 0xA7, 0x00, 0x01, 0x18 if event_flag else 0x10, 0x00, 0x00, 0x00])
+    pdu += bytes([0x01, 0x00, 0x04, ssm_code])
+    return pdu + bytes(ESMC_PDU_LEN - len(pdu))
+
+
+class Testbed:
+    """Namespaces, veth pairs and a running synced for one scenario."""
+
+    def __init__(self, args, num_ports):
+        self.args = args
+        self.num_ports = num_ports
+        self.dut_ns = "synced-e2e-dut-%d" % os.getpid()
+        self.gen_ns = "synced-e2e-gen-%d" % os.getpid()
+        self.work_dir = tempfile.mkdtemp(prefix="synced_e2e_")
+        self.proc = None
+
+    def dut_port(self, i):
+        return "dut%d" % i
+
+    def gen_port(self, i):
+        return "gen%d" % i
+
+    def create(self):
+        run(["ip", "netns", "add", self.dut_ns])
+        run(["ip", "netns", "add", self.gen_ns])
+        cmds = []
+        for i in range(self.num_ports):
+            cmds.append("link add %s netns %s type veth peer name %s netns %s"
+                        % (self.dut_port(i), self.dut_ns, self.gen_port(i), self.gen_ns))
+        run(["ip", "-batch", "-"], input="\n".join(cmds) + "\n", text=True)
+        for ns, port in ((self.dut_ns, self.dut_port), (self.gen_ns, self.gen_port)):
+            cmds = ["link set lo up"] + ["link set %s up" % port(i) for i in range(self.num_ports)]
+            run(["ip", "-n", ns, "-batch", "-"], input="\n".join(cmds) + "\n", text=True)
+
+    def write_cfg(self):
+        lines = [
+            "[global]",
+            "net_opt 1",
+            "lo_ql SEC",
+            "holdover_ql SEC",
+            "max_msg_lvl 5",
+            "wtr_tmr 0",
+            "mng_if_en 1",
+            "mng_if_ip_addr 127.0.0.1",
+            "mng_if_port_num %d" % MNG_IF_PORT_NUM,
+        ]
+        for i in range(self.num_ports):
+            lines += ["[%s]" % self.dut_port(i), "tx_en 1", "rx_en 1", "pri %d" % i]
+            # Clock indices are unique, so further ports are monitoring ports
+            if i < MAX_NUM_OF_CLOCKS:
+                lines.append("clk_idx %d" % i)
+        path = os.path.join(self.work_dir, "synced.cfg")
+        with open(path, "w") as cfg_file:
+            cfg_file.write("\n".join(lines) + "\n")
+        return path
+
+    def start(self):
+        cfg_path = self.write_cfg()
+        log = open(os.path.join(self.work_dir, "synced.log"), "w")
+        # ip netns exec replaces itself with synced, so the PID is the one of synced
+        self.proc = subprocess.Popen(["ip", "netns", "exec", self.dut_ns, self.args.synced, "-f", cfg_path],
+                                     stdout=log, stderr=subprocess.STDOUT)
+        deadline = time.monotonic() + STARTUP_TIMEOUT_S
+        while time.monotonic() < deadline:
+            if self.proc.poll() is not None:
+                raise RuntimeError("synced exited with %d (see %s)" % (self.proc.returncode, log.name))
+            if self.cli("get_current_status") is not None:
+                return
+            time.sleep(0.2)
+        raise RuntimeError("synced did not start within %d s" % STARTUP_TIMEOUT_S)
+
+    def cli(self, command):
+        result = subprocess.run(["ip", "netns", "exec", self.dut_ns, self.args.synced_cli,
+                                 "127.0.0.1", str(MNG_IF_PORT_NUM), "0", "-c", command],
+                                stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+        # synced_cli exits with 255 after a command, so check the output instead
+        if ("Connected" not in result.stdout) or ("***Error" in result.stdout):
+            return None
+        return result.stdout
+
+    def stop(self):
+        if self.proc is not None and self.proc.poll() is None:
+            self.proc.send_signal(signal.SIGINT)
+            try:
+                self.proc.wait(timeout=10)
+            except subprocess.TimeoutExpired:
+                self.proc.kill()
+                self.proc.wait()
+
+    def destroy(self):
+        self.stop()
+        for ns in (self.dut_ns, self.gen_ns):
+            subprocess.run(["ip", "netns", "del", ns], stderr=subprocess.DEVNULL)
+
+
+class ProcSample:
+    """CPU time, context switches and RSS of a process at one point in time."""
+
+    def __init__(self, pid):
+        self.time_s = time.monotonic()
+        with open("/proc/%d/stat" % pid) as stat_file:
+            fields = stat_file.read().rsplit(")", 1)[1].split()
+        self.cpu_s = (int(fields[11]) + int(fields[12])) / os.sysconf("SC_CLK_TCK")
+        self.ctxt_switches = 0
+        for tid in os.listdir("/proc/%d/task" % pid):
+            try:
+                with open("/proc/%d/task/%s/status" % (pid, tid)) as status_file:
+                    for line in status_file:
+                        if "ctxt_switches:" in line:
+                            self.ctxt_switches += int(line.split()[1])
+            except FileNotFoundError:
+                pass
+        self.status = {}
+        with open("/proc/%d/status" % pid) as status_file:
+            for line in status_file:
+                key, _, val = line.partition(":")
+                self.status[key] = val.strip()
+
+    def kb(self, key):
+        return int(self.status.get(key, "0 kB").split()[0])
+
+
+def percentile(values, fraction):
+    if not values:
+        return None
+    values = sorted(values)
+    return values[min(len(values) - 1, int(fraction * len(values)))]
+
+
+def drive(testbed, flap_rate_hz, duration_s):
+    """Send PDUs from the generator namespace and measure QL propagation on the second port."""
+    with open("/var/run/netns/" + testbed.gen_ns) as ns_file:
+        setns(ns_file.fileno(), testbed.gen_ns)
+
+    tx_sockets = []
+    for i in range(testbed.num_ports):
+        sock = socket.socket(socket.AF_PACKET, socket.SOCK_RAW, 0)
+        sock.bind((testbed.gen_port(i), 0))
+        tx_sockets.append((sock, sock.getsockname()[4]))
+    rx_socket = socket.socket(socket.AF_PACKET, socket.SOCK_RAW, socket.htons(ETH_P_SLOW))
+    rx_socket.bind((testbed.gen_port(1), 0))
+    rx_socket.setblocking(False)
+
+    latencies_ms = []
+    flaps_sent = 0
+    flaps_lost = 0
+    pending = None                  # (send time, SSM code) of the last unobserved flap
+    ssm_code = SSM_PRC
+
+    now = time.monotonic()
+    end_time = now + duration_s
+    next_info_time = now
+    next_flap_time = now + (1.0 / flap_rate_hz if flap_rate_hz > 0 else duration_s + 1)
+
+    while now < end_time:
+        if now >= next_info_time:
+            for i, (sock, mac_addr) in enumerate(tx_sockets):
+                sock.send(esmc_pdu(mac_addr, ssm_code if i == 0 else SSM_SSUB, False))
+            next_info_time += 1.0
+        if now >= next_flap_time:
+            ssm_code = SSM_SSUB if ssm_code == SSM_PRC else SSM_PRC
+            sock, mac_addr = tx_sockets[0]
+            if pending is not None:
+                flaps_lost += 1
+            pending = (time.monotonic_ns(), ssm_code)
+            sock.send(esmc_pdu(mac_addr, ssm_code, True))
+            flaps_sent += 1
+            next_flap_time += 1.0 / flap_rate_hz
+
+        timeout = max(0.0, min(next_info_time, next_flap_time, end_time) - time.monotonic())
+        if select.select([rx_socket], [], [], timeout)[0]:
+            while True:
+                try:
+                    pdu = rx_socket.recv(1514)
+                except BlockingIOError:
+                    break
+                if (pending is not None) and (len(pdu) > ESMC_SSM_OFFSET) and \
+                   ((pdu[ESMC_SSM_OFFSET] & 0xF) == pending[1]):
+                    latencies_ms.append((time.monotonic_ns() - pending[0]) / 1e6)
+                    pending = None
+        now = time.monotonic()
+
+    for sock, _ in tx_sockets:
+        sock.close()
+    rx_socket.close()
+
+    return {
+        "flaps_sent": flaps_sent,
+        "flaps_observed": len(latencies_ms),
+        "flaps_superseded": flaps_lost,
+        "propagation_ms": {
+            "p50": percentile(latencies_ms, 0.50),
+            "p90": percentile(latencies_ms, 0.90),
+            "p99": percentile(latencies_ms, 0.99),
+            "max": max(latencies_ms) if latencies_ms else None,
+            "mean": statistics.mean(latencies_ms) if latencies_ms else None,
+        },
+    }
+
+
+def parse_latency_stats(output):
+    """Parse the table printed by synced_cli -c get_latency_stats."""
+    stages = {}
+    header = None
+    for line in (output or "").splitlines():
+        words = line.split()
+        if words and words[0] == "Stage":
+            header = [w.lower() for w in line.replace(" (us)", "_us").split()]
+        elif header and (len(words) == len(header)):
+            stages[words[0]] = {key: (int(val) if key == "count" else float(val))
+                                for key, val in zip(header[1:], words[1:])}
+    return stages
+
+
+def run_scenario(args, num_ports, flap_rate_hz):
+    testbed = Testbed(args, num_ports)
+    try:
+        testbed.create()
+        testbed.start()
+        # Let the ports settle before measuring
+        time.sleep(args.settle)
+
+        root_ns = os.open("/proc/self/ns/net", os.O_RDONLY)
+        start = ProcSample(testbed.proc.pid)
+        try:
+            result = drive(testbed, flap_rate_hz, args.duration)
+        finally:
+            setns(root_ns, "root")
+            os.close(root_ns)
+        end = ProcSample(testbed.proc.pid)
+
+        elapsed_s = end.time_s - start.time_s
+        result.update({
+            "ports": num_ports,
+            "flap_rate_hz": flap_rate_hz,
+            "duration_s": args.duration,
+            "cpu_percent": round(100.0 * (end.cpu_s - start.cpu_s) / elapsed_s, 2),
+            "wakeups_per_s": round((end.ctxt_switches - start.ctxt_switches) / elapsed_s, 1),
+            "threads": int(end.status.get("Threads", "0")),
+            "rss_kb": end.kb("VmRSS"),
+            "rss_peak_kb": end.kb("VmHWM"),
+            "synced_latency_us": parse_latency_stats(testbed.cli("get_latency_stats")),
+        })
+        return result
+    finally:
+        testbed.destroy()
+        if not args.keep:
+            subprocess.run(["rm", "-rf", testbed.work_dir])
+
+
+def fmt(val, spec):
+    return "-" if val is None else format(val, spec)
+
+
+def print_summary(report):
+    print("%6s %8s %6s %9s %9s %9s %9s %7s %10s %9s" % ("ports", "flap_hz", "flaps", "p50_ms", "p90_ms", "p99_ms",
+                                                        "max_ms", "cpu_%", "wakeups/s", "rss_kb"))
+    for r in report["scenarios"]:
+        p = r["propagation_ms"]
+        print("%6d %8s %6s %9s %9s %9s %9s %7.2f %10.1f %9d" % (
+            r["ports"], fmt(r["flap_rate_hz"], "g"), "%d/%d" % (r["flaps_observed"], r["flaps_sent"]),
+            fmt(p["p50"], ".2f"), fmt(p["p90"], ".2f"), fmt(p["p99"], ".2f"), fmt(p["max"], ".2f"),
+            r["cpu_percent"], r["wakeups_per_s"], r["rss_kb"]))
+
+
+def main():
+    repo_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--synced", default=os.path.join(repo_dir, "build/bin/synced"))
+    parser.add_argument("--synced-cli", default=os.path.join(repo_dir, "build/bin/synced_cli"))
+    parser.add_argument("--ports", default="8,32,64", help="comma-separated port counts (default: 8,32,64)")
+    parser.add_argument("--flap-rates", default="0.5,2", help="comma-separated QL flaps per second (default: 0.5,2)")
+    parser.add_argument("--duration", type=float, default=20, help="measurement seconds per scenario (default: 20)")
+    parser.add_argument("--settle", type=float, default=3, help="seconds before measuring (default: 3)")
+    parser.add_argument("--output", help="write the JSON report to this file (default: stdout)")
+    parser.add_argument("--keep", action="store_true", help="keep the synced configuration and log files")
+    args = parser.parse_args()
+
+    if os.geteuid() != 0:
+        sys.exit("synced_e2e.py must run as root")
+
+    version = subprocess.run([args.synced, "-v"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                             text=True).stdout.strip()
+    report = {"synced_version": version, "scenarios": []}
+
+    for num_ports in [int(n) for n in args.ports.split(",")]:
+        for flap_rate_hz in [float(r) for r in args.flap_rates.split(",")]:
+            print("Running %d ports at %g flaps/s..." % (num_ports, flap_rate_hz), file=sys.stderr)
+            report["scenarios"].append(run_scenario(args, num_ports, flap_rate_hz))
+
+    text = json.dumps(report, indent=2, sort_keys=True) + "\n"
+    if args.output:
+        with open(args.output, "w") as report_file:
+            report_file.write(text)
+        print_summary(report)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
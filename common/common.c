@@ -161,10 +161,28 @@ static const char *g_api_code_to_str[] = {
   "Clear Sync-E clock wait-to-restore timer",
   "Assign new Sync-E clock port",
   "Set priority",
-  "Set max message level"
+  "Set max message level",
+  "Begin transaction",
+  "Commit transaction",
+  "Abort transaction",
+  "Get port statistics",
+  "Get latency statistics",
+  "Get mutex statistics",
+  "Get journal"
 };
 COMPILE_TIME_ASSERT((sizeof(g_api_code_to_str)/sizeof(g_api_code_to_str[0])) == E_mng_api_max, "Invalid array size for g_api_code_to_str!")
 
+/* See T_latency_stage in types.h */
+static const char *g_latency_stage_enum_to_str[] = {
+  "rx_dispatch",
+  "sync_update",
+  "priority_table",
+  "ql_determination",
+  "tx",
+  "end_to_end"
+};
+COMPILE_TIME_ASSERT((sizeof(g_latency_stage_enum_to_str)/sizeof(g_latency_stage_enum_to_str[0])) == E_latency_stage_max, "Invalid array size for g_latency_stage_enum_to_str!")
+
 /* Global functions */
 
 void generate_clock_id(const unsigned char mac_addr[ETH_ALEN], unsigned char clock_id[MAX_CLK_ID_LEN])
@@ -274,6 +292,16 @@ const char *conv_api_code_to_str(T_mng_api api_code)
   return g_api_code_to_str[api_code];
 }
 
+const char *conv_latency_stage_enum_to_str(T_latency_stage latency_stage)
+{
+  if(latency_stage >= E_latency_stage_max) {
+    pr_err("Failed to convert latency stage enumeration to string");
+    return "**unknown**";
+  }
+
+  return g_latency_stage_enum_to_str[latency_stage];
+}
+
 int check_ql_setting(T_esmc_network_option net_opt, T_esmc_ql ql)
 {
   int valid_flag = -1;
@@ -319,6 +347,24 @@ void mac_addr_arr_to_str(struct sockaddr_ll *mac_addr, char mac_addr_str[MAX_MAC
            mac_addr->sll_addr[3], mac_addr->sll_addr[4], mac_addr->sll_addr[5]);
 }
 
+int mac_addr_str_to_arr(const char *mac_addr_str, unsigned char mac_addr[ETH_ALEN])
+{
+  unsigned int bytes[ETH_ALEN];
+  char end;
+  int i;
+
+  if(sscanf(mac_addr_str, "%2x:%2x:%2x:%2x:%2x:%2x%c",
+            &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5], &end) != ETH_ALEN) {
+    return -1;
+  }
+
+  for(i = 0; i < ETH_ALEN; i++) {
+    mac_addr[i] = bytes[i];
+  }
+
+  return 0;
+}
+
 int calculate_rank(int ql, unsigned char priority, unsigned char hops)
 {
   return (((int)ql << 16) | (priority << 8) | hops);
@@ -349,6 +395,7 @@ void print_sync_info(T_management_sync_info *sync_info)
         pr_info_dump("      No activity alarm: %d\n", sync_info->synce_clk_info.ref_mon_status.no_activity_alarm_status);
         pr_info_dump("      Loss of signal alarm: %d\n", sync_info->synce_clk_info.ref_mon_status.loss_of_signal_alarm_status);
       }
+      pr_info_dump("    Frequency offset degrading: %s\n", sync_info->synce_clk_info.degrading_flag ? "yes" : "no");
       pr_info_dump("    RX timeout: %s\n", sync_info->synce_clk_info.rx_timeout_flag ? "yes" : "no");
       pr_info_dump("    Port link: %s\n", sync_info->synce_clk_info.port_link_down_flag ? "down" : "up");
       break;
@@ -382,6 +429,7 @@ void print_sync_info(T_management_sync_info *sync_info)
         pr_info_dump("      No activity alarm: %d\n", sync_info->ext_clk_info.ref_mon_status.no_activity_alarm_status);
         pr_info_dump("      Loss of signal alarm: %d\n", sync_info->ext_clk_info.ref_mon_status.loss_of_signal_alarm_status);
       }
+      pr_info_dump("    Frequency offset degrading: %s\n", sync_info->ext_clk_info.degrading_flag ? "yes" : "no");
       break;
 
     case E_sync_type_tx_only:
@@ -411,3 +459,191 @@ void print_current_status(T_management_status *status)
     pr_info_dump("  Selected clock index: %d\n", status->clk_idx);
   }
 }
+
+static void print_esmc_port_dir_stats(const char *dir_str, T_esmc_port_dir_stats *stats, int rx_flag)
+{
+  pr_info_dump("    %s:\n", dir_str);
+  pr_info_dump("      PDUs: %llu (event: %llu, information: %llu)\n", stats->pdus, stats->event_pdus, stats->information_pdus);
+  pr_info_dump("      %s: %llu\n", rx_flag ? "Parse errors" : "Send errors", stats->errors);
+  if(rx_flag) {
+    pr_info_dump("      Invalid length PDUs: %llu\n", stats->invalid_len_pdus);
+    pr_info_dump("      Timing loops: %llu\n", stats->timing_loops);
+    pr_info_dump("      Socket drops: %llu\n", stats->socket_drops);
+  }
+  if(stats->last_pdu_age_ms < 0) {
+    pr_info_dump("      Last PDU: never\n");
+  } else {
+    pr_info_dump("      Last PDU: %lld ms ago\n", stats->last_pdu_age_ms);
+  }
+}
+
+void print_port_stats(T_management_port_stats *port_stats)
+{
+  pr_info_dump("  [%s]\n", port_stats->name);
+  if(port_stats->esmc_stats.tx_flag) {
+    print_esmc_port_dir_stats("TX", &port_stats->esmc_stats.tx, 0);
+  }
+  if(port_stats->esmc_stats.rx_flag) {
+    print_esmc_port_dir_stats("RX", &port_stats->esmc_stats.rx, 1);
+  }
+}
+
+void print_latency_stats(T_management_latency_stats *latency_stats)
+{
+  T_latency_stage_stats *stats;
+  int stage;
+
+  pr_info_dump("  %-16s %10s %12s %12s %12s %12s %12s %12s %12s\n",
+               "Stage", "Count", "Min (us)", "Mean (us)", "P50 (us)", "P90 (us)", "P99 (us)", "P99.9 (us)", "Max (us)");
+  for(stage = 0; stage < E_latency_stage_max; stage++) {
+    stats = &latency_stats->stages[stage];
+    pr_info_dump("  %-16s %10llu %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n",
+                 conv_latency_stage_enum_to_str(stage),
+                 stats->count,
+                 stats->min_ns / 1e3,
+                 stats->mean_ns / 1e3,
+                 stats->p50_ns / 1e3,
+                 stats->p90_ns / 1e3,
+                 stats->p99_ns / 1e3,
+                 stats->p999_ns / 1e3,
+                 stats->max_ns / 1e3);
+  }
+}
+
+static void print_mutex_prof_stats(T_os_mutex_prof_stats *stats)
+{
+  pr_info_dump("  %-32s %10llu %10llu %12.1f %12.1f %12.1f %12.1f\n",
+               stats->name,
+               stats->acquisitions,
+               stats->contended,
+               stats->total_wait_ns / 1e3,
+               stats->max_wait_ns / 1e3,
+               stats->total_hold_ns / 1e3,
+               stats->max_hold_ns / 1e3);
+}
+
+void print_mutex_stats(T_os_mutex_prof_report *report)
+{
+  int i;
+
+  pr_info_dump("  Per mutex:\n");
+  pr_info_dump("  %-32s %10s %10s %12s %12s %12s %12s\n",
+               "Mutex", "Acquired", "Contended", "Wait (us)", "Max wait", "Hold (us)", "Max hold");
+  for(i = 0; i < report->num_mutexes; i++) {
+    print_mutex_prof_stats(&report->mutexes[i]);
+  }
+
+  pr_info_dump("  Per call site:\n");
+  for(i = 0; i < report->num_sites; i++) {
+    print_mutex_prof_stats(&report->sites[i]);
+    pr_info_dump("    at %s in %s()\n", report->sites[i].site, report->sites[i].func);
+  }
+  if(report->num_dropped_sites > 0) {
+    pr_info_dump("  (%d call sites with less wait time not shown)\n", report->num_dropped_sites);
+  }
+}
+
+static const char *conv_alarm_type_enum_to_str(T_alarm_type alarm_type)
+{
+  switch(alarm_type) {
+    case E_alarm_type_invalid_clock_idx:
+      return "Invalid clock index";
+    case E_alarm_type_invalid_sync_idx:
+      return "Invalid sync index";
+    case E_alarm_type_timing_loop:
+      return "Timing loop";
+    case E_alarm_type_invalid_rx_ql:
+      return "Invalid RX QL";
+    case E_alarm_type_reference_degradation:
+      return "Reference degradation";
+    default:
+      return "**unknown**";
+  }
+}
+
+/* Old QL and Sync-E DPLL state are not yet known for the first change after start */
+static const char *conv_journal_ql_to_str(int ql)
+{
+  return ((ql < 0) || (ql >= E_esmc_ql_max)) ? "none" : conv_ql_enum_to_str(ql);
+}
+
+static const char *conv_journal_synce_dpll_state_to_str(int synce_dpll_state)
+{
+  return ((synce_dpll_state < 0) || (synce_dpll_state >= E_device_dpll_state_max)) ? "none" : conv_synce_dpll_state_enum_to_str(synce_dpll_state);
+}
+
+void print_journal_entry(T_journal_entry const *entry, const char *time_str, const char *port_name)
+{
+  char event_str[128];
+
+  switch(entry->type) {
+    case E_journal_event_type_esmc:
+      if(entry->val[0] == E_esmc_event_type_ql_change) {
+        snprintf(event_str, sizeof(event_str), "ESMC %s to %s",
+                 conv_esmc_event_type_enum_to_str(entry->val[0]), conv_journal_ql_to_str(entry->val[1]));
+      } else {
+        snprintf(event_str, sizeof(event_str), "ESMC %s", conv_esmc_event_type_enum_to_str(entry->val[0]));
+      }
+      break;
+
+    case E_journal_event_type_sync_state:
+      snprintf(event_str, sizeof(event_str), "State %s -> %s",
+               conv_sync_state_enum_to_str(entry->val[0]), conv_sync_state_enum_to_str(entry->val[1]));
+      break;
+
+    case E_journal_event_type_sync_clk_state:
+      snprintf(event_str, sizeof(event_str), "Clock %d %s -> %s",
+               entry->val[2], conv_sync_clk_state_enum_to_str(entry->val[0]), conv_sync_clk_state_enum_to_str(entry->val[1]));
+      break;
+
+    case E_journal_event_type_rank:
+      snprintf(event_str, sizeof(event_str), "Rank 0x%X -> 0x%X (QL: %s)",
+               entry->val[0], entry->val[1], conv_journal_ql_to_str(entry->val[2]));
+      break;
+
+    case E_journal_event_type_device_priorities:
+      snprintf(event_str, sizeof(event_str), "Clock priorities set for %d clocks (first: %d)%s",
+               entry->val[0], entry->val[1], (entry->val[2] < 0) ? " failed" : "");
+      break;
+
+    case E_journal_event_type_dpll_state:
+      snprintf(event_str, sizeof(event_str), "Sync-E DPLL %s -> %s",
+               conv_journal_synce_dpll_state_to_str(entry->val[0]), conv_journal_synce_dpll_state_to_str(entry->val[1]));
+      break;
+
+    case E_journal_event_type_current_ql:
+      snprintf(event_str, sizeof(event_str), "Current QL %s -> %s (clock index: %d)",
+               conv_journal_ql_to_str(entry->val[0]), conv_journal_ql_to_str(entry->val[1]), entry->val[2]);
+      break;
+
+    case E_journal_event_type_alarm:
+      snprintf(event_str, sizeof(event_str), "Alarm %s (%d, clock index: %d)",
+               conv_alarm_type_enum_to_str(entry->val[0]), entry->val[1], entry->val[2]);
+      break;
+
+    default:
+      snprintf(event_str, sizeof(event_str), "Unknown event %d (%d, %d, %d)",
+               entry->type, entry->val[0], entry->val[1], entry->val[2]);
+      break;
+  }
+
+  pr_info_dump("  %10llu %20s %-16s %s\n", entry->seq, time_str, port_name, event_str);
+}
+
+void print_journal(T_management_journal *journal)
+{
+  T_journal_entry *entry;
+  char time_str[32];
+  int i;
+
+  pr_info_dump("  %10s %20s %-16s %s\n", "Seq", "Time (s)", "Port", "Event");
+  for(i = 0; i < journal->num_entries; i++) {
+    entry = &journal->entries[i].entry;
+    snprintf(time_str, sizeof(time_str), "%llu.%09llu", entry->time_ns / 1000000000ULL, entry->time_ns % 1000000000ULL);
+    print_journal_entry(entry, time_str, journal->entries[i].port_name);
+  }
+  if(journal->num_lost > 0) {
+    pr_info_dump("  (%llu entries were overwritten before they were read)\n", journal->num_lost);
+  }
+  pr_info_dump("  Last sequence number: %llu\n", journal->last_seq);
+}
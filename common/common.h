@@ -82,9 +82,12 @@ const char *conv_esmc_event_type_enum_to_str(T_esmc_event_type esmc_event_type);
 
 const char *conv_api_code_to_str(T_mng_api api_code);
 
+const char *conv_latency_stage_enum_to_str(T_latency_stage latency_stage);
+
 int check_ql_setting(T_esmc_network_option net_opt, T_esmc_ql ql);
 
 void mac_addr_arr_to_str(struct sockaddr_ll *mac_addr, char mac_addr_str[MAX_MAC_ADDR_STR_LEN]);
+int mac_addr_str_to_arr(const char *mac_addr_str, unsigned char mac_addr[ETH_ALEN]);
 
 int calculate_rank(int ql, unsigned char priority, unsigned char hops);
 
@@ -92,4 +95,15 @@ void print_sync_info(T_management_sync_info *sync_info);
 
 void print_current_status(T_management_status *status);
 
+void print_port_stats(T_management_port_stats *port_stats);
+
+void print_latency_stats(T_management_latency_stats *latency_stats);
+
+void print_mutex_stats(T_os_mutex_prof_report *report);
+
+/* time_str is printed as is; the monotonic time in seconds or the wall-clock time of a flight recorder file */
+void print_journal_entry(T_journal_entry const *entry, const char *time_str, const char *port_name);
+
+void print_journal(T_management_journal *journal);
+
 #endif /* COMMON_H */
@@ -235,8 +235,17 @@ static struct config_item g_config_table[] = {
   GLOB_ITEM_INT("lo_pri", 255, 0, 255),
   GLOB_ITEM_STR("msg_tag", NULL),
   GLOB_ITEM_INT("max_msg_lvl", PRINT_LEVEL_MAX, PRINT_LEVEL_MIN, PRINT_LEVEL_MAX),
+  GLOB_ITEM_INT("max_msg_lvl_esmc", -1, -1, PRINT_LEVEL_MAX),                      /* -1: use max_msg_lvl */
+  GLOB_ITEM_INT("max_msg_lvl_control", -1, -1, PRINT_LEVEL_MAX),
+  GLOB_ITEM_INT("max_msg_lvl_monitor", -1, -1, PRINT_LEVEL_MAX),
+  GLOB_ITEM_INT("max_msg_lvl_device", -1, -1, PRINT_LEVEL_MAX),
+  GLOB_ITEM_INT("max_msg_lvl_management", -1, -1, PRINT_LEVEL_MAX),
   GLOB_ITEM_INT("stdout_en", 1, 0, 1),
   GLOB_ITEM_INT("syslog_en", 0, 0, 1),
+  GLOB_ITEM_INT("async_log_en", 0, 0, 1),
+  GLOB_ITEM_INT("async_log_queue_len", 1024, 16, 65536),                          /* Messages */
+  GLOB_ITEM_INT("log_ratelimit_interval_ms", 5000, 0, INT32_MAX),                  /* Milliseconds; 0 disables */
+  GLOB_ITEM_INT("log_ratelimit_burst", 1, 1, 1000),
   GLOB_ITEM_STR("device_cfg_file", NULL),                                          /* Applicable for generic device */
   GLOB_ITEM_STR("device_name", "/dev/rsmu1"),
   GLOB_ITEM_INT("synce_dpll_idx", 0, 0, 7),
@@ -244,13 +253,40 @@ static struct config_item g_config_table[] = {
   GLOB_ITEM_INT("holdover_tmr", 300, 0, INT32_MAX),                                /* Seconds */
   GLOB_ITEM_INT("hoff_tmr", 300, 0, INT16_MAX),                                    /* Milliseconds */
   GLOB_ITEM_INT("wtr_tmr", 300, 0, INT16_MAX),                                     /* Seconds */
+  GLOB_ITEM_INT("degradation_detection_en", 0, 0, 1),
+  GLOB_ITEM_DBL("degradation_ewma_weight", 0.01, DBL_MIN, 1.0),
+  GLOB_ITEM_DBL("degradation_cusum_drift_ppb", 1.0, 0.0, DBL_MAX),                 /* Parts per billion */
+  GLOB_ITEM_DBL("degradation_cusum_threshold_ppb", 20.0, 0.0, DBL_MAX),            /* Parts per billion */
+  GLOB_ITEM_INT("degradation_rank_penalty", 16, 0, 255),                           /* Priority steps */
   GLOB_ITEM_INT("advanced_holdover_en", 0, 0, 1),
+  GLOB_ITEM_INT("adaptive_holdover_en", 0, 0, 1),
+  GLOB_ITEM_INT("adaptive_holdover_budget_ns", 1000, 1, INT32_MAX),               /* Nanoseconds */
+  GLOB_ITEM_INT("adaptive_holdover_window_s", 300, 2, 3600),                       /* Seconds */
   GLOB_ITEM_INT("pcm4l_if_en", 0, 0, 1),
   GLOB_ITEM_STR("pcm4l_if_ip_addr", ""),
   GLOB_ITEM_INT("pcm4l_if_port_num", 2400, 1024, UINT16_MAX),
+  GLOB_ITEM_STR("pcm4l_if_unix_path", ""),                                         /* Overrides IP address and port number */
   GLOB_ITEM_INT("mng_if_en", 0, 0, 1),
   GLOB_ITEM_STR("mng_if_ip_addr", ""),
   GLOB_ITEM_INT("mng_if_port_num", 2400, 1024, UINT16_MAX),
+  GLOB_ITEM_STR("mng_if_unix_path", ""),
+  GLOB_ITEM_INT("mng_if_unix_gid", -1, -1, INT32_MAX),
+  GLOB_ITEM_INT("status_page_en", 0, 0, 1),
+  GLOB_ITEM_STR("status_page_path", "/dev/shm/synced"),
+  GLOB_ITEM_INT("flight_recorder_en", 0, 0, 1),
+  GLOB_ITEM_STR("flight_recorder_path", "/var/tmp/synced.rec"),
+  GLOB_ITEM_INT("flight_recorder_num_entries", 65536, 1024, 16777216),            /* Entries (rounded up to a power of two) */
+  GLOB_ITEM_INT("flight_recorder_sync_interval_ms", 0, 0, INT32_MAX),              /* Milliseconds; 0 leaves write-back to the kernel */
+  GLOB_ITEM_INT("trace_en", 0, 0, 1),
+  GLOB_ITEM_INT("trace_buffer_len", 16384, 256, 1048576),                         /* Records per thread */
+  GLOB_ITEM_STR("trace_path", "/tmp/synced_trace.json"),
+  GLOB_ITEM_INT("metrics_en", 0, 0, 1),
+  GLOB_ITEM_STR("metrics_ip_addr", "127.0.0.1"),
+  GLOB_ITEM_INT("metrics_port_num", 9464, 1024, UINT16_MAX),
+  GLOB_ITEM_STR("pcap_in", ""),                                                    /* Replaces raw sockets of ESMC ports */
+  GLOB_ITEM_STR("pcap_out", ""),
+  GLOB_ITEM_INT("pcap_speed", 1, 0, 1000),                                         /* 0: as fast as possible */
+  GLOB_ITEM_INT("pcap_exit_delay", 2, -1, 3600),                                   /* Seconds; -1 keeps running */
 
   /* Interface (port) variables */
   PORT_ITEM_INT("clk_idx", MISSING_CLK_IDX, 0, MAX_NUM_OF_CLOCKS - 1), /* Default value is MISSING_CLK_IDX, which means Tx-only or Sync-E monitoring port */
@@ -258,7 +294,9 @@ static struct config_item g_config_table[] = {
   PORT_ITEM_STR("init_ql", DEFAULT_INIT_QL_STR),
   PORT_ITEM_INT("tx_en", 0, 0, 1),
   PORT_ITEM_INT("rx_en", 0, 0, 1),
-  PORT_ITEM_INT("tx_bundle_num", NO_TX_BUNDLE_NUM, NO_TX_BUNDLE_NUM, 255)
+  PORT_ITEM_INT("tx_bundle_num", NO_TX_BUNDLE_NUM, NO_TX_BUNDLE_NUM, 255),
+  PORT_ITEM_STR("pcap_if", ""),                                                    /* Capture interface name or number; default: port name */
+  PORT_ITEM_STR("pcap_mac_addr", "")
 };
 
 /* Static functions */
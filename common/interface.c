@@ -148,6 +148,22 @@ int interface_config_idx_and_mac_addr(struct interface *iface)
   return ret;
 }
 
+void interface_config_virtual_idx_and_mac_addr(struct interface *iface, int idx, const unsigned char mac_addr[ETH_ALEN])
+{
+  /* Ports of a replayed capture are not backed by net devices */
+
+  struct sockaddr_ll addr;
+
+  interface_config_idx(iface, idx);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sll_family = AF_PACKET;
+  addr.sll_ifindex = idx;
+  addr.sll_halen = ETH_ALEN;
+  memcpy(addr.sll_addr, mac_addr, ETH_ALEN);
+  interface_config_mac_addr(iface, &addr);
+}
+
 void interface_config_clk_idx(struct interface *iface, int clk_idx)
 {
   iface->clk_idx = clk_idx;
@@ -13,6 +13,7 @@
 #ifndef INTERFACE_H
 #define INTERFACE_H
 
+#include <linux/if_ether.h>
 #include <sys/queue.h>
 
 #include "types.h"
@@ -25,6 +26,7 @@ struct interface *interface_create(const char *name);
 void interface_destroy(struct interface *iface);
 
 int interface_config_idx_and_mac_addr(struct interface *iface);
+void interface_config_virtual_idx_and_mac_addr(struct interface *iface, int idx, const unsigned char mac_addr[ETH_ALEN]);
 void interface_config_clk_idx(struct interface *iface, int clk_idx);
 void interface_config_pri(struct interface *iface, int pri);
 void interface_config_tx_en(struct interface *iface, int tx_en);
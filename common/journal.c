@@ -0,0 +1,322 @@
+/**
+ * @file journal.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "journal.h"
+#include "os.h"
+#include "print.h"
+
+#define JOURNAL_INDEX_MASK  (JOURNAL_NUM_OF_ENTRIES - 1)
+
+#define JOURNAL_RECORDER_FILE_MODE  0644
+
+COMPILE_TIME_ASSERT(sizeof(T_journal_recorder_header) <= JOURNAL_RECORDER_HEADER_SIZE, "T_journal_recorder_header does not fit in JOURNAL_RECORDER_HEADER_SIZE!")
+
+/* Static data */
+
+/*
+ * The seq field of a slot doubles as its commit marker: it is cleared before the slot is rewritten and set to the
+ * new sequence number once the slot is complete, so a reader that sees the same sequence number before and after
+ * copying has a consistent entry.
+ */
+static T_journal_entry g_journal_entries[JOURNAL_NUM_OF_ENTRIES];
+static unsigned long long g_journal_last_seq = 0;
+
+/* Flight recorder; g_journal_recorder_entries is NULL unless enabled */
+static void *g_journal_recorder_map = NULL;
+static size_t g_journal_recorder_map_size = 0;
+static T_journal_recorder_header *g_journal_recorder_header = NULL;
+static T_journal_entry *g_journal_recorder_entries = NULL;
+static unsigned long long g_journal_recorder_index_mask = 0;
+static int g_journal_recorder_sync_interval_ms = 0;
+static unsigned long long g_journal_recorder_last_sync_ms = 0;
+
+/* Static functions */
+
+static unsigned long long journal_get_time_ns(void)
+{
+  struct timespec current_time;
+
+  /* Same clock as the log timestamps */
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return ((unsigned long long)current_time.tv_sec * 1000000000ULL) + current_time.tv_nsec;
+}
+
+static void journal_write_slot(T_journal_entry *slot,
+                               unsigned long long seq,
+                               unsigned long long time_ns,
+                               T_journal_event_type type,
+                               int sync_idx,
+                               int val0,
+                               int val1,
+                               int val2)
+{
+  __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  slot->time_ns = time_ns;
+  slot->type = (short)type;
+  slot->sync_idx = (short)sync_idx;
+  slot->val[0] = val0;
+  slot->val[1] = val1;
+  slot->val[2] = val2;
+
+  __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+}
+
+/* Return 0 and copy the entry with sequence number seq, 1 if it is not yet complete, and -1 if it was overwritten */
+static int journal_copy_entry(unsigned long long seq, T_journal_entry *entry)
+{
+  T_journal_entry const *slot = &g_journal_entries[seq & JOURNAL_INDEX_MASK];
+  unsigned long long seq_begin;
+  unsigned long long seq_end;
+
+  seq_begin = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+  if(seq_begin != seq) {
+    return ((seq_begin == 0) || (seq_begin < seq)) ? 1 : -1;
+  }
+
+  memcpy(entry, slot, sizeof(*entry));
+
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  seq_end = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+
+  return (seq_end == seq) ? 0 : -1;
+}
+
+static void journal_sink_record(void *ctx, T_journal_event_type type, int sync_idx, int val0, int val1, int val2)
+{
+  (void)ctx;
+
+  journal_record(type, sync_idx, val0, val1, val2);
+}
+
+static const T_journal_sink g_journal_sink = {
+  NULL,
+  journal_sink_record
+};
+
+/* Global functions */
+
+void journal_record(T_journal_event_type type, int sync_idx, int val0, int val1, int val2)
+{
+  T_journal_entry *recorder_entries;
+  unsigned long long seq;
+  unsigned long long time_ns;
+
+  seq = __atomic_add_fetch(&g_journal_last_seq, 1, __ATOMIC_RELAXED);
+  time_ns = journal_get_time_ns();
+
+  journal_write_slot(&g_journal_entries[seq & JOURNAL_INDEX_MASK], seq, time_ns, type, sync_idx, val0, val1, val2);
+
+  recorder_entries = __atomic_load_n(&g_journal_recorder_entries, __ATOMIC_ACQUIRE);
+  if(recorder_entries != NULL) {
+    journal_write_slot(&recorder_entries[seq & g_journal_recorder_index_mask], seq, time_ns, type, sync_idx, val0, val1, val2);
+  }
+}
+
+T_journal_sink const *journal_get_sink(void)
+{
+  return &g_journal_sink;
+}
+
+int journal_read(unsigned long long since_seq,
+                 T_journal_entry *entries,
+                 int max_entries,
+                 unsigned long long *last_seq,
+                 unsigned long long *num_lost)
+{
+  unsigned long long newest_seq;
+  unsigned long long seq;
+  int num_entries = 0;
+  int ret;
+
+  newest_seq = __atomic_load_n(&g_journal_last_seq, __ATOMIC_ACQUIRE);
+  *num_lost = 0;
+
+  /* A sequence number from before synced restarted reads from the start */
+  if(since_seq > newest_seq) {
+    since_seq = 0;
+  }
+
+  seq = since_seq + 1;
+  if((newest_seq > JOURNAL_NUM_OF_ENTRIES) && (seq <= (newest_seq - JOURNAL_NUM_OF_ENTRIES))) {
+    *num_lost = (newest_seq - JOURNAL_NUM_OF_ENTRIES + 1) - seq;
+    seq = newest_seq - JOURNAL_NUM_OF_ENTRIES + 1;
+  }
+
+  for(; (seq <= newest_seq) && (num_entries < max_entries); seq++) {
+    ret = journal_copy_entry(seq, &entries[num_entries]);
+    if(ret > 0) {
+      /* Keep entries in order; the caller picks this one up next time */
+      break;
+    } else if(ret < 0) {
+      (*num_lost)++;
+    } else {
+      num_entries++;
+    }
+  }
+
+  *last_seq = seq - 1;
+
+  return num_entries;
+}
+
+int journal_recorder_init(const char *path, int num_entries, int sync_interval_ms)
+{
+  char prev_path[PATH_MAX];
+  struct timespec realtime;
+  struct timespec monotonic;
+  T_journal_entry entry;
+  unsigned long long seq;
+  unsigned long long newest_seq;
+  unsigned int rounded_num_entries = 1;
+  int fd;
+
+  if(snprintf(prev_path, sizeof(prev_path), "%s.prev", path) >= (int)sizeof(prev_path)) {
+    pr_err("Flight recorder path %s is too long", path);
+    return -1;
+  }
+
+  while(rounded_num_entries < (unsigned int)num_entries) {
+    rounded_num_entries <<= 1;
+  }
+
+  /* Keep the record of the previous run for post-mortem analysis */
+  if((rename(path, prev_path) < 0) && (errno != ENOENT)) {
+    pr_warning("Failed to keep previous flight recorder file %s: %s", path, strerror(errno));
+  }
+
+  fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, JOURNAL_RECORDER_FILE_MODE);
+  if(fd < 0) {
+    pr_err("%s: %s: %s", __func__, path, strerror(errno));
+    return -1;
+  }
+
+  g_journal_recorder_map_size = JOURNAL_RECORDER_HEADER_SIZE + ((size_t)rounded_num_entries * sizeof(T_journal_entry));
+
+  /* Allocate the blocks now, so a full disk is reported here rather than as SIGBUS when recording */
+  if(posix_fallocate(fd, 0, g_journal_recorder_map_size) != 0) {
+    pr_err("%s: failed to allocate %zu bytes for %s", __func__, g_journal_recorder_map_size, path);
+    close(fd);
+    return -1;
+  }
+
+  g_journal_recorder_map = mmap(NULL, g_journal_recorder_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(g_journal_recorder_map == MAP_FAILED) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_journal_recorder_map = NULL;
+    return -1;
+  }
+
+  clock_gettime(CLOCK_REALTIME, &realtime);
+  clock_gettime(CLOCK_MONOTONIC, &monotonic);
+
+  /* The file is zero-filled, so readers reject it until the magic number is set */
+  g_journal_recorder_header = g_journal_recorder_map;
+  g_journal_recorder_header->version = JOURNAL_RECORDER_VERSION;
+  g_journal_recorder_header->header_size = JOURNAL_RECORDER_HEADER_SIZE;
+  g_journal_recorder_header->entry_size = sizeof(T_journal_entry);
+  g_journal_recorder_header->num_entries = rounded_num_entries;
+  g_journal_recorder_header->pid = getpid();
+  g_journal_recorder_header->realtime_offset_ns = ((int64_t)realtime.tv_sec - monotonic.tv_sec) * 1000000000LL +
+                                                  ((int64_t)realtime.tv_nsec - monotonic.tv_nsec);
+  __atomic_store_n(&g_journal_recorder_header->magic, JOURNAL_RECORDER_MAGIC, __ATOMIC_RELEASE);
+
+  g_journal_recorder_sync_interval_ms = sync_interval_ms;
+  g_journal_recorder_last_sync_ms = os_get_monotonic_milliseconds();
+  g_journal_recorder_index_mask = rounded_num_entries - 1;
+
+  /* Copy the events recorded so far, then record new ones directly */
+  __atomic_store_n(&g_journal_recorder_entries,
+                   (T_journal_entry *)((char *)g_journal_recorder_map + JOURNAL_RECORDER_HEADER_SIZE),
+                   __ATOMIC_RELEASE);
+  newest_seq = __atomic_load_n(&g_journal_last_seq, __ATOMIC_ACQUIRE);
+  seq = (newest_seq > JOURNAL_NUM_OF_ENTRIES) ? (newest_seq - JOURNAL_NUM_OF_ENTRIES + 1) : 1;
+  for(; seq <= newest_seq; seq++) {
+    /* Entries still being written at startup are skipped */
+    if((journal_copy_entry(seq, &entry) == 0) &&
+       (g_journal_recorder_entries[seq & g_journal_recorder_index_mask].seq == 0)) {
+      memcpy(&g_journal_recorder_entries[seq & g_journal_recorder_index_mask], &entry, sizeof(entry));
+    }
+  }
+
+  return 0;
+}
+
+void journal_recorder_set_sync_name(int sync_idx, const char *name)
+{
+  if((g_journal_recorder_header == NULL) || (sync_idx < 0) || (sync_idx >= MAX_NUM_OF_SYNC_ENTRIES)) {
+    return;
+  }
+
+  strncpy(g_journal_recorder_header->sync_names[sync_idx], name, INTERFACE_MAX_NAME_LEN - 1);
+  if(sync_idx >= g_journal_recorder_header->num_syncs) {
+    g_journal_recorder_header->num_syncs = sync_idx + 1;
+  }
+}
+
+void journal_recorder_sync(void)
+{
+  unsigned long long current_time_ms;
+
+  if((g_journal_recorder_map == NULL) || (g_journal_recorder_sync_interval_ms == 0)) {
+    return;
+  }
+
+  current_time_ms = os_get_monotonic_milliseconds();
+  if((current_time_ms - g_journal_recorder_last_sync_ms) < (unsigned long long)g_journal_recorder_sync_interval_ms) {
+    return;
+  }
+  g_journal_recorder_last_sync_ms = current_time_ms;
+
+  /* Only dirty pages are written */
+  if(msync(g_journal_recorder_map, g_journal_recorder_map_size, MS_SYNC) < 0) {
+    pr_err_ratelimited("Failed to sync flight recorder: %s", strerror(errno));
+  }
+}
+
+void journal_recorder_deinit(void)
+{
+  if(g_journal_recorder_map == NULL) {
+    return;
+  }
+
+  __atomic_store_n(&g_journal_recorder_entries, NULL, __ATOMIC_RELEASE);
+
+  /* The file is kept */
+  msync(g_journal_recorder_map, g_journal_recorder_map_size, MS_SYNC);
+  munmap(g_journal_recorder_map, g_journal_recorder_map_size);
+  g_journal_recorder_map = NULL;
+  g_journal_recorder_header = NULL;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file journal.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+
+#include "common.h"
+#include "types.h"
+
+/*
+ * Fixed-size in-memory ring of control events (see T_journal_event_type). Recording claims a sequence number with
+ * one atomic add and fills the slot in place, so it neither locks nor allocates and can be called from any thread,
+ * including with module mutexes held. The oldest entries are overwritten when the ring is full.
+ */
+
+#define JOURNAL_NUM_OF_ENTRIES  4096    /* Must be a power of two */
+
+/*
+ * Journal seen by a control instance and its monitor. synced uses journal_get_sink(), which records with
+ * journal_record(); a simulator gives each instance its own journal.
+ */
+typedef struct {
+  void *ctx;
+  void (*record)(void *ctx, T_journal_event_type type, int sync_idx, int val0, int val1, int val2);
+} T_journal_sink;
+
+void journal_record(T_journal_event_type type, int sync_idx, int val0, int val1, int val2);
+T_journal_sink const *journal_get_sink(void);
+
+/*
+ * Copy up to max_entries entries with sequence numbers greater than since_seq, oldest first, and return the number
+ * copied. last_seq is set to the sequence number to pass as since_seq to continue reading and num_lost to the number
+ * of entries after since_seq that were overwritten before they could be read.
+ */
+int journal_read(unsigned long long since_seq,
+                 T_journal_entry *entries,
+                 int max_entries,
+                 unsigned long long *last_seq,
+                 unsigned long long *num_lost);
+
+/*
+ * Flight recorder: an optional memory-mapped file (e.g., /var/tmp/synced.rec) that receives a copy of every journal
+ * entry. Entries are written in place like the in-memory ring, without system calls, so the file holds the last
+ * num_entries events when synced crashes. Pages are written back by the kernel unless a sync interval is set; a file
+ * left by a previous run is kept with the suffix .prev.
+ *
+ * Readers only need this header and journal_reader.c.
+ */
+
+#define JOURNAL_RECORDER_MAGIC          0x53594E4A /* "SYNJ" */
+#define JOURNAL_RECORDER_VERSION        1
+#define JOURNAL_RECORDER_HEADER_SIZE    4096       /* Entries start on the second page */
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size;                     /* JOURNAL_RECORDER_HEADER_SIZE */
+  uint32_t entry_size;                      /* sizeof(T_journal_entry) */
+  uint32_t num_entries;                     /* Power of two */
+  int32_t pid;
+  int64_t realtime_offset_ns;               /* CLOCK_REALTIME minus CLOCK_MONOTONIC when synced started */
+  int32_t num_syncs;
+  char sync_names[MAX_NUM_OF_SYNC_ENTRIES][INTERFACE_MAX_NAME_LEN];
+} T_journal_recorder_header;
+
+typedef struct {
+  T_journal_recorder_header const *header;
+  T_journal_entry const *entries;
+  size_t size;
+} T_journal_recorder_reader;
+
+/* Writer (synced); num_entries is rounded up to a power of two */
+int journal_recorder_init(const char *path, int num_entries, int sync_interval_ms);
+void journal_recorder_set_sync_name(int sync_idx, const char *name);
+/* Write dirty pages back to the file if the sync interval elapsed; called from the main loop */
+void journal_recorder_sync(void);
+void journal_recorder_deinit(void);
+
+/* Reader */
+int journal_recorder_reader_open(T_journal_recorder_reader *reader, const char *path);
+void journal_recorder_reader_close(T_journal_recorder_reader *reader);
+/*
+ * Copy the complete entries of the file, oldest first, into entries (which must hold header->num_entries entries)
+ * and return the number copied. num_lost is set to the number of entries missing between the oldest and newest one.
+ */
+int journal_recorder_reader_read(T_journal_recorder_reader const *reader,
+                                 T_journal_entry *entries,
+                                 unsigned long long *num_lost);
+/* Return the name of the sync, "LO" for the local oscillator, or an empty string */
+const char *journal_recorder_reader_get_sync_name(T_journal_recorder_reader const *reader, T_journal_entry const *entry);
+
+#endif /* JOURNAL_H */
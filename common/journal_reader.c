@@ -0,0 +1,153 @@
+/**
+ * @file journal_reader.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "journal.h"
+
+/* Global functions */
+
+int journal_recorder_reader_open(T_journal_recorder_reader *reader, const char *path)
+{
+  T_journal_recorder_header const *header;
+  struct stat st;
+  void *map;
+  int fd;
+
+  memset(reader, 0, sizeof(*reader));
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if(fd < 0) {
+    return -1;
+  }
+
+  if((fstat(fd, &st) < 0) || (st.st_size < JOURNAL_RECORDER_HEADER_SIZE)) {
+    close(fd);
+    return -1;
+  }
+
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) {
+    return -1;
+  }
+
+  reader->header = map;
+  reader->size = st.st_size;
+
+  /* The file may be truncated (e.g., after a reset before its blocks were written) */
+  header = reader->header;
+  if((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != JOURNAL_RECORDER_MAGIC) ||
+     (header->version != JOURNAL_RECORDER_VERSION) ||
+     (header->header_size != JOURNAL_RECORDER_HEADER_SIZE) ||
+     (header->entry_size != sizeof(T_journal_entry)) ||
+     (header->num_entries == 0) ||
+     ((header->num_entries & (header->num_entries - 1)) != 0) ||
+     (reader->size < (JOURNAL_RECORDER_HEADER_SIZE + ((size_t)header->num_entries * sizeof(T_journal_entry))))) {
+    journal_recorder_reader_close(reader);
+    return -1;
+  }
+
+  reader->entries = (T_journal_entry const *)((char const *)map + JOURNAL_RECORDER_HEADER_SIZE);
+
+  return 0;
+}
+
+void journal_recorder_reader_close(T_journal_recorder_reader *reader)
+{
+  if(reader->header != NULL) {
+    munmap((void *)reader->header, reader->size);
+    reader->header = NULL;
+    reader->entries = NULL;
+  }
+}
+
+int journal_recorder_reader_read(T_journal_recorder_reader const *reader,
+                                 T_journal_entry *entries,
+                                 unsigned long long *num_lost)
+{
+  unsigned long long num_entries;
+  unsigned long long index_mask;
+  unsigned long long newest_seq = 0;
+  unsigned long long seq;
+  unsigned long long i;
+  T_journal_entry const *slot;
+  int num_copied = 0;
+
+  *num_lost = 0;
+
+  if(reader->header == NULL) {
+    return -1;
+  }
+
+  num_entries = reader->header->num_entries;
+  index_mask = num_entries - 1;
+
+  /* synced is usually gone, so the newest entry is found by its sequence number rather than a write index */
+  for(i = 0; i < num_entries; i++) {
+    seq = __atomic_load_n(&reader->entries[i].seq, __ATOMIC_ACQUIRE);
+    if(seq > newest_seq) {
+      newest_seq = seq;
+    }
+  }
+
+  seq = (newest_seq > num_entries) ? (newest_seq - num_entries + 1) : 1;
+  for(; seq <= newest_seq; seq++) {
+    slot = &reader->entries[seq & index_mask];
+
+    /* A slot whose sequence number does not match was being written (or never written back) */
+    if(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) {
+      (*num_lost)++;
+      continue;
+    }
+    memcpy(&entries[num_copied], slot, sizeof(*slot));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+      (*num_lost)++;
+      continue;
+    }
+    num_copied++;
+  }
+
+  return num_copied;
+}
+
+const char *journal_recorder_reader_get_sync_name(T_journal_recorder_reader const *reader, T_journal_entry const *entry)
+{
+  T_journal_recorder_header const *header = reader->header;
+
+  if((entry->sync_idx >= 0) && (entry->sync_idx < header->num_syncs) && (entry->sync_idx < MAX_NUM_OF_SYNC_ENTRIES)) {
+    return header->sync_names[entry->sync_idx];
+  }
+
+  /* Sync index of the current QL event is that of the selected clock, which is LO if negative */
+  if(entry->type == E_journal_event_type_current_ql) {
+    return "LO";
+  }
+
+  return "";
+}
@@ -0,0 +1,214 @@
+/**
+ * @file latency.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#include <string.h>
+#include <time.h>
+
+#include "latency.h"
+
+#if (SYNCED_LATENCY_STATS == 1)
+
+#define LATENCY_SUB_BUCKET_BITS     5
+#define LATENCY_SUB_BUCKET_COUNT    (1 << LATENCY_SUB_BUCKET_BITS)
+
+/* Buckets [0, 2 * LATENCY_SUB_BUCKET_COUNT) are exact; above, each power of two has LATENCY_SUB_BUCKET_COUNT buckets */
+#define LATENCY_NUM_OF_BUCKETS      ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKET_COUNT)
+
+typedef struct {
+  uint64_t buckets[LATENCY_NUM_OF_BUCKETS];
+  uint64_t total_ns;
+  uint64_t inv_min_ns;                      /* UINT64_MAX - minimum, so the zero initial value is below every value */
+  uint64_t max_ns;
+} T_latency_hist;
+
+/* Static data */
+
+/* Stages are recorded by the RX, main and TX threads with relaxed atomic operations */
+static T_latency_hist g_latency_hists[E_latency_stage_max];
+
+/* Static functions */
+
+static unsigned int latency_get_bucket_idx(uint64_t val)
+{
+  unsigned int shift;
+
+  if(val < (2 * LATENCY_SUB_BUCKET_COUNT)) {
+    return (unsigned int)val;
+  }
+
+  /* Position of most significant bit minus sub-bucket bits */
+  shift = (63 - __builtin_clzll(val)) - LATENCY_SUB_BUCKET_BITS;
+
+  return ((shift + 1) * LATENCY_SUB_BUCKET_COUNT) + (unsigned int)((val >> shift) - LATENCY_SUB_BUCKET_COUNT);
+}
+
+/* Return the highest value that falls into bucket */
+static uint64_t latency_get_bucket_max(unsigned int idx)
+{
+  unsigned int shift;
+  uint64_t sub_bucket;
+
+  if(idx < (2 * LATENCY_SUB_BUCKET_COUNT)) {
+    return idx;
+  }
+
+  shift = (idx / LATENCY_SUB_BUCKET_COUNT) - 1;
+  sub_bucket = (idx % LATENCY_SUB_BUCKET_COUNT) + LATENCY_SUB_BUCKET_COUNT;
+
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+static void latency_record(T_latency_stage stage, uint64_t val)
+{
+  T_latency_hist *hist = &g_latency_hists[stage];
+  uint64_t old_val;
+  uint64_t inv_val = UINT64_MAX - val;
+
+  __atomic_fetch_add(&hist->buckets[latency_get_bucket_idx(val)], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&hist->total_ns, val, __ATOMIC_RELAXED);
+
+  old_val = __atomic_load_n(&hist->inv_min_ns, __ATOMIC_RELAXED);
+  while((inv_val > old_val) &&
+        !__atomic_compare_exchange_n(&hist->inv_min_ns, &old_val, inv_val, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+
+  old_val = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+  while((val > old_val) &&
+        !__atomic_compare_exchange_n(&hist->max_ns, &old_val, val, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+/* Return the value at or below which the given percentile (in thousandths of a percent) of the values fall */
+static uint64_t latency_get_percentile(uint64_t const *buckets, uint64_t count, uint64_t max_ns, uint64_t percentile_x1000)
+{
+  uint64_t rank;
+  uint64_t cumulative = 0;
+  uint64_t val;
+  unsigned int i;
+
+  /* Rank of the value in the sorted values, starting from 1 */
+  rank = ((count * percentile_x1000) + 99999) / 100000;
+  if(rank == 0) {
+    rank = 1;
+  }
+
+  for(i = 0; i < LATENCY_NUM_OF_BUCKETS; i++) {
+    cumulative += buckets[i];
+    if(cumulative >= rank) {
+      val = latency_get_bucket_max(i);
+      return (val > max_ns) ? max_ns : val;
+    }
+  }
+
+  return max_ns;
+}
+
+/* Global functions */
+
+uint64_t latency_get_time_ns(void)
+{
+  struct timespec current_time;
+
+  clock_gettime(CLOCK_MONOTONIC_RAW, &current_time);
+  return ((uint64_t)current_time.tv_sec * 1000000000ULL) + current_time.tv_nsec;
+}
+
+void latency_trace_start(T_latency_trace *trace, uint64_t rx_time_ns)
+{
+  memset(trace, 0, sizeof(*trace));
+
+  if(rx_time_ns == 0) {
+    return;
+  }
+
+  trace->time_ns[E_latency_point_rx_pdu] = rx_time_ns;
+  latency_trace_mark(trace, E_latency_point_control_rx_cb);
+}
+
+void latency_trace_mark(T_latency_trace *trace, T_latency_point point)
+{
+  uint64_t time_ns;
+  uint64_t prev_time_ns;
+
+  if(!latency_trace_is_active(trace) || (point == E_latency_point_rx_pdu) || (point >= E_latency_point_max)) {
+    return;
+  }
+
+  time_ns = latency_get_time_ns();
+  trace->time_ns[point] = time_ns;
+
+  prev_time_ns = trace->time_ns[point - 1];
+  if((prev_time_ns != 0) && (time_ns >= prev_time_ns)) {
+    latency_record((T_latency_stage)(point - 1), time_ns - prev_time_ns);
+  }
+
+  if(point == E_latency_point_tx_pdu) {
+    latency_record(E_latency_stage_end_to_end, time_ns - trace->time_ns[E_latency_point_rx_pdu]);
+  }
+}
+
+int latency_get_stage_stats(T_latency_stage stage, T_latency_stage_stats *stats)
+{
+  T_latency_hist *hist;
+  uint64_t buckets[LATENCY_NUM_OF_BUCKETS];
+  uint64_t count = 0;
+  uint64_t max_ns;
+  unsigned int i;
+
+  memset(stats, 0, sizeof(*stats));
+
+  if(stage >= E_latency_stage_max) {
+    return -1;
+  }
+
+  hist = &g_latency_hists[stage];
+
+  /* Percentiles are taken from a snapshot; a concurrent record may be partly included */
+  for(i = 0; i < LATENCY_NUM_OF_BUCKETS; i++) {
+    buckets[i] = __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+    count += buckets[i];
+  }
+
+  if(count == 0) {
+    return 0;
+  }
+
+  max_ns = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+
+  stats->count = count;
+  stats->min_ns = UINT64_MAX - __atomic_load_n(&hist->inv_min_ns, __ATOMIC_RELAXED);
+  stats->max_ns = max_ns;
+  stats->mean_ns = __atomic_load_n(&hist->total_ns, __ATOMIC_RELAXED) / count;
+  stats->p50_ns = latency_get_percentile(buckets, count, max_ns, 50000);
+  stats->p90_ns = latency_get_percentile(buckets, count, max_ns, 90000);
+  stats->p99_ns = latency_get_percentile(buckets, count, max_ns, 99000);
+  stats->p999_ns = latency_get_percentile(buckets, count, max_ns, 99900);
+
+  return 0;
+}
+
+#else
+
+/* ISO C does not allow an empty translation unit */
+typedef int T_latency_disabled;
+
+#endif
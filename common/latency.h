@@ -0,0 +1,107 @@
+/**
+ * @file latency.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+/*
+ * QL propagation latency.
+ *
+ * A trace follows one QL change through the node: the port RX thread stamps the PDU arrival, and each
+ * later stage stamps its point with CLOCK_MONOTONIC_RAW and records the time since the previous point
+ * in the histogram of its stage. The last point also records the end-to-end time.
+ *
+ * Histograms are log-linear (HDR-style): values below 64 ns have their own bucket, and every power of
+ * two above is split into 32 linear buckets.
+ *
+ * Built with SYNCED_LATENCY_STATS=0, the functions below are empty inline stubs and traces never start.
+ */
+
+/* Trace points, in pipeline order; stage N ends at point N + 1 */
+typedef enum {
+  E_latency_point_rx_pdu,             /* ESMC PDU received by the port RX thread */
+  E_latency_point_control_rx_cb,      /* Control RX event callback applied the QL change */
+  E_latency_point_sync_update,        /* Sync table update applied the new rank */
+  E_latency_point_priority_table,     /* Device clock priorities set */
+  E_latency_point_best_ql,            /* Best QL set and TX threads woken */
+  E_latency_point_tx_pdu,             /* Event ESMC PDU sent */
+  E_latency_point_max
+} T_latency_point;
+
+/* A zero time means the point was not reached; a trace is active if its first point is set */
+typedef struct {
+  uint64_t time_ns[E_latency_point_max];
+} T_latency_trace;
+
+#if (SYNCED_LATENCY_STATS == 1)
+
+/* Return CLOCK_MONOTONIC_RAW time in nanoseconds */
+uint64_t latency_get_time_ns(void);
+
+/* Start trace at PDU arrival time rx_time_ns (no-op if 0) and stamp the control RX event callback point */
+void latency_trace_start(T_latency_trace *trace, uint64_t rx_time_ns);
+
+/* Stamp point of an active trace and record the stage ending at it */
+void latency_trace_mark(T_latency_trace *trace, T_latency_point point);
+
+/* Return 0 on success */
+int latency_get_stage_stats(T_latency_stage stage, T_latency_stage_stats *stats);
+
+#else
+
+static inline uint64_t latency_get_time_ns(void)
+{
+  return 0;
+}
+
+static inline void latency_trace_start(T_latency_trace *trace, uint64_t rx_time_ns)
+{
+  (void)trace;
+  (void)rx_time_ns;
+}
+
+static inline void latency_trace_mark(T_latency_trace *trace, T_latency_point point)
+{
+  (void)trace;
+  (void)point;
+}
+
+/* Return -2 since latency statistics are not built in */
+static inline int latency_get_stage_stats(T_latency_stage stage, T_latency_stage_stats *stats)
+{
+  (void)stage;
+  (void)stats;
+  return -2;
+}
+
+#endif
+
+static inline int latency_trace_is_active(T_latency_trace const *trace)
+{
+  return trace->time_ns[E_latency_point_rx_pdu] != 0;
+}
+
+#endif /* LATENCY_H */
@@ -21,6 +21,7 @@
 ********************************************************************************************************************/
 
 #include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,10 +29,257 @@
 
 #include "os.h"
 #include "print.h"
+#include "trace.h"
 #include "types.h"
 
+#if (SYNCED_MUTEX_PROFILING == 1)
+
+/* The profiled wrappers below call the plain functions */
+#undef os_mutex_lock
+#undef os_mutex_unlock
+
+#define OS_MUTEX_PROF_NUM_OF_MUTEX_SLOTS   64   /* Power of two */
+#define OS_MUTEX_PROF_NUM_OF_SITE_SLOTS    512  /* Power of two */
+
+typedef struct {
+  uint64_t acquisitions;
+  uint64_t contended;
+  uint64_t total_wait_ns;
+  uint64_t max_wait_ns;
+  uint64_t total_hold_ns;
+  uint64_t max_hold_ns;
+} T_os_mutex_prof_counters;
+
+typedef struct T_os_mutex_prof_site T_os_mutex_prof_site;
+
+typedef struct {
+  pthread_mutex_t *mutex;                   /* Key; published last */
+  const char *name;
+  T_os_mutex_prof_counters counters;
+
+  /* Written by the holder of the mutex only */
+  uint64_t hold_start_ns;
+  uint64_t release_ns;                      /* End of the last profiled hold */
+  T_os_mutex_prof_site *holder_site;
+} T_os_mutex_prof_mutex;
+
+struct T_os_mutex_prof_site {
+  const char *site;                         /* Key together with prof_mutex; published last */
+  const char *func;
+  T_os_mutex_prof_mutex *prof_mutex;
+  T_os_mutex_prof_counters counters;
+};
+
+#endif
+
+/* Static data */
+
+#if (SYNCED_MUTEX_PROFILING == 1)
+/*
+ * Lookups are lock-free; new entries are added under g_os_mutex_prof_mutex.
+ * Counters of a mutex and of its call sites are only updated while holding that mutex,
+ * so plain relaxed stores are enough; readers load them without locking.
+ */
+static T_os_mutex_prof_mutex g_os_mutex_prof_mutexes[OS_MUTEX_PROF_NUM_OF_MUTEX_SLOTS];
+static T_os_mutex_prof_site g_os_mutex_prof_sites[OS_MUTEX_PROF_NUM_OF_SITE_SLOTS];
+static pthread_mutex_t g_os_mutex_prof_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /* Static functions */
 
+#if (SYNCED_MUTEX_PROFILING == 1)
+static uint64_t os_mutex_prof_get_time_ns(void)
+{
+  struct timespec current_time;
+
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return ((uint64_t)current_time.tv_sec * 1000000000ULL) + current_time.tv_nsec;
+}
+
+static unsigned int os_mutex_prof_hash(const void *key1, const void *key2, unsigned int num_slots)
+{
+  uint64_t val = (uint64_t)(uintptr_t)key1 ^ ((uint64_t)(uintptr_t)key2 << 1);
+
+  return (unsigned int)((val * 0x9E3779B97F4A7C15ULL) >> 40) & (num_slots - 1);
+}
+
+static T_os_mutex_prof_mutex *os_mutex_prof_find_mutex(pthread_mutex_t *mutex, const char *name)
+{
+  T_os_mutex_prof_mutex *prof_mutex;
+  unsigned int idx = os_mutex_prof_hash(mutex, NULL, OS_MUTEX_PROF_NUM_OF_MUTEX_SLOTS);
+  unsigned int i;
+  pthread_mutex_t *key;
+
+  for(i = 0; i < OS_MUTEX_PROF_NUM_OF_MUTEX_SLOTS; i++) {
+    prof_mutex = &g_os_mutex_prof_mutexes[(idx + i) & (OS_MUTEX_PROF_NUM_OF_MUTEX_SLOTS - 1)];
+    key = __atomic_load_n(&prof_mutex->mutex, __ATOMIC_ACQUIRE);
+    if(key == mutex) {
+      if((name != NULL) && (__atomic_load_n(&prof_mutex->name, __ATOMIC_ACQUIRE) == NULL)) {
+        /* Mutex created again at the address of a destroyed one */
+        pthread_mutex_lock(&g_os_mutex_prof_mutex);
+        if(prof_mutex->name == NULL) {
+          __atomic_store_n(&prof_mutex->name, name, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&g_os_mutex_prof_mutex);
+      }
+      return prof_mutex;
+    }
+
+    if(key == NULL) {
+      if(name == NULL) {
+        return NULL;
+      }
+
+      pthread_mutex_lock(&g_os_mutex_prof_mutex);
+      if(prof_mutex->mutex == NULL) {
+        prof_mutex->name = name;
+        __atomic_store_n(&prof_mutex->mutex, mutex, __ATOMIC_RELEASE);
+      }
+      pthread_mutex_unlock(&g_os_mutex_prof_mutex);
+
+      if(prof_mutex->mutex == mutex) {
+        return prof_mutex;
+      }
+      /* Another mutex took the slot; keep probing */
+    }
+  }
+
+  /* Table full; the mutex is not profiled */
+  return NULL;
+}
+
+static T_os_mutex_prof_site *os_mutex_prof_find_site(T_os_mutex_prof_mutex *prof_mutex, const char *site, const char *func)
+{
+  T_os_mutex_prof_site *prof_site;
+  unsigned int idx = os_mutex_prof_hash(site, prof_mutex, OS_MUTEX_PROF_NUM_OF_SITE_SLOTS);
+  unsigned int i;
+  const char *key;
+
+  for(i = 0; i < OS_MUTEX_PROF_NUM_OF_SITE_SLOTS; i++) {
+    prof_site = &g_os_mutex_prof_sites[(idx + i) & (OS_MUTEX_PROF_NUM_OF_SITE_SLOTS - 1)];
+    key = __atomic_load_n(&prof_site->site, __ATOMIC_ACQUIRE);
+    if((key == site) && (prof_site->prof_mutex == prof_mutex)) {
+      return prof_site;
+    }
+
+    if(key == NULL) {
+      pthread_mutex_lock(&g_os_mutex_prof_mutex);
+      if(prof_site->site == NULL) {
+        prof_site->func = func;
+        prof_site->prof_mutex = prof_mutex;
+        __atomic_store_n(&prof_site->site, site, __ATOMIC_RELEASE);
+      }
+      pthread_mutex_unlock(&g_os_mutex_prof_mutex);
+
+      if((prof_site->site == site) && (prof_site->prof_mutex == prof_mutex)) {
+        return prof_site;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static inline void os_mutex_prof_add(uint64_t *counter, uint64_t val)
+{
+  __atomic_store_n(counter, *counter + val, __ATOMIC_RELAXED);
+}
+
+static inline void os_mutex_prof_max(uint64_t *counter, uint64_t val)
+{
+  if(val > *counter) {
+    __atomic_store_n(counter, val, __ATOMIC_RELAXED);
+  }
+}
+
+static void os_mutex_prof_count_acquisition(T_os_mutex_prof_counters *counters, int contended_flag, uint64_t wait_ns)
+{
+  os_mutex_prof_add(&counters->acquisitions, 1);
+  if(contended_flag) {
+    os_mutex_prof_add(&counters->contended, 1);
+    os_mutex_prof_add(&counters->total_wait_ns, wait_ns);
+    os_mutex_prof_max(&counters->max_wait_ns, wait_ns);
+  }
+}
+
+static void os_mutex_prof_count_hold(T_os_mutex_prof_counters *counters, uint64_t hold_ns)
+{
+  os_mutex_prof_add(&counters->total_hold_ns, hold_ns);
+  os_mutex_prof_max(&counters->max_hold_ns, hold_ns);
+}
+
+/* Called by the holder just before it releases the mutex */
+static void os_mutex_prof_end_hold(T_os_mutex_prof_mutex *prof_mutex)
+{
+  uint64_t hold_ns;
+
+  if(prof_mutex->holder_site == NULL) {
+    /* Locked without profiling */
+    return;
+  }
+
+  prof_mutex->release_ns = os_mutex_prof_get_time_ns();
+  hold_ns = prof_mutex->release_ns - prof_mutex->hold_start_ns;
+  os_mutex_prof_count_hold(&prof_mutex->counters, hold_ns);
+  os_mutex_prof_count_hold(&prof_mutex->holder_site->counters, hold_ns);
+}
+
+/* Zero the counters of a destroyed mutex and of its call sites; the entry is renamed by the next lock */
+static void os_mutex_prof_reset_mutex(pthread_mutex_t *mutex)
+{
+  T_os_mutex_prof_mutex *prof_mutex = os_mutex_prof_find_mutex(mutex, NULL);
+  T_os_mutex_prof_site *prof_site;
+  int i;
+
+  if(prof_mutex == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&g_os_mutex_prof_mutex);
+  __atomic_store_n(&prof_mutex->name, NULL, __ATOMIC_RELEASE);
+  memset(&prof_mutex->counters, 0, sizeof(prof_mutex->counters));
+  prof_mutex->holder_site = NULL;
+  for(i = 0; i < OS_MUTEX_PROF_NUM_OF_SITE_SLOTS; i++) {
+    prof_site = &g_os_mutex_prof_sites[i];
+    if((__atomic_load_n(&prof_site->site, __ATOMIC_ACQUIRE) != NULL) && (prof_site->prof_mutex == prof_mutex)) {
+      memset(&prof_site->counters, 0, sizeof(prof_site->counters));
+    }
+  }
+  pthread_mutex_unlock(&g_os_mutex_prof_mutex);
+}
+
+static void os_mutex_prof_read_counters(T_os_mutex_prof_counters *counters, T_os_mutex_prof_stats *stats)
+{
+  stats->acquisitions = __atomic_load_n(&counters->acquisitions, __ATOMIC_RELAXED);
+  stats->contended = __atomic_load_n(&counters->contended, __ATOMIC_RELAXED);
+  stats->total_wait_ns = __atomic_load_n(&counters->total_wait_ns, __ATOMIC_RELAXED);
+  stats->max_wait_ns = __atomic_load_n(&counters->max_wait_ns, __ATOMIC_RELAXED);
+  stats->total_hold_ns = __atomic_load_n(&counters->total_hold_ns, __ATOMIC_RELAXED);
+  stats->max_hold_ns = __atomic_load_n(&counters->max_hold_ns, __ATOMIC_RELAXED);
+}
+
+static void os_mutex_prof_copy_name(char *dst, size_t size, const char *name)
+{
+  /* Drop the address-of operator of the mutex expression */
+  if(name[0] == '&') {
+    name++;
+  }
+  snprintf(dst, size, "%s", name);
+}
+
+static int os_mutex_prof_compare(const void *a, const void *b)
+{
+  unsigned long long wait_a = ((const T_os_mutex_prof_stats *)a)->total_wait_ns;
+  unsigned long long wait_b = ((const T_os_mutex_prof_stats *)b)->total_wait_ns;
+
+  if(wait_a != wait_b) {
+    return (wait_a > wait_b) ? -1 : 1;
+  }
+
+  return strcmp(((const T_os_mutex_prof_stats *)a)->name, ((const T_os_mutex_prof_stats *)b)->name);
+}
+#endif
+
 /* Global functions */
 
 int os_mutex_init(pthread_mutex_t *mutex)
@@ -56,8 +304,18 @@ int os_mutex_init(pthread_mutex_t *mutex)
 
 int os_mutex_lock(pthread_mutex_t *mutex)
 {
-  if(pthread_mutex_lock(mutex) != 0) {
-    pr_err("Mutex lock failed: %s", strerror(errno));
+  int err;
+
+  /* Only contended acquisitions are traced */
+  if(g_trace_enabled && (pthread_mutex_trylock(mutex) == 0)) {
+    return 0;
+  }
+
+  trace_begin();
+  err = pthread_mutex_lock(mutex);
+  trace_end(E_trace_span_lock_wait, NULL);
+  if(err != 0) {
+    pr_err("Mutex lock failed: %s", strerror(err));
     return -1;
   }
 
@@ -74,11 +332,127 @@ int os_mutex_unlock(pthread_mutex_t *mutex)
   return 0;
 }
 
+#if (SYNCED_MUTEX_PROFILING == 1)
+int os_mutex_lock_profiled(pthread_mutex_t *mutex, const char *name, const char *site, const char *func)
+{
+  T_os_mutex_prof_mutex *prof_mutex;
+  T_os_mutex_prof_site *prof_site;
+  int contended_flag = 0;
+  uint64_t wait_start_ns = 0;
+  uint64_t now_ns;
+
+  prof_mutex = os_mutex_prof_find_mutex(mutex, name);
+  prof_site = (prof_mutex != NULL) ? os_mutex_prof_find_site(prof_mutex, site, func) : NULL;
+  if(prof_site == NULL) {
+    return os_mutex_lock(mutex);
+  }
+
+  if(pthread_mutex_trylock(mutex) != 0) {
+    contended_flag = 1;
+    wait_start_ns = os_mutex_prof_get_time_ns();
+    if(os_mutex_lock(mutex) < 0) {
+      return -1;
+    }
+  }
+
+  now_ns = os_mutex_prof_get_time_ns();
+
+  /* Holding the mutex from here on */
+  os_mutex_prof_count_acquisition(&prof_mutex->counters, contended_flag, now_ns - wait_start_ns);
+  os_mutex_prof_count_acquisition(&prof_site->counters, contended_flag, now_ns - wait_start_ns);
+  prof_mutex->hold_start_ns = now_ns;
+  prof_mutex->holder_site = prof_site;
+
+  return 0;
+}
+
+int os_mutex_unlock_profiled(pthread_mutex_t *mutex)
+{
+  T_os_mutex_prof_mutex *prof_mutex;
+
+  prof_mutex = os_mutex_prof_find_mutex(mutex, NULL);
+  if(prof_mutex != NULL) {
+    os_mutex_prof_end_hold(prof_mutex);
+    prof_mutex->holder_site = NULL;
+  }
+
+  return os_mutex_unlock(mutex);
+}
+
+int os_mutex_prof_get_report(T_os_mutex_prof_report *report)
+{
+  static T_os_mutex_prof_stats sites[OS_MUTEX_PROF_NUM_OF_SITE_SLOTS];
+  static pthread_mutex_t report_mutex = PTHREAD_MUTEX_INITIALIZER;
+  T_os_mutex_prof_mutex *prof_mutex;
+  T_os_mutex_prof_site *prof_site;
+  T_os_mutex_prof_stats *stats;
+  const char *name;
+  int num_sites = 0;
+  int i;
+
+  memset(report, 0, sizeof(*report));
+
+  for(i = 0; i < OS_MUTEX_PROF_NUM_OF_MUTEX_SLOTS; i++) {
+    prof_mutex = &g_os_mutex_prof_mutexes[i];
+    /* Unnamed entries belong to destroyed mutexes */
+    name = __atomic_load_n(&prof_mutex->name, __ATOMIC_ACQUIRE);
+    if((__atomic_load_n(&prof_mutex->mutex, __ATOMIC_ACQUIRE) == NULL) || (name == NULL) ||
+       (report->num_mutexes >= OS_MUTEX_PROF_REPORT_MAX_NUM_OF_MUTEXES)) {
+      continue;
+    }
+
+    stats = &report->mutexes[report->num_mutexes++];
+    os_mutex_prof_copy_name(stats->name, sizeof(stats->name), name);
+    os_mutex_prof_read_counters(&prof_mutex->counters, stats);
+  }
+  qsort(report->mutexes, report->num_mutexes, sizeof(report->mutexes[0]), os_mutex_prof_compare);
+
+  /* Collect all call sites, then keep the ones that waited the longest */
+  pthread_mutex_lock(&report_mutex);
+  for(i = 0; i < OS_MUTEX_PROF_NUM_OF_SITE_SLOTS; i++) {
+    prof_site = &g_os_mutex_prof_sites[i];
+    if(__atomic_load_n(&prof_site->site, __ATOMIC_ACQUIRE) == NULL) {
+      continue;
+    }
+    /* Skip call sites of destroyed mutexes and sites not used since their mutex was created again */
+    name = __atomic_load_n(&prof_site->prof_mutex->name, __ATOMIC_ACQUIRE);
+    if((name == NULL) || (__atomic_load_n(&prof_site->counters.acquisitions, __ATOMIC_RELAXED) == 0)) {
+      continue;
+    }
+
+    stats = &sites[num_sites++];
+    memset(stats, 0, sizeof(*stats));
+    os_mutex_prof_copy_name(stats->name, sizeof(stats->name), name);
+    snprintf(stats->func, sizeof(stats->func), "%s", prof_site->func);
+    snprintf(stats->site, sizeof(stats->site), "%s", prof_site->site);
+    os_mutex_prof_read_counters(&prof_site->counters, stats);
+  }
+  qsort(sites, num_sites, sizeof(sites[0]), os_mutex_prof_compare);
+
+  report->num_sites = (num_sites > OS_MUTEX_PROF_REPORT_MAX_NUM_OF_SITES) ? OS_MUTEX_PROF_REPORT_MAX_NUM_OF_SITES : num_sites;
+  report->num_dropped_sites = num_sites - report->num_sites;
+  memcpy(report->sites, sites, report->num_sites * sizeof(sites[0]));
+  pthread_mutex_unlock(&report_mutex);
+
+  return 0;
+}
+#else
+int os_mutex_prof_get_report(T_os_mutex_prof_report *report)
+{
+  memset(report, 0, sizeof(*report));
+
+  return -2;
+}
+#endif
+
 int os_mutex_deinit(pthread_mutex_t *mutex)
 {
   os_mutex_lock(mutex);
   os_mutex_unlock(mutex);
   pthread_mutex_destroy(mutex);
+#if (SYNCED_MUTEX_PROFILING == 1)
+  os_mutex_prof_reset_mutex(mutex);
+#endif
 
   return 0;
 }
@@ -161,7 +535,46 @@ int os_cond_timed_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, unsigned in
 
   *timeout_flag = 0;
 
+#if (SYNCED_MUTEX_PROFILING == 1)
+  {
+    /*
+     * The wait releases the mutex and reacquires it before returning, which counts as an acquisition by the call
+     * site that locked it. The reacquire waited if another thread released the mutex after this thread was woken:
+     * at the timeout, or else during the last hold, as with broadcasts made under the mutex.
+     */
+    T_os_mutex_prof_mutex *prof_mutex = os_mutex_prof_find_mutex(mutex, NULL);
+    T_os_mutex_prof_site *prof_site = NULL;
+    uint64_t deadline_ns = ((uint64_t)time.tv_sec * 1000000000ULL) + time.tv_nsec;
+    uint64_t wait_start_ns = 0;
+    uint64_t wake_ns;
+    uint64_t now_ns;
+    int contended_flag;
+
+    if(prof_mutex != NULL) {
+      prof_site = prof_mutex->holder_site;
+      os_mutex_prof_end_hold(prof_mutex);
+      prof_mutex->holder_site = NULL;
+      wait_start_ns = prof_mutex->release_ns;
+    }
+
+    err = pthread_cond_timedwait(cond, mutex, &time);
+
+    if(prof_site != NULL) {
+      now_ns = os_mutex_prof_get_time_ns();
+      wake_ns = (err == ETIMEDOUT) ? deadline_ns : prof_mutex->hold_start_ns;
+      if(wake_ns < wait_start_ns) {
+        wake_ns = wait_start_ns;
+      }
+      contended_flag = (prof_mutex->release_ns > wake_ns) && (now_ns > wake_ns);
+      os_mutex_prof_count_acquisition(&prof_mutex->counters, contended_flag, now_ns - wake_ns);
+      os_mutex_prof_count_acquisition(&prof_site->counters, contended_flag, now_ns - wake_ns);
+      prof_mutex->hold_start_ns = now_ns;
+      prof_mutex->holder_site = prof_site;
+    }
+  }
+#else
   err = pthread_cond_timedwait(cond, mutex, &time);
+#endif
 
   if(err == ETIMEDOUT) {
     *timeout_flag = 1;
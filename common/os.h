@@ -28,11 +28,57 @@
 #include <signal.h>
 #include <time.h>
 
+#define OS_MUTEX_PROF_MAX_NAME_LEN              48
+#define OS_MUTEX_PROF_MAX_FUNC_LEN              64
+#define OS_MUTEX_PROF_MAX_SITE_LEN              64
+#define OS_MUTEX_PROF_REPORT_MAX_NUM_OF_MUTEXES 32
+#define OS_MUTEX_PROF_REPORT_MAX_NUM_OF_SITES   64
+
+/* Contention of a mutex, or of the acquisitions of a mutex at one call site */
+typedef struct {
+  char name[OS_MUTEX_PROF_MAX_NAME_LEN];    /* Mutex expression at its first lock, e.g. g_control_mutex */
+  char func[OS_MUTEX_PROF_MAX_FUNC_LEN];    /* Calling function (empty for mutex totals) */
+  char site[OS_MUTEX_PROF_MAX_SITE_LEN];    /* Calling file:line (empty for mutex totals) */
+  unsigned long long acquisitions;
+  unsigned long long contended;             /* Acquisitions that had to wait for another holder */
+  unsigned long long total_wait_ns;
+  unsigned long long max_wait_ns;
+  unsigned long long total_hold_ns;         /* Hold time is attributed to the call site that locked */
+  unsigned long long max_hold_ns;
+} T_os_mutex_prof_stats;
+
+/* Mutexes and call sites, each sorted by total wait time (largest first) */
+typedef struct {
+  int num_mutexes;
+  int num_sites;
+  int num_dropped_sites;                    /* Call sites left out of the report */
+  T_os_mutex_prof_stats mutexes[OS_MUTEX_PROF_REPORT_MAX_NUM_OF_MUTEXES];
+  T_os_mutex_prof_stats sites[OS_MUTEX_PROF_REPORT_MAX_NUM_OF_SITES];
+} T_os_mutex_prof_report;
+
 int os_mutex_init(pthread_mutex_t *mutex);
 int os_mutex_lock(pthread_mutex_t *mutex);
 int os_mutex_unlock(pthread_mutex_t *mutex);
 int os_mutex_deinit(pthread_mutex_t *mutex);
 
+#if (SYNCED_MUTEX_PROFILING == 1)
+/*
+ * Profiled build: every os_mutex_lock() call site passes the mutex expression as its name and a
+ * file:line tag, and acquisitions, waits and hold times are recorded per mutex and per call site.
+ */
+#define OS_STRINGIFY(x)   #x
+#define OS_TO_STRING(x)   OS_STRINGIFY(x)
+
+int os_mutex_lock_profiled(pthread_mutex_t *mutex, const char *name, const char *site, const char *func);
+int os_mutex_unlock_profiled(pthread_mutex_t *mutex);
+
+#define os_mutex_lock(mutex)     os_mutex_lock_profiled((mutex), #mutex, __FILE__ ":" OS_TO_STRING(__LINE__), __func__)
+#define os_mutex_unlock(mutex)   os_mutex_unlock_profiled(mutex)
+#endif
+
+/* Return 0 on success and -2 if synced was built without mutex profiling */
+int os_mutex_prof_get_report(T_os_mutex_prof_report *report);
+
 unsigned long long os_get_monotonic_milliseconds(void);
 
 int os_thread_create(pthread_t *thread, void *(*start_routine) (void *), void *arg);
@@ -0,0 +1,574 @@
+/**
+ * @file pcap.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os.h"
+#include "pcap.h"
+#include "print.h"
+
+#define PCAP_MAGIC_US             0xA1B2C3D4
+#define PCAP_MAGIC_NS             0xA1B23C4D
+#define PCAP_HEADER_LEN           24
+#define PCAP_RECORD_HEADER_LEN    16
+
+#define PCAPNG_BLOCK_SHB          0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB          0x00000001
+#define PCAPNG_BLOCK_EPB          0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC   0x1A2B3C4D
+#define PCAPNG_MAX_BLOCK_LEN      (16 * 1024 * 1024)
+
+#define PCAPNG_OPT_END            0
+#define PCAPNG_OPT_IF_NAME        2
+#define PCAPNG_OPT_IF_TSRESOL     9
+#define PCAPNG_OPT_EPB_FLAGS      2
+
+#define PCAPNG_EPB_FLAGS_DIR_MASK       0x3
+#define PCAPNG_EPB_FLAGS_DIR_OUTBOUND   0x2
+
+#define PCAP_LINKTYPE_ETHERNET    1
+#define PCAP_LINKTYPE_LINUX_SLL   113
+
+#define PCAP_SLL_HEADER_LEN       16
+#define PCAP_SLL_PKTTYPE_OUTGOING 4
+
+#define PCAP_ETH_HEADER_LEN       14
+#define PCAP_ETH_ADDR_LEN         6
+
+#define PCAP_MAX_NUM_OF_IFS       256
+#define PCAP_MAX_IF_NAME_LEN      64
+
+typedef struct {
+  int linktype;
+  char name[PCAP_MAX_IF_NAME_LEN];
+  int tsresol;                              /* pcapng if_tsresol option */
+} T_pcap_if;
+
+struct pcap_reader {
+  FILE *file;
+  int pcapng_flag;
+  int swap_flag;                            /* File byte order differs from host byte order */
+  int ns_flag;                              /* Classic pcap with nanosecond timestamps */
+  int section;
+  int num_ifs;
+  T_pcap_if ifs[PCAP_MAX_NUM_OF_IFS];
+  unsigned char *block;                     /* pcapng block buffer */
+  uint32_t block_size;
+};
+
+struct pcap_writer {
+  FILE *file;
+  int num_ifs;
+  pthread_mutex_t mutex;
+};
+
+/* Static data */
+
+static const unsigned char g_pcap_slow_proto_mcast_addr[PCAP_ETH_ADDR_LEN] = {0x01, 0x80, 0xC2, 0x00, 0x00, 0x02};
+
+/* Static functions */
+
+static uint16_t pcap_get16(T_pcap_reader const *reader, const unsigned char *buff)
+{
+  uint16_t val;
+
+  memcpy(&val, buff, sizeof(val));
+  return reader->swap_flag ? __builtin_bswap16(val) : val;
+}
+
+static uint32_t pcap_get32(T_pcap_reader const *reader, const unsigned char *buff)
+{
+  uint32_t val;
+
+  memcpy(&val, buff, sizeof(val));
+  return reader->swap_flag ? __builtin_bswap32(val) : val;
+}
+
+static uint64_t pcap_tsresol_to_ns(uint64_t ts, int tsresol)
+{
+  int exp = tsresol & 0x7F;
+  uint64_t scale = 1;
+
+  if(tsresol & 0x80) {
+    /* Negative power of two */
+    if(exp >= 64) {
+      return 0;
+    }
+    return ((ts >> exp) * 1000000000ULL) + (uint64_t)((double)(ts & ((1ULL << exp) - 1)) * 1e9 / (double)(1ULL << exp));
+  }
+
+  /* Negative power of ten */
+  if(exp <= 9) {
+    while(exp++ < 9) {
+      scale *= 10;
+    }
+    return ts * scale;
+  }
+  while(exp-- > 9) {
+    scale *= 10;
+  }
+  return ts / scale;
+}
+
+/* Convert a captured frame to an Ethernet frame in place */
+static int pcap_normalize_frame(int linktype, T_pcap_frame *frame)
+{
+  unsigned char sll_header[PCAP_SLL_HEADER_LEN];
+  int payload_len;
+
+  switch(linktype) {
+    case PCAP_LINKTYPE_ETHERNET:
+      return 0;
+    case PCAP_LINKTYPE_LINUX_SLL:
+      if(frame->len < PCAP_SLL_HEADER_LEN) {
+        return -1;
+      }
+      memcpy(sll_header, frame->data, PCAP_SLL_HEADER_LEN);
+      /* Packet type, link-layer address type and length, link-layer address and protocol are big-endian */
+      if(((sll_header[0] << 8) | sll_header[1]) == PCAP_SLL_PKTTYPE_OUTGOING) {
+        frame->outbound_flag = 1;
+      }
+      payload_len = frame->len - PCAP_SLL_HEADER_LEN;
+      if(payload_len > (PCAP_MAX_FRAME_LEN - PCAP_ETH_HEADER_LEN)) {
+        payload_len = PCAP_MAX_FRAME_LEN - PCAP_ETH_HEADER_LEN;
+      }
+      memmove(&frame->data[PCAP_ETH_HEADER_LEN], &frame->data[PCAP_SLL_HEADER_LEN], payload_len);
+      memcpy(&frame->data[0], g_pcap_slow_proto_mcast_addr, PCAP_ETH_ADDR_LEN);
+      memcpy(&frame->data[PCAP_ETH_ADDR_LEN], &sll_header[6], PCAP_ETH_ADDR_LEN);
+      memcpy(&frame->data[2 * PCAP_ETH_ADDR_LEN], &sll_header[14], 2);
+      frame->len = frame->len - PCAP_SLL_HEADER_LEN + PCAP_ETH_HEADER_LEN;
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+static int pcap_read_block(T_pcap_reader *reader, uint32_t *type, uint32_t *len)
+{
+  unsigned char header[8];
+  uint32_t block_len;
+  void *block;
+
+  if(fread(header, 1, sizeof(header), reader->file) != sizeof(header)) {
+    return 0;
+  }
+
+  if(pcap_get32(reader, header) == PCAPNG_BLOCK_SHB) {
+    /* The byte order of a new section is only known from its byte-order magic */
+    if(fread(&header[0], 1, 4, reader->file) != 4) {
+      return -1;
+    }
+    reader->swap_flag = (*(uint32_t *)header != PCAPNG_BYTE_ORDER_MAGIC);
+    if(reader->swap_flag && (__builtin_bswap32(*(uint32_t *)header) != PCAPNG_BYTE_ORDER_MAGIC)) {
+      return -1;
+    }
+    if(fseek(reader->file, -12, SEEK_CUR) < 0) {
+      return -1;
+    }
+    if(fread(header, 1, sizeof(header), reader->file) != sizeof(header)) {
+      return -1;
+    }
+  }
+
+  *type = pcap_get32(reader, &header[0]);
+  block_len = pcap_get32(reader, &header[4]);
+  if((block_len < 12) || (block_len > PCAPNG_MAX_BLOCK_LEN) || (block_len % 4)) {
+    return -1;
+  }
+
+  if(block_len > reader->block_size) {
+    block = realloc(reader->block, block_len);
+    if(block == NULL) {
+      return -1;
+    }
+    reader->block = block;
+    reader->block_size = block_len;
+  }
+
+  /* Body and trailing block length */
+  if(fread(reader->block, 1, block_len - 8, reader->file) != (block_len - 8)) {
+    return -1;
+  }
+  *len = block_len - 12;
+
+  return 1;
+}
+
+static void pcap_parse_idb(T_pcap_reader *reader, uint32_t len)
+{
+  T_pcap_if *iface;
+  uint32_t off = 8;
+  uint16_t opt_code;
+  uint16_t opt_len;
+
+  if((len < 8) || (reader->num_ifs == PCAP_MAX_NUM_OF_IFS)) {
+    return;
+  }
+
+  iface = &reader->ifs[reader->num_ifs++];
+  memset(iface, 0, sizeof(*iface));
+  iface->linktype = pcap_get16(reader, &reader->block[0]);
+  iface->tsresol = 6;
+
+  while((off + 4) <= len) {
+    opt_code = pcap_get16(reader, &reader->block[off]);
+    opt_len = pcap_get16(reader, &reader->block[off + 2]);
+    off += 4;
+    if((opt_code == PCAPNG_OPT_END) || ((off + opt_len) > len)) {
+      break;
+    }
+    if(opt_code == PCAPNG_OPT_IF_NAME) {
+      snprintf(iface->name, sizeof(iface->name), "%.*s", (int)opt_len, (const char *)&reader->block[off]);
+    } else if((opt_code == PCAPNG_OPT_IF_TSRESOL) && (opt_len >= 1)) {
+      iface->tsresol = reader->block[off];
+    }
+    off += (opt_len + 3) & ~3U;
+  }
+}
+
+static int pcap_parse_epb(T_pcap_reader *reader, uint32_t len, T_pcap_frame *frame)
+{
+  T_pcap_if const *iface;
+  uint32_t cap_len;
+  uint32_t off;
+  uint16_t opt_code;
+  uint16_t opt_len;
+
+  if(len < 20) {
+    return -1;
+  }
+
+  memset(frame, 0, offsetof(T_pcap_frame, data));
+  frame->if_id = pcap_get32(reader, &reader->block[0]);
+  if(frame->if_id >= reader->num_ifs) {
+    return -1;
+  }
+  iface = &reader->ifs[frame->if_id];
+
+  frame->time_ns = pcap_tsresol_to_ns(((uint64_t)pcap_get32(reader, &reader->block[4]) << 32) | pcap_get32(reader, &reader->block[8]),
+                                      iface->tsresol);
+  cap_len = pcap_get32(reader, &reader->block[12]);
+  if(cap_len > (len - 20)) {
+    return -1;
+  }
+  frame->len = (cap_len < PCAP_MAX_FRAME_LEN) ? cap_len : PCAP_MAX_FRAME_LEN;
+  memcpy(frame->data, &reader->block[20], frame->len);
+
+  off = 20 + ((cap_len + 3) & ~3U);
+  while((off + 4) <= len) {
+    opt_code = pcap_get16(reader, &reader->block[off]);
+    opt_len = pcap_get16(reader, &reader->block[off + 2]);
+    off += 4;
+    if((opt_code == PCAPNG_OPT_END) || ((off + opt_len) > len)) {
+      break;
+    }
+    if((opt_code == PCAPNG_OPT_EPB_FLAGS) && (opt_len >= 4)) {
+      frame->outbound_flag = ((pcap_get32(reader, &reader->block[off]) & PCAPNG_EPB_FLAGS_DIR_MASK) == PCAPNG_EPB_FLAGS_DIR_OUTBOUND);
+    }
+    off += (opt_len + 3) & ~3U;
+  }
+
+  return pcap_normalize_frame(iface->linktype, frame);
+}
+
+static int pcap_next_pcapng(T_pcap_reader *reader, T_pcap_frame *frame)
+{
+  uint32_t type;
+  uint32_t len;
+  int ret;
+
+  while((ret = pcap_read_block(reader, &type, &len)) == 1) {
+    switch(type) {
+      case PCAPNG_BLOCK_SHB:
+        reader->num_ifs = 0;
+        reader->section++;
+        break;
+      case PCAPNG_BLOCK_IDB:
+        pcap_parse_idb(reader, len);
+        break;
+      case PCAPNG_BLOCK_EPB:
+        if(pcap_parse_epb(reader, len, frame) == 0) {
+          return 1;
+        }
+        /* Skip frames of unsupported link types */
+        break;
+      default:
+        break;
+    }
+  }
+
+  return ret;
+}
+
+static int pcap_next_pcap(T_pcap_reader *reader, T_pcap_frame *frame)
+{
+  unsigned char header[PCAP_RECORD_HEADER_LEN];
+  uint32_t cap_len;
+  uint32_t read_len;
+
+  while(fread(header, 1, sizeof(header), reader->file) == sizeof(header)) {
+    memset(frame, 0, offsetof(T_pcap_frame, data));
+    frame->time_ns = ((uint64_t)pcap_get32(reader, &header[0]) * 1000000000ULL) +
+                     ((uint64_t)pcap_get32(reader, &header[4]) * (reader->ns_flag ? 1 : 1000));
+    cap_len = pcap_get32(reader, &header[8]);
+    if(cap_len > PCAPNG_MAX_BLOCK_LEN) {
+      return -1;
+    }
+    read_len = (cap_len < PCAP_MAX_FRAME_LEN) ? cap_len : PCAP_MAX_FRAME_LEN;
+    frame->len = read_len;
+    if(fread(frame->data, 1, read_len, reader->file) != read_len) {
+      return -1;
+    }
+    if((cap_len > read_len) && (fseek(reader->file, cap_len - read_len, SEEK_CUR) < 0)) {
+      return -1;
+    }
+
+    if(pcap_normalize_frame(reader->ifs[0].linktype, frame) == 0) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static int pcap_write_block(T_pcap_writer *writer, uint32_t type, const void *body, uint32_t body_len, const void *data, uint32_t data_len)
+{
+  static const unsigned char padding[4];
+  uint32_t pad_len = (4 - (data_len % 4)) % 4;
+  uint32_t block_len = 12 + body_len + data_len + pad_len;
+
+  if((fwrite(&type, sizeof(type), 1, writer->file) != 1) ||
+     (fwrite(&block_len, sizeof(block_len), 1, writer->file) != 1) ||
+     ((body_len > 0) && (fwrite(body, body_len, 1, writer->file) != 1)) ||
+     ((data_len > 0) && (fwrite(data, data_len, 1, writer->file) != 1)) ||
+     ((pad_len > 0) && (fwrite(padding, pad_len, 1, writer->file) != 1)) ||
+     (fwrite(&block_len, sizeof(block_len), 1, writer->file) != 1)) {
+    return -1;
+  }
+
+  return 0;
+}
+
+/* Global functions */
+
+T_pcap_reader *pcap_reader_open(const char *path)
+{
+  T_pcap_reader *reader;
+  unsigned char header[PCAP_HEADER_LEN];
+  uint32_t magic;
+
+  reader = calloc(1, sizeof(*reader));
+  if(reader == NULL) {
+    return NULL;
+  }
+
+  reader->file = fopen(path, "rb");
+  if(reader->file == NULL) {
+    pr_err("Failed to open %s: %s", path, strerror(errno));
+    free(reader);
+    return NULL;
+  }
+
+  if(fread(&magic, sizeof(magic), 1, reader->file) != 1) {
+    goto err;
+  }
+
+  if(magic == PCAPNG_BLOCK_SHB) {
+    reader->pcapng_flag = 1;
+    rewind(reader->file);
+    return reader;
+  }
+
+  if((magic == PCAP_MAGIC_US) || (magic == PCAP_MAGIC_NS)) {
+    reader->swap_flag = 0;
+  } else if((__builtin_bswap32(magic) == PCAP_MAGIC_US) || (__builtin_bswap32(magic) == PCAP_MAGIC_NS)) {
+    reader->swap_flag = 1;
+    magic = __builtin_bswap32(magic);
+  } else {
+    pr_err("%s is neither a pcap nor a pcapng file", path);
+    goto err;
+  }
+  reader->ns_flag = (magic == PCAP_MAGIC_NS);
+
+  rewind(reader->file);
+  if(fread(header, 1, sizeof(header), reader->file) != sizeof(header)) {
+    goto err;
+  }
+
+  /* Classic pcap has a single capture interface without a name */
+  reader->num_ifs = 1;
+  reader->ifs[0].linktype = pcap_get32(reader, &header[20]) & 0xFFFF;
+  if((reader->ifs[0].linktype != PCAP_LINKTYPE_ETHERNET) && (reader->ifs[0].linktype != PCAP_LINKTYPE_LINUX_SLL)) {
+    pr_err("Link type %d of %s is not supported", reader->ifs[0].linktype, path);
+    goto err;
+  }
+
+  return reader;
+
+err:
+  fclose(reader->file);
+  free(reader);
+  return NULL;
+}
+
+int pcap_reader_next(T_pcap_reader *reader, T_pcap_frame *frame)
+{
+  return reader->pcapng_flag ? pcap_next_pcapng(reader, frame) : pcap_next_pcap(reader, frame);
+}
+
+const char *pcap_reader_get_if_name(T_pcap_reader *reader, int if_id)
+{
+  if((if_id < 0) || (if_id >= reader->num_ifs) || (reader->ifs[if_id].name[0] == '\0')) {
+    return NULL;
+  }
+
+  return reader->ifs[if_id].name;
+}
+
+int pcap_reader_get_num_ifs(T_pcap_reader *reader)
+{
+  return reader->num_ifs;
+}
+
+int pcap_reader_get_section(T_pcap_reader *reader)
+{
+  return reader->section;
+}
+
+void pcap_reader_close(T_pcap_reader *reader)
+{
+  if(reader == NULL) {
+    return;
+  }
+
+  fclose(reader->file);
+  free(reader->block);
+  free(reader);
+}
+
+T_pcap_writer *pcap_writer_open(const char *path)
+{
+  T_pcap_writer *writer;
+  /* Byte-order magic, version 1.0 and unknown section length */
+  const uint32_t shb[4] = {PCAPNG_BYTE_ORDER_MAGIC, 0x00000001, 0xFFFFFFFF, 0xFFFFFFFF};
+
+  writer = calloc(1, sizeof(*writer));
+  if(writer == NULL) {
+    return NULL;
+  }
+
+  writer->file = fopen(path, "wb");
+  if(writer->file == NULL) {
+    pr_err("Failed to create %s: %s", path, strerror(errno));
+    free(writer);
+    return NULL;
+  }
+
+  if((os_mutex_init(&writer->mutex) < 0) ||
+     (pcap_write_block(writer, PCAPNG_BLOCK_SHB, shb, sizeof(shb), NULL, 0) < 0)) {
+    fclose(writer->file);
+    free(writer);
+    return NULL;
+  }
+
+  return writer;
+}
+
+int pcap_writer_add_if(T_pcap_writer *writer, const char *name)
+{
+  unsigned char body[8 + 4 + PCAP_MAX_IF_NAME_LEN + 4 + 4 + 4 + 4];
+  uint16_t opt[2];
+  uint16_t linktype = PCAP_LINKTYPE_ETHERNET;
+  uint32_t snaplen = 0;
+  int name_len = strnlen(name, PCAP_MAX_IF_NAME_LEN - 1);
+  int off = 0;
+  int if_id;
+
+  memset(body, 0, sizeof(body));
+  memcpy(&body[off], &linktype, sizeof(linktype));
+  off += 4;
+  memcpy(&body[off], &snaplen, sizeof(snaplen));
+  off += 4;
+
+  opt[0] = PCAPNG_OPT_IF_NAME;
+  opt[1] = name_len;
+  memcpy(&body[off], opt, sizeof(opt));
+  off += sizeof(opt);
+  memcpy(&body[off], name, name_len);
+  off += (name_len + 3) & ~3;
+
+  /* Nanosecond timestamps */
+  opt[0] = PCAPNG_OPT_IF_TSRESOL;
+  opt[1] = 1;
+  memcpy(&body[off], opt, sizeof(opt));
+  off += sizeof(opt);
+  body[off] = 9;
+  off += 4;
+
+  /* End of options */
+  off += 4;
+
+  os_mutex_lock(&writer->mutex);
+  if(pcap_write_block(writer, PCAPNG_BLOCK_IDB, body, off, NULL, 0) < 0) {
+    if_id = -1;
+  } else {
+    if_id = writer->num_ifs++;
+  }
+  os_mutex_unlock(&writer->mutex);
+
+  return if_id;
+}
+
+int pcap_writer_write(T_pcap_writer *writer, int if_id, uint64_t time_ns, const void *data, int len)
+{
+  uint32_t body[5];
+  int ret;
+
+  body[0] = if_id;
+  body[1] = time_ns >> 32;
+  body[2] = time_ns & 0xFFFFFFFF;
+  body[3] = len;
+  body[4] = len;
+
+  os_mutex_lock(&writer->mutex);
+  ret = pcap_write_block(writer, PCAPNG_BLOCK_EPB, body, sizeof(body), data, len);
+  os_mutex_unlock(&writer->mutex);
+
+  return ret;
+}
+
+void pcap_writer_close(T_pcap_writer *writer)
+{
+  if(writer == NULL) {
+    return;
+  }
+
+  fclose(writer->file);
+  os_mutex_deinit(&writer->mutex);
+  free(writer);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file pcap.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#ifndef PCAP_H
+#define PCAP_H
+
+#include <stdint.h>
+
+/*
+ * Minimal pcap and pcapng file support without libpcap, for replaying captured ESMC traffic.
+ *
+ * The reader accepts classic pcap (microsecond and nanosecond timestamps) and pcapng (Section Header, Interface
+ * Description and Enhanced Packet Blocks; other blocks are skipped) in either byte order, with Ethernet or Linux
+ * cooked capture (SLL) link types. SLL frames are returned as Ethernet frames with the IEEE Slow Protocols multicast
+ * address as destination. The writer produces pcapng with nanosecond timestamps and one interface per port.
+ */
+
+#define PCAP_MAX_FRAME_LEN   256    /* Longer frames are truncated to this length */
+
+typedef struct {
+  uint64_t time_ns;                         /* Capture time since the epoch */
+  int if_id;                                /* Capture interface (always 0 for classic pcap) */
+  int outbound_flag;                        /* Frame was sent by the capturing node (if the capture records it) */
+  int len;                                  /* Bytes in data (captured length, truncated to PCAP_MAX_FRAME_LEN) */
+  unsigned char data[PCAP_MAX_FRAME_LEN];
+} T_pcap_frame;
+
+typedef struct pcap_reader T_pcap_reader;
+typedef struct pcap_writer T_pcap_writer;
+
+T_pcap_reader *pcap_reader_open(const char *path);
+/* Return 1 and the next frame, 0 at the end of the file, or -1 if the file is malformed */
+int pcap_reader_next(T_pcap_reader *reader, T_pcap_frame *frame);
+/* Return the name of a capture interface of the current section, or NULL if it has none */
+const char *pcap_reader_get_if_name(T_pcap_reader *reader, int if_id);
+int pcap_reader_get_num_ifs(T_pcap_reader *reader);
+/* Incremented on every pcapng section, which restarts the interface numbering */
+int pcap_reader_get_section(T_pcap_reader *reader);
+void pcap_reader_close(T_pcap_reader *reader);
+
+T_pcap_writer *pcap_writer_open(const char *path);
+/* Add an Ethernet interface and return its ID */
+int pcap_writer_add_if(T_pcap_writer *writer, const char *name);
+int pcap_writer_write(T_pcap_writer *writer, int if_id, uint64_t time_ns, const void *data, int len);
+void pcap_writer_close(T_pcap_writer *writer);
+
+#endif /* PCAP_H */
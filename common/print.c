@@ -22,22 +22,298 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#include <pthread.h>
+#include <semaphore.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <syslog.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "common.h"
 #include "print.h"
 
+#define PRINT_ASYNC_IDLE_WAIT_MS  100
+
+#define PRINT_RATELIMIT_MAX_NUM_OF_ENTRIES  64
+
+/*
+ * Asynchronous mode: callers format into a slot of a bounded multi-producer single-consumer ring
+ * (per-slot sequence numbers, no locks) and a writer thread does the stdout and syslog output.
+ * A slot is free for position pos when its sequence is pos and ready for the writer when it is pos + 1.
+ */
+typedef struct {
+  uint64_t seq;
+  int level;
+  int timestamp_en;
+  struct timespec ts;
+  char buf[PRINT_BUFFER_SIZE];
+} T_print_record;
+
+/* Rate limiting state of one message; free when site is NULL */
+typedef struct {
+  const char *site;
+  uint64_t hash;
+  int level;
+  unsigned long long window_start_ms;
+  unsigned int num_printed;                 /* In the current interval */
+  unsigned int num_repeats;                 /* Suppressed since the message was last printed */
+  char buf[PRINT_BUFFER_SIZE];
+} T_print_ratelimit_entry;
+
 static const char *g_print_prog_name = NULL;
 
 static const char *g_msg_tag = NULL;
 
-static int g_pr_level = LOG_INFO;
+int g_print_max_msg_level[E_print_module_max] = {
+  LOG_INFO,
+  LOG_INFO,
+  LOG_INFO,
+  LOG_INFO,
+  LOG_INFO,
+  LOG_INFO
+};
+
+/* See T_print_module */
+static const char *g_print_module_to_str[] = {
+  "general",
+  "esmc",
+  "control",
+  "monitor",
+  "device",
+  "management"
+};
+COMPILE_TIME_ASSERT((sizeof(g_print_module_to_str)/sizeof(g_print_module_to_str[0])) == E_print_module_max, "Invalid array size for g_print_module_to_str!")
+
 static int g_stdout_en = 0;
 static int g_syslog_en = 0;
 
+static T_print_record *g_print_ring = NULL;
+static uint64_t g_print_ring_mask = 0;
+static uint64_t g_print_enqueue_pos = 0;  /* Claimed by callers with compare-and-swap */
+static uint64_t g_print_dequeue_pos = 0;  /* Only used by the writer thread */
+static uint64_t g_print_dropped_count = 0;
+static uint64_t g_print_reported_dropped_count = 0;
+
+static int g_print_async_running_flag = 0;
+static int g_print_async_stop_flag = 0;
+static int g_print_async_waiting_flag = 0;
+static sem_t g_print_async_sem;
+static pthread_t g_print_async_thread;
+
+static unsigned int g_print_ratelimit_interval_ms = 5000;
+static unsigned int g_print_ratelimit_burst = 1;
+static T_print_ratelimit_entry g_print_ratelimit_entries[PRINT_RATELIMIT_MAX_NUM_OF_ENTRIES];
+static int g_print_ratelimit_num_pending = 0;  /* Entries with repeats to report; read without the mutex */
+static pthread_mutex_t g_print_ratelimit_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void print_output(int level, int timestamp_en, struct timespec const *ts, char const *buf, int flush_flag)
+{
+  FILE *fp;
+
+  if(g_stdout_en) {
+    fp = level >= LOG_NOTICE ? stdout : stderr;
+    if(timestamp_en) {
+      fprintf(fp, "%s[%lld.%03ld]: %s%s%s\n",
+              g_print_prog_name ? g_print_prog_name : "",
+              (long long)ts->tv_sec, ts->tv_nsec / 1000000,
+              g_msg_tag ? g_msg_tag : "", g_msg_tag ? " " : "",
+              buf);
+    } else {
+      fprintf(fp, "%s",
+              buf);
+    }
+    if(flush_flag) {
+      fflush(fp);
+    }
+  }
+  if(g_syslog_en) {
+    if(timestamp_en) {
+      syslog(level, "[%lld.%03ld] %s%s%s",
+             (long long)ts->tv_sec, ts->tv_nsec / 1000000,
+             g_msg_tag ? g_msg_tag : "", g_msg_tag ? " " : "",
+             buf);
+    } else {
+      syslog(level, "%s",
+             buf);
+    }
+  }
+}
+
+static T_print_record *print_async_claim(uint64_t *pos)
+{
+  T_print_record *record;
+  uint64_t seq;
+  int64_t diff;
+
+  *pos = __atomic_load_n(&g_print_enqueue_pos, __ATOMIC_RELAXED);
+  for(;;) {
+    record = &g_print_ring[*pos & g_print_ring_mask];
+    seq = __atomic_load_n(&record->seq, __ATOMIC_ACQUIRE);
+    diff = (int64_t)(seq - *pos);
+    if(diff == 0) {
+      if(__atomic_compare_exchange_n(&g_print_enqueue_pos, pos, *pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return record;
+      }
+    } else if(diff < 0) {
+      /* The writer has not yet freed the slot, so the ring is full */
+      return NULL;
+    } else {
+      *pos = __atomic_load_n(&g_print_enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+static void print_async_commit(T_print_record *record, uint64_t pos)
+{
+  __atomic_store_n(&record->seq, pos + 1, __ATOMIC_RELEASE);
+
+  /* Pairs with the fence in print_async_wait(): either the writer sees the record before sleeping or this caller sees it waiting */
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if(__atomic_exchange_n(&g_print_async_waiting_flag, 0, __ATOMIC_RELAXED)) {
+    sem_post(&g_print_async_sem);
+  }
+}
+
+static int print_async_ready(void)
+{
+  T_print_record *record = &g_print_ring[g_print_dequeue_pos & g_print_ring_mask];
+
+  return __atomic_load_n(&record->seq, __ATOMIC_ACQUIRE) == (g_print_dequeue_pos + 1);
+}
+
+static void print_async_report_dropped(void)
+{
+  uint64_t dropped_count = __atomic_load_n(&g_print_dropped_count, __ATOMIC_RELAXED);
+  struct timespec ts;
+  char buf[PRINT_BUFFER_SIZE];
+
+  if(dropped_count == g_print_reported_dropped_count) {
+    return;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  snprintf(buf, sizeof(buf), "Dropped %llu log messages because the log queue was full (%llu in total)",
+           (unsigned long long)(dropped_count - g_print_reported_dropped_count),
+           (unsigned long long)dropped_count);
+  print_output(LOG_WARNING, TS_ENABLE, &ts, buf, 1);
+  g_print_reported_dropped_count = dropped_count;
+}
+
+static void print_async_drain(void)
+{
+  T_print_record *record;
+  int count = 0;
+
+  while(print_async_ready()) {
+    record = &g_print_ring[g_print_dequeue_pos & g_print_ring_mask];
+    print_output(record->level, record->timestamp_en, &record->ts, record->buf, 0);
+    __atomic_store_n(&record->seq, g_print_dequeue_pos + g_print_ring_mask + 1, __ATOMIC_RELEASE);
+    g_print_dequeue_pos++;
+    count++;
+  }
+
+  /* One flush per batch rather than per message */
+  if((count > 0) && g_stdout_en) {
+    fflush(stdout);
+    fflush(stderr);
+  }
+
+  print_async_report_dropped();
+}
+
+static void print_async_wait(void)
+{
+  struct timespec deadline;
+
+  __atomic_store_n(&g_print_async_waiting_flag, 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if(print_async_ready() || __atomic_load_n(&g_print_async_stop_flag, __ATOMIC_ACQUIRE)) {
+    __atomic_store_n(&g_print_async_waiting_flag, 0, __ATOMIC_RELAXED);
+    return;
+  }
+
+  /* The timeout also catches a record whose caller was preempted between claim and commit */
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += PRINT_ASYNC_IDLE_WAIT_MS * 1000000L;
+  if(deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+  sem_timedwait(&g_print_async_sem, &deadline);
+  __atomic_store_n(&g_print_async_waiting_flag, 0, __ATOMIC_RELAXED);
+}
+
+static void *print_async_thread(void *arg)
+{
+  (void)arg;
+
+  while(!__atomic_load_n(&g_print_async_stop_flag, __ATOMIC_ACQUIRE)) {
+    print_async_drain();
+    print_async_wait();
+  }
+
+  /* Flush what was queued before the stop */
+  print_async_drain();
+
+  return NULL;
+}
+
+static unsigned long long print_get_monotonic_milliseconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((unsigned long long)ts.tv_sec * 1000ULL) + (ts.tv_nsec / 1000000);
+}
+
+/* FNV-1a */
+static uint64_t print_hash_string(char const *str)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  while(*str) {
+    hash ^= (unsigned char)*str++;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+/* Must be called with g_print_ratelimit_mutex held */
+static T_print_ratelimit_entry *print_ratelimit_find_entry(char const *site, uint64_t hash, unsigned long long now_ms)
+{
+  T_print_ratelimit_entry *entry;
+  T_print_ratelimit_entry *free_entry = NULL;
+  int i;
+
+  for(i = 0; i < PRINT_RATELIMIT_MAX_NUM_OF_ENTRIES; i++) {
+    entry = &g_print_ratelimit_entries[i];
+    if((entry->site == site) && (entry->hash == hash)) {
+      return entry;
+    }
+    /* Entries with nothing to report can be reused once their interval has ended */
+    if((free_entry == NULL) &&
+       ((entry->site == NULL) ||
+        ((entry->num_repeats == 0) && ((now_ms - entry->window_start_ms) >= g_print_ratelimit_interval_ms)))) {
+      free_entry = entry;
+    }
+  }
+
+  if(free_entry != NULL) {
+    free_entry->site = site;
+    free_entry->hash = hash;
+    free_entry->window_start_ms = now_ms;
+    free_entry->num_printed = 0;
+    free_entry->num_repeats = 0;
+  }
+
+  return free_entry;
+}
+
 void print_set_prog_name(const char *name)
 {
   g_print_prog_name = name;
@@ -53,7 +329,53 @@ void print_set_msg_tag(const char *tag)
 
 void print_set_max_msg_level(int level)
 {
-  g_pr_level = level;
+  int i;
+
+  for(i = 0; i < E_print_module_max; i++) {
+    g_print_max_msg_level[i] = level;
+  }
+}
+
+int print_set_module_max_msg_level(T_print_module module, int level)
+{
+  if(module >= E_print_module_max) {
+    return -1;
+  }
+
+  g_print_max_msg_level[module] = level;
+
+  return 0;
+}
+
+int print_get_module_max_msg_level(T_print_module module)
+{
+  if(module >= E_print_module_max) {
+    return -1;
+  }
+
+  return g_print_max_msg_level[module];
+}
+
+int print_get_module_by_name(const char *name)
+{
+  int i;
+
+  for(i = 0; i < E_print_module_max; i++) {
+    if(strcmp(name, g_print_module_to_str[i]) == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+const char *print_module_to_str(T_print_module module)
+{
+  if(module >= E_print_module_max) {
+    return "Invalid module";
+  }
+
+  return g_print_module_to_str[module];
 }
 
 void print_set_stdout_en(int value)
@@ -66,45 +388,213 @@ void print_set_syslog_en(int value)
   g_syslog_en = value ? 1 : 0;
 }
 
+int print_async_start(unsigned int queue_len)
+{
+  uint64_t ring_len = 1;
+  uint64_t i;
+
+  if(g_print_async_running_flag) {
+    return 0;
+  }
+
+  /* Positions are masked, so the ring length must be a power of two */
+  while(ring_len < queue_len) {
+    ring_len <<= 1;
+  }
+
+  g_print_ring = calloc(ring_len, sizeof(*g_print_ring));
+  if(g_print_ring == NULL) {
+    return -1;
+  }
+  for(i = 0; i < ring_len; i++) {
+    g_print_ring[i].seq = i;
+  }
+  g_print_ring_mask = ring_len - 1;
+  g_print_enqueue_pos = 0;
+  g_print_dequeue_pos = 0;
+  g_print_dropped_count = 0;
+  g_print_reported_dropped_count = 0;
+  g_print_async_stop_flag = 0;
+  g_print_async_waiting_flag = 0;
+
+  if(sem_init(&g_print_async_sem, 0, 0) != 0) {
+    free(g_print_ring);
+    g_print_ring = NULL;
+    return -1;
+  }
+
+  if(pthread_create(&g_print_async_thread, NULL, print_async_thread, NULL) != 0) {
+    sem_destroy(&g_print_async_sem);
+    free(g_print_ring);
+    g_print_ring = NULL;
+    return -1;
+  }
+
+  __atomic_store_n(&g_print_async_running_flag, 1, __ATOMIC_RELEASE);
+
+  return 0;
+}
+
+void print_async_stop(void)
+{
+  if(!g_print_async_running_flag) {
+    return;
+  }
+
+  /* Later messages are written directly by their callers */
+  __atomic_store_n(&g_print_async_running_flag, 0, __ATOMIC_RELEASE);
+
+  __atomic_store_n(&g_print_async_stop_flag, 1, __ATOMIC_RELEASE);
+  sem_post(&g_print_async_sem);
+  pthread_join(g_print_async_thread, NULL);
+
+  sem_destroy(&g_print_async_sem);
+  free(g_print_ring);
+  g_print_ring = NULL;
+}
+
+unsigned long long print_get_dropped_count(void)
+{
+  return __atomic_load_n(&g_print_dropped_count, __ATOMIC_RELAXED);
+}
+
 void print(int level, int timestamp_en, char const *format, ...)
 {
   struct timespec ts;
   va_list ap;
   char buf[PRINT_BUFFER_SIZE];
-  FILE *fp;
+  T_print_record *record;
+  uint64_t pos;
 
-  if(level > g_pr_level)
+  /* Levels are checked by the pr_* macros */
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  if(__atomic_load_n(&g_print_async_running_flag, __ATOMIC_ACQUIRE)) {
+    record = print_async_claim(&pos);
+    if(record == NULL) {
+      __atomic_fetch_add(&g_print_dropped_count, 1, __ATOMIC_RELAXED);
+      return;
+    }
+
+    record->level = level;
+    record->timestamp_en = timestamp_en;
+    record->ts = ts;
+    va_start(ap, format);
+    vsnprintf(record->buf, sizeof(record->buf), format, ap);
+    va_end(ap);
+
+    print_async_commit(record, pos);
     return;
+  }
 
-  clock_gettime(CLOCK_MONOTONIC, &ts);
+  va_start(ap, format);
+  vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+
+  print_output(level, timestamp_en, &ts, buf, 1);
+}
+
+void print_ratelimited(int level, char const *site, char const *format, ...)
+{
+  T_print_ratelimit_entry *entry;
+  unsigned long long now_ms;
+  unsigned long long window_ms = 0;
+  unsigned int num_repeats = 0;
+  int print_flag = 1;
+  va_list ap;
+  char buf[PRINT_BUFFER_SIZE];
+  uint64_t hash;
 
   va_start(ap, format);
   vsnprintf(buf, sizeof(buf), format, ap);
   va_end(ap);
 
-  if(g_stdout_en) {
-    fp = level >= LOG_NOTICE ? stdout : stderr;
-    if(timestamp_en) {
-      fprintf(fp, "%s[%lld.%03ld]: %s%s%s\n",
-              g_print_prog_name ? g_print_prog_name : "",
-              (long long)ts.tv_sec, ts.tv_nsec / 1000000,
-              g_msg_tag ? g_msg_tag : "", g_msg_tag ? " " : "",
-              buf);
-    } else {
-      fprintf(fp, "%s",
-              buf);
+  if(g_print_ratelimit_interval_ms > 0) {
+    hash = print_hash_string(buf);
+    now_ms = print_get_monotonic_milliseconds();
+
+    pthread_mutex_lock(&g_print_ratelimit_mutex);
+
+    /* Without a free entry the message is printed */
+    entry = print_ratelimit_find_entry(site, hash, now_ms);
+    if(entry != NULL) {
+      if((now_ms - entry->window_start_ms) >= g_print_ratelimit_interval_ms) {
+        window_ms = now_ms - entry->window_start_ms;
+        entry->window_start_ms = now_ms;
+        entry->num_printed = 0;
+      }
+
+      if(entry->num_printed < g_print_ratelimit_burst) {
+        entry->num_printed++;
+        /* This message also reports the repeats since the last one printed */
+        num_repeats = entry->num_repeats;
+        if(num_repeats > 0) {
+          entry->num_repeats = 0;
+          __atomic_store_n(&g_print_ratelimit_num_pending, g_print_ratelimit_num_pending - 1, __ATOMIC_RELAXED);
+        }
+      } else {
+        if(entry->num_repeats == 0) {
+          entry->level = level;
+          memcpy(entry->buf, buf, sizeof(entry->buf));
+          __atomic_store_n(&g_print_ratelimit_num_pending, g_print_ratelimit_num_pending + 1, __ATOMIC_RELAXED);
+        }
+        entry->num_repeats++;
+        print_flag = 0;
+      }
     }
-    fflush(fp);
+
+    pthread_mutex_unlock(&g_print_ratelimit_mutex);
   }
-  if(g_syslog_en) {
-    if(timestamp_en) {
-      syslog(level, "[%lld.%03ld] %s%s%s",
-             (long long)ts.tv_sec, ts.tv_nsec / 1000000,
-             g_msg_tag ? g_msg_tag : "", g_msg_tag ? " " : "",
-             buf);
-    } else {
-      syslog(level, "%s",
-             buf);
+
+  if(!print_flag) {
+    return;
+  }
+
+  if(num_repeats > 0) {
+    print(level, TS_ENABLE, "%s (suppressed %u times in %llu ms)", buf, num_repeats, window_ms);
+  } else {
+    print(level, TS_ENABLE, "%s", buf);
+  }
+}
+
+void print_set_ratelimit(unsigned int interval_ms, unsigned int burst)
+{
+  pthread_mutex_lock(&g_print_ratelimit_mutex);
+  g_print_ratelimit_interval_ms = interval_ms;
+  g_print_ratelimit_burst = (burst > 0) ? burst : 1;
+  pthread_mutex_unlock(&g_print_ratelimit_mutex);
+}
+
+void print_ratelimit_flush(int force_flag)
+{
+  T_print_ratelimit_entry *entry;
+  unsigned long long now_ms;
+  int i;
+
+  /* Called every main loop iteration, so return early when there is nothing to report */
+  if(__atomic_load_n(&g_print_ratelimit_num_pending, __ATOMIC_RELAXED) == 0) {
+    return;
+  }
+
+  now_ms = print_get_monotonic_milliseconds();
+
+  pthread_mutex_lock(&g_print_ratelimit_mutex);
+
+  for(i = 0; i < PRINT_RATELIMIT_MAX_NUM_OF_ENTRIES; i++) {
+    entry = &g_print_ratelimit_entries[i];
+    if((entry->site == NULL) || (entry->num_repeats == 0) ||
+       (!force_flag && ((now_ms - entry->window_start_ms) < g_print_ratelimit_interval_ms))) {
+      continue;
     }
+
+    print(entry->level, TS_ENABLE, "%s (suppressed %u times in %llu ms)",
+          entry->buf, entry->num_repeats, now_ms - entry->window_start_ms);
+
+    /* Start a new interval so a recurrence is printed right away */
+    entry->site = NULL;
+    entry->num_repeats = 0;
+    __atomic_store_n(&g_print_ratelimit_num_pending, g_print_ratelimit_num_pending - 1, __ATOMIC_RELAXED);
   }
+
+  pthread_mutex_unlock(&g_print_ratelimit_mutex);
 }
@@ -31,30 +31,113 @@
 #define PRINT_LEVEL_MIN   LOG_EMERG
 #define PRINT_LEVEL_MAX   LOG_DEBUG
 
+/* Messages above this level are compiled out */
+#ifndef SYNCED_MAX_MSG_LVL
+#define SYNCED_MAX_MSG_LVL  PRINT_LEVEL_MAX
+#endif
+
 #define TS_ENABLE    1
 #define TS_DISABLE   0
 
+/* Modules with their own maximum message level */
+typedef enum {
+  E_print_module_general,
+  E_print_module_esmc,
+  E_print_module_control,
+  E_print_module_monitor,
+  E_print_module_device,
+  E_print_module_management,
+  E_print_module_max
+} T_print_module;
+
+#define PRINT_MODULE_ALL  E_print_module_max /* Not -1, which print_get_module_by_name() returns for an unknown name */
+
+/* A source file selects its module by defining PRINT_MODULE before its includes */
+#ifndef PRINT_MODULE
+#define PRINT_MODULE  E_print_module_general
+#endif
+
+extern int g_print_max_msg_level[E_print_module_max];
+
+#define print_is_enabled(level) \
+  (((level) <= SYNCED_MAX_MSG_LVL) && ((level) <= g_print_max_msg_level[PRINT_MODULE]))
+
 #ifdef __GNUC__
 __attribute__ ((format (printf, 3, 4)))
 #endif
 void print(int level, int timestamp_en, char const *format, ...);
 
-#define pr_emerg(...)       print(LOG_EMERG, TS_ENABLE, __VA_ARGS__)
-#define pr_alert(...)       print(LOG_ALERT, TS_ENABLE, __VA_ARGS__)
-#define pr_crit(...)        print(LOG_CRIT, TS_ENABLE, __VA_ARGS__)
-#define pr_err(...)         print(LOG_ERR, TS_ENABLE, __VA_ARGS__)
-#define pr_warning(...)     print(LOG_WARNING, TS_ENABLE, __VA_ARGS__)
-#define pr_notice(...)      print(LOG_NOTICE, TS_ENABLE, __VA_ARGS__)
-#define pr_info(...)        print(LOG_INFO, TS_ENABLE, __VA_ARGS__)
-#define pr_info_dump(...)   print(LOG_INFO, TS_DISABLE, __VA_ARGS__)
-#define pr_debug(...)       print(LOG_DEBUG, TS_ENABLE, __VA_ARGS__)
+/* The level is checked before the arguments are evaluated */
+#define print_if_enabled(level, timestamp_en, ...) \
+  do { \
+    if(print_is_enabled(level)) { \
+      print((level), (timestamp_en), __VA_ARGS__); \
+    } \
+  } while(0)
+
+#define pr_emerg(...)       print_if_enabled(LOG_EMERG, TS_ENABLE, __VA_ARGS__)
+#define pr_alert(...)       print_if_enabled(LOG_ALERT, TS_ENABLE, __VA_ARGS__)
+#define pr_crit(...)        print_if_enabled(LOG_CRIT, TS_ENABLE, __VA_ARGS__)
+#define pr_err(...)         print_if_enabled(LOG_ERR, TS_ENABLE, __VA_ARGS__)
+#define pr_warning(...)     print_if_enabled(LOG_WARNING, TS_ENABLE, __VA_ARGS__)
+#define pr_notice(...)      print_if_enabled(LOG_NOTICE, TS_ENABLE, __VA_ARGS__)
+#define pr_info(...)        print_if_enabled(LOG_INFO, TS_ENABLE, __VA_ARGS__)
+#define pr_info_dump(...)   print_if_enabled(LOG_INFO, TS_DISABLE, __VA_ARGS__)
+#define pr_debug(...)       print_if_enabled(LOG_DEBUG, TS_ENABLE, __VA_ARGS__)
+
+/*
+ * Rate-limited messages for conditions that can repeat every iteration. Messages are keyed by call site and text;
+ * within each interval only the first burst of equal messages is printed and later ones are counted.
+ * The count is reported with the next printed message, or by print_ratelimit_flush() if the condition stopped.
+ */
+#ifdef __GNUC__
+__attribute__ ((format (printf, 3, 4)))
+#endif
+void print_ratelimited(int level, char const *site, char const *format, ...);
+
+#define PRINT_STRINGIFY(x)  #x
+#define PRINT_TO_STRING(x)  PRINT_STRINGIFY(x)
+
+#define print_ratelimited_if_enabled(level, ...) \
+  do { \
+    if(print_is_enabled(level)) { \
+      print_ratelimited((level), __FILE__ ":" PRINT_TO_STRING(__LINE__), __VA_ARGS__); \
+    } \
+  } while(0)
+
+#define pr_err_ratelimited(...)       print_ratelimited_if_enabled(LOG_ERR, __VA_ARGS__)
+#define pr_warning_ratelimited(...)   print_ratelimited_if_enabled(LOG_WARNING, __VA_ARGS__)
 
 #define PRINT_BUFFER_SIZE 1024
 
 void print_set_prog_name(const char *name);
 void print_set_msg_tag(const char *tag);
+/* Set the maximum message level of all modules */
 void print_set_max_msg_level(int level);
+/* Set the maximum message level of one module; return -1 if module is invalid */
+int print_set_module_max_msg_level(T_print_module module, int level);
+int print_get_module_max_msg_level(T_print_module module);
+/* Return the module with the given name, or -1 */
+int print_get_module_by_name(const char *name);
+const char *print_module_to_str(T_print_module module);
 void print_set_stdout_en(int value);
 void print_set_syslog_en(int value);
 
+/*
+ * Hand messages to a writer thread through a lock-free queue of queue_len (rounded up to a power of two) messages,
+ * so callers never block on stdout or syslog. Messages that do not fit in the queue are dropped and counted.
+ * print_async_stop() writes out the queued messages and must be called after all other threads have stopped.
+ */
+int print_async_start(unsigned int queue_len);
+void print_async_stop(void);
+unsigned long long print_get_dropped_count(void);
+
+/* Print at most burst equal messages per interval_ms; 0 disables rate limiting */
+void print_set_ratelimit(unsigned int interval_ms, unsigned int burst);
+/*
+ * Report repeats of messages that have not been printed again since their interval ended; with force_flag set,
+ * report all pending repeats whether or not their interval has ended (e.g. at exit)
+ */
+void print_ratelimit_flush(int force_flag);
+
 #endif /* PRINT_H */
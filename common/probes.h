@@ -0,0 +1,64 @@
+/**
+ * @file probes.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#ifndef PROBES_H
+#define PROBES_H
+
+/*
+ * USDT (user statically-defined tracing) probes for bpftrace, perf and SystemTap, built in with
+ * SYNCED_USDT_PROBES=1 (requires sys/sdt.h, e.g. from systemtap-sdt-dev). Each probe is a single
+ * nop until a tracer attaches to it. The provider is "synced"; probe names and argument layouts
+ * are stable across releases, so scripts do not depend on function names:
+ *
+ *   pdu_rx(int port_num, int num_bytes)                              ESMC PDU read by a port RX thread
+ *   pdu_parse(int port_num, int err, int ql, int enhanced_flag)      ESMC PDU parsed (err: 0 or -1)
+ *   rx_cb_entry(int port_num, int event_type)                        RX event passed to control
+ *   rx_cb_return(int port_num, int event_type)
+ *   tx_cb_entry(int port_num, int event_type)                        TX event passed to control
+ *   tx_cb_return(int port_num, int event_type)
+ *   rank_change(int sync_idx, int old_rank, int new_rank, int ql)
+ *   priority_table_write(int num_entries, int best_clk_idx, int err) Clock priorities set on the device
+ *   device_op_entry(int op, char *op_name)                           Device adaptor operation (T_stats_device_op)
+ *   device_op_return(int op, char *op_name, int err)
+ *   dpll_state_change(int old_state, int new_state)                  Sync-E DPLL state (T_device_dpll_state)
+ *   pdu_tx(int port_num, int pdu_type, int ql, int num_bytes)        ESMC PDU sent (pdu_type: T_esmc_pdu_type)
+ *
+ * Without SYNCED_USDT_PROBES=1 the macros and their arguments are compiled out.
+ */
+
+#if (SYNCED_USDT_PROBES == 1)
+#include <sys/sdt.h>
+
+#define synced_probe2(name, arg1, arg2) \
+  STAP_PROBE2(synced, name, arg1, arg2)
+#define synced_probe3(name, arg1, arg2, arg3) \
+  STAP_PROBE3(synced, name, arg1, arg2, arg3)
+#define synced_probe4(name, arg1, arg2, arg3, arg4) \
+  STAP_PROBE4(synced, name, arg1, arg2, arg3, arg4)
+#else
+#define synced_probe2(name, arg1, arg2)               do {} while(0)
+#define synced_probe3(name, arg1, arg2, arg3)         do {} while(0)
+#define synced_probe4(name, arg1, arg2, arg3, arg4)   do {} while(0)
+#endif
+
+#endif /* PROBES_H */
@@ -0,0 +1,262 @@
+/**
+ * @file stats.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "os.h"
+#include "stats.h"
+
+#define STATS_CACHE_LINE_SIZE   64
+
+/* Enough for an RX and a TX thread per port plus the other threads */
+#define STATS_MAX_NUM_OF_SLOTS  ((2 * MAX_NUM_OF_SYNC_ENTRIES) + 16)
+
+typedef struct {
+  uint64_t port_counters[MAX_NUM_OF_SYNC_ENTRIES][E_stats_port_counter_max];
+  T_stats_device_op_latency device_op_latency[E_stats_device_op_max];
+  int in_use_flag;                          /* Owned by a running thread */
+} __attribute__((aligned(STATS_CACHE_LINE_SIZE))) T_stats_slot;
+
+/* Static data */
+
+/* See T_stats_port_counter */
+static const char *g_stats_port_counter_to_str[] = {
+  "ql_changes",
+  "rx_timeouts",
+  "link_flaps"
+};
+COMPILE_TIME_ASSERT((sizeof(g_stats_port_counter_to_str)/sizeof(g_stats_port_counter_to_str[0])) == E_stats_port_counter_max, "Invalid array size for g_stats_port_counter_to_str!")
+
+/* See T_stats_device_op */
+static const char *g_stats_device_op_to_str[] = {
+  "get_current_clk_idx",
+  "set_clock_priorities",
+  "get_reference_monitor_status",
+  "get_reference_ffo",
+  "get_synce_dpll_state",
+  "get_synce_dpll_ffo"
+};
+COMPILE_TIME_ASSERT((sizeof(g_stats_device_op_to_str)/sizeof(g_stats_device_op_to_str[0])) == E_stats_device_op_max, "Invalid array size for g_stats_device_op_to_str!")
+
+/* Slots are never freed; a slot released by an exiting thread is reused by the next new thread */
+static T_stats_slot *g_stats_slots[STATS_MAX_NUM_OF_SLOTS];
+static int g_stats_num_slots = 0;
+static pthread_mutex_t g_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Shared by threads that did not get a slot of their own; updated with atomic operations */
+static T_stats_slot g_stats_shared_slot;
+
+static pthread_key_t g_stats_key;
+static int g_stats_key_valid_flag = 0;
+static pthread_once_t g_stats_key_once = PTHREAD_ONCE_INIT;
+
+static __thread T_stats_slot *g_stats_thread_slot = NULL;
+
+/* Static functions */
+
+static void stats_release_slot(void *slot)
+{
+  os_mutex_lock(&g_stats_mutex);
+  ((T_stats_slot *)slot)->in_use_flag = 0;
+  os_mutex_unlock(&g_stats_mutex);
+}
+
+static void stats_create_key(void)
+{
+  /* Without the key, slots of exiting threads are not reused */
+  g_stats_key_valid_flag = (pthread_key_create(&g_stats_key, stats_release_slot) == 0);
+}
+
+static T_stats_slot *stats_acquire_slot(void)
+{
+  T_stats_slot *slot = NULL;
+  int i;
+
+  pthread_once(&g_stats_key_once, stats_create_key);
+
+  os_mutex_lock(&g_stats_mutex);
+
+  for(i = 0; i < g_stats_num_slots; i++) {
+    if(!g_stats_slots[i]->in_use_flag) {
+      slot = g_stats_slots[i];
+      break;
+    }
+  }
+
+  if((slot == NULL) && (g_stats_num_slots < STATS_MAX_NUM_OF_SLOTS)) {
+    if(posix_memalign((void **)&slot, STATS_CACHE_LINE_SIZE, sizeof(*slot)) == 0) {
+      memset(slot, 0, sizeof(*slot));
+      g_stats_slots[g_stats_num_slots] = slot;
+      /* Readers may sum the slots without the mutex */
+      __atomic_store_n(&g_stats_num_slots, g_stats_num_slots + 1, __ATOMIC_RELEASE);
+    } else {
+      slot = NULL;
+    }
+  }
+
+  if(slot != NULL) {
+    slot->in_use_flag = 1;
+  }
+
+  os_mutex_unlock(&g_stats_mutex);
+
+  if(slot == NULL) {
+    return &g_stats_shared_slot;
+  }
+
+  if(g_stats_key_valid_flag) {
+    pthread_setspecific(g_stats_key, slot);
+  }
+
+  return slot;
+}
+
+static inline T_stats_slot *stats_get_thread_slot(void)
+{
+  if(g_stats_thread_slot == NULL) {
+    g_stats_thread_slot = stats_acquire_slot();
+  }
+
+  return g_stats_thread_slot;
+}
+
+static inline void stats_add(T_stats_slot *slot, uint64_t *counter, uint64_t val)
+{
+  if(slot == &g_stats_shared_slot) {
+    __atomic_fetch_add(counter, val, __ATOMIC_RELAXED);
+  } else {
+    /* Only this thread writes its slot */
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + val, __ATOMIC_RELAXED);
+  }
+}
+
+static uint64_t stats_sum(size_t offset)
+{
+  uint64_t sum;
+  int num_slots;
+  int i;
+
+  sum = __atomic_load_n((uint64_t *)((char *)&g_stats_shared_slot + offset), __ATOMIC_RELAXED);
+
+  num_slots = __atomic_load_n(&g_stats_num_slots, __ATOMIC_ACQUIRE);
+  for(i = 0; i < num_slots; i++) {
+    sum += __atomic_load_n((uint64_t *)((char *)g_stats_slots[i] + offset), __ATOMIC_RELAXED);
+  }
+
+  return sum;
+}
+
+static void stats_sink_inc_port_counter(void *ctx, T_stats_port_counter counter, int sync_idx)
+{
+  (void)ctx;
+
+  stats_inc_port_counter(counter, sync_idx);
+}
+
+static const T_stats_sink g_stats_sink = {
+  NULL,
+  stats_sink_inc_port_counter
+};
+
+/* Global functions */
+
+void stats_inc_port_counter(T_stats_port_counter counter, int sync_idx)
+{
+  T_stats_slot *slot;
+
+  if((counter >= E_stats_port_counter_max) || (sync_idx < 0) || (sync_idx >= MAX_NUM_OF_SYNC_ENTRIES)) {
+    return;
+  }
+
+  slot = stats_get_thread_slot();
+  stats_add(slot, &slot->port_counters[sync_idx][counter], 1);
+}
+
+void stats_add_device_op_latency(T_stats_device_op op, uint64_t time_ns)
+{
+  T_stats_slot *slot;
+
+  if(op >= E_stats_device_op_max) {
+    return;
+  }
+
+  slot = stats_get_thread_slot();
+  stats_add(slot, &slot->device_op_latency[op].count, 1);
+  stats_add(slot, &slot->device_op_latency[op].total_time_ns, time_ns);
+}
+
+uint64_t stats_get_time_ns(void)
+{
+  struct timespec current_time;
+
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return ((uint64_t)current_time.tv_sec * 1000000000ULL) + current_time.tv_nsec;
+}
+
+uint64_t stats_get_port_counter(T_stats_port_counter counter, int sync_idx)
+{
+  if((counter >= E_stats_port_counter_max) || (sync_idx < 0) || (sync_idx >= MAX_NUM_OF_SYNC_ENTRIES)) {
+    return 0;
+  }
+
+  return stats_sum(offsetof(T_stats_slot, port_counters[sync_idx][counter]));
+}
+
+void stats_get_device_op_latency(T_stats_device_op op, T_stats_device_op_latency *latency)
+{
+  memset(latency, 0, sizeof(*latency));
+
+  if(op >= E_stats_device_op_max) {
+    return;
+  }
+
+  latency->count = stats_sum(offsetof(T_stats_slot, device_op_latency[op].count));
+  latency->total_time_ns = stats_sum(offsetof(T_stats_slot, device_op_latency[op].total_time_ns));
+}
+
+const char *stats_port_counter_to_str(T_stats_port_counter counter)
+{
+  if(counter >= E_stats_port_counter_max) {
+    return "Invalid counter";
+  }
+
+  return g_stats_port_counter_to_str[counter];
+}
+
+const char *stats_device_op_to_str(T_stats_device_op op)
+{
+  if(op >= E_stats_device_op_max) {
+    return "Invalid operation";
+  }
+
+  return g_stats_device_op_to_str[op];
+}
+
+T_stats_sink const *stats_get_sink(void)
+{
+  return &g_stats_sink;
+}
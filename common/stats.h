@@ -0,0 +1,81 @@
+/**
+ * @file stats.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/*
+ * Counters are kept in per-thread slots, each aligned to a cache line and only written by its thread,
+ * so counting is a plain load and store without locks or atomic read-modify-write operations.
+ * Readers sum the slots of all threads.
+ */
+
+/* Per-port control event counters (indexed by sync index); ESMC traffic counters are kept by the ESMC ports */
+typedef enum {
+  E_stats_port_counter_ql_changes,
+  E_stats_port_counter_rx_timeouts,
+  E_stats_port_counter_link_flaps,          /* Link down transitions */
+  E_stats_port_counter_max
+} T_stats_port_counter;
+
+/* Device adaptor operations */
+typedef enum {
+  E_stats_device_op_get_current_clk_idx,
+  E_stats_device_op_set_clock_priorities,
+  E_stats_device_op_get_reference_monitor_status,
+  E_stats_device_op_get_reference_ffo,
+  E_stats_device_op_get_synce_dpll_state,
+  E_stats_device_op_get_synce_dpll_ffo,
+  E_stats_device_op_max
+} T_stats_device_op;
+
+typedef struct {
+  uint64_t count;
+  uint64_t total_time_ns;
+} T_stats_device_op_latency;
+
+/*
+ * Port counters seen by a control instance. synced uses stats_get_sink(), which counts with
+ * stats_inc_port_counter(); a simulator gives each instance its own counters.
+ */
+typedef struct {
+  void *ctx;
+  void (*inc_port_counter)(void *ctx, T_stats_port_counter counter, int sync_idx);
+} T_stats_sink;
+
+void stats_inc_port_counter(T_stats_port_counter counter, int sync_idx);
+void stats_add_device_op_latency(T_stats_device_op op, uint64_t time_ns);
+
+/* Return CLOCK_MONOTONIC time in nanoseconds for latency measurements */
+uint64_t stats_get_time_ns(void);
+
+uint64_t stats_get_port_counter(T_stats_port_counter counter, int sync_idx);
+void stats_get_device_op_latency(T_stats_device_op op, T_stats_device_op_latency *latency);
+
+const char *stats_port_counter_to_str(T_stats_port_counter counter);
+const char *stats_device_op_to_str(T_stats_device_op op);
+
+T_stats_sink const *stats_get_sink(void);
+
+#endif /* STATS_H */
@@ -0,0 +1,375 @@
+/**
+ * @file trace.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "os.h"
+#include "print.h"
+#include "trace.h"
+
+#define TRACE_MAX_DEPTH               8
+#define TRACE_MAX_THREAD_NAME_LEN     32
+
+/* Enough for an RX and a TX thread per port plus the other threads */
+#define TRACE_MAX_NUM_OF_BUFFERS      ((2 * MAX_NUM_OF_SYNC_ENTRIES) + 16)
+
+typedef struct {
+  uint64_t time_ns;                         /* Start time (CLOCK_MONOTONIC) */
+  uint64_t duration_ns;
+  const char *arg;
+  uint16_t span;                            /* T_trace_span */
+  uint16_t instant_flag;
+} T_trace_record;
+
+typedef struct {
+  unsigned long long num_records;           /* Total written; the ring holds the last g_trace_buffer_len */
+  int tid;
+  char name[TRACE_MAX_THREAD_NAME_LEN];
+  int depth;
+  uint64_t begin_time_ns[TRACE_MAX_DEPTH];
+  T_trace_record records[];
+} T_trace_buffer;
+
+/* Static data */
+
+/* See T_trace_span */
+static const char *g_trace_span_to_str[] = {
+  "rx_wakeup",
+  "rx_parse",
+  "control_rx_cb",
+  "control_tx_cb",
+  "monitor",
+  "sync_update",
+  "device_op",
+  "lock_wait",
+  "tx_wakeup",
+  "tx_send",
+  "mng_request"
+};
+COMPILE_TIME_ASSERT((sizeof(g_trace_span_to_str)/sizeof(g_trace_span_to_str[0])) == E_trace_span_max, "Invalid array size for g_trace_span_to_str!")
+
+/* See T_trace_span; the category groups spans by module in the trace viewer */
+static const char *g_trace_span_to_category[] = {
+  "esmc",
+  "esmc",
+  "control",
+  "control",
+  "monitor",
+  "control",
+  "device",
+  "os",
+  "esmc",
+  "esmc",
+  "management"
+};
+COMPILE_TIME_ASSERT((sizeof(g_trace_span_to_category)/sizeof(g_trace_span_to_category[0])) == E_trace_span_max, "Invalid array size for g_trace_span_to_category!")
+
+int g_trace_enabled = 0;
+
+static int g_trace_buffer_len = 0;
+
+/* Buffers are never freed, so the records of exited threads are exported too */
+static T_trace_buffer *g_trace_buffers[TRACE_MAX_NUM_OF_BUFFERS];
+static int g_trace_num_buffers = 0;
+static pthread_mutex_t g_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread T_trace_buffer *g_trace_thread_buffer = NULL;
+static __thread int g_trace_thread_no_buffer_flag = 0;
+
+/* Static functions */
+
+static uint64_t trace_get_time_ns(void)
+{
+  struct timespec current_time;
+
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return ((uint64_t)current_time.tv_sec * 1000000000ULL) + current_time.tv_nsec;
+}
+
+static T_trace_buffer *trace_get_thread_buffer(void)
+{
+  T_trace_buffer *buffer = NULL;
+
+  if((g_trace_thread_buffer != NULL) || g_trace_thread_no_buffer_flag) {
+    return g_trace_thread_buffer;
+  }
+
+  /* Not os_mutex_lock(), which traces lock waits */
+  pthread_mutex_lock(&g_trace_mutex);
+  if(g_trace_num_buffers < TRACE_MAX_NUM_OF_BUFFERS) {
+    buffer = calloc(1, sizeof(*buffer) + ((size_t)g_trace_buffer_len * sizeof(buffer->records[0])));
+    if(buffer != NULL) {
+      buffer->tid = syscall(SYS_gettid);
+      snprintf(buffer->name, sizeof(buffer->name), "thread %d", buffer->tid);
+      g_trace_buffers[g_trace_num_buffers] = buffer;
+      /* The exporter reads the buffers without the mutex */
+      __atomic_store_n(&g_trace_num_buffers, g_trace_num_buffers + 1, __ATOMIC_RELEASE);
+    }
+  }
+  pthread_mutex_unlock(&g_trace_mutex);
+
+  g_trace_thread_buffer = buffer;
+  g_trace_thread_no_buffer_flag = (buffer == NULL);
+
+  return buffer;
+}
+
+static void trace_add_record(T_trace_buffer *buffer, T_trace_span span, const char *arg, uint64_t time_ns, uint64_t duration_ns, int instant_flag)
+{
+  T_trace_record *record;
+  unsigned long long num_records;
+
+  if(span >= E_trace_span_max) {
+    return;
+  }
+
+  num_records = buffer->num_records;
+  record = &buffer->records[num_records % g_trace_buffer_len];
+  record->time_ns = time_ns;
+  record->duration_ns = duration_ns;
+  record->arg = arg;
+  record->span = span;
+  record->instant_flag = instant_flag;
+
+  /* Publish after the record is written; only this thread writes the buffer */
+  __atomic_store_n(&buffer->num_records, num_records + 1, __ATOMIC_RELEASE);
+}
+
+static void trace_write_json_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for(; *str != '\0'; str++) {
+    if((*str == '"') || (*str == '\\')) {
+      fputc('\\', file);
+      fputc(*str, file);
+    } else if((unsigned char)*str < 0x20) {
+      fprintf(file, "\\u%04x", (unsigned char)*str);
+    } else {
+      fputc(*str, file);
+    }
+  }
+  fputc('"', file);
+}
+
+/* Write the records still in the buffer, oldest first; return the number of records written */
+static int trace_export_buffer(FILE *file, T_trace_buffer *buffer, T_trace_record *records, int pid, int *first_flag)
+{
+  T_trace_record *record;
+  unsigned long long copy_first;
+  unsigned long long first;
+  unsigned long long last;
+  unsigned long long i;
+  int num_written = 0;
+
+  fprintf(file, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+          *first_flag ? "" : ",", pid, buffer->tid);
+  trace_write_json_string(file, buffer->name);
+  fprintf(file, "}}");
+  *first_flag = 0;
+
+  /* Copy, then drop the records the thread may have overwritten meanwhile, including the slot of the record it may be writing now */
+  last = __atomic_load_n(&buffer->num_records, __ATOMIC_ACQUIRE);
+  copy_first = (last > (unsigned long long)g_trace_buffer_len) ? (last - g_trace_buffer_len) : 0;
+  for(i = copy_first; i < last; i++) {
+    records[i - copy_first] = buffer->records[i % g_trace_buffer_len];
+  }
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  first = copy_first;
+  i = __atomic_load_n(&buffer->num_records, __ATOMIC_RELAXED);
+  if(i >= (first + g_trace_buffer_len)) {
+    first = i - g_trace_buffer_len + 1;
+  }
+
+  for(i = first; i < last; i++) {
+    record = &records[i - copy_first];
+    fprintf(file, ",\n{\"ph\":\"%s\",\"name\":\"%s\",\"cat\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03llu",
+            record->instant_flag ? "i" : "X",
+            g_trace_span_to_str[record->span],
+            g_trace_span_to_category[record->span],
+            pid,
+            buffer->tid,
+            (unsigned long long)(record->time_ns / 1000),
+            (unsigned long long)(record->time_ns % 1000));
+    if(record->instant_flag) {
+      fprintf(file, ",\"s\":\"t\"");
+    } else {
+      fprintf(file, ",\"dur\":%llu.%03llu",
+              (unsigned long long)(record->duration_ns / 1000),
+              (unsigned long long)(record->duration_ns % 1000));
+    }
+    if(record->arg != NULL) {
+      fprintf(file, ",\"args\":{\"arg\":");
+      trace_write_json_string(file, record->arg);
+      fprintf(file, "}");
+    }
+    fprintf(file, "}");
+    num_written++;
+  }
+
+  return num_written;
+}
+
+/* Global functions */
+
+int trace_start(int buffer_len)
+{
+  if(buffer_len <= 0) {
+    return -1;
+  }
+
+  g_trace_buffer_len = buffer_len;
+  __atomic_store_n(&g_trace_enabled, 1, __ATOMIC_RELEASE);
+
+  return 0;
+}
+
+void trace_set_thread_name(const char *format, ...)
+{
+  T_trace_buffer *buffer;
+  va_list args;
+
+  if(!g_trace_enabled) {
+    return;
+  }
+
+  buffer = trace_get_thread_buffer();
+  if(buffer != NULL) {
+    va_start(args, format);
+    vsnprintf(buffer->name, sizeof(buffer->name), format, args);
+    va_end(args);
+  }
+}
+
+void trace_begin_slow(void)
+{
+  T_trace_buffer *buffer = trace_get_thread_buffer();
+
+  if(buffer == NULL) {
+    return;
+  }
+
+  /* Deeper spans are counted but not recorded */
+  if(buffer->depth < TRACE_MAX_DEPTH) {
+    buffer->begin_time_ns[buffer->depth] = trace_get_time_ns();
+  }
+  buffer->depth++;
+}
+
+void trace_end_slow(T_trace_span span, const char *arg)
+{
+  T_trace_buffer *buffer = trace_get_thread_buffer();
+  uint64_t begin_time_ns;
+
+  if((buffer == NULL) || (buffer->depth == 0)) {
+    return;
+  }
+
+  buffer->depth--;
+  if(buffer->depth < TRACE_MAX_DEPTH) {
+    begin_time_ns = buffer->begin_time_ns[buffer->depth];
+    trace_add_record(buffer, span, arg, begin_time_ns, trace_get_time_ns() - begin_time_ns, 0);
+  }
+}
+
+void trace_instant_slow(T_trace_span span, const char *arg)
+{
+  T_trace_buffer *buffer = trace_get_thread_buffer();
+
+  if(buffer == NULL) {
+    return;
+  }
+
+  trace_add_record(buffer, span, arg, trace_get_time_ns(), 0, 1);
+}
+
+int trace_export(const char *path)
+{
+  char tmp_path[PATH_MAX];
+  T_trace_record *records;
+  FILE *file;
+  int num_buffers;
+  int num_records = 0;
+  int first_flag = 1;
+  int pid = getpid();
+  int i;
+
+  if(!g_trace_enabled) {
+    return -1;
+  }
+
+  if(snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+    pr_err("Trace path %s is too long", path);
+    return -1;
+  }
+
+  records = malloc((size_t)g_trace_buffer_len * sizeof(*records));
+  if(records == NULL) {
+    pr_err("Failed to allocate trace export buffer");
+    return -1;
+  }
+
+  file = fopen(tmp_path, "w");
+  if(file == NULL) {
+    pr_err("Failed to open %s: %s", tmp_path, strerror(errno));
+    free(records);
+    return -1;
+  }
+
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+  num_buffers = __atomic_load_n(&g_trace_num_buffers, __ATOMIC_ACQUIRE);
+  for(i = 0; i < num_buffers; i++) {
+    num_records += trace_export_buffer(file, g_trace_buffers[i], records, pid, &first_flag);
+  }
+
+  fprintf(file, "\n]}\n");
+  free(records);
+
+  if(fclose(file) != 0) {
+    pr_err("Failed to write %s: %s", tmp_path, strerror(errno));
+    remove(tmp_path);
+    return -1;
+  }
+
+  /* Viewers never see a partial file */
+  if(rename(tmp_path, path) < 0) {
+    pr_err("Failed to rename %s to %s: %s", tmp_path, path, strerror(errno));
+    remove(tmp_path);
+    return -1;
+  }
+
+  pr_info("Exported %d trace events of %d threads to %s", num_records, num_buffers, path);
+
+  return 0;
+}
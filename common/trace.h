@@ -0,0 +1,91 @@
+/**
+ * @file trace.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+ * Thread activity tracing (trace_en).
+ *
+ * Each thread records spans and instant events into its own ring of the last trace_buffer_len records, so
+ * recording takes no locks. A span is recorded as one complete event when it ends. trace_export() writes the
+ * records of all threads as Chrome trace-event JSON, which Perfetto (ui.perfetto.dev) and chrome://tracing open.
+ *
+ * Disabled, every function returns after checking one flag.
+ */
+
+typedef enum {
+  E_trace_span_rx_wakeup,           /* Instant: ESMC PDU read by a port RX thread */
+  E_trace_span_rx_parse,
+  E_trace_span_control_rx_cb,
+  E_trace_span_control_tx_cb,
+  E_trace_span_monitor,             /* Main loop: QL determination */
+  E_trace_span_sync_update,         /* Main loop: sync table update */
+  E_trace_span_device_op,           /* Argument: device operation */
+  E_trace_span_lock_wait,           /* Contended mutex acquisition */
+  E_trace_span_tx_wakeup,           /* Instant: port TX thread woken by a best QL change */
+  E_trace_span_tx_send,
+  E_trace_span_mng_request,         /* Argument: API */
+  E_trace_span_max
+} T_trace_span;
+
+extern int g_trace_enabled;
+
+int trace_start(int buffer_len);
+
+/* Name the calling thread in the exported timeline */
+#ifdef __GNUC__
+__attribute__ ((format (printf, 1, 2)))
+#endif
+void trace_set_thread_name(const char *format, ...);
+
+/* Spans nest; trace_end() closes the innermost span. arg must be a string literal or otherwise never freed. */
+void trace_begin_slow(void);
+void trace_end_slow(T_trace_span span, const char *arg);
+void trace_instant_slow(T_trace_span span, const char *arg);
+
+#define trace_begin() \
+  do { \
+    if(g_trace_enabled) { \
+      trace_begin_slow(); \
+    } \
+  } while(0)
+
+#define trace_end(span, arg) \
+  do { \
+    if(g_trace_enabled) { \
+      trace_end_slow((span), (arg)); \
+    } \
+  } while(0)
+
+#define trace_instant(span, arg) \
+  do { \
+    if(g_trace_enabled) { \
+      trace_instant_slow((span), (arg)); \
+    } \
+  } while(0)
+
+/* Return 0 on success and -1 if tracing is disabled or the file cannot be written */
+int trace_export(const char *path);
+
+#endif /* TRACE_H */
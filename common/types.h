@@ -172,7 +172,60 @@ typedef enum {
   E_mng_api_assign_new_synce_clk_port,
   E_mng_api_set_pri,
   E_mng_api_set_max_msg_lvl,
+  E_mng_api_begin_transaction,
+  E_mng_api_commit_transaction,
+  E_mng_api_abort_transaction,
+  E_mng_api_get_port_stats,
+  E_mng_api_get_latency_stats,
+  E_mng_api_get_mutex_stats,
+  E_mng_api_get_journal,
   E_mng_api_max
 } T_mng_api;
 
+/* Stages of QL propagation through the node (see latency.h) */
+typedef enum {
+  E_latency_stage_rx_dispatch,        /* ESMC PDU received -> control RX event callback */
+  E_latency_stage_sync_update,        /* Control RX event callback -> new rank applied by sync table update */
+  E_latency_stage_priority_table,     /* New rank applied -> device clock priorities set */
+  E_latency_stage_ql_determination,   /* Device clock priorities set -> best QL set by monitor */
+  E_latency_stage_tx,                 /* Best QL set -> event ESMC PDU sent */
+  E_latency_stage_end_to_end,         /* ESMC PDU received -> event ESMC PDU sent */
+  E_latency_stage_max
+} T_latency_stage;
+
+/* Latency distribution of a stage in nanoseconds (percentiles are within 1/32 of the recorded value) */
+typedef struct {
+  unsigned long long count;
+  unsigned long long min_ns;
+  unsigned long long max_ns;
+  unsigned long long mean_ns;
+  unsigned long long p50_ns;
+  unsigned long long p90_ns;
+  unsigned long long p99_ns;
+  unsigned long long p999_ns;
+} T_latency_stage_stats;
+
+/* Journal events; the meaning of the values of T_journal_entry depends on the type */
+typedef enum {
+  E_journal_event_type_esmc,                /* val[0]: T_esmc_event_type, val[1]: new QL (QL change only) */
+  E_journal_event_type_sync_state,          /* val[0]: old T_sync_state, val[1]: new T_sync_state */
+  E_journal_event_type_sync_clk_state,      /* val[0]: old T_sync_clk_state, val[1]: new T_sync_clk_state, val[2]: clock index */
+  E_journal_event_type_rank,                /* val[0]: old rank, val[1]: new rank, val[2]: current QL */
+  E_journal_event_type_device_priorities,   /* val[0]: number of clocks, val[1]: first clock index, val[2]: 0 if set, -1 if failed */
+  E_journal_event_type_dpll_state,          /* val[0]: old T_device_dpll_state, val[1]: new T_device_dpll_state */
+  E_journal_event_type_current_ql,          /* val[0]: old QL, val[1]: new QL, val[2]: clock index */
+  E_journal_event_type_alarm,               /* val[0]: T_alarm_type, val[1]: timing loop type or degrading flag, val[2]: clock index */
+  E_journal_event_type_max
+} T_journal_event_type;
+
+#define JOURNAL_NO_SYNC_IDX   -1
+
+typedef struct {
+  unsigned long long seq;                   /* Starts at 1 */
+  unsigned long long time_ns;               /* CLOCK_MONOTONIC */
+  short type;                               /* T_journal_event_type */
+  short sync_idx;                           /* JOURNAL_NO_SYNC_IDX if not specific to a sync */
+  int val[3];
+} T_journal_entry;
+
 #endif /* TYPES_H */
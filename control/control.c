@@ -20,27 +20,48 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_control
+
 #include <stdlib.h>
 #include <string.h>
 
 #include "control.h"
 #include "../common/common.h"
 #include "../common/print.h"
+#include "../common/probes.h"
 #include "../common/os.h"
+#include "../common/journal.h"
+#include "../common/stats.h"
 #include "../device/device_adaptor/device_adaptor.h"
 
 #define MAX_NUMBER_HOPS   255
 
+#define APPLY_CHANGES_TIMEOUT_MS   1000 /* Main loop updates sync table every 100 ms */
+
 #define LO_NUMBER_OF_HOPS   0xFF
 
 /* Static data */
 
-static pthread_mutex_t g_control_mutex;
 static T_control_data g_control_data;
 
 /* Static functions */
 
-static int control_find_best_clock(T_sync_entry *table, int *rank)
+static void control_journal_record(T_control_data const *control, T_journal_event_type type, int sync_idx, int val0, int val1, int val2)
+{
+  control->journal_sink->record(control->journal_sink->ctx, type, sync_idx, val0, val1, val2);
+}
+
+static void control_inc_port_counter(T_control_data const *control, T_stats_port_counter counter, int sync_idx)
+{
+  control->stats_sink->inc_port_counter(control->stats_sink->ctx, counter, sync_idx);
+}
+
+static unsigned long long control_get_monotonic_milliseconds(T_control_data const *control)
+{
+  return control->device_ops->get_monotonic_milliseconds(control->device_ops->ctx);
+}
+
+static int control_find_best_clock(T_control_data *control, T_sync_entry *table, int *rank)
 {
   /* Mutex must be taken before this function can be called */
 
@@ -50,13 +71,13 @@ static int control_find_best_clock(T_sync_entry *table, int *rank)
   int best_rank;
   int best_clk_idx = -1;
 
-  if(g_control_data.lo_ql < g_control_data.do_not_use_ql) {
-    best_rank = calculate_rank((int)g_control_data.lo_ql, g_control_data.lo_pri, LO_NUMBER_OF_HOPS);
+  if(control->lo_ql < control->do_not_use_ql) {
+    best_rank = calculate_rank((int)control->lo_ql, control->lo_pri, LO_NUMBER_OF_HOPS);
   } else {
-    best_rank = calculate_rank((int)g_control_data.do_not_use_ql, 0, 0);
+    best_rank = calculate_rank((int)control->do_not_use_ql, 0, 0);
   }
 
-  for(i = 0; i < g_control_data.num_syncs; i++) {
+  for(i = 0; i < control->num_syncs; i++) {
     if((sync_entry->type == E_sync_type_synce) || (sync_entry->type == E_sync_type_external)) {
       /* Only consider Sync-E clock and external clock ports in selection */
       if(sync_entry->rank < best_rank) {
@@ -77,7 +98,7 @@ static int control_find_best_clock(T_sync_entry *table, int *rank)
   return best_clk_idx;
 }
 
-static void control_update_device_priority_table(void)
+static void control_update_device_priority_table(T_control_data *control)
 {
   /* Mutex must be taken before this function is called */
 
@@ -94,24 +115,24 @@ static void control_update_device_priority_table(void)
   int pos = 0;
   int ret;
 
-  temp_sync_table = calloc(g_control_data.num_syncs, sizeof(*temp_sync_table));
+  temp_sync_table = calloc(control->num_syncs, sizeof(*temp_sync_table));
   if(!temp_sync_table) {
     return;
   }
 
   /* Make copy of sync table */
-  memcpy(temp_sync_table, g_control_data.sync_table, g_control_data.num_syncs * sizeof(*temp_sync_table));
+  memcpy(temp_sync_table, control->sync_table, control->num_syncs * sizeof(*temp_sync_table));
 
   /* Clear priority array */
   memset(&priority_array, 0, sizeof(priority_array));
 
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    best_clk_idx = control_find_best_clock(temp_sync_table, &best_rank);
+  for(i = 0; i < control->num_syncs; i++) {
+    best_clk_idx = control_find_best_clock(control, temp_sync_table, &best_rank);
     if(best_clk_idx < 0) {
       break;
     }
 
-    /* Best clock index is between [0, g_control_data.num_syncs); fill new entry in priority array */
+    /* Best clock index is between [0, control->num_syncs); fill new entry in priority array */
     priority_array[priority].clk_idx = best_clk_idx;
     priority_array[priority].rank = best_rank;
 
@@ -128,12 +149,15 @@ static void control_update_device_priority_table(void)
   table.clock_priority_table = &priority_array[0];
 
   /* Set priority table */
-  err = device_adaptor_call_set_clock_priorities_cb(&table);
+  err = control->device_ops->set_clock_priorities(control->device_ops->ctx, &table);
+  synced_probe3(priority_table_write, table.num_entries, (table.num_entries > 0) ? priority_array[0].clk_idx : INVALID_CLK_IDX, err);
+  control_journal_record(control, E_journal_event_type_device_priorities, JOURNAL_NO_SYNC_IDX,
+                         table.num_entries, (table.num_entries > 0) ? priority_array[0].clk_idx : INVALID_CLK_IDX, (err < 0) ? -1 : 0);
   if(err < 0) {
-    pr_err("Failed to set device clock priorities");
+    pr_err_ratelimited("Failed to set device clock priorities");
   } else {
     /* Clear update priority table flag */
-    g_control_data.update_priority_table_flag = 0;
+    control->update_priority_table_flag = 0;
   }
 
   for(priority = 0; priority < table.num_entries; priority++) {
@@ -161,37 +185,40 @@ static void control_update_device_priority_table(void)
   temp_sync_table = NULL;
 }
 
-static int control_tx_event_cb(T_esmc_adaptor_tx_event_cb_data *cb_data)
+static int control_handle_tx_event(T_control_data *control, T_esmc_adaptor_tx_event_cb_data *cb_data)
 {
   T_esmc_event_type event_type = cb_data->event_type;
   int sync_idx = cb_data->sync_idx;
   T_sync_entry *sync_entry;
 
-  os_mutex_lock(&g_control_mutex);
-  sync_entry = &g_control_data.sync_table[sync_idx];
+  os_mutex_lock(&control->mutex);
+  sync_entry = &control->sync_table[sync_idx];
 
   if(sync_entry->type != E_sync_type_tx_only) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     return -1;
   }
 
+  control_journal_record(control, E_journal_event_type_esmc, sync_idx, event_type, 0, 0);
+
   switch(event_type) {
     case E_esmc_event_type_port_link_up:
       sync_entry->port_link_down_flag = 0;
       break;
     case E_esmc_event_type_port_link_down:
       sync_entry->port_link_down_flag = 1;
+      control_inc_port_counter(control, E_stats_port_counter_link_flaps, sync_idx);
       break;
     default:
       break;
   }
 
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   return 0;
 }
 
-static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
+static int control_handle_rx_event(T_control_data *control, T_esmc_adaptor_rx_event_cb_data *cb_data)
 {
   T_esmc_event_type event_type = cb_data->event_type;
   int sync_idx = cb_data->sync_idx;
@@ -203,22 +230,26 @@ static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
   T_sync_state state;
   T_alarm_data alarm_data;
 
-  os_mutex_lock(&g_control_mutex);
-  sync_entry = &g_control_data.sync_table[sync_idx];
+  os_mutex_lock(&control->mutex);
+  sync_entry = &control->sync_table[sync_idx];
 
   if((sync_entry->type != E_sync_type_synce) && (sync_entry->type != E_sync_type_monitoring)) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     return -1;
   }
 
-  do_not_use_ql = g_control_data.do_not_use_ql;
+  do_not_use_ql = control->do_not_use_ql;
   old_ql = sync_entry->esmc_ql;
   new_ql = old_ql;
 
+  control_journal_record(control, E_journal_event_type_esmc, sync_idx, event_type,
+                         (event_type == E_esmc_event_type_ql_change) ? (int)cb_data->event_data.ql_change.new_ql : 0, 0);
+
   switch(event_type) {
     case E_esmc_event_type_invalid_rx_ql:
       alarm_data.alarm_type = E_alarm_type_invalid_rx_ql;
       alarm_data.alarm_invalid_ql.port_name = sync_entry->name;
+      control_journal_record(control, E_journal_event_type_alarm, sync_idx, alarm_data.alarm_type, 0, sync_entry->clk_idx);
       management_call_notify_alarm_cb(&alarm_data);
       break;
     case E_esmc_event_type_ql_change:
@@ -229,11 +260,13 @@ static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
       new_total_num_hops = (new_total_num_hops > MAX_NUMBER_HOPS) ? MAX_NUMBER_HOPS : new_total_num_hops;
       sync_entry->current_num_hops = new_total_num_hops;
       sync_entry->rx_timeout_flag = 0;
+      control_inc_port_counter(control, E_stats_port_counter_ql_changes, sync_idx);
       break;
     case E_esmc_event_type_rx_timeout:
       new_ql = E_esmc_ql_FAILED;
       sync_entry->current_num_hops = 0;
       sync_entry->rx_timeout_flag = 1;
+      control_inc_port_counter(control, E_stats_port_counter_rx_timeouts, sync_idx);
       break;
     case E_esmc_event_type_port_link_up:
       sync_entry->port_link_down_flag = 0;
@@ -242,12 +275,14 @@ static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
       new_ql = do_not_use_ql;
       sync_entry->current_num_hops = 0;
       sync_entry->port_link_down_flag = 1;
+      control_inc_port_counter(control, E_stats_port_counter_link_flaps, sync_idx);
       break;
     case E_esmc_event_type_immediate_timing_loop:
       alarm_data.alarm_type = E_alarm_type_timing_loop;
       alarm_data.alarm_timing_loop.loop_type = E_timing_loop_type_immediate;
       alarm_data.alarm_timing_loop.mac_addr = cb_data->event_data.timing_loop.mac_addr;
       alarm_data.alarm_timing_loop.port_name = sync_entry->name;
+      control_journal_record(control, E_journal_event_type_alarm, sync_idx, alarm_data.alarm_type, alarm_data.alarm_timing_loop.loop_type, sync_entry->clk_idx);
       management_call_notify_alarm_cb(&alarm_data);
       break;
     case E_esmc_event_type_originator_timing_loop:
@@ -255,6 +290,7 @@ static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
       alarm_data.alarm_timing_loop.loop_type = E_timing_loop_type_originator;
       alarm_data.alarm_timing_loop.mac_addr = cb_data->event_data.timing_loop.mac_addr;
       alarm_data.alarm_timing_loop.port_name = sync_entry->name;
+      control_journal_record(control, E_journal_event_type_alarm, sync_idx, alarm_data.alarm_type, alarm_data.alarm_timing_loop.loop_type, sync_entry->clk_idx);
       management_call_notify_alarm_cb(&alarm_data);
       break;
     default:
@@ -263,7 +299,7 @@ static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
   }
 
   if(old_ql == new_ql) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     return 0;
   }
 
@@ -271,36 +307,42 @@ static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
   sync_entry->esmc_ql = new_ql;
 
   if(sync_entry->state == E_sync_state_forced) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     return 0;
   }
 
+  /* Follow the change until it is advertised (restarts the trace of an earlier change not yet applied) */
+  latency_trace_start(&sync_entry->latency_trace, cb_data->rx_time_ns);
+
   state = sync_entry->state;
   if(new_ql < E_esmc_ql_FAILED) {
     if(state == E_sync_state_wait_to_restore) {
       /* Continue in wait-to-restore state */
-    } else if((old_ql == E_esmc_ql_FAILED) && (g_control_data.wait_to_restore_timer_s != 0)) {
+    } else if((old_ql == E_esmc_ql_FAILED) && (control->wait_to_restore_timer_s != 0)) {
       state = E_sync_state_wait_to_restore;
-      sync_entry->temporary_state_monotonic_time_ms = os_get_monotonic_milliseconds() + (g_control_data.wait_to_restore_timer_s * 1000);
+      sync_entry->temporary_state_monotonic_time_ms = control_get_monotonic_milliseconds(control) + (control->wait_to_restore_timer_s * 1000);
     } else {
       /* Sync is in normal state (sync was already in normal state or was in hold-off state) */
       state = E_sync_state_normal;
     }
   } else {
-    if((g_control_data.hold_off_timer_ms == 0) || (sync_entry->state == E_sync_state_wait_to_restore)) {
+    if((control->hold_off_timer_ms == 0) || (sync_entry->state == E_sync_state_wait_to_restore)) {
       /* No hold-off timer */
       state = E_sync_state_normal;
     } else if(sync_entry->state == E_sync_state_normal) {
       state = E_sync_state_hold_off;
-      sync_entry->temporary_state_monotonic_time_ms = os_get_monotonic_milliseconds() + g_control_data.hold_off_timer_ms;
+      sync_entry->temporary_state_monotonic_time_ms = control_get_monotonic_milliseconds(control) + control->hold_off_timer_ms;
       sync_entry->hold_off_ql = old_ql;
     } else {
       /* Continue in hold-off state */
     }
   }
+  if(state != sync_entry->state) {
+    control_journal_record(control, E_journal_event_type_sync_state, sync_idx, sync_entry->state, state, 0);
+  }
   sync_entry->state = state;
 
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   management_call_notify_sync_current_state_cb(sync_entry->name, state);
 
@@ -308,7 +350,7 @@ static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
 }
 
 /* Return 1 if clock is qualified and 0 otherwise */
-static int control_check_qualification_status(int clk_idx, T_device_clk_reference_monitor_status *ref_mon_status)
+static int control_check_qualification_status(T_control_data *control, int clk_idx, T_device_clk_reference_monitor_status *ref_mon_status)
 {
   int alarm_raised_flag;
   int err;
@@ -317,9 +359,9 @@ static int control_check_qualification_status(int clk_idx, T_device_clk_referenc
     return 0;
   }
 
-  err = device_adaptor_call_get_reference_monitor_status_cb(clk_idx, ref_mon_status);
+  err = control->device_ops->get_reference_monitor_status(control->device_ops->ctx, clk_idx, ref_mon_status);
   if(err < 0) {
-    pr_err("Failed to get reference monitor status of clock index %d", clk_idx);
+    pr_err_ratelimited("Failed to get reference monitor status of clock index %d", clk_idx);
     return 0;
   }
 
@@ -336,9 +378,153 @@ static int control_check_qualification_status(int clk_idx, T_device_clk_referenc
   }
 }
 
-/* Global functions */
+/* Return 1 if degrading flag of the sync changed and 0 otherwise */
+static int control_check_degradation_status(T_control_data *control, T_sync_entry *sync_entry)
+{
+  /* Mutex must be taken before this function is called */
 
-int control_init(T_control_config const *control_config)
+  double ffo_ppb;
+  int err;
+
+  if(!control->degradation_config.en || control->degradation_unsupported_flag) {
+    return 0;
+  }
+
+  if(sync_entry->clk_state != E_sync_clk_state_qualified) {
+    /* Hard alarm takes over; keep the degrading flag latched and start from a fresh baseline once the clock is qualified again */
+    degradation_restart(&sync_entry->degradation_detector);
+    return 0;
+  }
+
+  err = control->device_ops->get_reference_ffo(control->device_ops->ctx, sync_entry->clk_idx, &ffo_ppb);
+  if(err == -2) {
+    pr_warning("Reference frequency offset not supported by device; disabled degradation detection");
+    control->degradation_unsupported_flag = 1;
+    return 0;
+  } else if(err < 0) {
+    pr_err_ratelimited("Failed to get frequency offset of clock index %d", sync_entry->clk_idx);
+    return 0;
+  }
+
+  return degradation_update(&control->degradation_config, &sync_entry->degradation_detector, ffo_ppb);
+}
+
+static int control_calculate_rank(T_control_data *control, T_sync_entry const *sync_entry)
+{
+  /* Mutex must be taken before this function is called */
+
+  T_esmc_ql ql = sync_entry->current_ql;
+  int pri = sync_entry->config_pri;
+
+  if(control->no_ql_en && (ql < control->do_not_use_ql)) {
+    ql = control->lo_ql;
+  }
+
+  if(sync_entry->degradation_detector.degrading_flag) {
+    /* Degrading clocks rank behind healthy clocks of the same QL */
+    pri += control->degradation_config.rank_penalty;
+    if(pri > (MAX_NUM_OF_PRIORITIES - 1)) {
+      pri = MAX_NUM_OF_PRIORITIES - 1;
+    }
+  }
+
+  return calculate_rank((int)ql, pri, sync_entry->current_num_hops);
+}
+
+/* Return 0 if change was applied to table, -1 if it failed, and -2 if it is not supported */
+static int control_stage_change(T_control_data *control, T_sync_entry *table, T_management_change const *change)
+{
+  /* Mutex must be taken before this function is called */
+
+  T_sync_entry *sync_entry = NULL;
+  T_esmc_ql forced_ql;
+  int i;
+
+  for(i = 0; i < control->num_syncs; i++) {
+    if(!strcmp(table[i].name, change->port_name)) {
+      sync_entry = &table[i];
+      break;
+    }
+  }
+
+  if(sync_entry == NULL) {
+    pr_err("Specified port %s does not exist", change->port_name);
+    return -1;
+  }
+
+  switch(change->type) {
+    case E_management_change_type_set_forced_ql:
+      forced_ql = (T_esmc_ql)change->value;
+      if(control->no_ql_en) {
+        pr_err("Set forced QL not supported because no QL mode is enabled");
+        return -2;
+      }
+      if(check_ql_setting(control->net_opt, forced_ql) < 0) {
+        pr_err("Specified incompatible forced QL %s (%d) for port %s",
+               conv_ql_enum_to_str(forced_ql),
+               forced_ql,
+               change->port_name);
+        return -1;
+      }
+      if(sync_entry->type == E_sync_type_tx_only) {
+        pr_warning("Forced QL is not supported for %s because it is Sync-E TX only port", change->port_name);
+        return -2;
+      }
+      if((sync_entry->type != E_sync_type_external) && !control->synce_forced_ql_en) {
+        pr_warning("Forced QL is not supported for %s because forced QL mode is disabled", change->port_name);
+        return -2;
+      }
+      sync_entry->forced_ql = forced_ql;
+      sync_entry->state = E_sync_state_forced;
+      break;
+
+    case E_management_change_type_clear_forced_ql:
+      if(control->no_ql_en) {
+        pr_err("Clear forced QL not supported because no QL mode is enabled");
+        return -2;
+      }
+      if(sync_entry->state == E_sync_state_forced) {
+        sync_entry->state = E_sync_state_normal;
+      }
+      break;
+
+    case E_management_change_type_assign_new_synce_clk_port:
+      for(i = 0; i < control->num_syncs; i++) {
+        if((&table[i] != sync_entry) && (table[i].clk_idx == change->value)) {
+          table[i].type = E_sync_type_monitoring;
+          table[i].clk_idx = MISSING_CLK_IDX;
+        }
+      }
+      sync_entry->type = E_sync_type_synce;
+      sync_entry->clk_idx = change->value;
+      break;
+
+    case E_management_change_type_set_pri:
+      sync_entry->config_pri = change->value;
+      break;
+
+    default:
+      return -1;
+  }
+
+  return 0;
+}
+
+static int control_tx_event_cb(T_esmc_adaptor_tx_event_cb_data *cb_data)
+{
+  return control_handle_tx_event(&g_control_data, cb_data);
+}
+
+static int control_rx_event_cb(T_esmc_adaptor_rx_event_cb_data *cb_data)
+{
+  return control_handle_rx_event(&g_control_data, cb_data);
+}
+
+static int control_init_data(T_control_data *control,
+                             T_control_config const *control_config,
+                             T_device_ops const *device_ops,
+                             T_journal_sink const *journal_sink,
+                             T_stats_sink const *stats_sink)
 {
   T_esmc_ql do_not_use_ql;
   int num_syncs;
@@ -348,43 +534,55 @@ int control_init(T_control_config const *control_config)
   int clk_idx;
   T_esmc_ql init_ql;
 
+  memset(control, 0, sizeof(*control));
+
   /* Initialize mutex */
-  if(os_mutex_init(&g_control_mutex) < 0) {
+  if(os_mutex_init(&control->mutex) < 0) {
+    return -1;
+  }
+
+  if(os_cond_init(&control->sync_table_cond) < 0) {
+    os_mutex_deinit(&control->mutex);
     return -1;
   }
 
-  memset(&g_control_data, 0, sizeof(g_control_data));
+  control->device_ops = device_ops;
+  control->journal_sink = journal_sink;
+  control->stats_sink = stats_sink;
 
-  g_control_data.net_opt = control_config->net_opt;
+  control->net_opt = control_config->net_opt;
 
-  g_control_data.no_ql_en = control_config->no_ql_en;
+  control->no_ql_en = control_config->no_ql_en;
 
-  g_control_data.synce_forced_ql_en = control_config->synce_forced_ql_en;
+  control->synce_forced_ql_en = control_config->synce_forced_ql_en;
 
-  g_control_data.lo_ql = control_config->lo_ql;
+  control->lo_ql = control_config->lo_ql;
 
-  g_control_data.lo_pri = control_config->lo_pri;
+  control->lo_pri = control_config->lo_pri;
 
   do_not_use_ql = control_config->do_not_use_ql;
-  g_control_data.do_not_use_ql = do_not_use_ql;
+  control->do_not_use_ql = do_not_use_ql;
+
+  control->hold_off_timer_ms = control_config->hold_off_timer_ms;
 
-  g_control_data.hold_off_timer_ms = control_config->hold_off_timer_ms;
+  control->wait_to_restore_timer_s = control_config->wait_to_restore_timer_s;
 
-  g_control_data.wait_to_restore_timer_s = control_config->wait_to_restore_timer_s;
+  control->degradation_config = control_config->degradation_config;
 
   num_syncs = control_config->num_syncs;
-  g_control_data.num_syncs = num_syncs;
+  control->num_syncs = num_syncs;
 
-  g_control_data.sync_table = calloc(num_syncs, sizeof(*g_control_data.sync_table));
-  if(!g_control_data.sync_table) {
-    os_mutex_deinit(&g_control_mutex);
-    memset(&g_control_data, 0, sizeof(g_control_data));
+  control->sync_table = calloc(num_syncs, sizeof(*control->sync_table));
+  if(!control->sync_table) {
+    os_cond_deinit(&control->sync_table_cond);
+    os_mutex_deinit(&control->mutex);
+    memset(control, 0, sizeof(*control));
     return -1;
   }
 
   sync_config = control_config->sync_config_array;
   for(sync_idx = 0; sync_idx < num_syncs; sync_idx++) {
-    sync_entry = &g_control_data.sync_table[sync_idx];
+    sync_entry = &control->sync_table[sync_idx];
 
     sync_entry->name = sync_config->name;
 
@@ -395,9 +593,9 @@ int control_init(T_control_config const *control_config)
 
     sync_entry->config_pri = sync_config->config_pri;
 
-    if(g_control_data.no_ql_en && (sync_entry->type == E_sync_type_external)) {
+    if(control->no_ql_en && (sync_entry->type == E_sync_type_external)) {
       /* If no QL mode is enabled and sync is external clock port, then force initial and current QL to LO QL */
-      init_ql = g_control_data.lo_ql;
+      init_ql = control->lo_ql;
     } else {
       init_ql = sync_config->init_ql;
     }
@@ -418,6 +616,8 @@ int control_init(T_control_config const *control_config)
 
     sync_entry->clk_state = E_sync_clk_state_unqualified;
 
+    degradation_reset(&sync_entry->degradation_detector);
+
     sync_entry->state = E_sync_state_normal;
 
     sync_entry->temporary_state_monotonic_time_ms = 0;
@@ -431,10 +631,80 @@ int control_init(T_control_config const *control_config)
     sync_config++;
   }
 
-  g_control_data.update_priority_table_flag = 0;
+  control->update_priority_table_flag = 0;
 
   /* Update sync table */
-  control_update_sync_table();
+  control_instance_update_sync_table(control);
+
+  return 0;
+}
+
+static void control_deinit_data(T_control_data *control)
+{
+  /* Deinitialize condition variable and mutex */
+  os_cond_deinit(&control->sync_table_cond);
+  os_mutex_deinit(&control->mutex);
+
+  control->net_opt = E_esmc_network_option_max;
+  control->no_ql_en = 0;
+  control->synce_forced_ql_en = 0;
+  control->lo_ql = E_esmc_ql_max;
+  control->lo_pri = 255;
+  control->do_not_use_ql = E_esmc_ql_max;
+  control->hold_off_timer_ms = 0;
+  control->wait_to_restore_timer_s = 0;
+  control->num_syncs = 0;
+  free(control->sync_table);
+  control->sync_table = NULL;
+  control->update_priority_table_flag = 0;
+}
+
+/* Global functions */
+
+T_control_data *control_instance_create(T_control_config const *control_config,
+                                        T_device_ops const *device_ops,
+                                        T_journal_sink const *journal_sink,
+                                        T_stats_sink const *stats_sink)
+{
+  T_control_data *control = malloc(sizeof(*control));
+
+  if(control == NULL) {
+    return NULL;
+  }
+
+  if(control_init_data(control, control_config, device_ops, journal_sink, stats_sink) < 0) {
+    free(control);
+    return NULL;
+  }
+
+  return control;
+}
+
+void control_instance_destroy(T_control_data *control)
+{
+  if(control == NULL) {
+    return;
+  }
+
+  control_deinit_data(control);
+  free(control);
+}
+
+int control_instance_tx_event(T_control_data *control, T_esmc_adaptor_tx_event_cb_data *cb_data)
+{
+  return control_handle_tx_event(control, cb_data);
+}
+
+int control_instance_rx_event(T_control_data *control, T_esmc_adaptor_rx_event_cb_data *cb_data)
+{
+  return control_handle_rx_event(control, cb_data);
+}
+
+int control_init(T_control_config const *control_config)
+{
+  if(control_init_data(&g_control_data, control_config, device_adaptor_get_ops(), journal_get_sink(), stats_get_sink()) < 0) {
+    return -1;
+  }
 
   /* Register control TX event callback with ESMC stack */
   esmc_adaptor_register_tx_cb(control_tx_event_cb);
@@ -446,7 +716,7 @@ int control_init(T_control_config const *control_config)
 }
 
 /* Update sync clock state, sync state, and current QL */
-void control_update_sync_table(void)
+void control_instance_update_sync_table(T_control_data *control)
 {
   int i;
   T_sync_entry *sync_entry;
@@ -458,10 +728,16 @@ void control_update_sync_table(void)
   T_esmc_ql current_ql;
   T_sync_clk_state clk_state;
   int clk_idx;
+  T_alarm_data alarm_data;
+  unsigned int changes_seq;
+
+  os_mutex_lock(&control->mutex);
 
-  os_mutex_lock(&g_control_mutex);
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  /* Configuration changes applied so far are covered once this update completes */
+  changes_seq = control->changes_seq;
+
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
 
     port_name = sync_entry->name;
 
@@ -472,11 +748,24 @@ void control_update_sync_table(void)
        Do not update the clock state for the monitoring ports. */
     old_clk_state = sync_entry->clk_state;
     if((sync_entry->type == E_sync_type_synce) || (sync_entry->type == E_sync_type_external)) {
-      if(control_check_qualification_status(sync_entry->clk_idx, &sync_entry->ref_mon_status)) {
+      if(control_check_qualification_status(control, sync_entry->clk_idx, &sync_entry->ref_mon_status)) {
         sync_entry->clk_state = E_sync_clk_state_qualified;
       } else {
         sync_entry->clk_state = E_sync_clk_state_unqualified;
       }
+
+      if(control_check_degradation_status(control, sync_entry)) {
+        alarm_data.alarm_type = E_alarm_type_reference_degradation;
+        alarm_data.alarm_reference_degradation.port_name = port_name;
+        alarm_data.alarm_reference_degradation.clk_idx = sync_entry->clk_idx;
+        alarm_data.alarm_reference_degradation.degrading_flag = sync_entry->degradation_detector.degrading_flag;
+        control_journal_record(control, E_journal_event_type_alarm, i, alarm_data.alarm_type,
+                               alarm_data.alarm_reference_degradation.degrading_flag, sync_entry->clk_idx);
+
+        os_mutex_unlock(&control->mutex);
+        management_call_notify_alarm_cb(&alarm_data);
+        os_mutex_lock(&control->mutex);
+      }
     }
 
     /* Update sync state */
@@ -484,12 +773,13 @@ void control_update_sync_table(void)
       switch(sync_entry->state) {
         case E_sync_state_hold_off:
         case E_sync_state_wait_to_restore:
-          if(os_get_monotonic_milliseconds() > sync_entry->temporary_state_monotonic_time_ms) {
+          if(control_get_monotonic_milliseconds(control) > sync_entry->temporary_state_monotonic_time_ms) {
+            control_journal_record(control, E_journal_event_type_sync_state, i, sync_entry->state, E_sync_state_normal, 0);
             sync_entry->state = E_sync_state_normal;
 
-            os_mutex_unlock(&g_control_mutex);
+            os_mutex_unlock(&control->mutex);
             management_call_notify_sync_current_state_cb(port_name, E_sync_state_normal);
-            os_mutex_lock(&g_control_mutex);
+            os_mutex_lock(&control->mutex);
           }
           break;
 
@@ -513,54 +803,70 @@ void control_update_sync_table(void)
       } else if(sync_entry->state == E_sync_state_hold_off) {
         sync_entry->current_ql = sync_entry->hold_off_ql;
       } else if(sync_entry->state == E_sync_state_wait_to_restore) {
-        sync_entry->current_ql = g_control_data.do_not_use_ql;
+        sync_entry->current_ql = control->do_not_use_ql;
       } else {
         sync_entry->current_ql = sync_entry->forced_ql;
       }
     }
 
     old_rank = sync_entry->rank;
-    if(g_control_data.no_ql_en && (sync_entry->current_ql < g_control_data.do_not_use_ql)) {
-      rank = calculate_rank((int)g_control_data.lo_ql, sync_entry->config_pri, sync_entry->current_num_hops);
-    } else {
-      rank = calculate_rank((int)sync_entry->current_ql, sync_entry->config_pri, sync_entry->current_num_hops);
-    }
+    rank = control_calculate_rank(control, sync_entry);
     if(old_rank != rank) {
       change_flag = 1;
       sync_entry->rank = rank;
+      control_journal_record(control, E_journal_event_type_rank, i, old_rank, rank, sync_entry->current_ql);
+      synced_probe4(rank_change, i, old_rank, rank, sync_entry->current_ql);
+
+      if(latency_trace_is_active(&sync_entry->latency_trace)) {
+        latency_trace_mark(&sync_entry->latency_trace, E_latency_point_sync_update);
+        control->latency_trace = sync_entry->latency_trace;
+        memset(&sync_entry->latency_trace, 0, sizeof(sync_entry->latency_trace));
+      }
 
-      if(g_control_data.no_ql_en) {
+      if(control->no_ql_en) {
         current_ql = E_esmc_ql_NSUPP;
       } else {
         current_ql = sync_entry->current_ql;
       }
 
-      os_mutex_unlock(&g_control_mutex);
+      os_mutex_unlock(&control->mutex);
       management_call_notify_sync_current_ql_cb(port_name, current_ql, rank);
-      os_mutex_lock(&g_control_mutex);
+      os_mutex_lock(&control->mutex);
     }
     if(old_clk_state != sync_entry->clk_state) {
       clk_state = sync_entry->clk_state;
       clk_idx = sync_entry->clk_idx;
+      control_journal_record(control, E_journal_event_type_sync_clk_state, i, old_clk_state, clk_state, clk_idx);
 
-      os_mutex_unlock(&g_control_mutex);
+      os_mutex_unlock(&control->mutex);
       management_call_notify_sync_current_clk_state_cb(port_name, clk_idx, clk_state);
-      os_mutex_lock(&g_control_mutex);
+      os_mutex_lock(&control->mutex);
     }
   }
 
-  if(g_control_data.update_priority_table_flag == 1) {
+  if(control->update_priority_table_flag == 1) {
     /* Change in clock index mapping */
     change_flag = 1;
   }
 
   if(change_flag) {
-    control_update_device_priority_table();
+    control_update_device_priority_table(control);
+    latency_trace_mark(&control->latency_trace, E_latency_point_priority_table);
   }
-  os_mutex_unlock(&g_control_mutex);
+
+  if(control->updated_changes_seq != changes_seq) {
+    control->updated_changes_seq = changes_seq;
+    os_cond_broadcast(&control->sync_table_cond);
+  }
+  os_mutex_unlock(&control->mutex);
 }
 
-int control_get_sync_idx(int clk_idx)
+void control_update_sync_table(void)
+{
+  control_instance_update_sync_table(&g_control_data);
+}
+
+int control_instance_get_sync_idx(T_control_data *control, int clk_idx)
 {
   int i;
   T_sync_entry *sync_entry;
@@ -569,41 +875,51 @@ int control_get_sync_idx(int clk_idx)
     return INVALID_SYNC_IDX;
   }
 
-  os_mutex_lock(&g_control_mutex);
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  os_mutex_lock(&control->mutex);
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
     if(sync_entry->clk_idx == clk_idx) {
-      os_mutex_unlock(&g_control_mutex);
+      os_mutex_unlock(&control->mutex);
       return i;
     }
   }
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
   return INVALID_SYNC_IDX;
 }
 
-T_esmc_ql control_get_ql(int sync_idx)
+int control_get_sync_idx(int clk_idx)
+{
+  return control_instance_get_sync_idx(&g_control_data, clk_idx);
+}
+
+T_esmc_ql control_instance_get_ql(T_control_data *control, int sync_idx)
 {
   T_sync_entry *sync_entry;
   T_esmc_ql ql = E_esmc_ql_max;
 
-  if((sync_idx < 0) || (sync_idx >= g_control_data.num_syncs)) {
+  if((sync_idx < 0) || (sync_idx >= control->num_syncs)) {
     pr_err("Failed to get QL due to invalid sync index %d", sync_idx);
     return ql;
   }
 
-  os_mutex_lock(&g_control_mutex);
-  sync_entry = &g_control_data.sync_table[sync_idx];
+  os_mutex_lock(&control->mutex);
+  sync_entry = &control->sync_table[sync_idx];
   ql = sync_entry->current_ql;
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   return ql;
 }
 
-void control_get_sync_name(int sync_idx, char *port_name)
+T_esmc_ql control_get_ql(int sync_idx)
+{
+  return control_instance_get_ql(&g_control_data, sync_idx);
+}
+
+void control_instance_get_sync_name(T_control_data *control, int sync_idx, char *port_name)
 {
   T_sync_entry *sync_entry;
 
-  if(sync_idx >= g_control_data.num_syncs) {
+  if(sync_idx >= control->num_syncs) {
     pr_warning("Failed to get port name due to invalid sync index %d", sync_idx);
     port_name[0] = '\0';
     return;
@@ -613,22 +929,28 @@ void control_get_sync_name(int sync_idx, char *port_name)
     return;
   }
 
-  sync_entry = &g_control_data.sync_table[sync_idx];
+  sync_entry = &control->sync_table[sync_idx];
   strcpy(port_name, sync_entry->name);
 }
 
+void control_get_sync_name(int sync_idx, char *port_name)
+{
+  control_instance_get_sync_name(&g_control_data, sync_idx, port_name);
+}
+
 int control_set_forced_ql(const char *port_name, T_esmc_ql forced_ql)
 {
+  T_control_data *control = &g_control_data;
   int i;
   T_sync_entry *sync_entry;
   T_esmc_ql old_forced_ql;
 
-  if(g_control_data.no_ql_en) {
+  if(control->no_ql_en) {
     pr_err("Set forced QL not supported because no QL mode is enabled");
     return -2;
   }
 
-  if(check_ql_setting(g_control_data.net_opt, forced_ql) < 0) {
+  if(check_ql_setting(control->net_opt, forced_ql) < 0) {
     pr_err("Specified incompatible forced QL %s (%d) for port %s",
            conv_ql_enum_to_str(forced_ql),
            forced_ql,
@@ -636,16 +958,16 @@ int control_set_forced_ql(const char *port_name, T_esmc_ql forced_ql)
     return -1;
   }
 
-  os_mutex_lock(&g_control_mutex);
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  os_mutex_lock(&control->mutex);
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
 
     if(!strcmp(sync_entry->name, port_name)) {
       old_forced_ql = sync_entry->forced_ql;
 
       if(sync_entry->state == E_sync_state_forced) {
         if(forced_ql == old_forced_ql) {
-          os_mutex_unlock(&g_control_mutex);
+          os_mutex_unlock(&control->mutex);
           pr_warning("Forced QL is already set to %s (%d) for port %s", conv_ql_enum_to_str(forced_ql), forced_ql, port_name);
           return 0;
         }
@@ -653,20 +975,23 @@ int control_set_forced_ql(const char *port_name, T_esmc_ql forced_ql)
 
       if(sync_entry->type != E_sync_type_external) {
         if(sync_entry->type == E_sync_type_tx_only) {
-          os_mutex_unlock(&g_control_mutex);
+          os_mutex_unlock(&control->mutex);
           pr_warning("Forced QL is not supported for %s because it is Sync-E TX only port", port_name);
           return -2;
-        } else if(!g_control_data.synce_forced_ql_en) {
-          os_mutex_unlock(&g_control_mutex);
+        } else if(!control->synce_forced_ql_en) {
+          os_mutex_unlock(&control->mutex);
           pr_warning("Forced QL is not supported for %s because forced QL mode is disabled", port_name);
           return -2;
         }
       }
 
       /* Change in QL */
+      if(sync_entry->state != E_sync_state_forced) {
+        control_journal_record(control, E_journal_event_type_sync_state, i, sync_entry->state, E_sync_state_forced, 0);
+      }
       sync_entry->forced_ql = forced_ql;
       sync_entry->state = E_sync_state_forced;
-      os_mutex_unlock(&g_control_mutex);
+      os_mutex_unlock(&control->mutex);
 
       management_call_notify_sync_current_state_cb(port_name, E_sync_state_forced);
 
@@ -678,69 +1003,72 @@ int control_set_forced_ql(const char *port_name, T_esmc_ql forced_ql)
       return 0;
     }
   }
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   return -1;
 }
 
 int control_clear_forced_ql(const char *port_name)
 {
+  T_control_data *control = &g_control_data;
   int i;
   T_sync_entry *sync_entry;
   T_esmc_ql old_forced_ql;
 
-  if(g_control_data.no_ql_en) {
+  if(control->no_ql_en) {
     pr_err("Clear forced QL not supported because no QL mode is enabled");
     return -2;
   }
 
-  os_mutex_lock(&g_control_mutex);
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  os_mutex_lock(&control->mutex);
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
 
     if(!strcmp(sync_entry->name, port_name)) {
       if(sync_entry->state == E_sync_state_forced) {
         old_forced_ql = sync_entry->forced_ql;
+        control_journal_record(control, E_journal_event_type_sync_state, i, E_sync_state_forced, E_sync_state_normal, 0);
         sync_entry->state = E_sync_state_normal;
-        os_mutex_unlock(&g_control_mutex);
+        os_mutex_unlock(&control->mutex);
 
         management_call_notify_sync_current_state_cb(port_name, E_sync_state_normal);
 
         pr_info("Cleared forced QL %s (%d) for port %s", conv_ql_enum_to_str(old_forced_ql), old_forced_ql, port_name);
       } else {
-        os_mutex_unlock(&g_control_mutex);
+        os_mutex_unlock(&control->mutex);
         pr_warning("No forced QL is set for port %s", port_name);
       }
 
       return 0;
     }
   }
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   return -1;
 }
 
 int control_get_sync_info_by_index(int sync_idx, T_management_sync_info *sync_info)
 {
+  T_control_data *control = &g_control_data;
   T_sync_entry *sync_entry;
   unsigned long long monotonic_time_now_ms;
 
   memset(sync_info, 0, sizeof(*sync_info));
 
-  if(sync_idx >= g_control_data.num_syncs) {
+  if(sync_idx >= control->num_syncs) {
     return -1;
   }
 
-  sync_entry = &g_control_data.sync_table[sync_idx];
+  sync_entry = &control->sync_table[sync_idx];
 
-  os_mutex_lock(&g_control_mutex);
+  os_mutex_lock(&control->mutex);
   strcpy(sync_info->name, sync_entry->name);
   sync_info->type = sync_entry->type;
 
   switch(sync_entry->type) {
     case E_sync_type_synce:
       sync_info->synce_clk_info.config_pri = sync_entry->config_pri;
-      if(g_control_data.no_ql_en) {
+      if(control->no_ql_en) {
         sync_info->synce_clk_info.current_ql = E_esmc_ql_NSUPP;
       } else {
         sync_info->synce_clk_info.current_ql = sync_entry->current_ql;
@@ -748,7 +1076,7 @@ int control_get_sync_info_by_index(int sync_idx, T_management_sync_info *sync_in
       sync_info->synce_clk_info.state = sync_entry->state;
       sync_info->synce_clk_info.tx_bundle_num = sync_entry->tx_bundle_num;
       sync_info->synce_clk_info.clk_idx = sync_entry->clk_idx;
-      monotonic_time_now_ms = os_get_monotonic_milliseconds();
+      monotonic_time_now_ms = control_get_monotonic_milliseconds(control);
       if(monotonic_time_now_ms >= sync_entry->temporary_state_monotonic_time_ms) {
         sync_info->synce_clk_info.remaining_time_ms = 0;
       } else {
@@ -758,20 +1086,21 @@ int control_get_sync_info_by_index(int sync_idx, T_management_sync_info *sync_in
       sync_info->synce_clk_info.rank = sync_entry->rank;
       sync_info->synce_clk_info.clk_state = sync_entry->clk_state;
       sync_info->synce_clk_info.ref_mon_status = sync_entry->ref_mon_status;
+      sync_info->synce_clk_info.degrading_flag = sync_entry->degradation_detector.degrading_flag;
       sync_info->synce_clk_info.rx_timeout_flag = sync_entry->rx_timeout_flag;
       sync_info->synce_clk_info.port_link_down_flag = sync_entry->port_link_down_flag;
       break;
 
     case E_sync_type_monitoring:
       sync_info->synce_mon_info.config_pri = sync_entry->config_pri;
-      if(g_control_data.no_ql_en) {
+      if(control->no_ql_en) {
         sync_info->synce_mon_info.current_ql = E_esmc_ql_NSUPP;
       } else {
         sync_info->synce_mon_info.current_ql = sync_entry->current_ql;
       }
       sync_info->synce_mon_info.state = sync_entry->state;
       sync_info->synce_mon_info.tx_bundle_num = sync_entry->tx_bundle_num;
-      monotonic_time_now_ms = os_get_monotonic_milliseconds();
+      monotonic_time_now_ms = control_get_monotonic_milliseconds(control);
       if(monotonic_time_now_ms >= sync_entry->temporary_state_monotonic_time_ms) {
         sync_info->synce_mon_info.remaining_time_ms = 0;
       } else {
@@ -785,7 +1114,7 @@ int control_get_sync_info_by_index(int sync_idx, T_management_sync_info *sync_in
 
     case E_sync_type_external:
       sync_info->ext_clk_info.config_pri = sync_entry->config_pri;
-      if(g_control_data.no_ql_en) {
+      if(control->no_ql_en) {
         sync_info->ext_clk_info.current_ql = E_esmc_ql_NSUPP;
       } else {
         sync_info->ext_clk_info.current_ql = sync_entry->current_ql;
@@ -795,6 +1124,7 @@ int control_get_sync_info_by_index(int sync_idx, T_management_sync_info *sync_in
       sync_info->ext_clk_info.rank = sync_entry->rank;
       sync_info->ext_clk_info.clk_state = sync_entry->clk_state;
       sync_info->ext_clk_info.ref_mon_status = sync_entry->ref_mon_status;
+      sync_info->ext_clk_info.degrading_flag = sync_entry->degradation_detector.degrading_flag;
       break;
 
     case E_sync_type_tx_only:
@@ -806,21 +1136,22 @@ int control_get_sync_info_by_index(int sync_idx, T_management_sync_info *sync_in
       break;
   }
 
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   return 0;
 }
 
 int control_get_sync_info_by_name(const char *port_name, T_management_sync_info *sync_info)
 {
+  T_control_data *control = &g_control_data;
   int i;
   T_sync_entry *sync_entry;
 
   memset(sync_info, 0, sizeof(*sync_info));
 
   /* Do not need to lock mutex */
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
     if(!strcmp(sync_entry->name, port_name)) {
       control_get_sync_info_by_index(i, sync_info);
       return 0;
@@ -830,18 +1161,56 @@ int control_get_sync_info_by_name(const char *port_name, T_management_sync_info
   return -1;
 }
 
+int control_get_port_stats(const char *port_name, T_management_port_stats *port_stats)
+{
+  T_control_data *control = &g_control_data;
+  int i;
+  T_sync_entry *sync_entry;
+
+  memset(port_stats, 0, sizeof(*port_stats));
+
+  /* Do not need to lock mutex */
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
+    if(!strcmp(sync_entry->name, port_name)) {
+      strcpy(port_stats->name, sync_entry->name);
+      if(esmc_adaptor_get_port_stats(i, &port_stats->esmc_stats) < 0) {
+        /* External clock port */
+        return -2;
+      }
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+void control_instance_take_latency_trace(T_control_data *control, T_latency_trace *latency_trace)
+{
+  os_mutex_lock(&control->mutex);
+  *latency_trace = control->latency_trace;
+  memset(&control->latency_trace, 0, sizeof(control->latency_trace));
+  os_mutex_unlock(&control->mutex);
+}
+
+void control_take_latency_trace(T_latency_trace *latency_trace)
+{
+  control_instance_take_latency_trace(&g_control_data, latency_trace);
+}
+
 int control_clear_synce_clk_wtr_timer(const char *port_name)
 {
+  T_control_data *control = &g_control_data;
   int i;
   T_sync_entry *sync_entry;
   int cleared_flag = 0;
 
-  os_mutex_lock(&g_control_mutex);
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  os_mutex_lock(&control->mutex);
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
     if(!strcmp(sync_entry->name, port_name)) {
       if((sync_entry->type == E_sync_type_external) || (sync_entry->type == E_sync_type_tx_only)) {
-        os_mutex_unlock(&g_control_mutex);
+        os_mutex_unlock(&control->mutex);
         pr_err("Attempted to clear wait-to-restore timer for %s port %s",
                conv_sync_type_enum_to_str(sync_entry->type),
                port_name);
@@ -852,7 +1221,7 @@ int control_clear_synce_clk_wtr_timer(const char *port_name)
       break;
     }
   }
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   if(cleared_flag == 0) {
     return -1;
@@ -865,13 +1234,14 @@ int control_clear_synce_clk_wtr_timer(const char *port_name)
 
 int control_update_sync_table_entry_clk_idx(const char *new_port_name, int clk_idx)
 {
+  T_control_data *control = &g_control_data;
   int i;
   T_sync_entry *new_sync_entry = NULL;
   T_sync_entry *sync_entry;
 
-  os_mutex_lock(&g_control_mutex);
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  os_mutex_lock(&control->mutex);
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
     if(!strcmp(sync_entry->name, new_port_name)) {
       new_sync_entry = sync_entry;
       break;
@@ -879,35 +1249,37 @@ int control_update_sync_table_entry_clk_idx(const char *new_port_name, int clk_i
   }
 
   if(new_sync_entry == NULL) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     pr_err("Specified port %s does not exist", new_port_name);
     return -1;
   }
 
   if(new_sync_entry->clk_idx == clk_idx) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     pr_info("%s is already assigned to clock index %d",
             new_port_name,
             clk_idx);
     return 0;
   }
 
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
 
     if(sync_entry->clk_idx == clk_idx) {
       sync_entry->type = E_sync_type_monitoring;
       sync_entry->clk_idx = MISSING_CLK_IDX;
+      degradation_reset(&sync_entry->degradation_detector);
     }
   }
 
   new_sync_entry->type = E_sync_type_synce;
   new_sync_entry->clk_idx = clk_idx;
+  degradation_reset(&new_sync_entry->degradation_detector);
   
   /* Trigger priority table update due to change in clock index */
-  g_control_data.update_priority_table_flag = 1;
+  control->update_priority_table_flag = 1;
 
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   pr_info("%s becomes active Sync-E clock port for clock index %d",
           new_port_name,
@@ -918,22 +1290,23 @@ int control_update_sync_table_entry_clk_idx(const char *new_port_name, int clk_i
 
 int control_set_pri(const char *port_name, int pri)
 {
+  T_control_data *control = &g_control_data;
   int i;
   T_sync_entry *sync_entry;
   T_sync_entry *target_sync_entry = NULL;
   int old_pri;
 
-  if(g_control_data.lo_pri == pri) {
+  if(control->lo_pri == pri) {
     pr_err("Priority is already set to %d for LO", pri);
     return -1;
   }
 
-  os_mutex_lock(&g_control_mutex);
-  for(i = 0; i < g_control_data.num_syncs; i++) {
-    sync_entry = &g_control_data.sync_table[i];
+  os_mutex_lock(&control->mutex);
+  for(i = 0; i < control->num_syncs; i++) {
+    sync_entry = &control->sync_table[i];
     if(!strcmp(sync_entry->name, port_name)) {
       if(sync_entry->config_pri == pri) {
-        os_mutex_unlock(&g_control_mutex);
+        os_mutex_unlock(&control->mutex);
         pr_err("Priority is already set to %d for port %s", pri, port_name);
         return -1;
       }
@@ -941,20 +1314,20 @@ int control_set_pri(const char *port_name, int pri)
       target_sync_entry = sync_entry;
       old_pri = sync_entry->config_pri;
     } else if(sync_entry->config_pri == pri) {
-      os_mutex_unlock(&g_control_mutex);
+      os_mutex_unlock(&control->mutex);
       pr_err("Failed to set priority %d for %s because priority already assigned to %s", pri, port_name, sync_entry->name);
       return -1;
     }
   }
 
   if(target_sync_entry == NULL) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     return -1;
   }
 
   target_sync_entry->config_pri = pri;
 
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
 
   pr_info("Changed priority from %d to %d for port %s",
           old_pri,
@@ -964,7 +1337,122 @@ int control_set_pri(const char *port_name, int pri)
   return 0;
 }
 
-void control_get_tx_bundle_info(int sync_idx, T_sync_tx_bundle_info *sync_tx_bundle_info)
+int control_apply_changes(T_management_change const *changes, int num_changes)
+{
+  T_control_data *control = &g_control_data;
+  T_sync_entry *staged_table;
+  T_sync_entry *sync_entry;
+  T_sync_entry *staged_entry;
+  int state_change_sync_idx[MAX_NUM_OF_SYNC_ENTRIES];
+  T_sync_state state_change_state[MAX_NUM_OF_SYNC_ENTRIES];
+  int num_state_changes = 0;
+  unsigned int changes_seq;
+  int timeout_flag = 0;
+  int err = 0;
+  int i;
+  int j;
+
+  os_mutex_lock(&control->mutex);
+
+  staged_table = calloc(control->num_syncs, sizeof(*staged_table));
+  if(!staged_table) {
+    os_mutex_unlock(&control->mutex);
+    return -1;
+  }
+
+  /* Apply changes to a copy of sync table first, so nothing is applied if any change fails */
+  memcpy(staged_table, control->sync_table, control->num_syncs * sizeof(*staged_table));
+
+  for(i = 0; (i < num_changes) && (err == 0); i++) {
+    err = control_stage_change(control, staged_table, &changes[i]);
+  }
+
+  /* Changed priorities must be unique once all changes are applied (i.e., priorities can be swapped) */
+  for(i = 0; (i < control->num_syncs) && (err == 0); i++) {
+    staged_entry = &staged_table[i];
+    if(staged_entry->config_pri == control->sync_table[i].config_pri) {
+      continue;
+    }
+
+    if(staged_entry->config_pri == control->lo_pri) {
+      pr_err("Failed to set priority %d for %s because priority already assigned to LO", staged_entry->config_pri, staged_entry->name);
+      err = -1;
+      break;
+    }
+
+    for(j = 0; j < control->num_syncs; j++) {
+      if((j != i) && (staged_table[j].config_pri == staged_entry->config_pri)) {
+        pr_err("Failed to set priority %d for %s because priority already assigned to %s",
+               staged_entry->config_pri,
+               staged_entry->name,
+               staged_table[j].name);
+        err = -1;
+        break;
+      }
+    }
+  }
+
+  if(err == 0) {
+    for(i = 0; i < control->num_syncs; i++) {
+      sync_entry = &control->sync_table[i];
+      staged_entry = &staged_table[i];
+
+      if(sync_entry->clk_idx != staged_entry->clk_idx) {
+        degradation_reset(&sync_entry->degradation_detector);
+
+        /* Trigger priority table update due to change in clock index */
+        control->update_priority_table_flag = 1;
+      }
+
+      if(sync_entry->state != staged_entry->state) {
+        control_journal_record(control, E_journal_event_type_sync_state, i, sync_entry->state, staged_entry->state, 0);
+        state_change_sync_idx[num_state_changes] = i;
+        state_change_state[num_state_changes] = staged_entry->state;
+        num_state_changes++;
+      }
+
+      sync_entry->type = staged_entry->type;
+      sync_entry->clk_idx = staged_entry->clk_idx;
+      sync_entry->config_pri = staged_entry->config_pri;
+      sync_entry->forced_ql = staged_entry->forced_ql;
+      sync_entry->state = staged_entry->state;
+    }
+
+    /* Leave clock selection and device priority table update to the next sync table update of the main loop */
+    changes_seq = ++control->changes_seq;
+  }
+
+  free(staged_table);
+  staged_table = NULL;
+
+  if(err < 0) {
+    os_mutex_unlock(&control->mutex);
+    return err;
+  }
+
+  /* Report the result once one clock selection and at most one device priority table update covered all changes */
+  while(((int)(control->updated_changes_seq - changes_seq) < 0) && !timeout_flag) {
+    if(os_cond_timed_wait(&control->sync_table_cond, &control->mutex, APPLY_CHANGES_TIMEOUT_MS, &timeout_flag) < 0) {
+      break;
+    }
+  }
+
+  os_mutex_unlock(&control->mutex);
+
+  if(timeout_flag) {
+    pr_warning("Applied %d configuration changes; sync table not updated yet", num_changes);
+  } else {
+    pr_info("Applied %d configuration changes", num_changes);
+  }
+
+  for(i = 0; i < num_state_changes; i++) {
+    management_call_notify_sync_current_state_cb(control->sync_table[state_change_sync_idx[i]].name, state_change_state[i]);
+  }
+
+  return 0;
+}
+
+void control_instance_get_tx_bundle_info(T_control_data *control, int sync_idx, T_sync_tx_bundle_info *sync_tx_bundle_info)
 {
   int tx_bundle_num;
   int i;
@@ -976,11 +1464,11 @@ void control_get_tx_bundle_info(int sync_idx, T_sync_tx_bundle_info *sync_tx_bun
     return;
   }
 
-  os_mutex_lock(&g_control_mutex);
-  sync_entry = &g_control_data.sync_table[sync_idx];
+  os_mutex_lock(&control->mutex);
+  sync_entry = &control->sync_table[sync_idx];
 
   if(sync_entry->type == E_sync_type_external) {
-    os_mutex_unlock(&g_control_mutex);
+    os_mutex_unlock(&control->mutex);
     return;
   }
 
@@ -989,8 +1477,8 @@ void control_get_tx_bundle_info(int sync_idx, T_sync_tx_bundle_info *sync_tx_bun
     sync_tx_bundle_info->sync_indices[0] = sync_idx;
     sync_tx_bundle_info->entries = 1;
   } else {
-    for(i = 0; i < g_control_data.num_syncs; i++) {
-      sync_entry = &g_control_data.sync_table[i];
+    for(i = 0; i < control->num_syncs; i++) {
+      sync_entry = &control->sync_table[i];
       if(tx_bundle_num == sync_entry->tx_bundle_num) {
         sync_tx_bundle_info->sync_indices[sync_tx_bundle_info->entries] = i;
         sync_tx_bundle_info->entries++;
@@ -998,24 +1486,20 @@ void control_get_tx_bundle_info(int sync_idx, T_sync_tx_bundle_info *sync_tx_bun
     }
   }
 
-  os_mutex_unlock(&g_control_mutex);
+  os_mutex_unlock(&control->mutex);
+}
+
+void control_get_tx_bundle_info(int sync_idx, T_sync_tx_bundle_info *sync_tx_bundle_info)
+{
+  control_instance_get_tx_bundle_info(&g_control_data, sync_idx, sync_tx_bundle_info);
+}
+
+T_control_data *control_get_instance(void)
+{
+  return &g_control_data;
 }
 
 void control_deinit(void)
 {
-  /* Deinitialize mutex */
-  os_mutex_deinit(&g_control_mutex);
-
-  g_control_data.net_opt = E_esmc_network_option_max;
-  g_control_data.no_ql_en = 0;
-  g_control_data.synce_forced_ql_en = 0;
-  g_control_data.lo_ql = E_esmc_ql_max;
-  g_control_data.lo_pri = 255;
-  g_control_data.do_not_use_ql = E_esmc_ql_max;
-  g_control_data.hold_off_timer_ms = 0;
-  g_control_data.wait_to_restore_timer_s = 0;
-  g_control_data.num_syncs = 0;
-  free(g_control_data.sync_table);
-  g_control_data.sync_table = NULL;
-  g_control_data.update_priority_table_flag = 0;
+  control_deinit_data(&g_control_data);
 }
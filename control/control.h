@@ -26,6 +26,10 @@
 #include "sync.h"
 #include "../esmc/esmc_adaptor/esmc_adaptor.h"
 #include "../management/management.h"
+#include "../device/device_adaptor/device_adaptor.h"
+#include "../common/journal.h"
+#include "../common/os.h"
+#include "../common/stats.h"
 
 typedef struct {
   T_esmc_network_option net_opt;
@@ -36,11 +40,16 @@ typedef struct {
   T_esmc_ql do_not_use_ql;
   unsigned int hold_off_timer_ms;       /* Milliseconds */
   unsigned int wait_to_restore_timer_s; /* Seconds */
+  T_degradation_config degradation_config;
   int num_syncs;
   T_sync_config const *sync_config_array;
 } T_control_config;
 
 typedef struct {
+  pthread_mutex_t mutex;
+  T_device_ops const *device_ops;       /* Device access; the device adaptor for the daemon instance */
+  T_journal_sink const *journal_sink;   /* Events of this instance and its monitor; the journal for the daemon instance */
+  T_stats_sink const *stats_sink;       /* Port event counters; the statistics of synced for the daemon instance */
   T_esmc_network_option net_opt;
   int no_ql_en;
   int synce_forced_ql_en;
@@ -49,9 +58,15 @@ typedef struct {
   T_esmc_ql do_not_use_ql;
   unsigned int hold_off_timer_ms;       /* Milliseconds */
   unsigned int wait_to_restore_timer_s; /* Seconds */
+  T_degradation_config degradation_config;
+  int degradation_unsupported_flag;
   int num_syncs;
   T_sync_entry *sync_table;
   int update_priority_table_flag;
+  unsigned int changes_seq;             /* Applied configuration change sets */
+  unsigned int updated_changes_seq;     /* Change sets covered by a completed sync table update */
+  pthread_cond_t sync_table_cond;       /* Broadcast when a sync table update completes */
+  T_latency_trace latency_trace;        /* Trace of the last rank change, until taken by the monitor */
 } T_control_data;
 
 int control_init(T_control_config const *control_config);
@@ -63,10 +78,29 @@ int control_set_forced_ql(const char *port_name, T_esmc_ql forced_ql);
 int control_clear_forced_ql(const char *port_name);
 int control_get_sync_info_by_index(int sync_idx, T_management_sync_info *sync_info);
 int control_get_sync_info_by_name(const char *port_name, T_management_sync_info *sync_info);
+int control_get_port_stats(const char *port_name, T_management_port_stats *port_stats);
+void control_take_latency_trace(T_latency_trace *latency_trace);
 int control_clear_synce_clk_wtr_timer(const char *port_name);
 int control_update_sync_table_entry_clk_idx(const char *new_port_name, int clk_idx);
 int control_set_pri(const char *port_name, int pri);
+int control_apply_changes(T_management_change const *changes, int num_changes);
 void control_get_tx_bundle_info(int sync_idx, T_sync_tx_bundle_info *sync_tx_bundle_info);
+T_control_data *control_get_instance(void);
 void control_deinit(void);
 
+/* Instance API used to run several independent control instances in one process (e.g. network simulation) */
+T_control_data *control_instance_create(T_control_config const *control_config,
+                                        T_device_ops const *device_ops,
+                                        T_journal_sink const *journal_sink,
+                                        T_stats_sink const *stats_sink);
+int control_instance_tx_event(T_control_data *control, T_esmc_adaptor_tx_event_cb_data *cb_data);
+int control_instance_rx_event(T_control_data *control, T_esmc_adaptor_rx_event_cb_data *cb_data);
+void control_instance_update_sync_table(T_control_data *control);
+int control_instance_get_sync_idx(T_control_data *control, int clk_idx);
+T_esmc_ql control_instance_get_ql(T_control_data *control, int sync_idx);
+void control_instance_get_sync_name(T_control_data *control, int sync_idx, char *port_name);
+void control_instance_take_latency_trace(T_control_data *control, T_latency_trace *latency_trace);
+void control_instance_get_tx_bundle_info(T_control_data *control, int sync_idx, T_sync_tx_bundle_info *sync_tx_bundle_info);
+void control_instance_destroy(T_control_data *control);
+
 #endif /* CONTROL_H */
@@ -0,0 +1,86 @@
+/**
+ * @file degradation.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#include "degradation.h"
+
+/* Static functions */
+
+static double degradation_max(double a, double b)
+{
+  return (a > b) ? a : b;
+}
+
+/* Global functions */
+
+void degradation_reset(T_degradation_detector *detector)
+{
+  detector->baseline_ppb = 0;
+  detector->cusum_high = 0;
+  detector->cusum_low = 0;
+  detector->num_samples = 0;
+  detector->degrading_flag = 0;
+}
+
+/* Discard the baseline but keep the degrading flag; degradation_update() clears it once a fresh baseline has settled */
+void degradation_restart(T_degradation_detector *detector)
+{
+  detector->baseline_ppb = 0;
+  detector->cusum_high = 0;
+  detector->cusum_low = 0;
+  detector->num_samples = 0;
+}
+
+/* Return 1 if degrading flag changed and 0 otherwise */
+int degradation_update(T_degradation_config const *config, T_degradation_detector *detector, double ffo_ppb)
+{
+  int old_degrading_flag = detector->degrading_flag;
+  double deviation;
+
+  if(detector->num_samples == 0) {
+    detector->baseline_ppb = ffo_ppb;
+  }
+
+  /* Wait until the baseline has settled (roughly one time constant of the EWMA) before accumulating */
+  if((double)detector->num_samples * config->ewma_weight < 1) {
+    detector->baseline_ppb += config->ewma_weight * (ffo_ppb - detector->baseline_ppb);
+    detector->num_samples++;
+    return 0;
+  }
+
+  deviation = ffo_ppb - detector->baseline_ppb;
+  detector->cusum_high = degradation_max(0, detector->cusum_high + deviation - config->cusum_drift_ppb);
+  detector->cusum_low = degradation_max(0, detector->cusum_low - deviation - config->cusum_drift_ppb);
+
+  if(detector->degrading_flag) {
+    if((detector->cusum_high == 0) && (detector->cusum_low == 0)) {
+      detector->degrading_flag = 0;
+    }
+  } else {
+    if((detector->cusum_high > config->cusum_threshold_ppb) || (detector->cusum_low > config->cusum_threshold_ppb)) {
+      detector->degrading_flag = 1;
+    } else {
+      detector->baseline_ppb += config->ewma_weight * deviation;
+    }
+  }
+
+  return (old_degrading_flag != detector->degrading_flag);
+}
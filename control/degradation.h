@@ -0,0 +1,51 @@
+/**
+ * @file degradation.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#ifndef DEGRADATION_H
+#define DEGRADATION_H
+
+typedef struct {
+  int en;
+  double ewma_weight;        /* Weight of newest sample in baseline frequency offset (0-1) */
+  double cusum_drift_ppb;    /* Parts per billion (deviation tolerated without accumulating) */
+  double cusum_threshold_ppb; /* Parts per billion (accumulated deviation that marks reference as degrading) */
+  int rank_penalty;          /* Priority steps added to rank of degrading reference */
+} T_degradation_config;
+
+/*
+ * Two-sided CUSUM of the reference frequency offset against an EWMA baseline.
+ * The baseline is frozen while the reference is degrading, so a persisting shift keeps the reference
+ * marked until the frequency offset returns to the baseline and both sums drain to zero.
+ */
+typedef struct {
+  double baseline_ppb;
+  double cusum_high;
+  double cusum_low;
+  unsigned int num_samples;
+  int degrading_flag;
+} T_degradation_detector;
+
+void degradation_reset(T_degradation_detector *detector);
+void degradation_restart(T_degradation_detector *detector);
+int degradation_update(T_degradation_config const *config, T_degradation_detector *detector, double ffo_ppb);
+
+#endif /* DEGRADATION_H */
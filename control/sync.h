@@ -23,6 +23,8 @@
 #ifndef SYNC_H
 #define SYNC_H
 
+#include "degradation.h"
+#include "../common/latency.h"
 #include "../common/types.h"
 #include "../device/device_adaptor/device_adaptor.h"
 
@@ -89,6 +91,9 @@ typedef struct {
   /* Current sync clock state */
   T_sync_clk_state clk_state;
 
+  /* Frequency offset degradation detector (degrading_flag adds rank penalty) */
+  T_degradation_detector degradation_detector;
+
   /* Current sync state */
   T_sync_state state;
 
@@ -107,6 +112,9 @@ typedef struct {
 
   /* Port link down flag */
   int port_link_down_flag;
+
+  /* Trace of the last received QL change, until the change is applied to the rank */
+  T_latency_trace latency_trace;
 } T_sync_entry;
 
 #endif /* SYNC_H */
@@ -20,12 +20,17 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_device
+
 #include <pthread.h>
 #include <string.h>
 
 #include "device_adaptor.h"
 #include "../../common/print.h"
+#include "../../common/probes.h"
 #include "../../common/os.h"
+#include "../../common/stats.h"
+#include "../../common/trace.h"
 
 DEVICE_REGISTER_CALLBACKS_DECLARE()
 
@@ -36,10 +41,88 @@ T_device_adaptor_callbacks g_device_adaptor_callbacks;
 pthread_mutex_t g_device_adaptor_mutex;
 int g_device_adaptor_init_flag = 0;
 
-/* Static data */
+/* Clock of the control and monitor timers */
+static unsigned long long (*g_device_adaptor_get_monotonic_milliseconds)(void) = os_get_monotonic_milliseconds;
 
 /* Static functions */
 
+/* Start latency statistics, USDT probe and trace span of a device operation; return its start time */
+static uint64_t device_adaptor_op_begin(T_stats_device_op op)
+{
+  (void)op; /* Only used by USDT probes */
+
+  synced_probe2(device_op_entry, op, stats_device_op_to_str(op));
+  trace_begin();
+
+  return stats_get_time_ns();
+}
+
+static void device_adaptor_op_end(T_stats_device_op op, uint64_t start_time_ns, int err)
+{
+  const char *op_name = stats_device_op_to_str(op);
+
+  (void)err; /* Only used by USDT probes */
+
+  stats_add_device_op_latency(op, stats_get_time_ns() - start_time_ns);
+  trace_end(E_trace_span_device_op, op_name);
+  synced_probe3(device_op_return, op, op_name, err);
+}
+
+static unsigned long long device_adaptor_ops_get_monotonic_milliseconds(void *ctx)
+{
+  (void)ctx;
+  return g_device_adaptor_get_monotonic_milliseconds();
+}
+
+static int device_adaptor_ops_get_current_clk_idx(void *ctx, int *clk_idx)
+{
+  (void)ctx;
+  return device_adaptor_call_get_current_clk_idx_cb(clk_idx);
+}
+
+static int device_adaptor_ops_set_clock_priorities(void *ctx, T_device_clock_priority_table const *table)
+{
+  (void)ctx;
+  return device_adaptor_call_set_clock_priorities_cb(table);
+}
+
+static int device_adaptor_ops_get_reference_monitor_status(void *ctx, int clk_idx, T_device_clk_reference_monitor_status *ref_mon_status)
+{
+  (void)ctx;
+  return device_adaptor_call_get_reference_monitor_status_cb(clk_idx, ref_mon_status);
+}
+
+static int device_adaptor_ops_get_reference_ffo(void *ctx, int clk_idx, double *ffo_ppb)
+{
+  (void)ctx;
+  return device_adaptor_call_get_reference_ffo_cb(clk_idx, ffo_ppb);
+}
+
+static int device_adaptor_ops_get_synce_dpll_state(void *ctx, T_device_dpll_state *synce_dpll_state)
+{
+  (void)ctx;
+  return device_adaptor_call_get_synce_dpll_state_cb(synce_dpll_state);
+}
+
+static int device_adaptor_ops_get_synce_dpll_ffo(void *ctx, double *ffo_ppb)
+{
+  (void)ctx;
+  return device_adaptor_call_get_synce_dpll_ffo_cb(ffo_ppb);
+}
+
+/* Static data */
+
+static const T_device_ops g_device_adaptor_ops = {
+  NULL,
+  device_adaptor_ops_get_monotonic_milliseconds,
+  device_adaptor_ops_get_current_clk_idx,
+  device_adaptor_ops_set_clock_priorities,
+  device_adaptor_ops_get_reference_monitor_status,
+  device_adaptor_ops_get_reference_ffo,
+  device_adaptor_ops_get_synce_dpll_state,
+  device_adaptor_ops_get_synce_dpll_ffo
+};
+
 /* Global functions */
 
 int device_adaptor_init(T_device_config const *device_config)
@@ -120,7 +203,9 @@ int device_adaptor_call_get_current_clk_idx_cb(int *clk_idx)
 
   os_mutex_lock(&g_device_adaptor_mutex);
   if(g_device_adaptor_callbacks.get_current_clk_idx != NULL) {
+    uint64_t start_time_ns = device_adaptor_op_begin(E_stats_device_op_get_current_clk_idx);
     err = g_device_adaptor_callbacks.get_current_clk_idx(g_device_adaptor_data.synce_dpll_idx, clk_idx);
+    device_adaptor_op_end(E_stats_device_op_get_current_clk_idx, start_time_ns, err);
   }
   os_mutex_unlock(&g_device_adaptor_mutex);
 
@@ -133,7 +218,9 @@ int device_adaptor_call_set_clock_priorities_cb(T_device_clock_priority_table co
 
   os_mutex_lock(&g_device_adaptor_mutex);
   if(g_device_adaptor_callbacks.set_clock_priorities != NULL) {
+    uint64_t start_time_ns = device_adaptor_op_begin(E_stats_device_op_set_clock_priorities);
     err = g_device_adaptor_callbacks.set_clock_priorities(g_device_adaptor_data.synce_dpll_idx, table);
+    device_adaptor_op_end(E_stats_device_op_set_clock_priorities, start_time_ns, err);
   }
   os_mutex_unlock(&g_device_adaptor_mutex);
 
@@ -146,7 +233,24 @@ int device_adaptor_call_get_reference_monitor_status_cb(int clk_idx, T_device_cl
 
   os_mutex_lock(&g_device_adaptor_mutex);
   if(g_device_adaptor_callbacks.get_reference_monitor_status != NULL) {
+    uint64_t start_time_ns = device_adaptor_op_begin(E_stats_device_op_get_reference_monitor_status);
     err = g_device_adaptor_callbacks.get_reference_monitor_status(clk_idx, ref_mon_status);
+    device_adaptor_op_end(E_stats_device_op_get_reference_monitor_status, start_time_ns, err);
+  }
+  os_mutex_unlock(&g_device_adaptor_mutex);
+
+  return err;
+}
+
+int device_adaptor_call_get_reference_ffo_cb(int clk_idx, double *ffo_ppb)
+{
+  int err = -2;
+
+  os_mutex_lock(&g_device_adaptor_mutex);
+  if(g_device_adaptor_callbacks.get_reference_ffo != NULL) {
+    uint64_t start_time_ns = device_adaptor_op_begin(E_stats_device_op_get_reference_ffo);
+    err = g_device_adaptor_callbacks.get_reference_ffo(clk_idx, ffo_ppb);
+    device_adaptor_op_end(E_stats_device_op_get_reference_ffo, start_time_ns, err);
   }
   os_mutex_unlock(&g_device_adaptor_mutex);
 
@@ -159,7 +263,24 @@ int device_adaptor_call_get_synce_dpll_state_cb(T_device_dpll_state *synce_dpll_
 
   os_mutex_lock(&g_device_adaptor_mutex);
   if(g_device_adaptor_callbacks.get_synce_dpll_state != NULL) {
+    uint64_t start_time_ns = device_adaptor_op_begin(E_stats_device_op_get_synce_dpll_state);
     err = g_device_adaptor_callbacks.get_synce_dpll_state(g_device_adaptor_data.synce_dpll_idx, synce_dpll_state);
+    device_adaptor_op_end(E_stats_device_op_get_synce_dpll_state, start_time_ns, err);
+  }
+  os_mutex_unlock(&g_device_adaptor_mutex);
+
+  return err;
+}
+
+int device_adaptor_call_get_synce_dpll_ffo_cb(double *ffo_ppb)
+{
+  int err = -2;
+
+  os_mutex_lock(&g_device_adaptor_mutex);
+  if(g_device_adaptor_callbacks.get_synce_dpll_ffo != NULL) {
+    uint64_t start_time_ns = device_adaptor_op_begin(E_stats_device_op_get_synce_dpll_ffo);
+    err = g_device_adaptor_callbacks.get_synce_dpll_ffo(g_device_adaptor_data.synce_dpll_idx, ffo_ppb);
+    device_adaptor_op_end(E_stats_device_op_get_synce_dpll_ffo, start_time_ns, err);
   }
   os_mutex_unlock(&g_device_adaptor_mutex);
 
@@ -178,3 +299,13 @@ int device_adaptor_call_deinit_device_cb(void)
 
   return err;
 }
+
+T_device_ops const *device_adaptor_get_ops(void)
+{
+  return &g_device_adaptor_ops;
+}
+
+void device_adaptor_set_clock(unsigned long long (*get_monotonic_milliseconds)(void))
+{
+  g_device_adaptor_get_monotonic_milliseconds = (get_monotonic_milliseconds != NULL) ? get_monotonic_milliseconds : os_get_monotonic_milliseconds;
+}
@@ -74,10 +74,29 @@ typedef struct
   int (*get_current_clk_idx)(int synce_dpll_idx, int *clk_idx);
   int (*set_clock_priorities)(int synce_dpll_idx, T_device_clock_priority_table const *table);
   int (*get_reference_monitor_status)(int clk_idx, T_device_clk_reference_monitor_status *ref_mon_status);
+  int (*get_reference_ffo)(int clk_idx, double *ffo_ppb);
   int (*get_synce_dpll_state)(int synce_dpll_idx, T_device_dpll_state *synce_dpll_state);
+  int (*get_synce_dpll_ffo)(int synce_dpll_idx, double *ffo_ppb);
   int (*deinit_device)(void);
 } T_device_adaptor_callbacks;
 
+/*
+ * Device seen by a control or monitor instance, with the clock its timers run on. synced uses
+ * device_adaptor_get_ops(), which forwards to the callback wrappers below and the monotonic clock
+ * (the pcap replay clock while replaying a capture);
+ * a simulator provides a modelled device and a virtual clock per instance.
+ */
+typedef struct {
+  void *ctx;
+  unsigned long long (*get_monotonic_milliseconds)(void *ctx);
+  int (*get_current_clk_idx)(void *ctx, int *clk_idx);
+  int (*set_clock_priorities)(void *ctx, T_device_clock_priority_table const *table);
+  int (*get_reference_monitor_status)(void *ctx, int clk_idx, T_device_clk_reference_monitor_status *ref_mon_status);
+  int (*get_reference_ffo)(void *ctx, int clk_idx, double *ffo_ppb);
+  int (*get_synce_dpll_state)(void *ctx, T_device_dpll_state *synce_dpll_state);
+  int (*get_synce_dpll_ffo)(void *ctx, double *ffo_ppb);
+} T_device_ops;
+
 #define DEVICE_REGISTER_CALLBACKS_DECLARE() \
   extern void XTOKENPASTE(DEVICE, _register_callbacks(T_device_adaptor_callbacks *device_adaptor_callbacks);)
 
@@ -93,7 +112,13 @@ int device_adaptor_call_init_device_cb(void);
 int device_adaptor_call_get_current_clk_idx_cb(int *clk_idx);
 int device_adaptor_call_set_clock_priorities_cb(T_device_clock_priority_table const *table);
 int device_adaptor_call_get_reference_monitor_status_cb(int clk_idx, T_device_clk_reference_monitor_status *ref_mon_status);
+int device_adaptor_call_get_reference_ffo_cb(int clk_idx, double *ffo_ppb);
 int device_adaptor_call_get_synce_dpll_state_cb(T_device_dpll_state *synce_dpll_state);
+int device_adaptor_call_get_synce_dpll_ffo_cb(double *ffo_ppb);
 int device_adaptor_call_deinit_device_cb(void);
 
+T_device_ops const *device_adaptor_get_ops(void);
+/* Replace the monotonic clock of device_adaptor_get_ops() (NULL restores it); call before the timers are armed */
+void device_adaptor_set_clock(unsigned long long (*get_monotonic_milliseconds)(void));
+
 #endif /* DEVICE_ADAPTOR_H */
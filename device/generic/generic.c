@@ -20,6 +20,8 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_device
+
 #include <pthread.h>
 
 #include "generic.h"
@@ -77,6 +79,13 @@ static int generic_get_ref_mon_status_helper(int clk_idx)
   return 0;
 }
 
+static double generic_get_ref_ffo_helper(int clk_idx)
+{
+  (void)clk_idx;
+
+  return 0.0;
+}
+
 static T_device_dpll_state generic_get_dpll_state_helper(int synce_dpll_idx)
 {
   (void)synce_dpll_idx;
@@ -84,6 +93,13 @@ static T_device_dpll_state generic_get_dpll_state_helper(int synce_dpll_idx)
   return (best_clk_idx == INVALID_CLK_IDX) ? E_device_dpll_state_freerun : E_device_dpll_state_locked;
 }
 
+static double generic_get_dpll_ffo_helper(int synce_dpll_idx)
+{
+  (void)synce_dpll_idx;
+
+  return 0.0;
+}
+
 static void generic_deinit_i2c_helper(void)
 {
   /* Left intentionally empty */
@@ -172,6 +188,15 @@ static int generic_template_get_reference_monitor_status(int clk_idx, T_device_c
   return 0;
 }
 
+static int generic_template_get_reference_ffo(int clk_idx, double *ffo_ppb)
+{
+  /* This function is a template; the user must implement their own code here or register their own functions using generic_register_callbacks(). */
+
+  *ffo_ppb = generic_get_ref_ffo_helper(clk_idx);
+
+  return 0;
+}
+
 static int generic_template_get_synce_dpll_state(int synce_dpll_idx, T_device_dpll_state *synce_dpll_state)
 {
   /* This function is a template; the user must implement their own code here or register their own functions using generic_register_callbacks(). */
@@ -181,6 +206,15 @@ static int generic_template_get_synce_dpll_state(int synce_dpll_idx, T_device_dp
   return 0;
 }
 
+static int generic_template_get_synce_dpll_ffo(int synce_dpll_idx, double *ffo_ppb)
+{
+  /* This function is a template; the user must implement their own code here or register their own functions using generic_register_callbacks(). */
+
+  *ffo_ppb = generic_get_dpll_ffo_helper(synce_dpll_idx);
+
+  return 0;
+}
+
 static int generic_template_deinit_device(void)
 {
   /* This function is a template; the user must implement their own code here or register their own functions using generic_register_callbacks(). */
@@ -199,6 +233,8 @@ void generic_register_callbacks(T_device_adaptor_callbacks *device_adaptor_callb
   device_adaptor_callbacks->get_current_clk_idx = &generic_template_get_current_clk_idx;
   device_adaptor_callbacks->set_clock_priorities = &generic_template_set_clock_priorities;
   device_adaptor_callbacks->get_reference_monitor_status = &generic_template_get_reference_monitor_status;
+  device_adaptor_callbacks->get_reference_ffo = &generic_template_get_reference_ffo;
   device_adaptor_callbacks->get_synce_dpll_state = &generic_template_get_synce_dpll_state;
+  device_adaptor_callbacks->get_synce_dpll_ffo = &generic_template_get_synce_dpll_ffo;
   device_adaptor_callbacks->deinit_device = &generic_template_deinit_device;
 }
@@ -20,6 +20,8 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_device
+
 #include <fcntl.h>
 #include <linux/types.h>
 #include <pthread.h>
@@ -174,6 +176,24 @@ static int rsmu_get_synce_dpll_state(int synce_dpll_idx, T_device_dpll_state *sy
   return 0;
 }
 
+static int rsmu_get_synce_dpll_ffo(int synce_dpll_idx, double *ffo_ppb)
+{
+  struct rsmu_get_ffo get;
+
+  memset(&get, 0, sizeof(get));
+  get.dpll = synce_dpll_idx;
+
+  if(ioctl(g_rsmu_fd, RSMU_GET_FFO, &get)) {
+    pr_err("%s failed: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  /* Driver reports fractional frequency offset in parts per quadrillion */
+  *ffo_ppb = (double)get.ffo / 1000000.0;
+
+  return 0;
+}
+
 static int rsmu_deinit_device(void)
 {
   return 0;
@@ -188,5 +208,6 @@ void rsmu_register_callbacks(T_device_adaptor_callbacks *device_adaptor_callback
   device_adaptor_callbacks->set_clock_priorities = &rsmu_set_clock_priorities;
   device_adaptor_callbacks->get_reference_monitor_status = &rsmu_get_reference_monitor_status;
   device_adaptor_callbacks->get_synce_dpll_state = &rsmu_get_synce_dpll_state;
+  device_adaptor_callbacks->get_synce_dpll_ffo = &rsmu_get_synce_dpll_ffo;
   device_adaptor_callbacks->deinit_device = &rsmu_deinit_device;
 }
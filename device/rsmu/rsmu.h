@@ -35,6 +35,12 @@ struct rsmu_get_state
   __u8 state;
 };
 
+struct rsmu_get_ffo
+{
+  __u8 dpll;
+  __s64 ffo;
+};
+
 struct rsmu_current_clock_index
 {
   __u8 dpll;
@@ -70,6 +76,7 @@ struct rsmu_reference_monitor_status
 #define RSMU_MAGIC   '?'
 
 #define RSMU_GET_STATE                      _IOR(RSMU_MAGIC, 2, struct rsmu_get_state)
+#define RSMU_GET_FFO                        _IOR(RSMU_MAGIC, 3, struct rsmu_get_ffo)
 #define RSMU_GET_CURRENT_CLOCK_INDEX        _IOR(RSMU_MAGIC, 6, struct rsmu_current_clock_index)
 #define RSMU_SET_CLOCK_PRIORITIES           _IOW(RSMU_MAGIC, 7, struct rsmu_clock_priorities)
 #define RSMU_GET_REFERENCE_MONITOR_STATUS   _IOR(RSMU_MAGIC, 8, struct rsmu_reference_monitor_status)
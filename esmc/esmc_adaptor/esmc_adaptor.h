@@ -26,6 +26,7 @@
 #include <linux/if_ether.h>
 #include <stdio.h>
 
+#include "../../common/latency.h"
 #include "../../common/types.h"
 
 #define ESMC_MAX_NUMBER_OF_PORTS   128
@@ -43,8 +44,17 @@ typedef struct {
   T_port_num port_num;
   unsigned char mac_addr[ETH_ALEN];
   int sync_idx;
+  const char *pcap_if;                      /* Capture interface replayed on the port (NULL or empty: port name) */
 } T_rx_port_info;
 
+/* Pcap replay input mode: ports read from and write to capture files instead of raw sockets */
+typedef struct {
+  const char *in_path;                      /* NULL or empty: raw sockets */
+  const char *out_path;                     /* NULL or empty: TX frames are discarded */
+  int speed;                                /* 0: as fast as possible; N: N times the original rate */
+  int exit_delay_s;                         /* Seconds from end of input to exit (-1: keep running) */
+} T_esmc_pcap_config;
+
 typedef struct {
   T_esmc_network_option net_opt;
   T_esmc_ql init_ql;
@@ -53,6 +63,7 @@ typedef struct {
   int num_rx_ports;
   T_tx_port_info const *tx_port_array;
   T_rx_port_info const *rx_port_array;
+  T_esmc_pcap_config pcap;
 } T_esmc_config;
 
 typedef enum {
@@ -88,6 +99,7 @@ typedef struct {
     T_event_ql_change ql_change;
     T_event_timing_loop timing_loop;
   } event_data;
+  uint64_t rx_time_ns;                      /* Arrival time of the PDU carrying a QL change (0 if not traced) */
 } T_esmc_adaptor_rx_event_cb_data;
 
 typedef struct {
@@ -95,17 +107,49 @@ typedef struct {
   int sync_indices[ESMC_MAX_NUMBER_OF_PORTS];
 } T_sync_tx_bundle_info;
 
+/* ESMC traffic counters of one direction of a port */
+typedef struct {
+  unsigned long long pdus;                  /* PDUs sent (TX) or PDUs of valid length received (RX) */
+  unsigned long long event_pdus;
+  unsigned long long information_pdus;
+  unsigned long long errors;                /* Failed sends (TX) or received PDUs that failed to parse (RX) */
+  unsigned long long invalid_len_pdus;      /* RX only */
+  unsigned long long timing_loops;          /* RX only */
+  unsigned long long socket_drops;          /* RX only: packets dropped by the kernel on the port socket */
+  long long last_pdu_age_ms;                /* Milliseconds since the last PDU (-1 if none) */
+} T_esmc_port_dir_stats;
+
+typedef struct {
+  int tx_flag;                              /* Port has a TX direction */
+  int rx_flag;                              /* Port has an RX direction */
+  T_esmc_port_dir_stats tx;
+  T_esmc_port_dir_stats rx;
+} T_esmc_port_stats;
+
 typedef int (*T_esmc_adaptor_tx_event_cb)(T_esmc_adaptor_tx_event_cb_data *cb_data);
 typedef int (*T_esmc_adaptor_rx_event_cb)(T_esmc_adaptor_rx_event_cb_data *cb_data);
 
 int esmc_adaptor_init(T_esmc_config *config);
 int esmc_adaptor_start(void);
-int esmc_adaptor_set_tx_ql(T_esmc_ql ql, int best_sync_idx, T_sync_tx_bundle_info *sync_tx_bundle_info);
+/* latency_trace may be NULL; otherwise it is completed when the TX ports send the event PDUs */
+int esmc_adaptor_set_tx_ql(T_esmc_ql ql,
+                           int best_sync_idx,
+                           T_sync_tx_bundle_info *sync_tx_bundle_info,
+                           T_latency_trace const *latency_trace);
 int esmc_adaptor_register_tx_cb(T_esmc_adaptor_tx_event_cb cb);
 int esmc_adaptor_register_rx_cb(T_esmc_adaptor_rx_event_cb cb);
 int esmc_adaptor_stop(void);
 int esmc_adaptor_deinit(void);
 
+int esmc_adaptor_get_port_stats(int sync_idx, T_esmc_port_stats *port_stats);
+
 int esmc_adaptor_check_mac_addr(const unsigned char mac_addr[ETH_ALEN]);
 
+/*
+ * Clock of the ESMC ports: the monotonic clock, or the capture time while replaying a capture. Periodic work that
+ * follows the ports' timers waits with esmc_adaptor_sleep() so that it runs at the same capture times.
+ */
+unsigned long long esmc_adaptor_get_monotonic_milliseconds(void);
+void esmc_adaptor_sleep(unsigned int timeout_ms);
+
 #endif /* ESMC_ADAPTOR_H */
@@ -20,6 +20,8 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_esmc
+
 #include <errno.h>
 #include <linux/if_packet.h>
 #include <netinet/in.h>
@@ -34,6 +36,8 @@
 #include "../../common/missing.h"
 #include "../../common/os.h"
 #include "../../common/print.h"
+#include "../../common/probes.h"
+#include "../../common/trace.h"
 
 #define ESMC_PDU_SLOW_PROTO_SUBTYPE   0xA
 #define ESMC_PDU_ITU_OUI              {0x00, 0x19, 0xA7}
@@ -709,6 +713,83 @@ static void esmc_parse_ext_ql_tlv_data(T_esmc_ext_ql_tlv *ext_ql_tlv, T_port_ext
   parsed_ext_ql_tlv_data->num_cascaded_EEC = ext_ql_tlv->num_cascaded_EEC;
 }
 
+static int esmc_init_stack_data(T_esmc *esmc, T_esmc_network_option net_opt, T_esmc_ql init_ql, T_esmc_ql do_not_use_ql)
+{
+  if(esmc->state != E_esmc_state_created_stack) {
+    goto err;
+  }
+
+  esmc->net_opt = net_opt;
+  esmc->init_ql = init_ql;
+  esmc->do_not_use_ql = do_not_use_ql;
+
+  esmc->best_ql = init_ql;
+  esmc->best_ext_ql_tlv_data.num_cascaded_eEEC = 1;
+  esmc->best_ext_ql_tlv_data.num_cascaded_EEC = 0;
+  esmc->best_port_num = INVALID_PORT_NUM;
+  esmc->port_tx_bundle_info.entries = 0;
+
+  if(os_mutex_init(&esmc->best_ql_mutex) < 0) {
+    goto err;
+  }
+  if(os_cond_init(&esmc->best_ql_cond) < 0) {
+    os_mutex_deinit(&esmc->best_ql_mutex);
+    goto err;
+  }
+
+  esmc->state = E_esmc_state_intitialized_stack;
+
+  return 0;
+
+err:
+  esmc->state = E_esmc_state_failed;
+  return -1;
+}
+
+static void esmc_destroy_stack_data(T_esmc *esmc)
+{
+  os_mutex_deinit(&esmc->best_ql_mutex);
+  os_cond_deinit(&esmc->best_ql_cond);
+
+  esmc->state = E_esmc_state_unknown;
+}
+
+static void esmc_set_best_ql_data(T_esmc *esmc,
+                                  T_esmc_ql best_ql,
+                                  T_port_num best_port_num,
+                                  T_port_tx_bundle_info const *port_tx_bundle_info,
+                                  T_port_ext_ql_tlv_data const *best_port_ext_ql_tlv_data,
+                                  T_latency_trace const *latency_trace)
+{
+  os_mutex_lock(&esmc->best_ql_mutex);
+  esmc->best_ql = best_ql;
+  esmc->best_port_num = best_port_num;
+  memcpy(&esmc->port_tx_bundle_info, port_tx_bundle_info, sizeof(*port_tx_bundle_info));
+
+  if(best_port_num == INVALID_PORT_NUM) {
+    /* Best clock is external clock or LO */
+    esmc->best_ext_ql_tlv_data.num_cascaded_eEEC = 1;
+    esmc->best_ext_ql_tlv_data.num_cascaded_EEC = 0;
+    esmc->best_ext_ql_tlv_data.mixed_EEC_eEEC = 0;
+    esmc->best_ext_ql_tlv_data.partial_chain = 0;
+    memset(esmc->best_ext_ql_tlv_data.originator_clock_id, 0, ESMC_PDU_EXT_QL_TLV_SYNCE_CLOCK_ID_LEN);
+  } else if(best_port_ext_ql_tlv_data != NULL) {
+    /* Best clock is Sync-E clock */
+    memcpy(&esmc->best_ext_ql_tlv_data, best_port_ext_ql_tlv_data, sizeof(esmc->best_ext_ql_tlv_data));
+  }
+
+  if(latency_trace != NULL) {
+    esmc->latency_trace = *latency_trace;
+    latency_trace_mark(&esmc->latency_trace, E_latency_point_best_ql);
+  } else {
+    memset(&esmc->latency_trace, 0, sizeof(esmc->latency_trace));
+  }
+
+  /* Unblock all threads waiting on condition */
+  os_cond_broadcast(&esmc->best_ql_cond);
+  os_mutex_unlock(&esmc->best_ql_mutex);
+}
+
 /* Global functions */
 
 int esmc_create_stack(void)
@@ -812,37 +893,7 @@ int esmc_create_rx_ports(T_rx_port_info const *rx_port, int num_rx_ports)
 
 int esmc_init_stack(T_esmc_network_option net_opt, T_esmc_ql init_ql, T_esmc_ql do_not_use_ql)
 {
-  T_esmc *esmc = &g_esmc;
-
-  if(esmc->state != E_esmc_state_created_stack) {
-    goto err;
-  }
-
-  esmc->net_opt = net_opt;
-  esmc->init_ql = init_ql;
-  esmc->do_not_use_ql = do_not_use_ql;
-
-  esmc->best_ql = init_ql;
-  esmc->best_ext_ql_tlv_data.num_cascaded_eEEC = 1;
-  esmc->best_ext_ql_tlv_data.num_cascaded_EEC = 0;
-  esmc->best_port_num = INVALID_PORT_NUM;
-  esmc->port_tx_bundle_info.entries = 0;
-
-  if(os_mutex_init(&esmc->best_ql_mutex) < 0) {
-    goto err;
-  }
-  if(os_cond_init(&esmc->best_ql_cond) < 0) {
-    os_mutex_deinit(&esmc->best_ql_mutex);
-    goto err;
-  }
-
-  esmc->state = E_esmc_state_intitialized_stack;
-
-  return 0;
-
-err:
-  esmc->state = E_esmc_state_failed;
-  return -1;
+  return esmc_init_stack_data(&g_esmc, net_opt, init_ql, do_not_use_ql);
 }
 
 int esmc_init_tx_ports(void)
@@ -965,12 +1016,7 @@ err:
 
 void esmc_destroy_stack(void)
 {
-  T_esmc *esmc = &g_esmc;
-
-  os_mutex_deinit(&esmc->best_ql_mutex);
-  os_cond_deinit(&esmc->best_ql_cond);
-
-  esmc->state = E_esmc_state_unknown;
+  esmc_destroy_stack_data(&g_esmc);
 }
 
 void esmc_destroy_tx_ports(void)
@@ -1019,36 +1065,27 @@ void esmc_destroy_rx_ports(void)
   esmc->num_rx_ports = 0;
 }
 
-void esmc_set_best_ql(T_esmc_ql best_ql, T_port_num best_port_num, T_port_tx_bundle_info *port_tx_bundle_info)
+void esmc_set_best_ql(T_esmc_ql best_ql,
+                      T_port_num best_port_num,
+                      T_port_tx_bundle_info *port_tx_bundle_info,
+                      T_latency_trace const *latency_trace)
 {
   T_esmc *esmc = &g_esmc;
-
   T_port_rx_data *rx_p;
+  T_port_ext_ql_tlv_data best_port_ext_ql_tlv_data;
+  T_port_ext_ql_tlv_data const *best_port_ext_ql_tlv_data_p = NULL;
 
-  os_mutex_lock(&esmc->best_ql_mutex);
-  esmc->best_ql = best_ql;
-  esmc->best_port_num = best_port_num;
-  memcpy(&esmc->port_tx_bundle_info, port_tx_bundle_info, sizeof(*port_tx_bundle_info));
-
-  if(best_port_num == INVALID_PORT_NUM) {
-    /* Best clock is external clock or LO */
-    esmc->best_ext_ql_tlv_data.num_cascaded_eEEC = 1;
-    esmc->best_ext_ql_tlv_data.num_cascaded_EEC = 0;
-    esmc->best_ext_ql_tlv_data.mixed_EEC_eEEC = 0;
-    esmc->best_ext_ql_tlv_data.partial_chain = 0;
-    memset(esmc->best_ext_ql_tlv_data.originator_clock_id, 0, ESMC_PDU_EXT_QL_TLV_SYNCE_CLOCK_ID_LEN);
-  } else {
+  if(best_port_num != INVALID_PORT_NUM) {
     /* Best clock is Sync-E clock */
     LIST_FOREACH(rx_p, &esmc->rx_ports, list) {
-      if(port_get_rx_ext_ql_tlv_data(rx_p, best_port_num, &esmc->best_ext_ql_tlv_data) == 1) {
+      if(port_get_rx_ext_ql_tlv_data(rx_p, best_port_num, &best_port_ext_ql_tlv_data) == 1) {
+        best_port_ext_ql_tlv_data_p = &best_port_ext_ql_tlv_data;
         break;
       }
     }
   }
 
-  /* Unblock all threads waiting on condition */
-  os_cond_broadcast(&esmc->best_ql_cond);
-  os_mutex_unlock(&esmc->best_ql_mutex);
+  esmc_instance_set_best_ql(esmc, best_ql, best_port_num, port_tx_bundle_info, best_port_ext_ql_tlv_data_p, latency_trace);
 }
 
 int esmc_reg_tx_cb(T_esmc_tx_event_cb event_cb)
@@ -1068,7 +1105,11 @@ int esmc_reg_rx_cb(T_esmc_rx_event_cb event_cb)
 int esmc_call_tx_cb(T_esmc_tx_event_cb_data *cb_data)
 {
   if(g_tx_cb != NULL) {
+    synced_probe2(tx_cb_entry, cb_data->port_num, cb_data->event_type);
+    trace_begin();
     g_tx_cb(cb_data);
+    trace_end(E_trace_span_control_tx_cb, NULL);
+    synced_probe2(tx_cb_return, cb_data->port_num, cb_data->event_type);
   }
 
   return 0;
@@ -1077,7 +1118,11 @@ int esmc_call_tx_cb(T_esmc_tx_event_cb_data *cb_data)
 int esmc_call_rx_cb(T_esmc_rx_event_cb_data *cb_data)
 {
   if(g_rx_cb != NULL) {
+    synced_probe2(rx_cb_entry, cb_data->port_num, cb_data->event_type);
+    trace_begin();
     g_rx_cb(cb_data);
+    trace_end(E_trace_span_control_rx_cb, NULL);
+    synced_probe2(rx_cb_return, cb_data->port_num, cb_data->event_type);
   }
 
   return 0;
@@ -1085,7 +1130,17 @@ int esmc_call_rx_cb(T_esmc_rx_event_cb_data *cb_data)
 
 int esmc_compose_pdu(T_esmc_pdu *msg, T_esmc_pdu_type msg_type, unsigned char src_mac_addr[ETH_ALEN], T_port_ext_ql_tlv_data const *best_ext_ql_tlv_data, T_port_num port_num, T_esmc_ql *composed_ql)
 {
-  T_esmc *esmc = &g_esmc;
+  return esmc_instance_compose_pdu(&g_esmc, msg, msg_type, src_mac_addr, best_ext_ql_tlv_data, port_num, composed_ql);
+}
+
+int esmc_instance_compose_pdu(T_esmc *esmc,
+                              T_esmc_pdu *msg,
+                              T_esmc_pdu_type msg_type,
+                              unsigned char src_mac_addr[ETH_ALEN],
+                              T_port_ext_ql_tlv_data const *best_ext_ql_tlv_data,
+                              T_port_num port_num,
+                              T_esmc_ql *composed_ql)
+{
   T_esmc_network_option net_opt = esmc->net_opt;
   T_port_num best_port_num = esmc->best_port_num;
   T_esmc_ql do_not_use_ql = esmc->do_not_use_ql;
@@ -1165,8 +1220,11 @@ int esmc_compose_pdu(T_esmc_pdu *msg, T_esmc_pdu_type msg_type, unsigned char sr
 
 int esmc_parse_pdu(T_esmc_pdu *msg, int *enhanced_flag, T_esmc_ql *parsed_ql, T_port_ext_ql_tlv_data *parsed_ext_ql_tlv_data)
 {
-  T_esmc *esmc = &g_esmc;
+  return esmc_instance_parse_pdu(&g_esmc, msg, enhanced_flag, parsed_ql, parsed_ext_ql_tlv_data);
+}
 
+int esmc_instance_parse_pdu(T_esmc const *esmc, T_esmc_pdu *msg, int *enhanced_flag, T_esmc_ql *parsed_ql, T_port_ext_ql_tlv_data *parsed_ext_ql_tlv_data)
+{
   if(esmc_check_slow_proto_subtype(&msg->slow_proto_subtype) < 0) {
     return -1;
   }
@@ -1201,6 +1259,39 @@ int esmc_parse_pdu(T_esmc_pdu *msg, int *enhanced_flag, T_esmc_ql *parsed_ql, T_
   return 0;
 }
 
+T_esmc_pdu_type esmc_get_pdu_type(T_esmc_pdu const *msg)
+{
+  return (ESMC_PDU_GET_EVENT_FLAG(msg->version_event_flag_reserved) & E_esmc_pdu_type_event) ? E_esmc_pdu_type_event : E_esmc_pdu_type_information;
+}
+
+int esmc_get_tx_port_stats(T_port_num port_num, T_esmc_port_dir_stats *stats)
+{
+  T_esmc *esmc = &g_esmc;
+  T_port_tx_data *tx_p;
+
+  LIST_FOREACH(tx_p, &esmc->tx_ports, list) {
+    if(port_tx_get_stats(tx_p, port_num, stats) == 1) {
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+int esmc_get_rx_port_stats(T_port_num port_num, T_esmc_port_dir_stats *stats)
+{
+  T_esmc *esmc = &g_esmc;
+  T_port_rx_data *rx_p;
+
+  LIST_FOREACH(rx_p, &esmc->rx_ports, list) {
+    if(port_rx_get_stats(rx_p, port_num, stats) == 1) {
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
 #if (SYNCED_DEBUG_MODE == 1)
 void esmc_print_esmc_pdu(T_esmc_pdu *msg, T_esmc_print_esmc_pdu_type type)
 {
@@ -1307,6 +1398,32 @@ void esmc_print_esmc_pdu(T_esmc_pdu *msg, T_esmc_print_esmc_pdu_type type)
 }
 #endif
 
+int esmc_instance_init(T_esmc *esmc, T_esmc_network_option net_opt, T_esmc_ql init_ql, T_esmc_ql do_not_use_ql)
+{
+  memset(esmc, 0, sizeof(*esmc));
+  LIST_INIT(&esmc->tx_ports);
+  LIST_INIT(&esmc->rx_ports);
+
+  esmc->state = E_esmc_state_created_stack;
+
+  return esmc_init_stack_data(esmc, net_opt, init_ql, do_not_use_ql);
+}
+
+void esmc_instance_set_best_ql(T_esmc *esmc,
+                               T_esmc_ql best_ql,
+                               T_port_num best_port_num,
+                               T_port_tx_bundle_info const *port_tx_bundle_info,
+                               T_port_ext_ql_tlv_data const *best_port_ext_ql_tlv_data,
+                               T_latency_trace const *latency_trace)
+{
+  esmc_set_best_ql_data(esmc, best_ql, best_port_num, port_tx_bundle_info, best_port_ext_ql_tlv_data, latency_trace);
+}
+
+void esmc_instance_deinit(T_esmc *esmc)
+{
+  esmc_destroy_stack_data(esmc);
+}
+
 T_esmc *esmc_get_stack_data(void)
 {
   return &g_esmc;
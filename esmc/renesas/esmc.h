@@ -183,7 +183,7 @@ typedef struct {
   T_port_num port_nums[ESMC_MAX_NUMBER_OF_PORTS];
 } T_port_tx_bundle_info;
 
-typedef struct {
+struct esmc {
   T_esmc_network_option net_opt;
   T_esmc_ql init_ql;
   T_esmc_ql do_not_use_ql;
@@ -195,6 +195,7 @@ typedef struct {
   T_port_tx_bundle_info port_tx_bundle_info;
   pthread_mutex_t best_ql_mutex;
   pthread_cond_t best_ql_cond;
+  T_latency_trace latency_trace;            /* Trace of the last best QL change */
 
   LIST_HEAD(tx_ports_head, T_port_tx_data) tx_ports;
   int num_tx_ports;
@@ -203,21 +204,24 @@ typedef struct {
   int num_rx_ports;
 
   T_esmc_state state;
-} T_esmc;
+};
+typedef struct esmc T_esmc;
 
 typedef struct {
   T_esmc_event_type event_type;
   int port_num;
 } T_esmc_tx_event_cb_data;
 
-typedef struct {
+struct esmc_rx_event_cb_data {
   T_esmc_event_type event_type;
   int port_num;
   union {
     T_event_ql_change ql_change;
     T_event_timing_loop timing_loop;
   } event_data;
-} T_esmc_rx_event_cb_data;
+  uint64_t rx_time_ns;                      /* Arrival time of the PDU carrying a QL change (0 if not traced) */
+};
+typedef struct esmc_rx_event_cb_data T_esmc_rx_event_cb_data;
 
 #if (SYNCED_DEBUG_MODE == 1)
 typedef enum {
@@ -249,10 +253,17 @@ int esmc_reg_rx_cb(T_esmc_rx_event_cb event_cb);
 int esmc_call_tx_cb(T_esmc_tx_event_cb_data *cb_data);
 int esmc_call_rx_cb(T_esmc_rx_event_cb_data *cb_data);
 
-void esmc_set_best_ql(T_esmc_ql best_ql, T_port_num best_port_num, T_port_tx_bundle_info *port_tx_bundle_info);
+void esmc_set_best_ql(T_esmc_ql best_ql,
+                      T_port_num best_port_num,
+                      T_port_tx_bundle_info *port_tx_bundle_info,
+                      T_latency_trace const *latency_trace);
 
 int esmc_compose_pdu(T_esmc_pdu *msg, T_esmc_pdu_type msg_type, unsigned char src_mac_addr[ETH_ALEN], T_port_ext_ql_tlv_data const *best_ext_ql_tlv_data, T_port_num port_num, T_esmc_ql *composed_ql);
 int esmc_parse_pdu(T_esmc_pdu *msg, int *enhanced_flag, T_esmc_ql *parsed_ql, T_port_ext_ql_tlv_data *parsed_ext_ql_tlv_data);
+T_esmc_pdu_type esmc_get_pdu_type(T_esmc_pdu const *msg);
+
+int esmc_get_tx_port_stats(T_port_num port_num, T_esmc_port_dir_stats *stats);
+int esmc_get_rx_port_stats(T_port_num port_num, T_esmc_port_dir_stats *stats);
 
 #if (SYNCED_DEBUG_MODE == 1)
 void esmc_print_esmc_pdu(T_esmc_pdu *msg, T_esmc_print_esmc_pdu_type type);
@@ -260,4 +271,26 @@ void esmc_print_esmc_pdu(T_esmc_pdu *msg, T_esmc_print_esmc_pdu_type type);
 
 T_esmc *esmc_get_stack_data(void);
 
+/*
+ * Instance API used to run several ESMC stacks without ports in one process (e.g. network simulation).
+ * best_port_ext_ql_tlv_data is the extended QL TLV data of the best port after cascade update (see
+ * port_get_rx_ext_ql_tlv_data()); NULL keeps the current data when best_port_num is valid.
+ */
+int esmc_instance_init(T_esmc *esmc, T_esmc_network_option net_opt, T_esmc_ql init_ql, T_esmc_ql do_not_use_ql);
+void esmc_instance_set_best_ql(T_esmc *esmc,
+                               T_esmc_ql best_ql,
+                               T_port_num best_port_num,
+                               T_port_tx_bundle_info const *port_tx_bundle_info,
+                               T_port_ext_ql_tlv_data const *best_port_ext_ql_tlv_data,
+                               T_latency_trace const *latency_trace);
+int esmc_instance_compose_pdu(T_esmc *esmc,
+                              T_esmc_pdu *msg,
+                              T_esmc_pdu_type msg_type,
+                              unsigned char src_mac_addr[ETH_ALEN],
+                              T_port_ext_ql_tlv_data const *best_ext_ql_tlv_data,
+                              T_port_num port_num,
+                              T_esmc_ql *composed_ql);
+int esmc_instance_parse_pdu(T_esmc const *esmc, T_esmc_pdu *msg, int *enhanced_flag, T_esmc_ql *parsed_ql, T_port_ext_ql_tlv_data *parsed_ext_ql_tlv_data);
+void esmc_instance_deinit(T_esmc *esmc);
+
 #endif /* ESMC_H */
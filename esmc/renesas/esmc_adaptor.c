@@ -21,6 +21,7 @@
 ********************************************************************************************************************/
 
 #include "esmc.h"
+#include "pcap_socket.h"
 #include "../esmc_adaptor/esmc_adaptor.h"
 #include "../../common/common.h"
 
@@ -168,6 +169,7 @@ static int esmc_rx_event_cb(T_esmc_rx_event_cb_data *cb_data)
   }
 
   generic_cb_data.event_type = cb_data->event_type;
+  generic_cb_data.rx_time_ns = 0;
   port_num = cb_data->port_num;
 
   switch(cb_data->event_type) {
@@ -178,6 +180,7 @@ static int esmc_rx_event_cb(T_esmc_rx_event_cb_data *cb_data)
       generic_cb_data.event_data.ql_change.new_ql = cb_data->event_data.ql_change.new_ql;
       generic_cb_data.event_data.ql_change.new_num_cascaded_eEEC = cb_data->event_data.ql_change.new_num_cascaded_eEEC;
       generic_cb_data.event_data.ql_change.new_num_cascaded_EEC = cb_data->event_data.ql_change.new_num_cascaded_EEC;
+      generic_cb_data.rx_time_ns = cb_data->rx_time_ns;
       break;
 
     case E_esmc_event_type_rx_timeout:
@@ -236,6 +239,13 @@ int esmc_adaptor_init(T_esmc_config *config)
     return -1;
   }
 
+  /* Replace raw sockets with the pcap replay transport before the ports open them */
+  if((config->pcap.in_path != NULL) && (config->pcap.in_path[0] != '\0')) {
+    if(pcap_socket_init(&config->pcap) < 0) {
+      return -1;
+    }
+  }
+
   /* Create and initialize ESMC TX ports */
   tx_port = config->tx_port_array;
   if(esmc_create_tx_ports(tx_port, num_tx_ports) < 0) {
@@ -283,10 +293,17 @@ int esmc_adaptor_init(T_esmc_config *config)
 
 int esmc_adaptor_start(void)
 {
-  return esmc_check_init();
+  if(esmc_check_init() < 0) {
+    return -1;
+  }
+
+  return pcap_socket_start();
 }
 
-int esmc_adaptor_set_tx_ql(T_esmc_ql ql, int best_sync_idx, T_sync_tx_bundle_info *sync_tx_bundle_info)
+int esmc_adaptor_set_tx_ql(T_esmc_ql ql,
+                           int best_sync_idx,
+                           T_sync_tx_bundle_info *sync_tx_bundle_info,
+                           T_latency_trace const *latency_trace)
 {
   T_port_num best_port_num;
   T_port_num tx_port_num;
@@ -297,7 +314,7 @@ int esmc_adaptor_set_tx_ql(T_esmc_ql ql, int best_sync_idx, T_sync_tx_bundle_inf
   port_tx_bundle_info.entries = 0;
 
   if(best_sync_idx == INVALID_SYNC_IDX) {
-    esmc_set_best_ql(ql, INVALID_PORT_NUM, &port_tx_bundle_info);
+    esmc_set_best_ql(ql, INVALID_PORT_NUM, &port_tx_bundle_info, latency_trace);
     return 0;
   }
 
@@ -314,7 +331,7 @@ int esmc_adaptor_set_tx_ql(T_esmc_ql ql, int best_sync_idx, T_sync_tx_bundle_inf
   /* Find best port number */
   best_port_num = get_rx_port_num_from_sync_idx(best_sync_idx);
   /* Set the best QL */
-  esmc_set_best_ql(ql, best_port_num, &port_tx_bundle_info);
+  esmc_set_best_ql(ql, best_port_num, &port_tx_bundle_info, latency_trace);
 
   return 0;
 }
@@ -341,6 +358,8 @@ int esmc_adaptor_register_rx_cb(T_esmc_adaptor_rx_event_cb cb)
 
 int esmc_adaptor_stop(void)
 {
+  pcap_socket_stop();
+
   return 0;
 }
 
@@ -358,6 +377,42 @@ int esmc_adaptor_deinit(void)
   esmc_destroy_tx_ports();
   esmc_destroy_rx_ports();
   esmc_destroy_stack();
+  pcap_socket_deinit();
+
+  return 0;
+}
+
+unsigned long long esmc_adaptor_get_monotonic_milliseconds(void)
+{
+  return pcap_socket_get_monotonic_milliseconds();
+}
+
+void esmc_adaptor_sleep(unsigned int timeout_ms)
+{
+  pcap_socket_sleep(timeout_ms);
+}
+
+int esmc_adaptor_get_port_stats(int sync_idx, T_esmc_port_stats *port_stats)
+{
+  T_port_num tx_port_num;
+  T_port_num rx_port_num;
+
+  memset(port_stats, 0, sizeof(*port_stats));
+
+  tx_port_num = get_tx_port_num_from_sync_idx(sync_idx);
+  if(tx_port_num != INVALID_PORT_NUM) {
+    port_stats->tx_flag = (esmc_get_tx_port_stats(tx_port_num, &port_stats->tx) == 0);
+  }
+
+  rx_port_num = get_rx_port_num_from_sync_idx(sync_idx);
+  if(rx_port_num != INVALID_PORT_NUM) {
+    port_stats->rx_flag = (esmc_get_rx_port_stats(rx_port_num, &port_stats->rx) == 0);
+  }
+
+  if(!port_stats->tx_flag && !port_stats->rx_flag) {
+    /* Not a Sync-E port */
+    return -1;
+  }
 
   return 0;
 }
@@ -0,0 +1,689 @@
+/**
+ * @file pcap_socket.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#define PRINT_MODULE E_print_module_esmc
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <net/ethernet.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esmc.h"
+#include "pcap_socket.h"
+#include "../../common/common.h"
+#include "../../common/os.h"
+#include "../../common/pcap.h"
+#include "../../common/print.h"
+
+#define PCAP_SOCKET_MAX_NUM_OF_PORTS       (2 * ESMC_MAX_NUMBER_OF_PORTS)
+#define PCAP_SOCKET_MAX_NUM_OF_CAPTURE_IFS 256
+#define PCAP_SOCKET_MAX_PDU_LEN            128    /* Same length limit as the raw socket filter */
+#define PCAP_SOCKET_WAIT_PERIOD_MS         100    /* Longest wait before checking for stop */
+
+#define PCAP_SOCKET_IF_UNRESOLVED          -2
+#define PCAP_SOCKET_IF_UNMAPPED            -1
+
+typedef struct {
+  int fd;                                   /* Port end of the socket pair */
+  int peer_fd;                              /* Replay end of the socket pair */
+  int rx_flag;
+  char name[INTERFACE_MAX_NAME_LEN];
+  char pcap_if[INTERFACE_MAX_NAME_LEN];     /* Capture interface name or number of an RX port */
+  unsigned char mac_addr[ETH_ALEN];
+  int writer_if_id;                         /* Output interface of a TX port (-1 if TX frames are discarded) */
+  int num_queued;                           /* Frames handed to an RX port and not read yet */
+  int idle_flag;                            /* RX port thread is waiting in pcap_socket_poll() */
+  uint64_t idle_time_ns;                    /* Replay clock the RX port thread has caught up with */
+} T_pcap_socket_port;
+
+typedef struct {
+  unsigned int delivered;
+  unsigned int not_esmc;
+  unsigned int unmapped;
+  unsigned int own;                         /* Outbound frames and frames sent from the port's own MAC address */
+} T_pcap_socket_replay_stats;
+
+/* Static data */
+
+static int g_pcap_socket_enabled = 0;
+static int g_pcap_socket_speed;
+static int g_pcap_socket_exit_delay_s;
+static char g_pcap_socket_in_path[PATH_MAX];
+
+static T_pcap_reader *g_pcap_socket_reader = NULL;
+static T_pcap_writer *g_pcap_socket_writer = NULL;
+
+static T_pcap_socket_port g_pcap_socket_ports[PCAP_SOCKET_MAX_NUM_OF_PORTS];
+static int g_pcap_socket_num_ports = 0;
+
+static pthread_t g_pcap_socket_thread;
+static volatile int g_pcap_socket_running = 0;
+
+/* First frame of the file, read at start so that the replay clock is known before the ports send anything */
+static T_pcap_frame g_pcap_socket_first_frame;
+static int g_pcap_socket_first_frame_ret;
+
+/*
+ * Replay clock: capture time, mapped onto the monotonic clock at the start of the replay. At speed N it runs N times
+ * faster than the monotonic clock. At speed 0 the replay thread steps it, and each step waits until the RX ports and
+ * the main loop have run at the current capture time (see pcap_socket_step()).
+ */
+static pthread_mutex_t g_pcap_socket_clock_mutex;
+static pthread_cond_t g_pcap_socket_clock_cond;
+static int g_pcap_socket_started = 0;
+static uint64_t g_pcap_socket_start_time_ns;
+static uint64_t g_pcap_socket_first_frame_time_ns;
+static uint64_t g_pcap_socket_clock_ns;              /* Speed 0: capture time reached by the replay thread */
+static uint64_t g_pcap_socket_free_run_time_ns;      /* Speed 0: monotonic time the clock was released (0 while stepped) */
+static int g_pcap_socket_main_loop_idle_flag;        /* Main loop is waiting in pcap_socket_sleep() */
+static uint64_t g_pcap_socket_main_loop_wake_time_ns;
+
+/* Static functions */
+
+static uint64_t pcap_socket_get_monotonic_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/* Capture time corresponding to now: original timestamps scaled by speed, or the stepped clock at full speed */
+static uint64_t pcap_socket_get_replay_time_ns(void)
+{
+  uint64_t free_run_time_ns;
+
+  if(g_pcap_socket_speed == 0) {
+    /* Once released, the clock keeps running at the monotonic rate from where replay left it */
+    free_run_time_ns = __atomic_load_n(&g_pcap_socket_free_run_time_ns, __ATOMIC_ACQUIRE);
+    if(free_run_time_ns != 0) {
+      return g_pcap_socket_clock_ns + (pcap_socket_get_monotonic_ns() - free_run_time_ns);
+    }
+    return __atomic_load_n(&g_pcap_socket_clock_ns, __ATOMIC_RELAXED);
+  }
+
+  return g_pcap_socket_first_frame_time_ns +
+         ((pcap_socket_get_monotonic_ns() - g_pcap_socket_start_time_ns) * g_pcap_socket_speed);
+}
+
+/* Speed 0: the RX ports and the main loop are all waiting for the clock to move past the current capture time */
+static int pcap_socket_is_idle(void)
+{
+  T_pcap_socket_port const *port;
+  int i;
+
+  if(!g_pcap_socket_main_loop_idle_flag || (g_pcap_socket_main_loop_wake_time_ns <= g_pcap_socket_clock_ns)) {
+    return 0;
+  }
+
+  for(i = 0; i < g_pcap_socket_num_ports; i++) {
+    port = &g_pcap_socket_ports[i];
+    if(!port->rx_flag || (port->fd == UNINITIALIZED_FD)) {
+      continue;
+    }
+    if(!port->idle_flag || (port->num_queued > 0) || (port->idle_time_ns != g_pcap_socket_clock_ns)) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/*
+ * Speed 0: advance the replay clock to a capture time. The clock stops at every main loop wake-up on the way, and
+ * each step waits until the RX ports have checked their timers and the main loop has run, as they would have at
+ * that time of the capture. Return -1 if stopped.
+ */
+static int pcap_socket_step(uint64_t time_ns)
+{
+  uint64_t next_time_ns;
+  int timeout_flag;
+
+  os_mutex_lock(&g_pcap_socket_clock_mutex);
+  while(g_pcap_socket_running) {
+    if(!pcap_socket_is_idle()) {
+      os_cond_timed_wait(&g_pcap_socket_clock_cond, &g_pcap_socket_clock_mutex, PCAP_SOCKET_WAIT_PERIOD_MS, &timeout_flag);
+      continue;
+    }
+    if(g_pcap_socket_clock_ns >= time_ns) {
+      break;
+    }
+    next_time_ns = (g_pcap_socket_main_loop_wake_time_ns < time_ns) ? g_pcap_socket_main_loop_wake_time_ns : time_ns;
+    __atomic_store_n(&g_pcap_socket_clock_ns, next_time_ns, __ATOMIC_RELAXED);
+    os_cond_broadcast(&g_pcap_socket_clock_cond);
+  }
+  os_mutex_unlock(&g_pcap_socket_clock_mutex);
+
+  return g_pcap_socket_running ? 0 : -1;
+}
+
+/* Speed 0: let the clock run at the monotonic rate once nothing steps it any more */
+static void pcap_socket_release_clock(void)
+{
+  if(g_pcap_socket_speed != 0) {
+    return;
+  }
+
+  os_mutex_lock(&g_pcap_socket_clock_mutex);
+  __atomic_store_n(&g_pcap_socket_free_run_time_ns, pcap_socket_get_monotonic_ns(), __ATOMIC_RELEASE);
+  os_cond_broadcast(&g_pcap_socket_clock_cond);
+  os_mutex_unlock(&g_pcap_socket_clock_mutex);
+}
+
+static T_pcap_socket_port *pcap_socket_find_port(int fd)
+{
+  int i;
+
+  for(i = 0; i < g_pcap_socket_num_ports; i++) {
+    if(g_pcap_socket_ports[i].fd == fd) {
+      return &g_pcap_socket_ports[i];
+    }
+  }
+
+  return NULL;
+}
+
+/* Apply the raw socket filter: IEEE Slow Protocols multicast destination, Slow Protocols ethertype and length */
+static int pcap_socket_is_esmc(T_pcap_frame const *frame)
+{
+  const unsigned char mcast_addr[ETH_ALEN] = ESMC_PDU_IEEE_SLOW_PROTO_MCAST_ADDR;
+
+  if((frame->len < ETH_HLEN) || (frame->len > PCAP_SOCKET_MAX_PDU_LEN)) {
+    return 0;
+  }
+  if(memcmp(&frame->data[0], mcast_addr, ETH_ALEN) != 0) {
+    return 0;
+  }
+  if(((frame->data[2 * ETH_ALEN] << 8) | frame->data[(2 * ETH_ALEN) + 1]) != ETH_P_SLOW) {
+    return 0;
+  }
+
+  return 1;
+}
+
+static int pcap_socket_is_if_num(const char *str)
+{
+  if(*str == '\0') {
+    return 0;
+  }
+  while(*str != '\0') {
+    if(!isdigit((unsigned char)*str)) {
+      return 0;
+    }
+    str++;
+  }
+
+  return 1;
+}
+
+/* Return the index of the RX port receiving frames captured on capture interface if_id */
+static int pcap_socket_map_if(int if_id)
+{
+  const char *if_name = pcap_reader_get_if_name(g_pcap_socket_reader, if_id);
+  T_pcap_socket_port const *port;
+  int num_rx_ports = 0;
+  int rx_port_idx = PCAP_SOCKET_IF_UNMAPPED;
+  int i;
+
+  for(i = 0; i < g_pcap_socket_num_ports; i++) {
+    port = &g_pcap_socket_ports[i];
+    if(!port->rx_flag) {
+      continue;
+    }
+    if(((if_name != NULL) && (strcmp(port->pcap_if, if_name) == 0)) ||
+       (pcap_socket_is_if_num(port->pcap_if) && (atoi(port->pcap_if) == if_id))) {
+      pr_info("Replaying capture interface %d (%s) on port %s", if_id, if_name ? if_name : "unnamed", port->name);
+      return i;
+    }
+    num_rx_ports++;
+    rx_port_idx = i;
+  }
+
+  /* A single capture interface feeds a single RX port whatever their names */
+  if((pcap_reader_get_num_ifs(g_pcap_socket_reader) == 1) && (num_rx_ports == 1)) {
+    pr_info("Replaying capture interface %d (%s) on port %s", if_id, if_name ? if_name : "unnamed", g_pcap_socket_ports[rx_port_idx].name);
+    return rx_port_idx;
+  }
+
+  pr_warning("Capture interface %d (%s) is not mapped to any RX port", if_id, if_name ? if_name : "unnamed");
+
+  return PCAP_SOCKET_IF_UNMAPPED;
+}
+
+/* Wait until the capture time of a frame is reached on the replay clock; return -1 if stopped */
+static int pcap_socket_pace(uint64_t frame_time_ns)
+{
+  uint64_t target_ns;
+  uint64_t now_ns;
+  uint64_t wait_ns;
+  struct timespec ts;
+
+  if(g_pcap_socket_speed == 0) {
+    return pcap_socket_step(frame_time_ns);
+  }
+  if(frame_time_ns <= g_pcap_socket_first_frame_time_ns) {
+    return 0;
+  }
+
+  target_ns = g_pcap_socket_start_time_ns + ((frame_time_ns - g_pcap_socket_first_frame_time_ns) / g_pcap_socket_speed);
+  while(g_pcap_socket_running) {
+    now_ns = pcap_socket_get_monotonic_ns();
+    if(now_ns >= target_ns) {
+      return 0;
+    }
+    wait_ns = target_ns - now_ns;
+    if(wait_ns > (PCAP_SOCKET_WAIT_PERIOD_MS * 1000000ULL)) {
+      wait_ns = PCAP_SOCKET_WAIT_PERIOD_MS * 1000000ULL;
+    }
+    ts.tv_sec = wait_ns / 1000000000ULL;
+    ts.tv_nsec = wait_ns % 1000000000ULL;
+    nanosleep(&ts, NULL);
+  }
+
+  return -1;
+}
+
+/* Hand a frame to an RX port, waiting while the port's queue is full; return -1 if stopped */
+static int pcap_socket_deliver(T_pcap_socket_port *port, T_pcap_frame const *frame)
+{
+  struct pollfd poll_fd;
+  int send_errno;
+
+  while(g_pcap_socket_running) {
+    send_errno = 0;
+    /* Counted under the clock mutex so that a step never sees the frame neither queued nor read */
+    os_mutex_lock(&g_pcap_socket_clock_mutex);
+    if(send(port->peer_fd, frame->data, frame->len, MSG_DONTWAIT) >= 0) {
+      port->num_queued++;
+      os_cond_broadcast(&g_pcap_socket_clock_cond);
+    } else {
+      send_errno = errno;
+    }
+    os_mutex_unlock(&g_pcap_socket_clock_mutex);
+    if(send_errno == 0) {
+      return 0;
+    }
+    if((send_errno != EAGAIN) && (send_errno != EWOULDBLOCK) && (send_errno != ENOBUFS)) {
+      pr_err_ratelimited("Failed to replay frame on port %s: %s", port->name, strerror(send_errno));
+      return 0;
+    }
+    memset(&poll_fd, 0, sizeof(poll_fd));
+    poll_fd.fd = port->peer_fd;
+    poll_fd.events = POLLOUT;
+    poll(&poll_fd, 1, PCAP_SOCKET_WAIT_PERIOD_MS);
+  }
+
+  return -1;
+}
+
+static void *pcap_socket_thread(void *arg)
+{
+  int if_map[PCAP_SOCKET_MAX_NUM_OF_CAPTURE_IFS];
+  T_pcap_socket_replay_stats stats;
+  T_pcap_socket_port *port;
+  T_pcap_frame frame;
+  int section = -1;
+  int port_idx;
+  int ret;
+  int i;
+
+  (void)arg;
+
+  memset(&stats, 0, sizeof(stats));
+  frame = g_pcap_socket_first_frame;
+  ret = g_pcap_socket_first_frame_ret;
+
+  while((ret == 1) && g_pcap_socket_running) {
+    if(section != pcap_reader_get_section(g_pcap_socket_reader)) {
+      /* Interface numbering restarts in every pcapng section */
+      section = pcap_reader_get_section(g_pcap_socket_reader);
+      for(i = 0; i < PCAP_SOCKET_MAX_NUM_OF_CAPTURE_IFS; i++) {
+        if_map[i] = PCAP_SOCKET_IF_UNRESOLVED;
+      }
+    }
+
+    if(!pcap_socket_is_esmc(&frame)) {
+      stats.not_esmc++;
+    } else if(frame.if_id >= PCAP_SOCKET_MAX_NUM_OF_CAPTURE_IFS) {
+      stats.unmapped++;
+    } else {
+      if(if_map[frame.if_id] == PCAP_SOCKET_IF_UNRESOLVED) {
+        if_map[frame.if_id] = pcap_socket_map_if(frame.if_id);
+      }
+      port_idx = if_map[frame.if_id];
+
+      if(port_idx == PCAP_SOCKET_IF_UNMAPPED) {
+        stats.unmapped++;
+      } else {
+        port = &g_pcap_socket_ports[port_idx];
+        if(frame.outbound_flag || (memcmp(&frame.data[ETH_ALEN], port->mac_addr, ETH_ALEN) == 0)) {
+          /* Raw sockets do not capture their own transmission */
+          stats.own++;
+        } else {
+          if(pcap_socket_pace(frame.time_ns) < 0) {
+            break;
+          }
+          if(pcap_socket_deliver(port, &frame) < 0) {
+            break;
+          }
+          stats.delivered++;
+        }
+      }
+    }
+
+    ret = pcap_reader_next(g_pcap_socket_reader, &frame);
+  }
+
+  if(!g_pcap_socket_running) {
+    return NULL;
+  }
+
+  if(ret < 0) {
+    pr_err("Malformed capture in %s", g_pcap_socket_in_path);
+  }
+  pr_info("Replayed %u ESMC frames from %s (not ESMC: %u, unmapped: %u, own: %u)",
+          stats.delivered, g_pcap_socket_in_path, stats.not_esmc, stats.unmapped, stats.own);
+
+  if(g_pcap_socket_exit_delay_s < 0) {
+    pcap_socket_release_clock();
+    return NULL;
+  }
+
+  /* Let the ports drain their queues and the state machines settle for the exit delay of capture time */
+  if(pcap_socket_pace(pcap_socket_get_replay_time_ns() + (g_pcap_socket_exit_delay_s * 1000000000ULL)) < 0) {
+    return NULL;
+  }
+  pcap_socket_release_clock();
+  pr_info("End of capture reached: exiting");
+  kill(getpid(), SIGTERM);
+
+  return NULL;
+}
+
+/* Global functions */
+
+int pcap_socket_init(T_esmc_pcap_config const *config)
+{
+  g_pcap_socket_num_ports = 0;
+  g_pcap_socket_running = 0;
+  g_pcap_socket_speed = config->speed;
+  g_pcap_socket_exit_delay_s = config->exit_delay_s;
+  snprintf(g_pcap_socket_in_path, sizeof(g_pcap_socket_in_path), "%s", config->in_path);
+
+  g_pcap_socket_reader = pcap_reader_open(config->in_path);
+  if(g_pcap_socket_reader == NULL) {
+    pr_err("Failed to open pcap input %s", config->in_path);
+    return -1;
+  }
+
+  os_mutex_init(&g_pcap_socket_clock_mutex);
+  os_cond_init(&g_pcap_socket_clock_cond);
+
+  if((config->out_path != NULL) && (config->out_path[0] != '\0')) {
+    g_pcap_socket_writer = pcap_writer_open(config->out_path);
+    if(g_pcap_socket_writer == NULL) {
+      pr_err("Failed to open pcap output %s", config->out_path);
+      pcap_reader_close(g_pcap_socket_reader);
+      g_pcap_socket_reader = NULL;
+      os_cond_deinit(&g_pcap_socket_clock_cond);
+      os_mutex_deinit(&g_pcap_socket_clock_mutex);
+      return -1;
+    }
+  }
+
+  g_pcap_socket_enabled = 1;
+  pr_info("Replaying %s at speed %d%s", config->in_path, g_pcap_socket_speed, (g_pcap_socket_speed == 0) ? " (as fast as possible)" : "");
+
+  return 0;
+}
+
+int pcap_socket_is_enabled(void)
+{
+  return g_pcap_socket_enabled;
+}
+
+unsigned long long pcap_socket_get_monotonic_milliseconds(void)
+{
+  if(!g_pcap_socket_started) {
+    return os_get_monotonic_milliseconds();
+  }
+
+  return (g_pcap_socket_start_time_ns + (pcap_socket_get_replay_time_ns() - g_pcap_socket_first_frame_time_ns)) / 1000000ULL;
+}
+
+void pcap_socket_sleep(unsigned int timeout_ms)
+{
+  int stepped_flag;
+  int timeout_flag;
+
+  if(!g_pcap_socket_started) {
+    usleep(timeout_ms * 1000);
+    return;
+  }
+  if(g_pcap_socket_speed != 0) {
+    usleep((timeout_ms * 1000) / g_pcap_socket_speed);
+    return;
+  }
+
+  os_mutex_lock(&g_pcap_socket_clock_mutex);
+  g_pcap_socket_main_loop_wake_time_ns = g_pcap_socket_clock_ns + (timeout_ms * 1000000ULL);
+  g_pcap_socket_main_loop_idle_flag = 1;
+  os_cond_broadcast(&g_pcap_socket_clock_cond);
+  while(g_pcap_socket_running && (g_pcap_socket_free_run_time_ns == 0) &&
+        (g_pcap_socket_clock_ns < g_pcap_socket_main_loop_wake_time_ns)) {
+    os_cond_timed_wait(&g_pcap_socket_clock_cond, &g_pcap_socket_clock_mutex, PCAP_SOCKET_WAIT_PERIOD_MS, &timeout_flag);
+  }
+  g_pcap_socket_main_loop_idle_flag = 0;
+  stepped_flag = (g_pcap_socket_clock_ns >= g_pcap_socket_main_loop_wake_time_ns);
+  os_mutex_unlock(&g_pcap_socket_clock_mutex);
+
+  /* Released or stopped clock: wait on the monotonic clock */
+  if(!stepped_flag) {
+    usleep(timeout_ms * 1000);
+  }
+}
+
+int pcap_socket_poll(struct pollfd *poll_fd, int timeout_ms)
+{
+  T_pcap_socket_port *port = pcap_socket_find_port(poll_fd->fd);
+  int timeout_flag = 0;
+
+  if(!g_pcap_socket_started || (g_pcap_socket_speed != 0) || (port == NULL)) {
+    return poll(poll_fd, 1, timeout_ms);
+  }
+
+  /* Caught up with the clock: wait for a frame or the next step */
+  os_mutex_lock(&g_pcap_socket_clock_mutex);
+  port->idle_time_ns = g_pcap_socket_clock_ns;
+  port->idle_flag = 1;
+  os_cond_broadcast(&g_pcap_socket_clock_cond);
+  while(g_pcap_socket_running && (g_pcap_socket_free_run_time_ns == 0) && !timeout_flag &&
+        (port->num_queued == 0) && (port->idle_time_ns == g_pcap_socket_clock_ns)) {
+    os_cond_timed_wait(&g_pcap_socket_clock_cond, &g_pcap_socket_clock_mutex, timeout_ms, &timeout_flag);
+  }
+  port->idle_flag = 0;
+  os_mutex_unlock(&g_pcap_socket_clock_mutex);
+
+  return poll(poll_fd, 1, 0);
+}
+
+int pcap_socket_open(const char *name, T_port_num port_num, struct sockaddr_ll *mac_addr, int rx_flag, const char *pcap_if)
+{
+  T_pcap_socket_port *port;
+  int fds[2];
+
+  (void)port_num;
+
+  if(g_pcap_socket_num_ports == PCAP_SOCKET_MAX_NUM_OF_PORTS) {
+    pr_err("%s: too many ports", __func__);
+    return UNINITIALIZED_FD;
+  }
+
+  if(socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return UNINITIALIZED_FD;
+  }
+
+  port = &g_pcap_socket_ports[g_pcap_socket_num_ports];
+  memset(port, 0, sizeof(*port));
+  port->fd = fds[0];
+  port->peer_fd = fds[1];
+  port->rx_flag = rx_flag;
+  snprintf(port->name, sizeof(port->name), "%s", name);
+  snprintf(port->pcap_if, sizeof(port->pcap_if), "%s", ((pcap_if != NULL) && (pcap_if[0] != '\0')) ? pcap_if : name);
+  memcpy(port->mac_addr, mac_addr->sll_addr, ETH_ALEN);
+  port->writer_if_id = -1;
+
+  if(!rx_flag && (g_pcap_socket_writer != NULL)) {
+    port->writer_if_id = pcap_writer_add_if(g_pcap_socket_writer, name);
+    if(port->writer_if_id < 0) {
+      close(fds[0]);
+      close(fds[1]);
+      return UNINITIALIZED_FD;
+    }
+  }
+
+  g_pcap_socket_num_ports++;
+
+  return port->fd;
+}
+
+int pcap_socket_send(int fd, void *msg, int msg_len)
+{
+  T_pcap_socket_port const *port = pcap_socket_find_port(fd);
+
+  if(port == NULL) {
+    errno = EBADF;
+    return -1;
+  }
+
+  if(port->writer_if_id >= 0) {
+    if(pcap_writer_write(g_pcap_socket_writer, port->writer_if_id, pcap_socket_get_replay_time_ns(), msg, msg_len) < 0) {
+      errno = EIO;
+      return -1;
+    }
+  }
+
+  return msg_len;
+}
+
+int pcap_socket_recv(int fd, void *msg, int msg_len, struct sockaddr_ll *src_addr)
+{
+  T_pcap_socket_port *port = pcap_socket_find_port(fd);
+  int num_bytes;
+
+  num_bytes = (int)recv(fd, msg, msg_len, 0);
+  if((num_bytes >= 0) && (port != NULL)) {
+    os_mutex_lock(&g_pcap_socket_clock_mutex);
+    port->num_queued--;
+    os_mutex_unlock(&g_pcap_socket_clock_mutex);
+  }
+  if(num_bytes >= ETH_HLEN) {
+    src_addr->sll_halen = ETH_ALEN;
+    memcpy(src_addr->sll_addr, (unsigned char *)msg + ETH_ALEN, ETH_ALEN);
+  }
+
+  return num_bytes;
+}
+
+int pcap_socket_close(int fd)
+{
+  T_pcap_socket_port *port = pcap_socket_find_port(fd);
+
+  if(port == NULL) {
+    return close(fd);
+  }
+
+  close(port->peer_fd);
+  port->peer_fd = UNINITIALIZED_FD;
+  port->fd = UNINITIALIZED_FD;
+
+  return close(fd);
+}
+
+int pcap_socket_start(void)
+{
+  if(!g_pcap_socket_enabled || g_pcap_socket_running) {
+    return 0;
+  }
+
+  g_pcap_socket_first_frame_ret = pcap_reader_next(g_pcap_socket_reader, &g_pcap_socket_first_frame);
+  g_pcap_socket_first_frame_time_ns = (g_pcap_socket_first_frame_ret == 1) ? g_pcap_socket_first_frame.time_ns : 0;
+  g_pcap_socket_clock_ns = g_pcap_socket_first_frame_time_ns;
+  g_pcap_socket_free_run_time_ns = 0;
+  g_pcap_socket_main_loop_idle_flag = 0;
+  g_pcap_socket_start_time_ns = pcap_socket_get_monotonic_ns();
+
+  g_pcap_socket_running = 1;
+  g_pcap_socket_started = 1;
+  /* Joinable, so that stop returns only once the replay thread no longer touches the ports */
+  if(pthread_create(&g_pcap_socket_thread, NULL, pcap_socket_thread, NULL) != 0) {
+    g_pcap_socket_running = 0;
+    g_pcap_socket_started = 0;
+    pr_err("Failed to create pcap replay thread");
+    return -1;
+  }
+
+  return 0;
+}
+
+void pcap_socket_stop(void)
+{
+  if(!g_pcap_socket_running) {
+    return;
+  }
+
+  os_mutex_lock(&g_pcap_socket_clock_mutex);
+  g_pcap_socket_running = 0;
+  os_cond_broadcast(&g_pcap_socket_clock_cond);
+  os_mutex_unlock(&g_pcap_socket_clock_mutex);
+  pthread_join(g_pcap_socket_thread, NULL);
+}
+
+void pcap_socket_deinit(void)
+{
+  pcap_socket_stop();
+
+  pcap_reader_close(g_pcap_socket_reader);
+  g_pcap_socket_reader = NULL;
+  pcap_writer_close(g_pcap_socket_writer);
+  g_pcap_socket_writer = NULL;
+
+  if(g_pcap_socket_enabled) {
+    os_cond_deinit(&g_pcap_socket_clock_cond);
+    os_mutex_deinit(&g_pcap_socket_clock_mutex);
+  }
+
+  g_pcap_socket_num_ports = 0;
+  g_pcap_socket_started = 0;
+  g_pcap_socket_enabled = 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file pcap_socket.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#ifndef PCAP_SOCKET_H
+#define PCAP_SOCKET_H
+
+#include <linux/if_packet.h>
+#include <poll.h>
+
+#include "../esmc_adaptor/esmc_adaptor.h"
+
+/*
+ * Pcap replay transport
+ *
+ * Replaces the raw sockets of the ESMC ports for offline runs: frames received by the RX ports are read from a pcap or
+ * pcapng file and frames sent by the TX ports are written to a pcapng file. Each port gets one end of a local datagram
+ * socket pair so that the port threads keep polling and reading file descriptors as they do with raw sockets.
+ *
+ * While replaying, timers run on the replay clock, which follows the capture timestamps. At speed 0 it advances only
+ * as the RX port threads (pcap_socket_poll()) and the main loop (pcap_socket_sleep()) catch up with it.
+ */
+
+int pcap_socket_init(T_esmc_pcap_config const *config);
+int pcap_socket_is_enabled(void);
+unsigned long long pcap_socket_get_monotonic_milliseconds(void);
+void pcap_socket_sleep(unsigned int timeout_ms);
+int pcap_socket_poll(struct pollfd *poll_fd, int timeout_ms);
+int pcap_socket_open(const char *name, T_port_num port_num, struct sockaddr_ll *mac_addr, int rx_flag, const char *pcap_if);
+int pcap_socket_send(int fd, void *msg, int msg_len);
+int pcap_socket_recv(int fd, void *msg, int msg_len, struct sockaddr_ll *src_addr);
+int pcap_socket_close(int fd);
+int pcap_socket_start(void);
+void pcap_socket_stop(void);
+void pcap_socket_deinit(void);
+
+#endif /* PCAP_SOCKET_H */
@@ -20,6 +20,8 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_esmc
+
 #include <errno.h>
 #include <linux/if.h>
 #include <netinet/in.h>
@@ -34,17 +36,21 @@
 #include <unistd.h>
 
 #include "esmc.h"
+#include "pcap_socket.h"
 #include "port.h"
 #include "raw_socket.h"
 #include "../esmc_adaptor/esmc_adaptor.h"
 #include "../../common/common.h"
 #include "../../common/os.h"
 #include "../../common/print.h"
+#include "../../common/probes.h"
+#include "../../common/trace.h"
 #include "../../common/types.h"
 
 
 #define PORT_MAX_NAME_LEN               INTERFACE_MAX_NAME_LEN
 #define PORT_THREAD_WAIT_MICROSECONDS   2000000
+#define PORT_SOCKET_DROPS_PERIOD_MS     1000
 
 typedef enum {
   E_port_type_tx,
@@ -80,10 +86,6 @@ typedef struct {
 
   int fd;
 
-  int port_link_down_flag;
-
-  T_port_ext_ql_tlv_data ext_ql_tlv;
-
   pthread_t thread_id;
   T_port_thread_state thread_state;
 } T_port_cmn_thread_data;
@@ -91,20 +93,19 @@ typedef struct {
 typedef struct {
   T_port_cmn_thread_data cmn_thread_data;
 
+  int port_link_down_flag;
+
   int check_link_status;
+
+  T_port_counters counters;
 } T_port_tx_thread_data;
 
 typedef struct {
   T_port_cmn_thread_data cmn_thread_data;
 
-  unsigned long long rx_timeout_monotonic_time_ms;
-  int rx_timeout_flag;
+  T_port_rx_state rx_state;
 
-  int enhanced_flag;
-
-  T_esmc_ql last_ql;
-
-  int ext_ql_tlv_received_flag;
+  unsigned long long socket_drops_monotonic_time_ms;
 } T_port_rx_thread_data;
 
 struct T_port_tx_data {
@@ -140,7 +141,11 @@ static int port_open_tx(const char *name, T_port_num port_num, struct sockaddr_l
 {
   int fd;
 
-  fd = raw_socket_open(name, port_num, mac_addr);
+  if(pcap_socket_is_enabled()) {
+    fd = pcap_socket_open(name, port_num, mac_addr, 0, NULL);
+  } else {
+    fd = raw_socket_open(name, port_num, mac_addr);
+  }
 
   if(fd == UNINITIALIZED_FD) {
     pr_err("Failed to open TX for port %s (port number: %d)", name, port_num);
@@ -151,11 +156,15 @@ static int port_open_tx(const char *name, T_port_num port_num, struct sockaddr_l
   return fd;
 }
 
-static int port_open_rx(const char *name, T_port_num port_num, struct sockaddr_ll *mac_addr)
+static int port_open_rx(const char *name, T_port_num port_num, struct sockaddr_ll *mac_addr, const char *pcap_if)
 {
   int fd;
 
-  fd = raw_socket_open(name, port_num, mac_addr);
+  if(pcap_socket_is_enabled()) {
+    fd = pcap_socket_open(name, port_num, mac_addr, 1, pcap_if);
+  } else {
+    fd = raw_socket_open(name, port_num, mac_addr);
+  }
 
   if(fd == UNINITIALIZED_FD) {
     pr_err("Failed to open RX for port %s (port number: %d)", name, port_num);
@@ -168,7 +177,112 @@ static int port_open_rx(const char *name, T_port_num port_num, struct sockaddr_l
 
 static void port_close(int fd)
 {
-  raw_socket_close(fd);
+  if(pcap_socket_is_enabled()) {
+    pcap_socket_close(fd);
+  } else {
+    raw_socket_close(fd);
+  }
+}
+
+static int port_send(int fd, void *msg, int msg_len, struct sockaddr_ll *dst_addr)
+{
+  if(pcap_socket_is_enabled()) {
+    return pcap_socket_send(fd, msg, msg_len);
+  }
+
+  return raw_socket_send(fd, msg, msg_len, 0, dst_addr, sizeof(*dst_addr));
+}
+
+static int port_recv(int fd, void *msg, int msg_len, struct sockaddr_ll *src_addr)
+{
+  if(pcap_socket_is_enabled()) {
+    return pcap_socket_recv(fd, msg, msg_len, src_addr);
+  }
+
+  return raw_socket_recv(fd, msg, msg_len, 0, src_addr, sizeof(*src_addr));
+}
+
+/* Allocate zeroed port data aligned for its counters */
+static void *port_alloc(size_t size)
+{
+  void *data;
+
+  if(posix_memalign(&data, PORT_CACHE_LINE_SIZE, size) != 0) {
+    return NULL;
+  }
+
+  memset(data, 0, size);
+
+  return data;
+}
+
+/* Port timers and PDU times follow the replay clock while replaying a capture */
+static unsigned long long port_get_monotonic_milliseconds(void)
+{
+  return pcap_socket_is_enabled() ? pcap_socket_get_monotonic_milliseconds() : os_get_monotonic_milliseconds();
+}
+
+static inline void port_counter_add(uint64_t *counter, uint64_t val)
+{
+  /* Only the port thread writes its counters */
+  __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + val, __ATOMIC_RELAXED);
+}
+
+static void port_count_pdu(T_port_counters *counters, unsigned long long monotonic_time_ms)
+{
+  port_counter_add(&counters->pdus, 1);
+  __atomic_store_n(&counters->last_pdu_monotonic_time_ms, monotonic_time_ms, __ATOMIC_RELAXED);
+}
+
+static void port_count_pdu_type(T_port_counters *counters, T_esmc_pdu_type msg_type)
+{
+  if(msg_type == E_esmc_pdu_type_event) {
+    port_counter_add(&counters->event_pdus, 1);
+  } else {
+    port_counter_add(&counters->information_pdus, 1);
+  }
+}
+
+static void port_update_socket_drops(T_port_rx_thread_data *rx_thread_data)
+{
+  T_port_cmn_thread_data *cmn_thread_data = &rx_thread_data->cmn_thread_data;
+  unsigned long long monotonic_time_ms = port_get_monotonic_milliseconds();
+  unsigned int num_drops;
+
+  if(monotonic_time_ms < rx_thread_data->socket_drops_monotonic_time_ms) {
+    return;
+  }
+  rx_thread_data->socket_drops_monotonic_time_ms = monotonic_time_ms + PORT_SOCKET_DROPS_PERIOD_MS;
+
+  /* Replayed frames wait in the port's queue instead of being dropped */
+  if(pcap_socket_is_enabled()) {
+    return;
+  }
+
+  if((raw_socket_get_drops(cmn_thread_data->fd, &num_drops) == 0) && (num_drops > 0)) {
+    port_counter_add(&rx_thread_data->rx_state.counters.socket_drops, num_drops);
+    pr_warning("%u packets dropped by kernel on port %s (port number: %d)", num_drops, cmn_thread_data->name, cmn_thread_data->port_num);
+  }
+}
+
+static void port_get_stats(T_port_counters const *counters, T_esmc_port_dir_stats *stats)
+{
+  unsigned long long last_pdu_monotonic_time_ms;
+
+  stats->pdus = __atomic_load_n(&counters->pdus, __ATOMIC_RELAXED);
+  stats->event_pdus = __atomic_load_n(&counters->event_pdus, __ATOMIC_RELAXED);
+  stats->information_pdus = __atomic_load_n(&counters->information_pdus, __ATOMIC_RELAXED);
+  stats->errors = __atomic_load_n(&counters->errors, __ATOMIC_RELAXED);
+  stats->invalid_len_pdus = __atomic_load_n(&counters->invalid_len_pdus, __ATOMIC_RELAXED);
+  stats->timing_loops = __atomic_load_n(&counters->timing_loops, __ATOMIC_RELAXED);
+  stats->socket_drops = __atomic_load_n(&counters->socket_drops, __ATOMIC_RELAXED);
+
+  last_pdu_monotonic_time_ms = __atomic_load_n(&counters->last_pdu_monotonic_time_ms, __ATOMIC_RELAXED);
+  if(last_pdu_monotonic_time_ms == 0) {
+    stats->last_pdu_age_ms = -1;
+  } else {
+    stats->last_pdu_age_ms = (long long)(port_get_monotonic_milliseconds() - last_pdu_monotonic_time_ms);
+  }
 }
 
 static const char *conv_port_thread_type_enum_to_str(T_port_thread_type thread_type) {
@@ -219,6 +333,12 @@ static void port_thread_stop(T_port_cmn_thread_data *cmn_thread_data)
 static int port_check_link(int fd, const char *name)
 {
   struct ifreq ifreq;
+
+  /* Replayed ports have no link */
+  if(pcap_socket_is_enabled()) {
+    return 0;
+  }
+
   memset(&ifreq, 0, sizeof(ifreq));
   strncpy(ifreq.ifr_name, name, IFNAMSIZ);
 
@@ -250,6 +370,7 @@ static void *port_tx_thread(void *arg)
   unsigned char src_mac_addr[ETH_ALEN];
   int check_link_status;
   int fd;
+  uint64_t last_best_ql_time_ns = 0;
 
   T_esmc *esmc;
 
@@ -273,6 +394,7 @@ static void *port_tx_thread(void *arg)
 
   strncpy(name, cmn_thread_data->name, PORT_MAX_NAME_LEN);
   port_num = cmn_thread_data->port_num;
+  trace_set_thread_name("tx %s", name);
   memcpy(src_mac_addr, cmn_thread_data->mac_addr.sll_addr, ETH_ALEN);
   check_link_status = tx_thread_data->check_link_status;
   fd = cmn_thread_data->fd;
@@ -297,12 +419,25 @@ static void *port_tx_thread(void *arg)
 
     T_esmc_tx_event_cb_data cb_data;
 
+    T_latency_trace latency_trace;
+
     os_mutex_lock(&esmc->best_ql_mutex);
     if(os_cond_timed_wait(&esmc->best_ql_cond, &esmc->best_ql_mutex, ESMC_TX_HEARTBEAT_PERIOD_MS, &timeout_flag) < 0) {
       goto err;
     }
+    /* Complete each traced best QL change once per port */
+    if((timeout_flag == 0) && (esmc->latency_trace.time_ns[E_latency_point_best_ql] != last_best_ql_time_ns)) {
+      latency_trace = esmc->latency_trace;
+      last_best_ql_time_ns = latency_trace.time_ns[E_latency_point_best_ql];
+    } else {
+      memset(&latency_trace, 0, sizeof(latency_trace));
+    }
     os_mutex_unlock(&esmc->best_ql_mutex);
 
+    if(timeout_flag == 0) {
+      trace_instant(E_trace_span_tx_wakeup, NULL);
+    }
+
     /* Send information ESMC PDU when timeout occurs */
     if(timeout_flag == 1) {
       msg_type = E_esmc_pdu_type_information;
@@ -314,8 +449,8 @@ static void *port_tx_thread(void *arg)
     if(check_link_status != 0) {
       if(port_check_link(fd, name) < 0) {
         /* ESMC TX event : port link down */
-        if(cmn_thread_data->port_link_down_flag == 0) {
-          cmn_thread_data->port_link_down_flag = 1;
+        if(tx_thread_data->port_link_down_flag == 0) {
+          tx_thread_data->port_link_down_flag = 1;
 
           pr_warning("Link went down on port %s (port number: %d)", name, port_num);
 
@@ -327,9 +462,9 @@ static void *port_tx_thread(void *arg)
         }
         /* No need to compose and send the PDU */
         continue;
-      } else if(cmn_thread_data->port_link_down_flag == 1) {
+      } else if(tx_thread_data->port_link_down_flag == 1) {
         /* ESMC TX event : port link up */
-        cmn_thread_data->port_link_down_flag = 0;
+        tx_thread_data->port_link_down_flag = 0;
 
         pr_info("Link is up on port %s (port number: %d)", name, port_num);
 
@@ -345,24 +480,35 @@ static void *port_tx_thread(void *arg)
     msg_len = esmc_compose_pdu(&msg, msg_type, src_mac_addr, &esmc->best_ext_ql_tlv_data, port_num, &composed_ql);
 
     if(msg_len == ESMC_PDU_LEN) {
-      num_bytes_tx = raw_socket_send(fd, &msg, msg_len, 0, &dst_mac_addr, sizeof(dst_mac_addr));
+      trace_begin();
+      num_bytes_tx = port_send(fd, &msg, msg_len, &dst_mac_addr);
+      trace_end(E_trace_span_tx_send, NULL);
       if(num_bytes_tx != ESMC_PDU_LEN) {
-        pr_err("Send failed on port %s (port number: %d): %s", name, port_num, strerror(errno));
+        port_counter_add(&tx_thread_data->counters.errors, 1);
+        pr_err_ratelimited("Send failed on port %s (port number: %d): %s", name, port_num, strerror(errno));
       } else {
         /* Sent ESMC_PDU_LEN bytes */
-        os_mutex_lock(&g_port_print_mutex);
-        pr_debug("<<Sent %s ESMC PDU with %s (%d) (extended QL TLV: %s) on port %s (port number: %d)>>",
-                 (msg_type == E_esmc_pdu_type_event) ? "event" : "information",
-                 conv_ql_enum_to_str(composed_ql),
-                 composed_ql,
-                 (msg.ext_ql_tlv.esmc_e_ssm_code != 0) ? "yes" : "no",
-                 name,
-                 port_num);
+        port_count_pdu(&tx_thread_data->counters, port_get_monotonic_milliseconds());
+        port_count_pdu_type(&tx_thread_data->counters, msg_type);
+        synced_probe4(pdu_tx, port_num, msg_type, composed_ql, num_bytes_tx);
+        latency_trace_mark(&latency_trace, E_latency_point_tx_pdu);
+
+        /* Skip the print mutex when debug messages are off */
+        if(print_is_enabled(LOG_DEBUG)) {
+          os_mutex_lock(&g_port_print_mutex);
+          pr_debug("<<Sent %s ESMC PDU with %s (%d) (extended QL TLV: %s) on port %s (port number: %d)>>",
+                   (msg_type == E_esmc_pdu_type_event) ? "event" : "information",
+                   conv_ql_enum_to_str(composed_ql),
+                   composed_ql,
+                   (msg.ext_ql_tlv.esmc_e_ssm_code != 0) ? "yes" : "no",
+                   name,
+                   port_num);
 
 #if (SYNCED_DEBUG_MODE == 1)
-        esmc_print_esmc_pdu(&msg, E_esmc_print_esmc_pdu_type_tx);
+          esmc_print_esmc_pdu(&msg, E_esmc_print_esmc_pdu_type_tx);
 #endif
-        os_mutex_unlock(&g_port_print_mutex);
+          os_mutex_unlock(&g_port_print_mutex);
+        }
       }
     } else {
       pr_err("Failed to compose ESMC PDU on port %s (port number: %d)", name, port_num);
@@ -380,6 +526,7 @@ static void *port_rx_thread(void *arg)
 {
   T_port_rx_thread_data *rx_thread_data = (T_port_rx_thread_data *)arg;
   T_port_cmn_thread_data *cmn_thread_data;
+  T_port_rx_state *rx_state;
   volatile T_port_thread_state *thread_state;
 
   char name[PORT_MAX_NAME_LEN];
@@ -392,6 +539,7 @@ static void *port_rx_thread(void *arg)
   }
 
   cmn_thread_data = &rx_thread_data->cmn_thread_data;
+  rx_state = &rx_thread_data->rx_state;
   thread_state = &cmn_thread_data->thread_state;
 
   while(*thread_state != E_port_thread_state_starting) {
@@ -403,30 +551,26 @@ static void *port_rx_thread(void *arg)
   strncpy(name, cmn_thread_data->name, PORT_MAX_NAME_LEN);
   port_num = cmn_thread_data->port_num;
   fd = cmn_thread_data->fd;
+  trace_set_thread_name("rx %s", name);
 
-  rx_thread_data->last_ql = E_esmc_ql_max;
+  rx_state->last_ql = E_esmc_ql_max;
 
   /* Initialize RX timeout monotonic time */
-  rx_thread_data->rx_timeout_monotonic_time_ms = os_get_monotonic_milliseconds() + (ESMC_RX_TIMEOUT_PERIOD_S * 1000);
-  rx_thread_data->rx_timeout_flag = 0;
+  rx_state->rx_timeout_monotonic_time_ms = port_get_monotonic_milliseconds() + (ESMC_RX_TIMEOUT_PERIOD_S * 1000);
+  rx_state->rx_timeout_flag = 0;
 
   while(*thread_state == E_port_thread_state_started) {
     struct pollfd poll_fd;
     int ret;
-    T_esmc_rx_event_cb_data cb_data;
     T_esmc_pdu msg;
     struct sockaddr_ll src_mac_addr;
-    unsigned char originator_mac_addr[ETH_ALEN];
     int num_bytes_rx;
+    uint64_t rx_time_ns;
 
-    int enhanced_flag = 0;
-    int ql_change_flag;
-    int ext_ql_tlv_change_flag;
-
-    T_esmc_ql parsed_ql = rx_thread_data->last_ql;
-    T_port_ext_ql_tlv_data parsed_ext_ql_tlv_data;
-
-    usleep(ESMC_RX_HEARTBEAT_PERIOD_MS * 1000);
+    /* Replayed frames are read as soon as they are queued so that replay is not limited by the heartbeat */
+    if(!pcap_socket_is_enabled()) {
+      usleep(ESMC_RX_HEARTBEAT_PERIOD_MS * 1000);
+    }
 
     memset(&src_mac_addr, 0, sizeof(src_mac_addr));
 
@@ -434,178 +578,74 @@ static void *port_rx_thread(void *arg)
     poll_fd.fd = fd;
     poll_fd.events = POLLIN;
     
-    ret = poll(&poll_fd, 1, 0);
+    if(pcap_socket_is_enabled()) {
+      ret = pcap_socket_poll(&poll_fd, ESMC_RX_HEARTBEAT_PERIOD_MS);
+    } else {
+      ret = poll(&poll_fd, 1, 0);
+    }
 
     if((ret > 0) && (poll_fd.revents & POLLIN)) {
-      num_bytes_rx = raw_socket_recv(fd, &msg, sizeof(msg), 0, &src_mac_addr, sizeof(src_mac_addr));
-      if(cmn_thread_data->port_link_down_flag == 0) {
-        if(num_bytes_rx >= ESMC_PDU_LEN) {
-          if(esmc_parse_pdu(&msg, &enhanced_flag, &parsed_ql, &parsed_ext_ql_tlv_data) < 0) {
-            /* ESMC RX event: invalid QL */
-            pr_err("Failed to parse ESMC PDU on port %s (port number: %d)", name, port_num);
-
-            memset(&cb_data, 0, sizeof(cb_data));
-            cb_data.event_type = E_esmc_event_type_invalid_rx_ql;
-            cb_data.port_num = port_num;
-
-            esmc_call_rx_cb(&cb_data);
-          } else {
-            /* Check the source MAC address and the originator clock */
-            if(esmc_adaptor_check_mac_addr(src_mac_addr.sll_addr) != 0) {
-              /* ESMC RX event: immediate timing loop */
-              memset(&cb_data, 0, sizeof(cb_data));
-              cb_data.event_type = E_esmc_event_type_immediate_timing_loop;
-              cb_data.port_num = port_num;
-              cb_data.event_data.timing_loop.mac_addr = src_mac_addr.sll_addr;
-
-              esmc_call_rx_cb(&cb_data);
-            } else if(enhanced_flag) {
-              extract_mac_addr(parsed_ext_ql_tlv_data.originator_clock_id, originator_mac_addr);
-              if(esmc_adaptor_check_mac_addr(originator_mac_addr) != 0) {
-                /* ESMC RX event: originator timing loop */
-                memset(&cb_data, 0, sizeof(cb_data));
-                cb_data.event_type = E_esmc_event_type_originator_timing_loop;
-                cb_data.port_num = port_num;
-                cb_data.event_data.timing_loop.mac_addr = originator_mac_addr;
-
-                esmc_call_rx_cb(&cb_data);
-              }
-            }
-
-            rx_thread_data->enhanced_flag = enhanced_flag;
-
-            ql_change_flag = (parsed_ql != rx_thread_data->last_ql);
-
-            if(ql_change_flag) {
-              /* ESMC RX event: QL change */
-              pr_info("QL changed to %s (%d) on port %s (port number: %d)",
-                      conv_ql_enum_to_str(parsed_ql),
-                      parsed_ql,
-                      name,
-                      port_num);
-
-              memset(&cb_data, 0, sizeof(cb_data));
-              cb_data.event_type = E_esmc_event_type_ql_change;
-              cb_data.port_num = port_num;
-              cb_data.event_data.ql_change.new_ql = parsed_ql;
-
-              if(enhanced_flag) {
-                /* Received extended QL TLV */
-
-                /* memcmp() returns non-zero value if there is difference (i.e. change in extended QL TLV data) */
-                ext_ql_tlv_change_flag = memcmp(&parsed_ext_ql_tlv_data, &cmn_thread_data->ext_ql_tlv, sizeof(parsed_ext_ql_tlv_data));
-
-                if(ext_ql_tlv_change_flag != 0) {
-                  /* Extended QL TLV change */
-                  pr_info("Extended QL TLV data changed on port %s (port number: %d)",
-                          name,
-                          port_num);
-
-                  cb_data.event_data.ql_change.new_num_cascaded_eEEC = parsed_ext_ql_tlv_data.num_cascaded_eEEC;
-                  cb_data.event_data.ql_change.new_num_cascaded_EEC = parsed_ext_ql_tlv_data.num_cascaded_EEC;
-                }
-
-                /* Store parsed extended QL TLV data */
-                memcpy(&cmn_thread_data->ext_ql_tlv, &parsed_ext_ql_tlv_data, sizeof(cmn_thread_data->ext_ql_tlv));
-              }
-
-              esmc_call_rx_cb(&cb_data);
-
-              /* Store parsed QL */
-              rx_thread_data->last_ql = parsed_ql;
-            }
-
-            if(enhanced_flag) {
-              if(rx_thread_data->ext_ql_tlv_received_flag == 0) {
-                rx_thread_data->ext_ql_tlv_received_flag = 1;
-                pr_warning("Extended QL TLV appeared on port %s (port number: %d)", name, port_num);
-              }
-            } else if(rx_thread_data->ext_ql_tlv_received_flag == 1) {
-              rx_thread_data->ext_ql_tlv_received_flag = 0;
-              pr_warning("Extended QL TLV disappeared on port %s (port number: %d)", name, port_num);
-            }
-
-            /* Recalculate RX timeout monotonic time */
-            rx_thread_data->rx_timeout_monotonic_time_ms = os_get_monotonic_milliseconds() + (ESMC_RX_TIMEOUT_PERIOD_S * 1000);
-            rx_thread_data->rx_timeout_flag = 0;
-            os_mutex_lock(&g_port_print_mutex);
-            pr_debug(">>Received ESMC PDU with %s (%d) (extended QL TLV: %s) on port %s (port number: %d)<<",
-                    conv_ql_enum_to_str(parsed_ql),
-                    parsed_ql,
-                    (enhanced_flag == 1) ? "yes" : "no",
-                    name,
-                    port_num);
-#if (SYNCED_DEBUG_MODE == 1)
-            esmc_print_esmc_pdu(&msg, E_esmc_print_esmc_pdu_type_rx);
-#endif
-            os_mutex_unlock(&g_port_print_mutex);
-          }
-        } else {
-          pr_err("Invalid ESMC PDU length %d on port %s (port number: %d)", num_bytes_rx, name, port_num);
-        }
-      }
+      num_bytes_rx = port_recv(fd, &msg, sizeof(msg), &src_mac_addr);
+      rx_time_ns = latency_get_time_ns();
+      trace_instant(E_trace_span_rx_wakeup, NULL);
+      synced_probe2(pdu_rx, port_num, num_bytes_rx);
+      port_rx_state_process_pdu(rx_state, &msg, num_bytes_rx, src_mac_addr.sll_addr, rx_time_ns);
     } else if(ret < 0) {
       /* Timeout */
-      pr_err("Failed to poll on port %s (port number: %d): %s", name, port_num, strerror(errno));
+      pr_err_ratelimited("Failed to poll on port %s (port number: %d): %s", name, port_num, strerror(errno));
     } else if(poll_fd.revents & POLLERR) {
       /* Error occurred */
-      pr_err("Detected poll error on port %s (port number: %d)", name, port_num);
+      pr_err_ratelimited("Detected poll error on port %s (port number: %d)", name, port_num);
     }
 
-    if(port_check_link(fd, name) < 0) {
-      if(cmn_thread_data->port_link_down_flag == 0) {
-        /* ESMC RX event: port link down */
-        cmn_thread_data->port_link_down_flag = 1;
-
-        pr_warning("Link went down on port %s (port number: %d)", name, port_num);
+    port_update_socket_drops(rx_thread_data);
 
-        memset(&cb_data, 0, sizeof(cb_data));
-        cb_data.event_type = E_esmc_event_type_port_link_down;
-        cb_data.port_num = port_num;
+    port_rx_state_check_link(rx_state, port_check_link(fd, name) == 0);
+    port_rx_state_check_timeout(rx_state);
+  }
 
-        esmc_call_rx_cb(&cb_data);
-        rx_thread_data->last_ql = E_esmc_ql_max;
-      }
-    } else if(cmn_thread_data->port_link_down_flag == 1) {
-      /* ESMC RX event: port link up */
-      cmn_thread_data->port_link_down_flag = 0;
+  *thread_state = (*thread_state == E_port_thread_state_stopping) ? E_port_thread_state_stopped : *thread_state;
 
-      pr_info("Link is up on port %s (port number: %d)", name, port_num);
+err:
+  pthread_exit(NULL);
+}
 
-      memset(&cb_data, 0, sizeof(cb_data));
-      cb_data.event_type = E_esmc_event_type_port_link_up;
-      cb_data.port_num = port_num;
+static unsigned long long port_rx_ops_get_monotonic_milliseconds(void *ctx)
+{
+  (void)ctx;
 
-      esmc_call_rx_cb(&cb_data);
-      rx_thread_data->last_ql = E_esmc_ql_max;
-    }
+  return port_get_monotonic_milliseconds();
+}
 
-    if(rx_thread_data->rx_timeout_flag == 0) {
-      if(os_get_monotonic_milliseconds() > rx_thread_data->rx_timeout_monotonic_time_ms) {
-        /* ESMC RX event: RX timeout */
-        rx_thread_data->rx_timeout_flag = 1;
+static int port_rx_ops_check_mac_addr(void *ctx, const unsigned char mac_addr[ETH_ALEN])
+{
+  (void)ctx;
 
-        pr_info("RX timeout occurred (QL not received within %d seconds period) on port %s (port number: %d)",
-                ESMC_RX_TIMEOUT_PERIOD_S,
-                name,
-                port_num);
+  return esmc_adaptor_check_mac_addr(mac_addr);
+}
 
-        memset(&cb_data, 0, sizeof(cb_data));
-        cb_data.event_type = E_esmc_event_type_rx_timeout;
-        cb_data.port_num = port_num;
+static void port_rx_ops_rx_event(void *ctx, T_esmc_rx_event_cb_data *cb_data)
+{
+  (void)ctx;
 
-        esmc_call_rx_cb(&cb_data);
-        rx_thread_data->last_ql = E_esmc_ql_max;
-      }
-    }
-  }
+  esmc_call_rx_cb(cb_data);
+}
 
-  *thread_state = (*thread_state == E_port_thread_state_stopping) ? E_port_thread_state_stopped : *thread_state;
+static void port_rx_state_call_event(T_port_rx_state *rx_state, T_esmc_event_type event_type, T_esmc_rx_event_cb_data *cb_data)
+{
+  cb_data->event_type = event_type;
+  cb_data->port_num = rx_state->port_num;
 
-err:
-  pthread_exit(NULL);
+  rx_state->ops->rx_event(rx_state->ops->ctx, cb_data);
 }
 
+static const T_port_rx_ops g_port_rx_ops = {
+  NULL,
+  port_rx_ops_get_monotonic_milliseconds,
+  port_rx_ops_check_mac_addr,
+  port_rx_ops_rx_event
+};
+
 /* Global functions */
 
 T_port_tx_data *port_tx_create(T_tx_port_info const *tx_port)
@@ -614,7 +654,7 @@ T_port_tx_data *port_tx_create(T_tx_port_info const *tx_port)
   struct sockaddr_ll mac_addr;
   int fd;
 
-  tx_p = calloc(1, sizeof(*tx_p));
+  tx_p = port_alloc(sizeof(*tx_p));
   if(!tx_p) {
     return NULL;
   }
@@ -659,7 +699,7 @@ T_port_rx_data *port_rx_create(T_rx_port_info const *rx_port)
   struct sockaddr_ll mac_addr;
   int fd;
 
-  rx_p = calloc(1, sizeof(*rx_p));
+  rx_p = port_alloc(sizeof(*rx_p));
   if(!rx_p) {
     return NULL;
   }
@@ -667,7 +707,7 @@ T_port_rx_data *port_rx_create(T_rx_port_info const *rx_port)
   memset(&mac_addr, 0, sizeof(mac_addr));
   memcpy(mac_addr.sll_addr, rx_port->mac_addr, ETH_ALEN);
 
-  fd = port_open_rx(rx_port->name, rx_port->port_num, &mac_addr);
+  fd = port_open_rx(rx_port->name, rx_port->port_num, &mac_addr, rx_port->pcap_if);
   if(fd == UNINITIALIZED_FD) {
     free(rx_p);
     return NULL;
@@ -677,6 +717,7 @@ T_port_rx_data *port_rx_create(T_rx_port_info const *rx_port)
   rx_p->thread_data.cmn_thread_data.port_num = rx_port->port_num;
   memcpy(rx_p->thread_data.cmn_thread_data.mac_addr.sll_addr, mac_addr.sll_addr, ETH_ALEN);
   rx_p->thread_data.cmn_thread_data.fd = fd;
+  port_rx_state_init(&rx_p->thread_data.rx_state, rx_p->thread_data.cmn_thread_data.name, rx_port->port_num, esmc_get_stack_data(), &g_port_rx_ops);
 
   if(os_thread_create(&rx_p->thread_data.cmn_thread_data.thread_id, port_rx_thread, &rx_p->thread_data) < 0) {
     port_close(fd);
@@ -700,17 +741,11 @@ T_port_rx_data *port_rx_create(T_rx_port_info const *rx_port)
 void port_tx_init(T_port_tx_data *tx_p)
 {
   tx_p->state = E_port_state_initialized;
-
-  tx_p->thread_data.cmn_thread_data.ext_ql_tlv.num_cascaded_eEEC = 1;
-  tx_p->thread_data.cmn_thread_data.ext_ql_tlv.num_cascaded_EEC = 0;
 }
 
 void port_rx_init(T_port_rx_data *rx_p)
 {
   rx_p->state = E_port_state_initialized;
-
-  rx_p->thread_data.cmn_thread_data.ext_ql_tlv.num_cascaded_eEEC = 1;
-  rx_p->thread_data.cmn_thread_data.ext_ql_tlv.num_cascaded_EEC = 0;
 }
 
 int port_tx_check(T_port_tx_data *tx_p)
@@ -754,24 +789,31 @@ int port_get_rx_ext_ql_tlv_data(T_port_rx_data *rx_p, T_port_num best_port_num,
   T_port_cmn_thread_data *cmn_thread_data = &rx_p->thread_data.cmn_thread_data;
 
   if(best_port_num == cmn_thread_data->port_num) {
-    if(rx_p->thread_data.ext_ql_tlv_received_flag == 0) {
-      best_ext_ql_tlv_data->num_cascaded_eEEC = 0;
-      best_ext_ql_tlv_data->num_cascaded_EEC = 1;
-      best_ext_ql_tlv_data->mixed_EEC_eEEC = 1;
-      best_ext_ql_tlv_data->partial_chain = 1;
+    port_rx_state_get_ext_ql_tlv_data(&rx_p->thread_data.rx_state, best_ext_ql_tlv_data);
+    return 1;
+  }
 
-      memset(best_ext_ql_tlv_data->originator_clock_id, 0, ESMC_PDU_EXT_QL_TLV_SYNCE_CLOCK_ID_LEN);
-    } else {
-      best_ext_ql_tlv_data->num_cascaded_eEEC = cmn_thread_data->ext_ql_tlv.num_cascaded_eEEC;
-      best_ext_ql_tlv_data->num_cascaded_EEC = cmn_thread_data->ext_ql_tlv.num_cascaded_EEC;
-      best_ext_ql_tlv_data->mixed_EEC_eEEC = cmn_thread_data->ext_ql_tlv.mixed_EEC_eEEC;
-      best_ext_ql_tlv_data->partial_chain = cmn_thread_data->ext_ql_tlv.partial_chain;
+  return 0;
+}
 
-      memcpy(best_ext_ql_tlv_data->originator_clock_id, cmn_thread_data->ext_ql_tlv.originator_clock_id, ESMC_PDU_EXT_QL_TLV_SYNCE_CLOCK_ID_LEN);
-    }
+int port_tx_get_stats(T_port_tx_data *tx_p, T_port_num port_num, T_esmc_port_dir_stats *stats)
+{
+  T_port_cmn_thread_data *cmn_thread_data = &tx_p->thread_data.cmn_thread_data;
+
+  if(port_num == cmn_thread_data->port_num) {
+    port_get_stats(&tx_p->thread_data.counters, stats);
+    return 1;
+  }
+
+  return 0;
+}
 
-    best_ext_ql_tlv_data->num_cascaded_eEEC++;
+int port_rx_get_stats(T_port_rx_data *rx_p, T_port_num port_num, T_esmc_port_dir_stats *stats)
+{
+  T_port_cmn_thread_data *cmn_thread_data = &rx_p->thread_data.cmn_thread_data;
 
+  if(port_num == cmn_thread_data->port_num) {
+    port_get_stats(&rx_p->thread_data.rx_state.counters, stats);
     return 1;
   }
 
@@ -829,3 +871,218 @@ void port_rx_close(T_port_rx_data *rx_p)
   cmn_thread_data->fd = UNINITIALIZED_FD;
   rx_p->state = E_port_state_unknown;
 }
+
+void port_rx_state_init(T_port_rx_state *rx_state, const char *name, T_port_num port_num, T_esmc const *esmc, T_port_rx_ops const *ops)
+{
+  memset(rx_state, 0, sizeof(*rx_state));
+
+  rx_state->name = name;
+  rx_state->port_num = port_num;
+  rx_state->esmc = esmc;
+  rx_state->ops = ops;
+
+  rx_state->last_ql = E_esmc_ql_max;
+
+  rx_state->ext_ql_tlv.num_cascaded_eEEC = 1;
+  rx_state->ext_ql_tlv.num_cascaded_EEC = 0;
+
+  rx_state->rx_timeout_monotonic_time_ms = ops->get_monotonic_milliseconds(ops->ctx) + (ESMC_RX_TIMEOUT_PERIOD_S * 1000);
+}
+
+void port_rx_state_process_pdu(T_port_rx_state *rx_state, T_esmc_pdu *msg, int num_bytes_rx, unsigned char src_mac_addr[ETH_ALEN], uint64_t rx_time_ns)
+{
+  T_port_rx_ops const *ops = rx_state->ops;
+  const char *name = rx_state->name;
+  T_port_num port_num = rx_state->port_num;
+  T_esmc_rx_event_cb_data cb_data;
+  unsigned char originator_mac_addr[ETH_ALEN];
+  int parse_ret;
+
+  int enhanced_flag = 0;
+  int ext_ql_tlv_change_flag;
+
+  T_esmc_ql parsed_ql = rx_state->last_ql;
+  T_port_ext_ql_tlv_data parsed_ext_ql_tlv_data;
+
+  if(rx_state->port_link_down_flag == 1) {
+    return;
+  }
+
+  if(num_bytes_rx < ESMC_PDU_LEN) {
+    port_counter_add(&rx_state->counters.invalid_len_pdus, 1);
+    pr_err_ratelimited("Invalid ESMC PDU length %d on port %s (port number: %d)", num_bytes_rx, name, port_num);
+    return;
+  }
+
+  port_count_pdu(&rx_state->counters, ops->get_monotonic_milliseconds(ops->ctx));
+  trace_begin();
+  parse_ret = esmc_instance_parse_pdu(rx_state->esmc, msg, &enhanced_flag, &parsed_ql, &parsed_ext_ql_tlv_data);
+  trace_end(E_trace_span_rx_parse, NULL);
+  synced_probe4(pdu_parse, port_num, parse_ret, parsed_ql, enhanced_flag);
+  if(parse_ret < 0) {
+    /* ESMC RX event: invalid QL */
+    port_counter_add(&rx_state->counters.errors, 1);
+    pr_err_ratelimited("Failed to parse ESMC PDU on port %s (port number: %d)", name, port_num);
+
+    memset(&cb_data, 0, sizeof(cb_data));
+    port_rx_state_call_event(rx_state, E_esmc_event_type_invalid_rx_ql, &cb_data);
+    return;
+  }
+
+  port_count_pdu_type(&rx_state->counters, esmc_get_pdu_type(msg));
+
+  /* Check the source MAC address and the originator clock */
+  if(ops->check_mac_addr(ops->ctx, src_mac_addr) != 0) {
+    /* ESMC RX event: immediate timing loop */
+    port_counter_add(&rx_state->counters.timing_loops, 1);
+    memset(&cb_data, 0, sizeof(cb_data));
+    cb_data.event_data.timing_loop.mac_addr = src_mac_addr;
+    port_rx_state_call_event(rx_state, E_esmc_event_type_immediate_timing_loop, &cb_data);
+  } else if(enhanced_flag) {
+    extract_mac_addr(parsed_ext_ql_tlv_data.originator_clock_id, originator_mac_addr);
+    if(ops->check_mac_addr(ops->ctx, originator_mac_addr) != 0) {
+      /* ESMC RX event: originator timing loop */
+      port_counter_add(&rx_state->counters.timing_loops, 1);
+      memset(&cb_data, 0, sizeof(cb_data));
+      cb_data.event_data.timing_loop.mac_addr = originator_mac_addr;
+      port_rx_state_call_event(rx_state, E_esmc_event_type_originator_timing_loop, &cb_data);
+    }
+  }
+
+  rx_state->enhanced_flag = enhanced_flag;
+
+  if(parsed_ql != rx_state->last_ql) {
+    /* ESMC RX event: QL change */
+    pr_info("QL changed to %s (%d) on port %s (port number: %d)",
+            conv_ql_enum_to_str(parsed_ql),
+            parsed_ql,
+            name,
+            port_num);
+
+    memset(&cb_data, 0, sizeof(cb_data));
+    cb_data.event_data.ql_change.new_ql = parsed_ql;
+    cb_data.rx_time_ns = rx_time_ns;
+
+    if(enhanced_flag) {
+      /* Received extended QL TLV */
+
+      /* memcmp() returns non-zero value if there is difference (i.e. change in extended QL TLV data) */
+      ext_ql_tlv_change_flag = memcmp(&parsed_ext_ql_tlv_data, &rx_state->ext_ql_tlv, sizeof(parsed_ext_ql_tlv_data));
+
+      if(ext_ql_tlv_change_flag != 0) {
+        /* Extended QL TLV change */
+        pr_info("Extended QL TLV data changed on port %s (port number: %d)",
+                name,
+                port_num);
+
+        cb_data.event_data.ql_change.new_num_cascaded_eEEC = parsed_ext_ql_tlv_data.num_cascaded_eEEC;
+        cb_data.event_data.ql_change.new_num_cascaded_EEC = parsed_ext_ql_tlv_data.num_cascaded_EEC;
+      }
+
+      /* Store parsed extended QL TLV data */
+      memcpy(&rx_state->ext_ql_tlv, &parsed_ext_ql_tlv_data, sizeof(rx_state->ext_ql_tlv));
+    }
+
+    port_rx_state_call_event(rx_state, E_esmc_event_type_ql_change, &cb_data);
+
+    /* Store parsed QL */
+    rx_state->last_ql = parsed_ql;
+  }
+
+  if(enhanced_flag) {
+    if(rx_state->ext_ql_tlv_received_flag == 0) {
+      rx_state->ext_ql_tlv_received_flag = 1;
+      pr_warning("Extended QL TLV appeared on port %s (port number: %d)", name, port_num);
+    }
+  } else if(rx_state->ext_ql_tlv_received_flag == 1) {
+    rx_state->ext_ql_tlv_received_flag = 0;
+    pr_warning("Extended QL TLV disappeared on port %s (port number: %d)", name, port_num);
+  }
+
+  /* Recalculate RX timeout monotonic time */
+  rx_state->rx_timeout_monotonic_time_ms = ops->get_monotonic_milliseconds(ops->ctx) + (ESMC_RX_TIMEOUT_PERIOD_S * 1000);
+  rx_state->rx_timeout_flag = 0;
+  if(print_is_enabled(LOG_DEBUG)) {
+    os_mutex_lock(&g_port_print_mutex);
+    pr_debug(">>Received ESMC PDU with %s (%d) (extended QL TLV: %s) on port %s (port number: %d)<<",
+            conv_ql_enum_to_str(parsed_ql),
+            parsed_ql,
+            (enhanced_flag == 1) ? "yes" : "no",
+            name,
+            port_num);
+#if (SYNCED_DEBUG_MODE == 1)
+    esmc_print_esmc_pdu(msg, E_esmc_print_esmc_pdu_type_rx);
+#endif
+    os_mutex_unlock(&g_port_print_mutex);
+  }
+}
+
+void port_rx_state_check_link(T_port_rx_state *rx_state, int link_up_flag)
+{
+  T_esmc_rx_event_cb_data cb_data;
+
+  if(!link_up_flag) {
+    if(rx_state->port_link_down_flag == 0) {
+      /* ESMC RX event: port link down */
+      rx_state->port_link_down_flag = 1;
+
+      pr_warning("Link went down on port %s (port number: %d)", rx_state->name, rx_state->port_num);
+
+      memset(&cb_data, 0, sizeof(cb_data));
+      port_rx_state_call_event(rx_state, E_esmc_event_type_port_link_down, &cb_data);
+      rx_state->last_ql = E_esmc_ql_max;
+    }
+  } else if(rx_state->port_link_down_flag == 1) {
+    /* ESMC RX event: port link up */
+    rx_state->port_link_down_flag = 0;
+
+    pr_info("Link is up on port %s (port number: %d)", rx_state->name, rx_state->port_num);
+
+    memset(&cb_data, 0, sizeof(cb_data));
+    port_rx_state_call_event(rx_state, E_esmc_event_type_port_link_up, &cb_data);
+    rx_state->last_ql = E_esmc_ql_max;
+  }
+}
+
+void port_rx_state_check_timeout(T_port_rx_state *rx_state)
+{
+  T_port_rx_ops const *ops = rx_state->ops;
+  T_esmc_rx_event_cb_data cb_data;
+
+  if(rx_state->rx_timeout_flag == 0) {
+    if(ops->get_monotonic_milliseconds(ops->ctx) > rx_state->rx_timeout_monotonic_time_ms) {
+      /* ESMC RX event: RX timeout */
+      rx_state->rx_timeout_flag = 1;
+
+      pr_info("RX timeout occurred (QL not received within %d seconds period) on port %s (port number: %d)",
+              ESMC_RX_TIMEOUT_PERIOD_S,
+              rx_state->name,
+              rx_state->port_num);
+
+      memset(&cb_data, 0, sizeof(cb_data));
+      port_rx_state_call_event(rx_state, E_esmc_event_type_rx_timeout, &cb_data);
+      rx_state->last_ql = E_esmc_ql_max;
+    }
+  }
+}
+
+void port_rx_state_get_ext_ql_tlv_data(T_port_rx_state const *rx_state, T_port_ext_ql_tlv_data *best_ext_ql_tlv_data)
+{
+  if(rx_state->ext_ql_tlv_received_flag == 0) {
+    best_ext_ql_tlv_data->num_cascaded_eEEC = 0;
+    best_ext_ql_tlv_data->num_cascaded_EEC = 1;
+    best_ext_ql_tlv_data->mixed_EEC_eEEC = 1;
+    best_ext_ql_tlv_data->partial_chain = 1;
+
+    memset(best_ext_ql_tlv_data->originator_clock_id, 0, ESMC_PDU_EXT_QL_TLV_SYNCE_CLOCK_ID_LEN);
+  } else {
+    best_ext_ql_tlv_data->num_cascaded_eEEC = rx_state->ext_ql_tlv.num_cascaded_eEEC;
+    best_ext_ql_tlv_data->num_cascaded_EEC = rx_state->ext_ql_tlv.num_cascaded_EEC;
+    best_ext_ql_tlv_data->mixed_EEC_eEEC = rx_state->ext_ql_tlv.mixed_EEC_eEEC;
+    best_ext_ql_tlv_data->partial_chain = rx_state->ext_ql_tlv.partial_chain;
+
+    memcpy(best_ext_ql_tlv_data->originator_clock_id, rx_state->ext_ql_tlv.originator_clock_id, ESMC_PDU_EXT_QL_TLV_SYNCE_CLOCK_ID_LEN);
+  }
+
+  best_ext_ql_tlv_data->num_cascaded_eEEC++;
+}
@@ -28,6 +28,13 @@
 #include "../common/common.h"
 #include "../esmc_adaptor/esmc_adaptor.h"
 
+#define PORT_CACHE_LINE_SIZE   64
+
+/* Defined in esmc.h, which includes this header */
+struct esmc;
+union esmc_pdu;
+struct esmc_rx_event_cb_data;
+
 typedef struct {
   unsigned char originator_clock_id[MAX_CLK_ID_LEN];
   int mixed_EEC_eEEC;                                /* Equivalent to ITU-T G.8264 (08/2017) Amd. 1 (03/2018) bit 0 of extended QL TLV flag field */
@@ -36,6 +43,56 @@ typedef struct {
   int num_cascaded_EEC;
 } T_port_ext_ql_tlv_data;
 
+/*
+ * ESMC traffic counters
+ *
+ * Counters are only written by the port thread, so they are updated without locks or atomic read-modify-write
+ * operations. The block starts on its own cache line, so management readers do not slow down the port thread.
+ */
+typedef struct {
+  uint64_t pdus;
+  uint64_t event_pdus;
+  uint64_t information_pdus;
+  uint64_t errors;
+  uint64_t invalid_len_pdus;
+  uint64_t timing_loops;
+  uint64_t socket_drops;
+  uint64_t last_pdu_monotonic_time_ms;        /* 0 if no PDU yet */
+} __attribute__((aligned(PORT_CACHE_LINE_SIZE))) T_port_counters;
+
+/*
+ * ESMC stack seen by the receive side of a port. RX threads use the stack of synced, the monotonic clock (the pcap
+ * replay clock while replaying a capture) and esmc_call_rx_cb(); a simulator provides them per node.
+ */
+typedef struct {
+  void *ctx;
+  unsigned long long (*get_monotonic_milliseconds)(void *ctx);
+  int (*check_mac_addr)(void *ctx, const unsigned char mac_addr[ETH_ALEN]);   /* Non-zero for an own MAC address */
+  void (*rx_event)(void *ctx, struct esmc_rx_event_cb_data *cb_data);
+} T_port_rx_ops;
+
+/* Receive state of a port, only written by the thread that runs the port_rx_state_*() functions on it */
+typedef struct {
+  const char *name;
+  T_port_num port_num;
+  struct esmc const *esmc;
+  T_port_rx_ops const *ops;
+
+  int port_link_down_flag;
+
+  unsigned long long rx_timeout_monotonic_time_ms;
+  int rx_timeout_flag;
+
+  int enhanced_flag;
+
+  T_esmc_ql last_ql;
+
+  T_port_ext_ql_tlv_data ext_ql_tlv;
+  int ext_ql_tlv_received_flag;
+
+  T_port_counters counters;
+} T_port_rx_state;
+
 typedef struct T_port_tx_data T_port_tx_data;
 typedef struct T_port_rx_data T_port_rx_data;
 
@@ -50,6 +107,9 @@ int port_rx_check(T_port_rx_data *rx_p);
 
 int port_get_rx_ext_ql_tlv_data(T_port_rx_data *rx_p, T_port_num best_port_num, T_port_ext_ql_tlv_data *best_ext_ql_tlv_data);
 
+int port_tx_get_stats(T_port_tx_data *tx_p, T_port_num port_num, T_esmc_port_dir_stats *stats);
+int port_rx_get_stats(T_port_rx_data *rx_p, T_port_num port_num, T_esmc_port_dir_stats *stats);
+
 void port_tx_stop(T_port_tx_data *tx_p);
 void port_tx_wait_stop(T_port_tx_data *tx_p);
 void port_tx_close(T_port_tx_data *tx_p);
@@ -58,5 +118,17 @@ void port_rx_stop(T_port_rx_data *rx_p);
 void port_rx_wait_stop(T_port_rx_data *rx_p);
 void port_rx_close(T_port_rx_data *rx_p);
 
+/*
+ * Receive side of a port without its socket, shared by the RX threads and the network simulator.
+ * port_rx_state_process_pdu() handles one received frame of num_bytes_rx bytes (rx_time_ns is its arrival time for
+ * latency tracing, 0 if not traced); port_rx_state_check_link() and port_rx_state_check_timeout() run after every
+ * heartbeat.
+ */
+void port_rx_state_init(T_port_rx_state *rx_state, const char *name, T_port_num port_num, struct esmc const *esmc, T_port_rx_ops const *ops);
+void port_rx_state_process_pdu(T_port_rx_state *rx_state, union esmc_pdu *msg, int num_bytes_rx, unsigned char src_mac_addr[ETH_ALEN], uint64_t rx_time_ns);
+void port_rx_state_check_link(T_port_rx_state *rx_state, int link_up_flag);
+void port_rx_state_check_timeout(T_port_rx_state *rx_state);
+void port_rx_state_get_ext_ql_tlv_data(T_port_rx_state const *rx_state, T_port_ext_ql_tlv_data *best_ext_ql_tlv_data);
+
 
 #endif /* PORT_H */
@@ -20,6 +20,8 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_esmc
+
 #include <arpa/inet.h>
 #include <errno.h>
 #include <linux/filter.h>
@@ -159,6 +161,21 @@ int raw_socket_recv(int fd, void *msg, int msg_len, int flags, struct sockaddr_l
   return (int)recvfrom(fd, msg, msg_len, flags, (struct sockaddr *)src_addr, (socklen_t *)&src_addr_len);
 }
 
+/* Return the number of packets dropped by the kernel since the previous call (PACKET_STATISTICS resets on read) */
+int raw_socket_get_drops(int fd, unsigned int *num_drops)
+{
+  struct tpacket_stats stats;
+  socklen_t len = sizeof(stats);
+
+  if(getsockopt(fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) < 0) {
+    return -1;
+  }
+
+  *num_drops = stats.tp_drops;
+
+  return 0;
+}
+
 int raw_socket_close(int fd)
 {
   return close(fd);
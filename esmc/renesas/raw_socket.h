@@ -26,6 +26,7 @@
 int raw_socket_open(const char *name, T_port_num port_num, struct sockaddr_ll *mac_addr);
 int raw_socket_send(int fd, void *msg, int msg_len, int flags, struct sockaddr_ll *dst_addr, int dst_addr_len);
 int raw_socket_recv(int fd, void *msg, int msg_len, int flags, struct sockaddr_ll *src_addr, int src_addr_len);
+int raw_socket_get_drops(int fd, unsigned int *num_drops);
 int raw_socket_close(int fd);
 
 #endif /* RAW_SOCKET_H */
@@ -29,11 +29,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "../mng_if.h"
+#include "../mng_shm.h"
+#include "../mng_tlv.h"
 #include "../../common/common.h"
 #include "../../common/config.h"
+#include "../../common/journal.h"
 #include "../../common/print.h"
 
 #ifndef __linux__
@@ -48,6 +52,8 @@
 
 #define COMMAND_QUEUE_SIZE   64
 
+#define COMMAND_FILE_MAX_ARGS   3   /* Management API code and its arguments */
+
 typedef struct {
   char port_name[INTERFACE_MAX_NAME_LEN];
 } T_command_get_sync_info;
@@ -76,9 +82,18 @@ typedef struct {
 } T_command_set_pri;
 
 typedef struct {
+  int module;
   int max_msg_lvl;
 } T_command_set_max_msg_lvl;
 
+typedef struct {
+  char port_name[INTERFACE_MAX_NAME_LEN];
+} T_command_get_port_stats;
+
+typedef struct {
+  unsigned long long since_seq;
+} T_command_get_journal;
+
 typedef struct {
   T_mng_api api_code;
   union {
@@ -89,11 +104,15 @@ typedef struct {
     T_command_assign_new_synce_clk_port command_line_info_assign_new_synce_clk_port;
     T_command_set_pri                   command_line_info_set_pri;
     T_command_set_max_msg_lvl           command_line_info_set_max_msg_lvl;
+    T_command_get_port_stats            command_line_info_get_port_stats;
+    T_command_get_journal               command_line_info_get_journal;
 
     /* No data for following APIs:
      *   - get_sync_info_list
      *   - get_current_status
      *   - clear_holdover_timer
+     *   - get_latency_stats
+     *   - get_mutex_stats
      */
   };
 } T_command;
@@ -111,6 +130,27 @@ static int print_flag;
 /* g_command_line_mode = 0 -> interactive mode; g_command_line_mode = 1 -> command-line mode */
 static int g_command_line_mode = 0;
 
+/* g_legacy_encoding_en = 0 -> TLV frames; g_legacy_encoding_en = 1 -> fixed-size messages (for older synced versions) */
+static int g_legacy_encoding_en = 0;
+
+/* Connected to a Unix domain socket (SOCK_SEQPACKET); every frame is received as one packet */
+static int g_unix_socket_en = 0;
+static unsigned char g_tlv_buff[MNG_TLV_MAX_FRAME_LEN];
+
+/* g_batch_mode = 1 -> all commands are sent as one batch request */
+static int g_batch_mode = 0;
+
+/* g_event_mask = 0 -> no subscription; otherwise, events are printed after the commands are executed */
+static unsigned int g_event_mask = 0;
+
+/* Status page read instead of connecting to the management interface */
+static const char *g_status_page_path = NULL;
+
+/* Flight recorder file decoded instead of connecting to the management interface; 0 minutes prints all entries */
+static const char *g_flight_recorder_path = NULL;
+static unsigned int g_flight_recorder_minutes = 0;
+static unsigned int g_last_event_seq = 0;
+
 /*
  * Command queue:
  *
@@ -142,7 +182,14 @@ static const char *g_api_code_to_api_code_str[] = {
   "clear_synce_clk_wtr_timer",
   "assign_new_synce_clk_port",
   "set_pri",
-  "set_max_msg_lvl"
+  "set_max_msg_lvl",
+  "begin_transaction",
+  "commit_transaction",
+  "abort_transaction",
+  "get_port_stats",
+  "get_latency_stats",
+  "get_mutex_stats",
+  "get_journal"
 };
 COMPILE_TIME_ASSERT((sizeof(g_api_code_to_api_code_str)/sizeof(g_api_code_to_api_code_str[0])) == E_mng_api_max, "Invalid array size for g_api_code_to_api_code_str!")
 COMPILE_TIME_ASSERT(E_mng_api_get_sync_info_list == 0, "Invalid index for 'get_sync_info_list' in g_api_code_to_api_code_str")
@@ -155,6 +202,13 @@ COMPILE_TIME_ASSERT(E_mng_api_clear_synce_clk_wtr_timer == 6, "Invalid index for
 COMPILE_TIME_ASSERT(E_mng_api_assign_new_synce_clk_port == 7, "Invalid index for 'assign_new_synce_clk_port' in g_api_code_to_api_code_str")
 COMPILE_TIME_ASSERT(E_mng_api_set_pri == 8, "Invalid index for 'set_pri' in g_api_code_to_api_code_str")
 COMPILE_TIME_ASSERT(E_mng_api_set_max_msg_lvl == 9, "Invalid index for 'set_max_msg_lvl' in g_api_code_to_api_code_str")
+COMPILE_TIME_ASSERT(E_mng_api_begin_transaction == 10, "Invalid index for 'begin_transaction' in g_api_code_to_api_code_str")
+COMPILE_TIME_ASSERT(E_mng_api_commit_transaction == 11, "Invalid index for 'commit_transaction' in g_api_code_to_api_code_str")
+COMPILE_TIME_ASSERT(E_mng_api_abort_transaction == 12, "Invalid index for 'abort_transaction' in g_api_code_to_api_code_str")
+COMPILE_TIME_ASSERT(E_mng_api_get_port_stats == 13, "Invalid index for 'get_port_stats' in g_api_code_to_api_code_str")
+COMPILE_TIME_ASSERT(E_mng_api_get_latency_stats == 14, "Invalid index for 'get_latency_stats' in g_api_code_to_api_code_str")
+COMPILE_TIME_ASSERT(E_mng_api_get_mutex_stats == 15, "Invalid index for 'get_mutex_stats' in g_api_code_to_api_code_str")
+COMPILE_TIME_ASSERT(E_mng_api_get_journal == 16, "Invalid index for 'get_journal' in g_api_code_to_api_code_str")
 
 /* Static functions */
 
@@ -162,9 +216,16 @@ static void usage(char *prog_name)
 {
   fprintf(stderr,
           "usage: %s IP_address port_number print_flag [options]\n"
+          "An IP_address starting with / is the path of a Unix domain socket (port_number is then ignored).\n"
           "options:\n"
+          "  -b [command_file] Execute commands from file (one per line, same format as -c) and -c commands as one batch request.\n"
           "  -c [command] [args] Execute specified Management API via command-line (maximum %d commands).\n"
           "  -h Display command-line options (i.e. print this message).\n"
+          "  -L Use legacy fixed-size message encoding (for synced versions without TLV support).\n"
+          "  -S [status_page_path] Print the status page of a local synced (e.g. /dev/shm/synced) instead of connecting.\n"
+          "  -s [event_mask] Subscribe to events and print them until interrupted (0 subscribes to all events).\n"
+          "  -R [flight_recorder_path] Decode a flight recorder file of synced (e.g. /var/tmp/synced.rec) instead of connecting.\n"
+          "  -m [minutes] With -R, print only the last minutes before the newest entry.\n"
           "  -l Display list of Management API codes (in square brackets on left) and strings (in parentheses on right).\n"
           "  -v Display software version.\n",
           prog_name,
@@ -253,12 +314,32 @@ static int command_queue_pop(T_command *command)
   return 0;
 }
 
+/* Return 0 on success and -1 if the argument is neither a Management API code nor a string */
+static int parse_api_code(const char *arg, T_mng_api *api_code)
+{
+  *api_code = atoi(arg);
+  if(strcmp(arg, "0") && (*api_code == 0)) {
+    /* Not a number; might be a command string */
+    if(conv_api_code_str_to_enum(arg, api_code) < 0) {
+      printf("***Error: Failed to recognize Management API string %s\n", arg);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
 static int parse_command(T_command *command, int optind, char *argv[])
 {
   switch(command->api_code) {
     case E_mng_api_get_sync_info_list:
     case E_mng_api_get_current_status:
     case E_mng_api_clear_holdover_timer:
+    case E_mng_api_begin_transaction:
+    case E_mng_api_commit_transaction:
+    case E_mng_api_abort_transaction:
+    case E_mng_api_get_latency_stats:
+    case E_mng_api_get_mutex_stats:
       /* Left intentionally empty */
       break;
 
@@ -343,11 +424,40 @@ static int parse_command(T_command *command, int optind, char *argv[])
     case E_mng_api_set_max_msg_lvl:
       {
         const char *arg = argv[optind];
+        const char *module_arg = (arg != NULL) ? argv[optind + 1] : NULL;
         if(arg == NULL) {
           printf("***Error: %s: %s expected maximum message log level\n", __func__, conv_api_code_to_str(E_mng_api_set_max_msg_lvl));
           return -1;
         }
         command->command_line_info_set_max_msg_lvl.max_msg_lvl = atoi(arg);
+        command->command_line_info_set_max_msg_lvl.module = PRINT_MODULE_ALL;
+        if(module_arg != NULL) {
+          command->command_line_info_set_max_msg_lvl.module = print_get_module_by_name(module_arg);
+          if(command->command_line_info_set_max_msg_lvl.module < 0) {
+            printf("***Error: %s: %s unknown module %s\n", __func__, conv_api_code_to_str(E_mng_api_set_max_msg_lvl), module_arg);
+            return -1;
+          }
+        }
+      }
+      break;
+
+    case E_mng_api_get_port_stats:
+      {
+        const char *arg = argv[optind];
+        if(arg == NULL) {
+          printf("***Error: %s: %s expected port name\n", __func__, conv_api_code_to_str(E_mng_api_get_port_stats));
+          return -1;
+        }
+        strncpy(command->command_line_info_get_port_stats.port_name, arg, INTERFACE_MAX_NAME_LEN - 1);
+        command->command_line_info_get_port_stats.port_name[INTERFACE_MAX_NAME_LEN - 1] = 0; /* Limit to maximum 15 characters + null */
+      }
+      break;
+
+    case E_mng_api_get_journal:
+      {
+        /* Optional; without it, the oldest entries kept are returned */
+        const char *arg = argv[optind];
+        command->command_line_info_get_journal.since_seq = (arg != NULL) ? strtoull(arg, NULL, 0) : 0;
       }
       break;
 
@@ -359,6 +469,55 @@ static int parse_command(T_command *command, int optind, char *argv[])
   return 0;
 }
 
+static int read_command_file(const char *file_name)
+{
+  FILE *fp;
+  char line[CLI_BUFF_SIZE];
+  char *args[COMMAND_FILE_MAX_ARGS + 1];
+  int num_args;
+  int line_num = 0;
+  T_command command;
+
+  fp = fopen(file_name, "r");
+  if(fp == NULL) {
+    printf("***Error: Failed to open command file %s\n", file_name);
+    return -1;
+  }
+
+  while(fgets(line, sizeof(line), fp) != NULL) {
+    line_num++;
+
+    num_args = 0;
+    args[num_args] = strtok(line, " \t\r\n");
+    while((args[num_args] != NULL) && (num_args < COMMAND_FILE_MAX_ARGS)) {
+      num_args++;
+      args[num_args] = strtok(NULL, " \t\r\n");
+    }
+    args[num_args] = NULL;
+
+    /* Skip empty lines and comments */
+    if((num_args == 0) || (args[0][0] == '#')) {
+      continue;
+    }
+
+    memset(&command, 0, sizeof(command));
+    if((parse_api_code(args[0], &command.api_code) < 0) || (parse_command(&command, 1, args) < 0)) {
+      printf("***Error: Invalid command on line %d of %s\n", line_num, file_name);
+      fclose(fp);
+      return -1;
+    }
+
+    if(command_queue_push(&command) < 0) {
+      printf("***Warning: Maximum of %u commands will be executed\n", COMMAND_QUEUE_SIZE);
+      break;
+    }
+  }
+
+  fclose(fp);
+
+  return 0;
+}
+
 static void compose_req_msg_in_command_line_mode(T_command *command, T_mng_api_request_msg *req_msg)
 {
   req_msg->api_code = command->api_code;
@@ -412,6 +571,39 @@ static void compose_req_msg_in_command_line_mode(T_command *command, T_mng_api_r
     case E_mng_api_set_max_msg_lvl:
       req_msg->request_set_max_msg_lvl.print_flag = print_flag;
       req_msg->request_set_max_msg_lvl.max_msg_lvl = command->command_line_info_set_max_msg_lvl.max_msg_lvl;
+      req_msg->request_set_max_msg_lvl.module_flag = (command->command_line_info_set_max_msg_lvl.module != PRINT_MODULE_ALL);
+      req_msg->request_set_max_msg_lvl.module = command->command_line_info_set_max_msg_lvl.module;
+      break;
+
+    case E_mng_api_begin_transaction:
+      req_msg->request_begin_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_commit_transaction:
+      req_msg->request_commit_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_abort_transaction:
+      req_msg->request_abort_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_port_stats:
+      req_msg->request_get_port_stats.print_flag = print_flag;
+      strcpy(req_msg->request_get_port_stats.port_name, command->command_line_info_get_port_stats.port_name);
+      break;
+
+    case E_mng_api_get_latency_stats:
+      req_msg->request_get_latency_stats.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_mutex_stats:
+      req_msg->request_get_mutex_stats.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_journal:
+      req_msg->request_get_journal.print_flag = print_flag;
+      req_msg->request_get_journal.since_seq_low = (uint32_t)command->command_line_info_get_journal.since_seq;
+      req_msg->request_get_journal.since_seq_high = (uint32_t)(command->command_line_info_get_journal.since_seq >> 32);
       break;
 
     default:
@@ -420,7 +612,8 @@ static void compose_req_msg_in_command_line_mode(T_command *command, T_mng_api_r
   }
 }
 
-static void compose_req_msg_in_interactive_mode(T_mng_api api_code, T_mng_api_request_msg *req_msg)
+/* Return 0 on success and -1 if the user entered an invalid argument */
+static int compose_req_msg_in_interactive_mode(T_mng_api api_code, T_mng_api_request_msg *req_msg)
 {
   req_msg->api_code = api_code;
   switch(req_msg->api_code) {
@@ -499,12 +692,63 @@ static void compose_req_msg_in_interactive_mode(T_mng_api api_code, T_mng_api_re
       printf("maximum message level: ");
       get_cli_string();
       req_msg->request_set_max_msg_lvl.max_msg_lvl = atoi(cli_buffer);
+      printf("module (empty for all modules): ");
+      get_cli_string();
+      if(cli_buffer[0] != 0) {
+        req_msg->request_set_max_msg_lvl.module = print_get_module_by_name(cli_buffer);
+        if(req_msg->request_set_max_msg_lvl.module < 0) {
+          printf("***Error: %s: %s unknown module %s\n", __func__, conv_api_code_to_str(E_mng_api_set_max_msg_lvl), cli_buffer);
+          return -1;
+        }
+        req_msg->request_set_max_msg_lvl.module_flag = 1;
+      }
+      break;
+
+    case E_mng_api_begin_transaction:
+      req_msg->request_begin_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_commit_transaction:
+      req_msg->request_commit_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_abort_transaction:
+      req_msg->request_abort_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_port_stats:
+      req_msg->request_get_port_stats.print_flag = print_flag;
+      printf("port name: ");
+      get_cli_string();
+      cli_buffer[INTERFACE_MAX_NAME_LEN - 1] = 0; /* Limit to maximum 15 characters + null */
+      strcpy(req_msg->request_get_port_stats.port_name, cli_buffer);
+      break;
+
+    case E_mng_api_get_latency_stats:
+      req_msg->request_get_latency_stats.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_mutex_stats:
+      req_msg->request_get_mutex_stats.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_journal:
+      req_msg->request_get_journal.print_flag = print_flag;
+      printf("since sequence number (empty for oldest): ");
+      get_cli_string();
+      {
+        unsigned long long since_seq = strtoull(cli_buffer, NULL, 0);
+        req_msg->request_get_journal.since_seq_low = (uint32_t)since_seq;
+        req_msg->request_get_journal.since_seq_high = (uint32_t)(since_seq >> 32);
+      }
       break;
 
     default:
       printf("***Error: %s: unknown API\n", __func__);
       break;
   }
+
+  return 0;
 }
 
 static void parse_rsp_msg(T_mng_api api_code, T_mng_api_response_msg *rsp_msg)
@@ -605,12 +849,435 @@ static void parse_rsp_msg(T_mng_api api_code, T_mng_api_response_msg *rsp_msg)
       printf("Set maximum message level was successful\n");
       break;
 
+    case E_mng_api_begin_transaction:
+      printf("Begin transaction was successful\n");
+      break;
+
+    case E_mng_api_commit_transaction:
+      printf("Commit transaction was successful\n");
+      break;
+
+    case E_mng_api_abort_transaction:
+      printf("Abort transaction was successful\n");
+      break;
+
+    case E_mng_api_get_port_stats:
+      printf("Port statistics:\n");
+      print_port_stats(&rsp_msg->response_get_port_stats.port_stats);
+      break;
+
+    case E_mng_api_get_latency_stats:
+      printf("Latency statistics:\n");
+      print_latency_stats(&rsp_msg->response_get_latency_stats.latency_stats);
+      break;
+
+    case E_mng_api_get_mutex_stats:
+      printf("Mutex statistics:\n");
+      if(rsp_msg->response_get_mutex_stats.mutex_stats != NULL) {
+        print_mutex_stats(rsp_msg->response_get_mutex_stats.mutex_stats);
+      }
+      break;
+
+    case E_mng_api_get_journal:
+      printf("Journal:\n");
+      print_journal(&rsp_msg->response_get_journal.journal);
+      break;
+
     default:
       printf("***Error: %s: unknown API\n", __func__);
       break;
   }
 }
 
+static int send_req_msg(int fd, T_mng_api_request_msg const *req_msg)
+{
+  T_mng_tlv_writer writer;
+  int frame_len;
+
+  if(g_legacy_encoding_en) {
+    return send(fd, req_msg, sizeof(*req_msg), 0);
+  }
+
+  mng_tlv_begin_frame(&writer, g_tlv_buff, sizeof(g_tlv_buff), E_mng_tlv_frame_type_request);
+  mng_tlv_encode_request(&writer, req_msg);
+  frame_len = mng_tlv_end_frame(&writer);
+  if(frame_len < 0) {
+    return -1;
+  }
+
+  return send(fd, g_tlv_buff, frame_len, 0);
+}
+
+/* Receive a frame into g_tlv_buff; return 0 on success and -1 if the connection was lost or the frame is invalid */
+static int recv_frame(int fd, T_mng_tlv_frame_header *header)
+{
+  int status;
+
+  if(g_unix_socket_en) {
+    /* Frame arrives in one packet */
+    status = recv(fd, g_tlv_buff, sizeof(g_tlv_buff), 0);
+    if((status < MNG_TLV_FRAME_HEADER_LEN) || (mng_tlv_parse_frame_header(g_tlv_buff, status, header) <= 0) ||
+       (status != MNG_TLV_FRAME_HEADER_LEN + (int)header->payload_len)) {
+      return -1;
+    }
+    memmove(g_tlv_buff, &g_tlv_buff[MNG_TLV_FRAME_HEADER_LEN], header->payload_len);
+    return 0;
+  }
+
+  /* Frame may arrive in several segments */
+  status = recv(fd, g_tlv_buff, MNG_TLV_FRAME_HEADER_LEN, MSG_WAITALL);
+  if(status < MNG_TLV_FRAME_HEADER_LEN) {
+    return -1;
+  }
+
+  if(mng_tlv_parse_frame_header(g_tlv_buff, MNG_TLV_FRAME_HEADER_LEN, header) <= 0) {
+    printf("***Error: Invalid frame (try -L for older synced versions)\n");
+    return -1;
+  }
+
+  if(header->payload_len > 0) {
+    status = recv(fd, g_tlv_buff, header->payload_len, MSG_WAITALL);
+    if(status < (int)header->payload_len) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void print_event(unsigned int seq, T_mng_event const *event)
+{
+  if(event->type == E_mng_event_type_subscribed) {
+    printf("Subscribed to events 0x%X (last sequence number %u)\n", event->event_mask, seq);
+    g_last_event_seq = seq;
+    return;
+  }
+
+  if(seq != g_last_event_seq + 1) {
+    printf("***Warning: %u events lost; use get_sync_info_list and get_current_status to resync\n", seq - g_last_event_seq - 1);
+  }
+  g_last_event_seq = seq;
+
+  printf("[%u] ", seq);
+  switch(event->type) {
+    case E_mng_event_type_current_ql:
+      printf("Current QL: %s (selected port: %s)\n", conv_ql_enum_to_str(event->current_ql), event->port_name);
+      break;
+
+    case E_mng_event_type_sync_current_ql:
+      printf("Port %s: current QL %s, rank 0x%06X\n", event->port_name, conv_ql_enum_to_str(event->current_ql), event->rank);
+      break;
+
+    case E_mng_event_type_synce_dpll_state:
+      printf("Sync-E DPLL state: %s\n", conv_synce_dpll_state_enum_to_str(event->dpll_state));
+      break;
+
+    case E_mng_event_type_sync_clk_state:
+      printf("Port %s: clock index %d state %s\n", event->port_name, event->clk_idx, conv_sync_clk_state_enum_to_str(event->clk_state));
+      break;
+
+    case E_mng_event_type_sync_state:
+      printf("Port %s: state %s\n", event->port_name, conv_sync_state_enum_to_str(event->state));
+      break;
+
+    case E_mng_event_type_alarm:
+      switch(event->alarm_type) {
+        case E_alarm_type_invalid_clock_idx:
+          printf("Alarm: invalid current clock index\n");
+          break;
+        case E_alarm_type_invalid_sync_idx:
+          printf("Alarm: invalid current sync index\n");
+          break;
+        case E_alarm_type_timing_loop:
+          printf("Alarm: %s timing loop on port %s (MAC address %02X:%02X:%02X:%02X:%02X:%02X)\n",
+                 (event->loop_type == E_timing_loop_type_originator) ? "originator clock" : "immediate",
+                 event->port_name,
+                 event->mac_addr[0],
+                 event->mac_addr[1],
+                 event->mac_addr[2],
+                 event->mac_addr[3],
+                 event->mac_addr[4],
+                 event->mac_addr[5]);
+          break;
+        case E_alarm_type_invalid_rx_ql:
+          printf("Alarm: invalid received QL on port %s\n", event->port_name);
+          break;
+        case E_alarm_type_reference_degradation:
+          printf("Alarm: frequency offset of port %s (clock index %d) %s\n",
+                 event->port_name,
+                 event->clk_idx,
+                 event->degrading_flag ? "is degrading" : "recovered");
+          break;
+        default:
+          printf("Alarm: unknown alarm type %d\n", event->alarm_type);
+          break;
+      }
+      break;
+
+    default:
+      printf("Unknown event type %d\n", event->type);
+      break;
+  }
+}
+
+static int handle_event_frame(T_mng_tlv_frame_header const *header)
+{
+  T_mng_event event;
+  unsigned int seq;
+
+  if(mng_tlv_decode_event(g_tlv_buff, header->payload_len, &seq, &event) < 0) {
+    printf("***Error: Invalid event frame\n");
+    return -1;
+  }
+
+  print_event(seq, &event);
+
+  return 0;
+}
+
+/* Return 0 on success and -1 if the connection was lost or the response is invalid */
+static int recv_rsp_msg(int fd, T_mng_api_response_msg *rsp_msg)
+{
+  T_mng_tlv_frame_header header;
+  int status;
+
+  /* Response may arrive in several segments */
+  if(g_legacy_encoding_en) {
+    status = recv(fd, g_tlv_buff, MNG_API_LEGACY_RESPONSE_MSG_LEN, MSG_WAITALL);
+    if(status < (int)MNG_API_LEGACY_RESPONSE_MSG_LEN) {
+      return -1;
+    }
+    mng_tlv_unpack_legacy_response(g_tlv_buff, rsp_msg);
+    return 0;
+  }
+
+  while(1) {
+    if(recv_frame(fd, &header) < 0) {
+      return -1;
+    }
+
+    if(header.type == E_mng_tlv_frame_type_response) {
+      return mng_tlv_decode_response(g_tlv_buff, header.payload_len, rsp_msg);
+    }
+
+    /* Events of an active subscription may precede the response */
+    if((header.type != E_mng_tlv_frame_type_event) || (handle_event_frame(&header) < 0)) {
+      return -1;
+    }
+  }
+}
+
+/* Send all queued commands as one batch request and print the responses in order */
+static int execute_batch(int fd)
+{
+  T_mng_api api_codes[COMMAND_QUEUE_SIZE];
+  T_command command;
+  T_mng_api_request_msg req_msg;
+  T_mng_api_response_msg rsp_msg;
+  T_mng_tlv_frame_header header;
+  T_mng_tlv_writer writer;
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  size_t offset;
+  int num_commands = 0;
+  int num_responses = 0;
+  int frame_len;
+
+  mng_tlv_begin_frame(&writer, g_tlv_buff, sizeof(g_tlv_buff), E_mng_tlv_frame_type_batch_request);
+  while(command_queue_pop(&command) == 0) {
+    memset(&req_msg, 0, sizeof(req_msg));
+    compose_req_msg_in_command_line_mode(&command, &req_msg);
+    api_codes[num_commands++] = command.api_code;
+
+    offset = mng_tlv_begin_nested(&writer, E_mng_tlv_type_batch_request);
+    mng_tlv_encode_request(&writer, &req_msg);
+    mng_tlv_end_nested(&writer, offset);
+  }
+
+  frame_len = mng_tlv_end_frame(&writer);
+  if((frame_len < 0) || (send(fd, g_tlv_buff, frame_len, 0) < 0)) {
+    printf("***Error: Failed to send message\n");
+    return -1;
+  }
+
+  printf("Batch of %d commands\n", num_commands);
+
+  while(1) {
+    if(recv_frame(fd, &header) < 0) {
+      printf("***Error: Connection lost\n");
+      return -1;
+    }
+
+    if(header.type == E_mng_tlv_frame_type_batch_response) {
+      break;
+    }
+
+    /* Events of an active subscription may precede the response */
+    if((header.type != E_mng_tlv_frame_type_event) || (handle_event_frame(&header) < 0)) {
+      return -1;
+    }
+  }
+
+  mng_tlv_reader_init(&reader, g_tlv_buff, header.payload_len);
+  while((mng_tlv_next(&reader, &type, &val, &val_len) > 0) && (num_responses < num_commands)) {
+    if(type != E_mng_tlv_type_batch_response) {
+      continue;
+    }
+
+    printf("%s\n", conv_api_code_to_str(api_codes[num_responses]));
+    if(mng_tlv_decode_response(val, val_len, &rsp_msg) < 0) {
+      printf("***Error: Invalid response\n");
+    } else {
+      parse_rsp_msg(api_codes[num_responses], &rsp_msg);
+    }
+    num_responses++;
+  }
+
+  if(num_responses != num_commands) {
+    printf("***Error: Received %d responses for %d commands\n", num_responses, num_commands);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* Subscribe to events and print them until the connection is lost */
+static int subscribe_events(int fd)
+{
+  T_mng_tlv_frame_header header;
+  T_mng_tlv_writer writer;
+  int frame_len;
+
+  mng_tlv_begin_frame(&writer, g_tlv_buff, sizeof(g_tlv_buff), E_mng_tlv_frame_type_subscribe);
+  mng_tlv_encode_subscribe(&writer, g_event_mask);
+  frame_len = mng_tlv_end_frame(&writer);
+  if((frame_len < 0) || (send(fd, g_tlv_buff, frame_len, 0) < 0)) {
+    printf("***Error: Failed to send message\n");
+    return -1;
+  }
+
+  while(recv_frame(fd, &header) == 0) {
+    if((header.type != E_mng_tlv_frame_type_event) || (handle_event_frame(&header) < 0)) {
+      return -1;
+    }
+    fflush(stdout);
+  }
+
+  printf("***Error: Connection lost\n");
+
+  return -1;
+}
+
+/* Print a snapshot of the status page; no request is sent to synced */
+static int print_status_page(const char *path)
+{
+  T_mng_shm_reader reader;
+  T_mng_shm_data data;
+  T_mng_shm_sync const *sync;
+  int i;
+
+  if(mng_shm_reader_open(&reader, path) < 0) {
+    printf("***Error: Failed to open status page %s\n", path);
+    return -1;
+  }
+
+  if(mng_shm_reader_read(&reader, &data) < 0) {
+    printf("***Error: Failed to read status page %s\n", path);
+    mng_shm_reader_close(&reader);
+    return -1;
+  }
+
+  mng_shm_reader_close(&reader);
+
+  printf("Current status (updated %llu ms ago):\n", mng_shm_reader_get_age_ms(&data));
+  print_current_status(&data.status);
+
+  printf("Sync list:\n");
+  for(i = 0; (i < data.num_syncs) && (i < MNG_SHM_MAX_NUM_SYNCS); i++) {
+    sync = &data.syncs[i];
+    printf("  %s (%s):", sync->name, conv_sync_type_enum_to_str(sync->type));
+    if(sync->type != E_sync_type_tx_only) {
+      printf(" state %s, QL %s, rank 0x%06X, priority %d,",
+             conv_sync_state_enum_to_str(sync->state),
+             conv_ql_enum_to_str(sync->current_ql),
+             sync->rank,
+             sync->config_pri);
+    }
+    if(sync->clk_idx >= 0) {
+      printf(" clock index %d (%s),", sync->clk_idx, conv_sync_clk_state_enum_to_str(sync->clk_state));
+    }
+    printf(" flags:%s%s%s%s\n",
+           (sync->flags == 0) ? " none" : "",
+           (sync->flags & MNG_SHM_SYNC_FLAG_DEGRADING) ? " degrading" : "",
+           (sync->flags & MNG_SHM_SYNC_FLAG_RX_TIMEOUT) ? " rx-timeout" : "",
+           (sync->flags & MNG_SHM_SYNC_FLAG_LINK_DOWN) ? " link-down" : "");
+  }
+
+  return 0;
+}
+
+/* Print the entries of a flight recorder file with wall-clock times; works after synced crashed */
+static int print_flight_recorder(const char *path, unsigned int minutes)
+{
+  T_journal_recorder_reader reader;
+  T_journal_recorder_header const *header;
+  T_journal_entry *entries;
+  unsigned long long num_lost;
+  unsigned long long start_time_ns = 0;
+  long long realtime_ns;
+  struct tm tm;
+  time_t sec;
+  char date_str[24];
+  char time_str[40];
+  int num_entries;
+  int i;
+
+  if(journal_recorder_reader_open(&reader, path) < 0) {
+    printf("***Error: Failed to open flight recorder file %s\n", path);
+    return -1;
+  }
+  header = reader.header;
+
+  entries = malloc(header->num_entries * sizeof(*entries));
+  if(entries == NULL) {
+    printf("***Error: Failed to allocate %u entries\n", header->num_entries);
+    journal_recorder_reader_close(&reader);
+    return -1;
+  }
+
+  num_entries = journal_recorder_reader_read(&reader, entries, &num_lost);
+
+  printf("Flight recorder of synced (PID %d): %d entries", header->pid, num_entries);
+  if(num_lost > 0) {
+    printf(" (%llu incomplete or overwritten)", num_lost);
+  }
+  printf("\n");
+
+  if((minutes > 0) && (num_entries > 0) && (entries[num_entries - 1].time_ns > (minutes * 60ULL * 1000000000ULL))) {
+    start_time_ns = entries[num_entries - 1].time_ns - (minutes * 60ULL * 1000000000ULL);
+  }
+
+  printf("  %10s %-29s %-16s %s\n", "Seq", "Time", "Port", "Event");
+  for(i = 0; i < num_entries; i++) {
+    if(entries[i].time_ns < start_time_ns) {
+      continue;
+    }
+    realtime_ns = (long long)entries[i].time_ns + header->realtime_offset_ns;
+    sec = realtime_ns / 1000000000LL;
+    localtime_r(&sec, &tm);
+    strftime(date_str, sizeof(date_str), "%Y-%m-%d %H:%M:%S", &tm);
+    snprintf(time_str, sizeof(time_str), "%s.%09lld", date_str, realtime_ns % 1000000000LL);
+    print_journal_entry(&entries[i], time_str, journal_recorder_reader_get_sync_name(&reader, &entries[i]));
+  }
+
+  free(entries);
+  journal_recorder_reader_close(&reader);
+
+  return 0;
+}
+
 /* Global functions */
 
 int main(int argc, char *argv[])
@@ -622,25 +1289,29 @@ int main(int argc, char *argv[])
   T_command command;
   int fd;
   struct sockaddr_in server;
+  struct sockaddr_un unix_server;
   T_mng_api_request_msg req_msg;
   T_mng_api_response_msg rsp_msg;
   int status;
 
   memset(&server, 0, sizeof(server));
+  memset(&unix_server, 0, sizeof(unix_server));
   memset(&req_msg, 0, sizeof(req_msg));
   memset(&rsp_msg, 0, sizeof(rsp_msg));
 
   /* Minus (-) instructs getopt() to not move all non-option arguments to the end of the command-line */
-  while(EOF != (opt = getopt(argc, argv, "-c:hlv"))) {
+  while(EOF != (opt = getopt(argc, argv, "-b:c:hlLm:R:s:S:v"))) {
     switch(opt) {
+      case 'b':
+        if(read_command_file(optarg) < 0) {
+          goto quick_end;
+        }
+        g_batch_mode = 1;
+        break;
+
       case 'c':
-        api_code = atoi(optarg);
-        if(strcmp(optarg, "0") && (api_code == 0)) {
-          /* Not a number; might be a command string */
-          if(conv_api_code_str_to_enum(optarg, &api_code) < 0) {
-            printf("***Error: Failed to recognize Management API string %s\n", optarg);
-            goto quick_end;
-          }
+        if(parse_api_code(optarg, &api_code) < 0) {
+          goto quick_end;
         }
         command.api_code = api_code;
         if(parse_command(&command, optind, argv) < 0) {
@@ -655,6 +1326,29 @@ int main(int argc, char *argv[])
         print_help();
         goto quick_end;
 
+      case 'L':
+        g_legacy_encoding_en = 1;
+        break;
+
+      case 's':
+        g_event_mask = strtoul(optarg, NULL, 0);
+        if(g_event_mask == 0) {
+          g_event_mask = MNG_EVENT_MASK_ALL;
+        }
+        break;
+
+      case 'S':
+        g_status_page_path = optarg;
+        break;
+
+      case 'R':
+        g_flight_recorder_path = optarg;
+        break;
+
+      case 'm':
+        g_flight_recorder_minutes = strtoul(optarg, NULL, 0);
+        break;
+
       case 'v':
         printf("%s version: %s.%s.%s\n", prog_name, g_version, g_pipeline, g_commit);
         goto quick_end;
@@ -670,37 +1364,78 @@ int main(int argc, char *argv[])
     }
   }
 
+  if(g_status_page_path != NULL) {
+    print_set_prog_name(prog_name);
+    print_set_stdout_en(1);
+    err = print_status_page(g_status_page_path);
+    goto quick_end;
+  }
+
+  if(g_flight_recorder_path != NULL) {
+    print_set_prog_name(prog_name);
+    print_set_stdout_en(1);
+    err = print_flight_recorder(g_flight_recorder_path, g_flight_recorder_minutes);
+    goto quick_end;
+  }
+
   if(argc <= 3) {
     printf("***Error: Must specify IP address, port number, and print flag (ex: 127.0.0.2, 2400, and 1)\n");
     usage(prog_name);
     goto quick_end;
   }
 
-  /* optind points to the next element in argv; if optind = 4, then 3 arguments were entered by user */
-  if(optind == 4) {
+  if(g_event_mask && g_legacy_encoding_en) {
+    printf("***Error: Event subscription is not supported with legacy message encoding\n");
+    goto quick_end;
+  }
+
+  if(g_batch_mode && g_legacy_encoding_en) {
+    printf("***Error: Batch requests are not supported with legacy message encoding\n");
+    goto quick_end;
+  }
+
+  /* Interactive mode unless commands or a subscription were entered on the command-line */
+  if((g_command_queue_tail == 0) && (g_event_mask == 0)) {
     printf("%s mode: interactive\n", prog_name);
   } else {
     printf("%s mode: command-line\n", prog_name);
     g_command_line_mode = 1;
   }
 
-  fd = socket(AF_INET, SOCK_STREAM, 0);
+  g_unix_socket_en = (argv[1][0] == '/');
+  if(g_unix_socket_en && (strlen(argv[1]) >= sizeof(unix_server.sun_path))) {
+    printf("***Error: Socket path is too long\n");
+    goto quick_end;
+  }
+
+  fd = g_unix_socket_en ? socket(AF_UNIX, SOCK_SEQPACKET, 0) : socket(AF_INET, SOCK_STREAM, 0);
   if(fd < 0) {
     printf("***Error: Failed to create socket\n");
     usage(prog_name);
     goto quick_end;
   }
 
-  server.sin_family = AF_INET;
-  server.sin_addr.s_addr = inet_addr(argv[1]);
-  server.sin_port = htons(atoi(argv[2]));
   print_flag = atoi(argv[3]);
 
-  if(connect(fd, (struct sockaddr*)&server, sizeof(server)) < 0) {
+  if(g_unix_socket_en) {
+    unix_server.sun_family = AF_UNIX;
+    strcpy(unix_server.sun_path, argv[1]);
+    status = connect(fd, (struct sockaddr*)&unix_server, sizeof(unix_server));
+  } else {
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = inet_addr(argv[1]);
+    server.sin_port = htons(atoi(argv[2]));
+    status = connect(fd, (struct sockaddr*)&server, sizeof(server));
+  }
+  if(status < 0) {
     printf("***Error: Failed to connect\n");
     goto end;
   }
-  printf("Connected to socket with IP Address: %s, port number: %s, and print flag: %s\n", argv[1], argv[2], argv[3]);
+  if(g_unix_socket_en) {
+    printf("Connected to socket with path: %s and print flag: %s\n", argv[1], argv[3]);
+  } else {
+    printf("Connected to socket with IP Address: %s, port number: %s, and print flag: %s\n", argv[1], argv[2], argv[3]);
+  }
 
   print_set_prog_name(prog_name);
   print_set_max_msg_level(LOG_DEBUG);
@@ -708,6 +1443,10 @@ int main(int argc, char *argv[])
 
   printf("---Started %s (version: %s.%s.%s %s %s)---\n", prog_name, g_version, g_pipeline, g_commit, __DATE__, __TIME__);
 
+  if(g_batch_mode && (execute_batch(fd) < 0)) {
+    goto end;
+  }
+
   memset(&command, 0, sizeof(command));
   while(1) {
     if(g_command_line_mode == 1) {
@@ -715,6 +1454,9 @@ int main(int argc, char *argv[])
 
       if(command_queue_pop(&command) < 0) {
         /* No more commands in queue */
+        if(g_event_mask) {
+          subscribe_events(fd);
+        }
         goto end;
       }
 
@@ -763,7 +1505,9 @@ int main(int argc, char *argv[])
       compose_req_msg_in_command_line_mode(&command, &req_msg);
     } else {
       /* Interactive mode */
-      compose_req_msg_in_interactive_mode(api_code, &req_msg);
+      if(compose_req_msg_in_interactive_mode(api_code, &req_msg) < 0) {
+        continue;
+      }
     }
 
     /* Discard stale messages */
@@ -771,14 +1515,13 @@ int main(int argc, char *argv[])
       status = recv(fd, &rsp_msg, sizeof(rsp_msg), MSG_DONTWAIT);
     } while(status > 0);
 
-    status = send(fd, &req_msg, sizeof(req_msg), 0);
+    status = send_req_msg(fd, &req_msg);
     if(status < 0) {
       printf("***Error: Failed to send message\n");
       break;
     }
 
-    status = recv(fd, &rsp_msg, sizeof(rsp_msg), 0);
-    if(status <= 0) {
+    if(recv_rsp_msg(fd, &rsp_msg) < 0) {
       /* No response from management interface */
       printf("***Error: Connection lost\n");
       break;
@@ -20,14 +20,19 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_management
+
 #include <limits.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "management.h"
+#include "mng_if.h"
 #include "pcm4l_msg.h"
 #include "../common/common.h"
+#include "../common/journal.h"
+#include "../common/latency.h"
 #include "../common/print.h"
 #include "../control/control.h"
 #include "../device/device_adaptor/device_adaptor.h"
@@ -273,6 +278,18 @@ static void management_template_notify_alarm(const T_alarm_data *alarm_data)
       pr_warning("Invalid received QL on port %s", alarm_data->alarm_invalid_ql.port_name);
       break;
 
+    case E_alarm_type_reference_degradation:
+      if(alarm_data->alarm_reference_degradation.degrading_flag) {
+        pr_warning("Frequency offset of port %s (clock index %d) is degrading",
+                   alarm_data->alarm_reference_degradation.port_name,
+                   alarm_data->alarm_reference_degradation.clk_idx);
+      } else {
+        pr_info("Frequency offset of port %s (clock index %d) recovered",
+                alarm_data->alarm_reference_degradation.port_name,
+                alarm_data->alarm_reference_degradation.clk_idx);
+      }
+      break;
+
     default:
       break;
   }
@@ -293,6 +310,46 @@ static void management_template_notify_pcm4l_connection_status(int on)
   }
 }
 
+static void management_init_event(T_mng_event *event, T_mng_event_type type, const char *port_name)
+{
+  memset(event, 0, sizeof(*event));
+  event->type = type;
+  event->clk_idx = -1;
+  if(port_name != NULL) {
+    strncpy(event->port_name, port_name, sizeof(event->port_name) - 1);
+  }
+}
+
+static void management_publish_alarm_event(const T_alarm_data *alarm_data)
+{
+  T_mng_event event;
+
+  switch(alarm_data->alarm_type) {
+    case E_alarm_type_timing_loop:
+      management_init_event(&event, E_mng_event_type_alarm, alarm_data->alarm_timing_loop.port_name);
+      event.loop_type = alarm_data->alarm_timing_loop.loop_type;
+      memcpy(event.mac_addr, alarm_data->alarm_timing_loop.mac_addr, sizeof(event.mac_addr));
+      break;
+
+    case E_alarm_type_invalid_rx_ql:
+      management_init_event(&event, E_mng_event_type_alarm, alarm_data->alarm_invalid_ql.port_name);
+      break;
+
+    case E_alarm_type_reference_degradation:
+      management_init_event(&event, E_mng_event_type_alarm, alarm_data->alarm_reference_degradation.port_name);
+      event.clk_idx = alarm_data->alarm_reference_degradation.clk_idx;
+      event.degrading_flag = alarm_data->alarm_reference_degradation.degrading_flag;
+      break;
+
+    default:
+      management_init_event(&event, E_mng_event_type_alarm, NULL);
+      break;
+  }
+  event.alarm_type = alarm_data->alarm_type;
+
+  mng_if_publish_event(&event);
+}
+
 /* Global functions */
 
 int management_init(void)
@@ -341,13 +398,21 @@ int management_deinit(void)
 
 void management_call_notify_current_ql_cb(const char *port_name, T_esmc_ql current_ql)
 {
+  T_mng_event event;
+
   if(g_management_callbacks.notify_current_ql != NULL) {
     g_management_callbacks.notify_current_ql(port_name, current_ql);
   }
+
+  management_init_event(&event, E_mng_event_type_current_ql, port_name);
+  event.current_ql = current_ql;
+  mng_if_publish_event(&event);
 }
 
 void management_call_notify_sync_current_ql_cb(const char *port_name, T_esmc_ql current_ql, int rank)
 {
+  T_mng_event event;
+
   if(port_name == NULL) {
     return;
   }
@@ -355,17 +420,30 @@ void management_call_notify_sync_current_ql_cb(const char *port_name, T_esmc_ql
   if(g_management_callbacks.notify_sync_current_ql != NULL) {
     g_management_callbacks.notify_sync_current_ql(port_name, current_ql, rank);
   }
+
+  management_init_event(&event, E_mng_event_type_sync_current_ql, port_name);
+  event.current_ql = current_ql;
+  event.rank = rank;
+  mng_if_publish_event(&event);
 }
 
 void management_call_notify_synce_dpll_current_state_cb(T_device_dpll_state synce_dpll_state)
 {
+  T_mng_event event;
+
   if(g_management_callbacks.notify_synce_dpll_current_state != NULL) {
     g_management_callbacks.notify_synce_dpll_current_state(synce_dpll_state);
   }
+
+  management_init_event(&event, E_mng_event_type_synce_dpll_state, NULL);
+  event.dpll_state = synce_dpll_state;
+  mng_if_publish_event(&event);
 }
 
 void management_call_notify_sync_current_clk_state_cb(const char *port_name, int clk_idx, T_sync_clk_state clk_state)
 {
+  T_mng_event event;
+
   if(port_name == NULL) {
     return;
   }
@@ -373,10 +451,17 @@ void management_call_notify_sync_current_clk_state_cb(const char *port_name, int
   if(g_management_callbacks.notify_sync_current_clk_state != NULL) {
     g_management_callbacks.notify_sync_current_clk_state(port_name, clk_idx, clk_state);
   }
+
+  management_init_event(&event, E_mng_event_type_sync_clk_state, port_name);
+  event.clk_idx = clk_idx;
+  event.clk_state = clk_state;
+  mng_if_publish_event(&event);
 }
 
 void management_call_notify_sync_current_state_cb(const char *port_name, T_sync_state state)
 {
+  T_mng_event event;
+
   if(port_name == NULL) {
     return;
   }
@@ -384,6 +469,10 @@ void management_call_notify_sync_current_state_cb(const char *port_name, T_sync_
   if(g_management_callbacks.notify_sync_current_state != NULL) {
     g_management_callbacks.notify_sync_current_state(port_name, state);
   }
+
+  management_init_event(&event, E_mng_event_type_sync_state, port_name);
+  event.state = state;
+  mng_if_publish_event(&event);
 }
 
 void management_call_notify_alarm_cb(const T_alarm_data *alarm_data)
@@ -395,6 +484,8 @@ void management_call_notify_alarm_cb(const T_alarm_data *alarm_data)
   if(g_management_callbacks.notify_alarm != NULL) {
     g_management_callbacks.notify_alarm(alarm_data);
   }
+
+  management_publish_alarm_event(alarm_data);
 }
 
 void management_call_notify_pcm4l_connection_status_cb(int on)
@@ -491,6 +582,130 @@ T_management_api_response management_get_sync_info(int print_flag, const char *p
   return E_management_api_response_ok;
 }
 
+T_management_api_response management_get_port_stats(int print_flag, const char *port_name, T_management_port_stats *port_stats)
+{
+  int resp;
+
+  if(port_name == NULL) {
+    return E_management_api_response_invalid;
+  }
+
+  if(port_stats == NULL) {
+    return E_management_api_response_invalid;
+  }
+
+  if(print_flag) {
+    pr_info("**%s**", __func__);
+  }
+
+  resp = control_get_port_stats(port_name, port_stats);
+  if(resp < 0) {
+    if(resp == -1) {
+      pr_err("Failed to find port %s", port_name);
+      return E_management_api_response_failed;
+    } else {
+      pr_err("Port %s has no ESMC statistics", port_name);
+      return E_management_api_response_not_supported;
+    }
+  }
+
+  if(print_flag) {
+    print_port_stats(port_stats);
+  }
+
+  return E_management_api_response_ok;
+}
+
+T_management_api_response management_get_latency_stats(int print_flag, T_management_latency_stats *latency_stats)
+{
+  int stage;
+
+  if(latency_stats == NULL) {
+    return E_management_api_response_invalid;
+  }
+
+  if(print_flag) {
+    pr_info("**%s**", __func__);
+  }
+
+  memset(latency_stats, 0, sizeof(*latency_stats));
+
+  for(stage = 0; stage < E_latency_stage_max; stage++) {
+    if(latency_get_stage_stats(stage, &latency_stats->stages[stage]) < 0) {
+      pr_err("Latency statistics are not built in");
+      return E_management_api_response_not_supported;
+    }
+  }
+
+  if(print_flag) {
+    print_latency_stats(latency_stats);
+  }
+
+  return E_management_api_response_ok;
+}
+
+T_management_api_response management_get_mutex_stats(int print_flag, T_os_mutex_prof_report *mutex_stats)
+{
+  if(mutex_stats == NULL) {
+    return E_management_api_response_invalid;
+  }
+
+  if(print_flag) {
+    pr_info("**%s**", __func__);
+  }
+
+  if(os_mutex_prof_get_report(mutex_stats) < 0) {
+    pr_err("Mutex profiling is not built in");
+    return E_management_api_response_not_supported;
+  }
+
+  if(print_flag) {
+    print_mutex_stats(mutex_stats);
+  }
+
+  return E_management_api_response_ok;
+}
+
+T_management_api_response management_get_journal(int print_flag,
+                                                 unsigned long long since_seq,
+                                                 T_management_journal *journal)
+{
+  T_journal_entry entries[MAX_JOURNAL_ENTRIES_PER_RESPONSE];
+  T_management_journal_entry *journal_entry;
+  int i;
+
+  if(journal == NULL) {
+    return E_management_api_response_invalid;
+  }
+
+  if(print_flag) {
+    pr_info("**%s**", __func__);
+  }
+
+  memset(journal, 0, sizeof(*journal));
+
+  journal->num_entries = journal_read(since_seq,
+                                      entries,
+                                      MAX_JOURNAL_ENTRIES_PER_RESPONSE,
+                                      &journal->last_seq,
+                                      &journal->num_lost);
+
+  for(i = 0; i < journal->num_entries; i++) {
+    journal_entry = &journal->entries[i];
+    journal_entry->entry = entries[i];
+    /* Sync index of the current QL event is that of the selected clock, which is LO if negative */
+    if((entries[i].sync_idx != JOURNAL_NO_SYNC_IDX) || (entries[i].type == E_journal_event_type_current_ql)) {
+      control_get_sync_name(entries[i].sync_idx, journal_entry->port_name);
+    }
+  }
+
+  if(print_flag) {
+    print_journal(journal);
+  }
+
+  return E_management_api_response_ok;
+}
+
 T_management_api_response management_set_forced_ql(int print_flag, const char *port_name, T_esmc_ql forced_ql)
 {
   int resp;
@@ -627,6 +842,11 @@ T_management_api_response management_set_pri(int print_flag, const char *port_na
 }
 
 T_management_api_response management_set_max_msg_level(int print_flag, int max_msg_lvl)
+{
+  return management_set_module_max_msg_level(print_flag, PRINT_MODULE_ALL, max_msg_lvl);
+}
+
+T_management_api_response management_set_module_max_msg_level(int print_flag, int module, int max_msg_lvl)
 {
   if(print_flag) {
     pr_info("**%s**", __func__);
@@ -638,9 +858,65 @@ T_management_api_response management_set_max_msg_level(int print_flag, int max_m
     return E_management_api_response_invalid;
   }
 
-  print_set_max_msg_level(max_msg_lvl);
+  if(module == PRINT_MODULE_ALL) {
+    print_set_max_msg_level(max_msg_lvl);
+    pr_info("Updated max message level to %d", max_msg_lvl);
+  } else {
+    if((module < 0) || (print_set_module_max_msg_level(module, max_msg_lvl) < 0)) {
+      pr_err("Invalid message module %d", module);
+      return E_management_api_response_invalid;
+    }
+    pr_info("Updated max message level of %s module to %d", print_module_to_str(module), max_msg_lvl);
+  }
+
+  if(max_msg_lvl > SYNCED_MAX_MSG_LVL) {
+    pr_warning("Messages above level %d are not built in", SYNCED_MAX_MSG_LVL);
+  }
+
+  return E_management_api_response_ok;
+}
+
+T_management_api_response management_apply_changes(int print_flag, T_management_change const *changes, int num_changes)
+{
+  int resp;
+  int i;
 
-  pr_info("Updated max message level to %d", max_msg_lvl);
+  if(print_flag) {
+    pr_info("**%s**", __func__);
+  }
+
+  if((changes == NULL) && (num_changes > 0)) {
+    return E_management_api_response_invalid;
+  }
+
+  for(i = 0; i < num_changes; i++) {
+    if(changes[i].type >= E_management_change_type_max) {
+      return E_management_api_response_invalid;
+    }
+
+    /* Check if clock index is valid */
+    if((changes[i].type == E_management_change_type_assign_new_synce_clk_port) &&
+       ((changes[i].value < 0) || (changes[i].value >= MAX_NUM_OF_CLOCKS))) {
+      pr_err("Invalid clock index %d", changes[i].value);
+      return E_management_api_response_invalid;
+    }
+
+    /* Check if priority is valid */
+    if((changes[i].type == E_management_change_type_set_pri) && ((changes[i].value < 0) || (changes[i].value > 255))) {
+      pr_err("Invalid priority %d", changes[i].value);
+      return E_management_api_response_invalid;
+    }
+  }
+
+  resp = control_apply_changes(changes, num_changes);
+  if(resp < 0) {
+    pr_err("Failed to apply %d changes", num_changes);
+    if(resp == -1) {
+      return E_management_api_response_failed;
+    } else {
+      return E_management_api_response_not_supported;
+    }
+  }
 
   return E_management_api_response_ok;
 }
@@ -33,6 +33,7 @@
 #include "../common/types.h"
 #include "../control/sync.h"
 #include "../device/device_adaptor/device_adaptor.h"
+#include "../esmc/esmc_adaptor/esmc_adaptor.h"
 
 typedef enum {
   E_management_api_response_ok,
@@ -45,7 +46,8 @@ typedef enum {
   E_alarm_type_invalid_clock_idx,
   E_alarm_type_invalid_sync_idx,
   E_alarm_type_timing_loop,
-  E_alarm_type_invalid_rx_ql
+  E_alarm_type_invalid_rx_ql,
+  E_alarm_type_reference_degradation
 } T_alarm_type;
 
 typedef enum {
@@ -63,6 +65,12 @@ typedef struct {
   const char *port_name;
 } T_alarm_data_invalid_rx_ql;
 
+typedef struct {
+  const char *port_name;
+  int clk_idx;
+  int degrading_flag;
+} T_alarm_data_reference_degradation;
+
 typedef struct {
   int config_pri;
   T_esmc_ql current_ql;
@@ -76,6 +84,7 @@ typedef struct {
   T_device_clk_reference_monitor_status ref_mon_status;
   int rx_timeout_flag;
   int port_link_down_flag;
+  int degrading_flag;                                   /* Last, so the fixed-size message layout of older releases is kept */
 } T_management_synce_clk_info;
 
 typedef struct {
@@ -98,6 +107,7 @@ typedef struct {
   int rank;
   T_sync_clk_state clk_state;
   T_device_clk_reference_monitor_status ref_mon_status;
+  int degrading_flag;
 } T_management_ext_clk_info;
 
 typedef struct {
@@ -116,6 +126,29 @@ typedef struct {
   };
 } T_management_sync_info;
 
+typedef struct {
+  char name[INTERFACE_MAX_NAME_LEN];
+  T_esmc_port_stats esmc_stats;
+} T_management_port_stats;
+
+typedef struct {
+  T_latency_stage_stats stages[E_latency_stage_max];
+} T_management_latency_stats;
+
+#define MAX_JOURNAL_ENTRIES_PER_RESPONSE   64
+
+typedef struct {
+  T_journal_entry entry;
+  char port_name[INTERFACE_MAX_NAME_LEN];   /* Empty if the event is not specific to a sync */
+} T_management_journal_entry;
+
+typedef struct {
+  unsigned long long last_seq;              /* Pass as since_seq to get the following entries */
+  unsigned long long num_lost;              /* Entries after since_seq overwritten before they were read */
+  int num_entries;
+  T_management_journal_entry entries[MAX_JOURNAL_ENTRIES_PER_RESPONSE];
+} T_management_journal;
+
 typedef struct {
   T_esmc_ql current_ql;
   char port_name[INTERFACE_MAX_NAME_LEN];
@@ -124,11 +157,26 @@ typedef struct {
   unsigned int holdover_remaining_time_ms;
 } T_management_status;
 
+typedef enum {
+  E_management_change_type_set_forced_ql,
+  E_management_change_type_clear_forced_ql,
+  E_management_change_type_assign_new_synce_clk_port,
+  E_management_change_type_set_pri,
+  E_management_change_type_max
+} T_management_change_type;
+
+typedef struct {
+  T_management_change_type type;
+  char port_name[INTERFACE_MAX_NAME_LEN];
+  int value;                                /* Forced QL, clock index, or priority (unused for clear forced QL) */
+} T_management_change;
+
 typedef struct {
   T_alarm_type alarm_type;
   union {
     T_alarm_data_timing_loop alarm_timing_loop;
     T_alarm_data_invalid_rx_ql alarm_invalid_ql;
+    T_alarm_data_reference_degradation alarm_reference_degradation;
   };
 } T_alarm_data;
 
@@ -202,6 +250,41 @@ T_management_api_response management_get_sync_info(int print_flag,
                                                    const char *port_name,
                                                    T_management_sync_info *sync_info);
 
+/*
+ * Get ESMC traffic and error counters for specified Sync-E clock, Sync-E monitoring, or Sync-E TX only port name
+ *
+ * Counters are cumulative since synced started.
+ */
+T_management_api_response management_get_port_stats(int print_flag,
+                                                    const char *port_name,
+                                                    T_management_port_stats *port_stats);
+
+/*
+ * Get QL propagation latency statistics (count, mean and percentiles of each stage and end to end)
+ *
+ * Statistics are cumulative since synced started. Returns not supported if synced was built with
+ * SYNCED_LATENCY_STATS=0.
+ */
+T_management_api_response management_get_latency_stats(int print_flag, T_management_latency_stats *latency_stats);
+
+/*
+ * Get mutex contention statistics (acquisitions, contended acquisitions, wait and hold times per mutex and per call site)
+ *
+ * Statistics are cumulative since synced started. Returns not supported unless synced was built with
+ * SYNCED_MUTEX_PROFILING=1.
+ */
+T_management_api_response management_get_mutex_stats(int print_flag, T_os_mutex_prof_report *mutex_stats);
+
+/*
+ * Get up to MAX_JOURNAL_ENTRIES_PER_RESPONSE journal entries (ESMC events, state changes, clock priority updates
+ * and alarms) recorded after sequence number since_seq, oldest first
+ *
+ * Pass 0 to start from the oldest entry kept and journal->last_seq of the previous response to continue.
+ */
+T_management_api_response management_get_journal(int print_flag,
+                                                 unsigned long long since_seq,
+                                                 T_management_journal *journal);
+
 /*
  * Set forced QL for specified Sync-E clock, Sync-E monitoring, or external clock port name
  *
@@ -242,4 +325,20 @@ T_management_api_response management_set_pri(int print_flag,
 T_management_api_response management_set_max_msg_level(int print_flag,
                                                        int max_msg_lvl);
 
+/* Set max message level for one module (T_print_module), or for all modules if module is PRINT_MODULE_ALL */
+T_management_api_response management_set_module_max_msg_level(int print_flag,
+                                                              int module,
+                                                              int max_msg_lvl);
+
+/*
+ * Apply forced QL, priority, and Sync-E clock port changes as one transaction
+ *
+ * The changes are applied in order to a copy of the configuration and validated together, so priorities
+ * can be swapped between ports. If any change fails, none is applied. Otherwise, all changes take effect at once,
+ * followed by a single clock selection and device priority table update.
+ */
+T_management_api_response management_apply_changes(int print_flag,
+                                                   T_management_change const *changes,
+                                                   int num_changes);
+
 #endif /* MANAGEMENT_H */
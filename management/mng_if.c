@@ -20,15 +20,46 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_management
+
+#define _GNU_SOURCE /* struct ucred */
+
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include "mng_if.h"
+#include "mng_tlv.h"
 #include "../common/print.h"
+#include "../common/trace.h"
+
+#define MNG_IF_MAX_NUM_OF_CLIENTS   16
+#define MNG_IF_LISTEN_BACKLOG       MNG_IF_MAX_NUM_OF_CLIENTS
+#define MNG_IF_RX_BUFF_SIZE         16384 /* Limits the size of a batch request */
+#define MNG_IF_BATCH_FAILED_RESPONSE_LEN (3 * MNG_TLV_HEADER_LEN + 2 * sizeof(uint32_t)) /* API code and response only */
+#define MNG_IF_MAX_TX_PENDING       (4 * sizeof(T_mng_api_response_msg)) /* Stop reading requests from a client that does not read responses */
+#define MNG_IF_MAX_TLV_FRAME_LEN    MNG_TLV_MAX_FRAME_LEN
+#define MNG_IF_MAX_EPOLL_EVENTS     (MNG_IF_MAX_NUM_OF_CLIENTS + 4)
+#define MNG_IF_EVENT_QUEUE_SIZE     64  /* Per subscriber; the oldest event is dropped when full */
+#define MNG_IF_MAX_TRANSACTION_SIZE 128 /* Changes staged by one transaction */
+
+#define MNG_IF_UNIX_SOCKET_MODE     0660
+#define MNG_IF_UNIX_SNDBUF_SIZE     MNG_IF_MAX_TLV_FRAME_LEN /* Each response must fit into one packet */
+
+/* epoll user data for the listening sockets, the stop event, and the publish event; client slots use their index */
+#define MNG_IF_EPOLL_ID_LISTEN      MNG_IF_MAX_NUM_OF_CLIENTS
+#define MNG_IF_EPOLL_ID_STOP        (MNG_IF_MAX_NUM_OF_CLIENTS + 1)
+#define MNG_IF_EPOLL_ID_EVENT       (MNG_IF_MAX_NUM_OF_CLIENTS + 2)
+#define MNG_IF_EPOLL_ID_LISTEN_UNIX (MNG_IF_MAX_NUM_OF_CLIENTS + 3)
 
 typedef enum  {
   E_mng_if_thread_state_not_started,
@@ -42,204 +73,1151 @@ typedef struct {
   T_mng_if_thread_state thread_state;
 } T_mng_if_thread_data;
 
+typedef enum {
+  E_mng_if_protocol_unknown,                 /* No request received yet */
+  E_mng_if_protocol_legacy,                  /* Fixed-size request and response messages */
+  E_mng_if_protocol_tlv                      /* TLV frames (see mng_tlv.h) */
+} T_mng_if_protocol;
+
+typedef struct {
+  int fd;
+  int seqpacket_flag;                        /* Unix domain socket; every frame is sent and received as one packet */
+  uint32_t events;                           /* Events currently registered with epoll */
+  T_mng_if_protocol protocol;
+  int subscribed_flag;
+  unsigned char rx_buff[MNG_IF_RX_BUFF_SIZE];
+  size_t rx_len;                             /* Bytes received but not yet processed */
+  int rx_blocked_flag;                       /* Requests were left in rx_buff until the client reads its responses */
+  unsigned char *tx_buff;
+  size_t tx_size;                            /* Bytes allocated */
+  size_t tx_len;                             /* Bytes queued */
+  size_t tx_pos;                             /* Bytes already sent */
+  int transaction_flag;                      /* Configuration changes are staged until commit */
+  int num_changes;
+  T_management_change changes[MNG_IF_MAX_TRANSACTION_SIZE];
+} T_mng_if_client;
+
+typedef enum {
+  E_mng_if_request_type_api,
+  E_mng_if_request_type_subscribe,
+  E_mng_if_request_type_batch
+} T_mng_if_request_type;
+
+typedef struct {
+  T_mng_if_request_type type;
+  size_t len;                                /* Bytes taken from the receive buffer */
+  T_mng_api_request_msg api_msg;             /* API request */
+  unsigned int event_mask;                   /* Subscribe request */
+  const unsigned char *batch;                /* Batch request payload (points into the receive buffer) */
+  size_t batch_len;
+  int unsupported_flag;                      /* Batch request of unsupported version */
+} T_mng_if_request;
+
+typedef struct {
+  unsigned int seq;
+  T_mng_event event;
+} T_mng_if_event_entry;
+
+/* Event queue of a client; shared between publishing threads and the management interface thread */
+typedef struct {
+  unsigned int event_mask;                   /* Subscribed event types (0 if not subscribed) */
+  unsigned int last_seq;                     /* Sequence number of the last queued event */
+  T_mng_if_event_entry queue[MNG_IF_EVENT_QUEUE_SIZE];
+  int head;                                  /* Index of the oldest queued event */
+  int num_events;
+  unsigned int num_dropped;
+} T_mng_if_subscriber;
+
 /* Static data */
 
 static int g_mng_if_fd = UNINITIALIZED_FD;
+static int g_mng_if_unix_fd = UNINITIALIZED_FD;
+static char g_mng_if_unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static int g_mng_if_unix_gid = -1;
+static int g_mng_if_epoll_fd = UNINITIALIZED_FD;
+static int g_mng_if_stop_fd = UNINITIALIZED_FD;
+static int g_mng_if_event_fd = UNINITIALIZED_FD;
 T_mng_if_thread_data g_mng_if_thread_data;
 
+static T_mng_if_client g_mng_if_clients[MNG_IF_MAX_NUM_OF_CLIENTS];
+
+/* Indexed like g_mng_if_clients and protected by g_mng_if_event_mutex */
+static T_mng_if_subscriber g_mng_if_subscribers[MNG_IF_MAX_NUM_OF_CLIENTS];
+static pthread_mutex_t g_mng_if_event_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Only used by management interface thread */
+static T_mng_api_response_msg g_mng_if_rsp_msg;
+static T_os_mutex_prof_report g_mng_if_mutex_stats;
+static unsigned char g_mng_if_tlv_buff[MNG_IF_MAX_TLV_FRAME_LEN];
+
 /* Static functions */
 
-static int create_new_connection(void)
+static int mng_if_set_nonblocking(int fd)
+{
+  int flags;
+
+  flags = fcntl(fd, F_GETFL, 0);
+  if((flags < 0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  return 0;
+}
+
+static int mng_if_epoll_add(int fd, uint32_t events, uint32_t id)
+{
+  struct epoll_event event;
+
+  memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.u32 = id;
+
+  if(epoll_ctl(g_mng_if_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  return 0;
+}
+
+static void mng_if_client_set_events(T_mng_if_client *client, uint32_t events)
 {
-  int new_conn;
+  struct epoll_event event;
 
-  new_conn = accept(g_mng_if_fd, NULL, NULL);
-  if(new_conn == UNINITIALIZED_FD) {
-    /* Wait for 50 ms */
-    usleep(50000);
-    return UNINITIALIZED_FD;
+  if(client->events == events) {
+    return;
   }
 
-  pr_info("Management interface thread accepted connection %d", new_conn);
+  memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.u32 = (uint32_t)(client - g_mng_if_clients);
 
-  return new_conn;
+  if(epoll_ctl(g_mng_if_epoll_fd, EPOLL_CTL_MOD, client->fd, &event) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return;
+  }
+
+  client->events = events;
 }
 
-static int respond_to_request(int conn_fd)
+static void mng_if_client_close(T_mng_if_client *client)
 {
-  T_mng_api_request_msg req_msg;
-  T_mng_api_response_msg rsp_msg;
-  int status;
-  struct iovec iov;
-  struct msghdr msgh;
+  pr_info("Management interface thread terminated connection %d", client->fd);
 
-  memset(&req_msg, 0, sizeof(req_msg));
-  memset(&rsp_msg, 0, sizeof(rsp_msg));
-  memset(&iov, 0, sizeof(iov));
-  memset(&msgh, 0, sizeof(msgh));
+  epoll_ctl(g_mng_if_epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+  close(client->fd);
 
-  iov.iov_base = &req_msg;
-  iov.iov_len = sizeof(req_msg);
+  os_mutex_lock(&g_mng_if_event_mutex);
+  memset(&g_mng_if_subscribers[client - g_mng_if_clients], 0, sizeof(T_mng_if_subscriber));
+  os_mutex_unlock(&g_mng_if_event_mutex);
 
-  msgh.msg_iov = &iov;
-  msgh.msg_iovlen = 1;
+  free(client->tx_buff);
+  memset(client, 0, sizeof(*client));
+  client->fd = UNINITIALIZED_FD;
+}
 
-  status = recvmsg(conn_fd, &msgh, 0);
-  if(status < 0) {
-    if((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
-      return conn_fd;
+static int mng_if_client_queue(T_mng_if_client *client, const void *data, size_t len)
+{
+  unsigned char *tx_buff;
+  size_t tx_size;
+
+  if(client->tx_pos == client->tx_len) {
+    /* Everything was sent; reuse the buffer from the start */
+    client->tx_pos = 0;
+    client->tx_len = 0;
+  }
+
+  if(client->tx_len + len > client->tx_size) {
+    if(client->tx_pos > 0) {
+      /* Compact unsent bytes to the start of the buffer */
+      memmove(client->tx_buff, &client->tx_buff[client->tx_pos], client->tx_len - client->tx_pos);
+      client->tx_len -= client->tx_pos;
+      client->tx_pos = 0;
+    }
+
+    tx_size = (client->tx_size > 0) ? client->tx_size : len;
+    while(tx_size < client->tx_len + len) {
+      tx_size *= 2;
     }
 
-    pr_err("Management interface connection failed");
-    close(conn_fd);
-    return UNINITIALIZED_FD;
-  } else if(status == 0) {
-    pr_info("Management interface thread terminated connection %d", conn_fd);
-    close(conn_fd);
-    return UNINITIALIZED_FD;
+    if(tx_size != client->tx_size) {
+      tx_buff = realloc(client->tx_buff, tx_size);
+      if(tx_buff == NULL) {
+        pr_err("Failed to allocate memory for management interface response");
+        return -1;
+      }
+      client->tx_buff = tx_buff;
+      client->tx_size = tx_size;
+    }
   }
 
-  /* Request message received */
-  if(req_msg.api_code < E_mng_api_max) {
-    pr_info("Management API: %s", conv_api_code_to_str(req_msg.api_code));
+  memcpy(&client->tx_buff[client->tx_len], data, len);
+  client->tx_len += len;
 
-    memset(&rsp_msg, 0, sizeof(rsp_msg));
+  return 0;
+}
 
-    rsp_msg.api_code = req_msg.api_code;
+/* Length of the next queued frame, which a Unix domain socket client must receive as one packet */
+static size_t mng_if_client_next_frame_len(T_mng_if_client const *client)
+{
+  T_mng_tlv_frame_header header;
+  size_t len = client->tx_len - client->tx_pos;
 
-    switch(rsp_msg.api_code) {
-      case E_mng_api_get_sync_info_list:
-      {
-        int print_flag = req_msg.request_get_sync_info_list.print_flag;
-        int max_num_syncs = req_msg.request_get_sync_info_list.max_num_syncs;
-        if(max_num_syncs > MAX_SYNC_INFO_STRUCTURES) {
-          max_num_syncs = MAX_SYNC_INFO_STRUCTURES;
-        }
-        rsp_msg.response = management_get_sync_info_list(print_flag,
-                                                         max_num_syncs,
-                                                         &rsp_msg.response_get_sync_info_list.sync_info_list[0],
-                                                         &rsp_msg.response_get_sync_info_list.num_syncs);
+  if(client->protocol == E_mng_if_protocol_legacy) {
+    return MNG_API_LEGACY_RESPONSE_MSG_LEN;
+  }
+
+  /* Only whole frames are queued */
+  if(mng_tlv_parse_frame_header(&client->tx_buff[client->tx_pos], len, &header) <= 0) {
+    return len;
+  }
+
+  return MNG_TLV_FRAME_HEADER_LEN + header.payload_len;
+}
+
+/* Return 0 if client is still connected and -1 otherwise */
+static int mng_if_client_flush(T_mng_if_client *client)
+{
+  ssize_t status;
+  size_t len;
+
+  while(client->tx_pos < client->tx_len) {
+    len = client->seqpacket_flag ? mng_if_client_next_frame_len(client) : (client->tx_len - client->tx_pos);
+    status = send(client->fd, &client->tx_buff[client->tx_pos], len, MSG_NOSIGNAL);
+    if(status < 0) {
+      if((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
+        break;
+      } else if(errno == EINTR) {
+        continue;
       }
-      break;
 
-      case E_mng_api_get_current_status:
-      {
-        int print_flag = req_msg.request_get_current_status.print_flag;
-        rsp_msg.response = management_get_current_status(print_flag,
-                                                         &rsp_msg.response_get_current_status.current_status);
+      pr_err("Management interface connection %d failed: %s", client->fd, strerror(errno));
+      mng_if_client_close(client);
+      return -1;
+    }
+    client->tx_pos += status;
+  }
+
+  return 0;
+}
+
+static void mng_if_client_update_events(T_mng_if_client *client)
+{
+  uint32_t events = 0;
+  size_t tx_pending = client->tx_len - client->tx_pos;
+
+  if(tx_pending < MNG_IF_MAX_TX_PENDING) {
+    events |= EPOLLIN;
+  }
+  if(tx_pending > 0) {
+    events |= EPOLLOUT;
+  }
+
+  mng_if_client_set_events(client, events);
+}
+
+/* Stage a configuration change of an open transaction */
+static T_management_api_response mng_if_client_stage_change(T_mng_if_client *client,
+                                                            T_management_change_type type,
+                                                            const char *port_name,
+                                                            int value)
+{
+  T_management_change *change;
+
+  if(client->num_changes >= MNG_IF_MAX_TRANSACTION_SIZE) {
+    pr_err("Management interface connection %d exceeded %d changes in a transaction",
+           client->fd, MNG_IF_MAX_TRANSACTION_SIZE);
+    return E_management_api_response_failed;
+  }
+
+  change = &client->changes[client->num_changes];
+  change->type = type;
+  strncpy(change->port_name, port_name, sizeof(change->port_name) - 1);
+  change->port_name[sizeof(change->port_name) - 1] = '\0';
+  change->value = value;
+  client->num_changes++;
+
+  return E_management_api_response_ok;
+}
+
+static void mng_if_client_end_transaction(T_mng_if_client *client)
+{
+  client->transaction_flag = 0;
+  client->num_changes = 0;
+}
+
+static void mng_if_process_request(T_mng_if_client *client,
+                                   T_mng_api_request_msg const *req_msg,
+                                   T_mng_api_response_msg *rsp_msg)
+{
+  memset(rsp_msg, 0, sizeof(*rsp_msg));
+
+  rsp_msg->api_code = req_msg->api_code;
+
+  if(req_msg->api_code >= E_mng_api_max) {
+    rsp_msg->response = E_management_api_response_not_supported;
+    return;
+  }
+
+  pr_info("Management API: %s", conv_api_code_to_str(req_msg->api_code));
+
+  switch(rsp_msg->api_code) {
+    case E_mng_api_get_sync_info_list:
+    {
+      int print_flag = req_msg->request_get_sync_info_list.print_flag;
+      int max_num_syncs = req_msg->request_get_sync_info_list.max_num_syncs;
+      if(max_num_syncs > MAX_SYNC_INFO_STRUCTURES) {
+        max_num_syncs = MAX_SYNC_INFO_STRUCTURES;
       }
-      break;
+      rsp_msg->response = management_get_sync_info_list(print_flag,
+                                                        max_num_syncs,
+                                                        &rsp_msg->response_get_sync_info_list.sync_info_list[0],
+                                                        &rsp_msg->response_get_sync_info_list.num_syncs);
+    }
+    break;
 
-      case E_mng_api_get_sync_info:
-      {
-        int print_flag = req_msg.request_get_sync_info.print_flag;
-        const char *port_name = req_msg.request_get_sync_info.port_name;
-        rsp_msg.response = management_get_sync_info(print_flag,
-                                                    port_name,
-                                                    &rsp_msg.response_get_sync_info.sync_info);
+    case E_mng_api_get_current_status:
+    {
+      int print_flag = req_msg->request_get_current_status.print_flag;
+      rsp_msg->response = management_get_current_status(print_flag,
+                                                        &rsp_msg->response_get_current_status.current_status);
+    }
+    break;
+
+    case E_mng_api_get_sync_info:
+    {
+      int print_flag = req_msg->request_get_sync_info.print_flag;
+      const char *port_name = req_msg->request_get_sync_info.port_name;
+      rsp_msg->response = management_get_sync_info(print_flag,
+                                                   port_name,
+                                                   &rsp_msg->response_get_sync_info.sync_info);
+    }
+    break;
+
+    case E_mng_api_set_forced_ql:
+    {
+      int print_flag = req_msg->request_set_forced_ql.print_flag;
+      const char *port_name = req_msg->request_set_forced_ql.port_name;
+      T_esmc_ql forced_ql = req_msg->request_set_forced_ql.forced_ql;
+      if(client->transaction_flag) {
+        rsp_msg->response = mng_if_client_stage_change(client,
+                                                       E_management_change_type_set_forced_ql,
+                                                       port_name,
+                                                       forced_ql);
+        break;
       }
-      break;
+      rsp_msg->response = management_set_forced_ql(print_flag,
+                                                   port_name,
+                                                   forced_ql);
+    }
+    break;
+
+    case E_mng_api_clear_forced_ql:
+    {
+      int print_flag = req_msg->request_clear_forced_ql.print_flag;
+      const char *port_name = req_msg->request_clear_forced_ql.port_name;
+      if(client->transaction_flag) {
+        rsp_msg->response = mng_if_client_stage_change(client,
+                                                       E_management_change_type_clear_forced_ql,
+                                                       port_name,
+                                                       0);
+        break;
+      }
+      rsp_msg->response = management_clear_forced_ql(print_flag,
+                                                     port_name);
+    }
+    break;
+
+    case E_mng_api_clear_holdover_timer:
+    {
+      int print_flag = req_msg->request_clear_holdover_timer.print_flag;
+      rsp_msg->response = management_clear_holdover_timer(print_flag);
+    }
+    break;
+
+    case E_mng_api_clear_synce_clk_wtr_timer:
+    {
+      int print_flag = req_msg->request_clear_synce_clk_wtr_timer.print_flag;
+      const char *port_name = req_msg->request_clear_synce_clk_wtr_timer.port_name;
+      rsp_msg->response = management_clear_synce_clk_wtr_timer(print_flag,
+                                                               port_name);
+    }
+    break;
+
+    case E_mng_api_assign_new_synce_clk_port:
+    {
+      int print_flag = req_msg->request_assign_new_synce_clk_port.print_flag;
+      int clk_idx = req_msg->request_assign_new_synce_clk_port.clk_idx;
+      const char *port_name = req_msg->request_assign_new_synce_clk_port.port_name;
+      if(client->transaction_flag) {
+        rsp_msg->response = mng_if_client_stage_change(client,
+                                                       E_management_change_type_assign_new_synce_clk_port,
+                                                       port_name,
+                                                       clk_idx);
+        break;
+      }
+      rsp_msg->response = management_assign_new_synce_clk_port(print_flag,
+                                                               clk_idx,
+                                                               port_name);
+    }
+    break;
+
+    case E_mng_api_set_pri:
+    {
+      int print_flag = req_msg->request_set_pri.print_flag;
+      const char *port_name = req_msg->request_set_pri.port_name;
+      int pri = req_msg->request_set_pri.pri;
+      if(client->transaction_flag) {
+        rsp_msg->response = mng_if_client_stage_change(client,
+                                                       E_management_change_type_set_pri,
+                                                       port_name,
+                                                       pri);
+        break;
+      }
+      rsp_msg->response = management_set_pri(print_flag,
+                                             port_name,
+                                             pri);
+    }
+    break;
+
+    case E_mng_api_set_max_msg_lvl:
+    {
+      int print_flag = req_msg->request_set_max_msg_lvl.print_flag;
+      int module = req_msg->request_set_max_msg_lvl.module_flag ? req_msg->request_set_max_msg_lvl.module : PRINT_MODULE_ALL;
+      int max_msg_level = req_msg->request_set_max_msg_lvl.max_msg_lvl;
+      rsp_msg->response = management_set_module_max_msg_level(print_flag,
+                                                              module,
+                                                              max_msg_level);
+    }
+    break;
+
+    case E_mng_api_begin_transaction:
+    {
+      if(client->transaction_flag) {
+        pr_err("Management interface connection %d already has an open transaction", client->fd);
+        rsp_msg->response = E_management_api_response_failed;
+        break;
+      }
+      client->transaction_flag = 1;
+      client->num_changes = 0;
+      rsp_msg->response = E_management_api_response_ok;
+    }
+    break;
+
+    case E_mng_api_commit_transaction:
+    {
+      int print_flag = req_msg->request_commit_transaction.print_flag;
+      if(!client->transaction_flag) {
+        pr_err("Management interface connection %d has no open transaction", client->fd);
+        rsp_msg->response = E_management_api_response_failed;
+        break;
+      }
+      /* The transaction ends whether or not its changes could be applied */
+      rsp_msg->response = management_apply_changes(print_flag,
+                                                   client->changes,
+                                                   client->num_changes);
+      mng_if_client_end_transaction(client);
+    }
+    break;
+
+    case E_mng_api_abort_transaction:
+    {
+      if(!client->transaction_flag) {
+        pr_err("Management interface connection %d has no open transaction", client->fd);
+        rsp_msg->response = E_management_api_response_failed;
+        break;
+      }
+      mng_if_client_end_transaction(client);
+      rsp_msg->response = E_management_api_response_ok;
+    }
+    break;
 
-      case E_mng_api_set_forced_ql:
-      {
-        int print_flag = req_msg.request_set_forced_ql.print_flag;
-        const char *port_name = req_msg.request_set_forced_ql.port_name;
-        T_esmc_ql forced_ql = req_msg.request_set_forced_ql.forced_ql;
-        rsp_msg.response = management_set_forced_ql(print_flag,
+    case E_mng_api_get_port_stats:
+    {
+      int print_flag = req_msg->request_get_port_stats.print_flag;
+      const char *port_name = req_msg->request_get_port_stats.port_name;
+      rsp_msg->response = management_get_port_stats(print_flag,
                                                     port_name,
-                                                    forced_ql);
+                                                    &rsp_msg->response_get_port_stats.port_stats);
+    }
+    break;
+
+    case E_mng_api_get_latency_stats:
+    {
+      int print_flag = req_msg->request_get_latency_stats.print_flag;
+      rsp_msg->response = management_get_latency_stats(print_flag,
+                                                       &rsp_msg->response_get_latency_stats.latency_stats);
+    }
+    break;
+
+    case E_mng_api_get_mutex_stats:
+    {
+      int print_flag = req_msg->request_get_mutex_stats.print_flag;
+      if(client->protocol == E_mng_if_protocol_legacy) {
+        /* Report is only sent with TLV encoding, so it does not size every fixed-size response */
+        rsp_msg->response = E_management_api_response_not_supported;
+        break;
       }
+      rsp_msg->response_get_mutex_stats.mutex_stats = &g_mng_if_mutex_stats;
+      rsp_msg->response = management_get_mutex_stats(print_flag,
+                                                     rsp_msg->response_get_mutex_stats.mutex_stats);
+    }
+    break;
+
+    case E_mng_api_get_journal:
+    {
+      int print_flag = req_msg->request_get_journal.print_flag;
+      unsigned long long since_seq = ((unsigned long long)req_msg->request_get_journal.since_seq_high << 32) |
+                                     req_msg->request_get_journal.since_seq_low;
+      rsp_msg->response = management_get_journal(print_flag,
+                                                 since_seq,
+                                                 &rsp_msg->response_get_journal.journal);
+    }
+    break;
+
+    default:
       break;
+  }
+}
+
+/* Return 1 if a request was parsed, 0 if more bytes are needed, and -1 if the stream is invalid */
+static int mng_if_client_parse_request(T_mng_if_client *client, size_t offset, T_mng_if_request *req)
+{
+  const unsigned char *buff = &client->rx_buff[offset];
+  size_t len = client->rx_len - offset;
+  T_mng_tlv_frame_header header;
+  const unsigned char *payload;
+  int status;
+
+  if(client->protocol == E_mng_if_protocol_unknown) {
+    /* The first request of a connection selects its encoding */
+    status = mng_tlv_is_frame(buff, len);
+    if(status == 0) {
+      return 0;
+    }
+    client->protocol = (status > 0) ? E_mng_if_protocol_tlv : E_mng_if_protocol_legacy;
+  }
+
+  if(client->protocol == E_mng_if_protocol_legacy) {
+    if(len < sizeof(req->api_msg)) {
+      return 0;
+    }
+    req->type = E_mng_if_request_type_api;
+    req->len = sizeof(req->api_msg);
+    memcpy(&req->api_msg, buff, sizeof(req->api_msg));
+    return 1;
+  }
+
+  status = mng_tlv_parse_frame_header(buff, len, &header);
+  if(status <= 0) {
+    if(status < 0) {
+      pr_err("Management interface connection %d sent invalid frame header", client->fd);
+    }
+    return status;
+  }
 
-      case E_mng_api_clear_forced_ql:
-      {
-        int print_flag = req_msg.request_clear_forced_ql.print_flag;
-        const char *port_name = req_msg.request_clear_forced_ql.port_name;
-        rsp_msg.response = management_clear_forced_ql(print_flag,
-                                                      port_name);
+  req->len = MNG_TLV_FRAME_HEADER_LEN + header.payload_len;
+  if(req->len > sizeof(client->rx_buff)) {
+    pr_err("Management interface connection %d sent too long frame (%zu bytes)", client->fd, req->len);
+    return -1;
+  }
+
+  if(len < req->len) {
+    return 0;
+  }
+  payload = &buff[MNG_TLV_FRAME_HEADER_LEN];
+
+  switch(header.type) {
+    case E_mng_tlv_frame_type_request:
+      req->type = E_mng_if_request_type_api;
+      if((header.version != MNG_TLV_VERSION) || (mng_tlv_decode_request(payload, header.payload_len, &req->api_msg) < 0)) {
+        /* Answered as not supported so the client can fall back to an older version */
+        pr_warning("Management interface connection %d sent unsupported request (version %u)", client->fd, header.version);
+        memset(&req->api_msg, 0, sizeof(req->api_msg));
+        req->api_msg.api_code = E_mng_api_max;
       }
       break;
 
-      case E_mng_api_clear_holdover_timer:
-      {
-        int print_flag = req_msg.request_clear_holdover_timer.print_flag;
-        rsp_msg.response = management_clear_holdover_timer(print_flag);
+    case E_mng_tlv_frame_type_subscribe:
+      req->type = E_mng_if_request_type_subscribe;
+      if((header.version != MNG_TLV_VERSION) || (mng_tlv_decode_subscribe(payload, header.payload_len, &req->event_mask) < 0)) {
+        /* Acknowledged with an empty event mask */
+        pr_warning("Management interface connection %d sent unsupported subscribe request (version %u)", client->fd, header.version);
+        req->event_mask = 0;
       }
       break;
 
-      case E_mng_api_clear_synce_clk_wtr_timer:
-      {
-        int print_flag = req_msg.request_clear_synce_clk_wtr_timer.print_flag;
-        const char *port_name = req_msg.request_clear_synce_clk_wtr_timer.port_name;
-        rsp_msg.response = management_clear_synce_clk_wtr_timer(print_flag,
-                                                                port_name);
+    case E_mng_tlv_frame_type_batch_request:
+      req->type = E_mng_if_request_type_batch;
+      req->batch = payload;
+      req->batch_len = header.payload_len;
+      req->unsupported_flag = (header.version != MNG_TLV_VERSION);
+      if(req->unsupported_flag) {
+        /* Every sub-request is answered as not supported */
+        pr_warning("Management interface connection %d sent unsupported batch request (version %u)", client->fd, header.version);
       }
       break;
 
-      case E_mng_api_assign_new_synce_clk_port:
-      {
-        int print_flag = req_msg.request_assign_new_synce_clk_port.print_flag;
-        int clk_idx = req_msg.request_assign_new_synce_clk_port.clk_idx;
-        const char *port_name = req_msg.request_assign_new_synce_clk_port.port_name;
-        rsp_msg.response = management_assign_new_synce_clk_port(print_flag,
-                                                                clk_idx,
-                                                                port_name);
-      }
+    default:
+      pr_err("Management interface connection %d sent invalid frame type %u", client->fd, header.type);
+      return -1;
+  }
+
+  return 1;
+}
+
+/* Answer sub-requests of a batch in order with one frame */
+static int mng_if_client_queue_batch_response(T_mng_if_client *client, T_mng_if_request const *req)
+{
+  T_mng_tlv_writer writer;
+  T_mng_tlv_reader reader;
+  T_mng_api_request_msg req_msg;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  size_t offset;
+  int num_requests = 0;
+  int num_failed = 0;
+  int total_num_requests = 0;
+  int frame_len;
+  int status;
+
+  /* Count sub-requests first, so room for a failed response to each of them can be kept free */
+  mng_tlv_reader_init(&reader, req->batch, req->batch_len);
+  while((status = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type == E_mng_tlv_type_batch_request) {
+      total_num_requests++;
+    }
+  }
+
+  if(status < 0) {
+    pr_err("Management interface connection %d sent malformed batch request", client->fd);
+    return -1;
+  }
+
+  mng_tlv_begin_frame(&writer, g_mng_if_tlv_buff, sizeof(g_mng_if_tlv_buff), E_mng_tlv_frame_type_batch_response);
+  writer.size -= (size_t)total_num_requests * MNG_IF_BATCH_FAILED_RESPONSE_LEN;
+
+  mng_tlv_reader_init(&reader, req->batch, req->batch_len);
+  while((status = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type != E_mng_tlv_type_batch_request) {
+      continue;
+    }
+
+    if(req->unsupported_flag || (num_requests >= MNG_TLV_MAX_BATCH_SIZE) || (mng_tlv_decode_request(val, val_len, &req_msg) < 0)) {
+      memset(&req_msg, 0, sizeof(req_msg));
+      req_msg.api_code = E_mng_api_max;
+    }
+    num_requests++;
+
+    trace_begin();
+    mng_if_process_request(client, &req_msg, &g_mng_if_rsp_msg);
+    trace_end(E_trace_span_mng_request, (req_msg.api_code < E_mng_api_max) ? conv_api_code_to_str(req_msg.api_code) : NULL);
+
+    /* Release the room kept for this sub-request */
+    writer.size += MNG_IF_BATCH_FAILED_RESPONSE_LEN;
+
+    offset = mng_tlv_begin_nested(&writer, E_mng_tlv_type_batch_response);
+    mng_tlv_encode_response(&writer, &g_mng_if_rsp_msg);
+    mng_tlv_end_nested(&writer, offset);
+
+    if(writer.overflow_flag) {
+      /* Response does not fit into the frame; answer the sub-request as failed instead */
+      writer.len = offset;
+      writer.overflow_flag = 0;
+      g_mng_if_rsp_msg.response = E_management_api_response_failed;
+
+      offset = mng_tlv_begin_nested(&writer, E_mng_tlv_type_batch_response);
+      mng_tlv_encode_response(&writer, &g_mng_if_rsp_msg);
+      mng_tlv_end_nested(&writer, offset);
+      num_failed++;
+    }
+  }
+
+  if(num_failed > 0) {
+    pr_warning("Management interface connection %d: %d responses of a batch did not fit into a frame", client->fd, num_failed);
+  }
+
+  if(num_requests > MNG_TLV_MAX_BATCH_SIZE) {
+    pr_warning("Management interface connection %d sent %d requests in a batch (maximum of %d)",
+               client->fd,
+               num_requests,
+               MNG_TLV_MAX_BATCH_SIZE);
+  }
+
+  frame_len = mng_tlv_end_frame(&writer);
+  if(frame_len < 0) {
+    pr_err("Management interface batch response does not fit into a frame");
+    return -1;
+  }
+
+  return mng_if_client_queue(client, g_mng_if_tlv_buff, (size_t)frame_len);
+}
+
+static int mng_if_client_queue_response(T_mng_if_client *client, T_mng_api_response_msg const *rsp_msg)
+{
+  T_mng_tlv_writer writer;
+  int frame_len;
+
+  if(client->protocol == E_mng_if_protocol_legacy) {
+    mng_tlv_pack_legacy_response(rsp_msg, g_mng_if_tlv_buff);
+    return mng_if_client_queue(client, g_mng_if_tlv_buff, MNG_API_LEGACY_RESPONSE_MSG_LEN);
+  }
+
+  mng_tlv_begin_frame(&writer, g_mng_if_tlv_buff, sizeof(g_mng_if_tlv_buff), E_mng_tlv_frame_type_response);
+  mng_tlv_encode_response(&writer, rsp_msg);
+  frame_len = mng_tlv_end_frame(&writer);
+  if(frame_len < 0) {
+    pr_err("Management interface response does not fit into a frame");
+    return -1;
+  }
+
+  return mng_if_client_queue(client, g_mng_if_tlv_buff, (size_t)frame_len);
+}
+
+/* Return 1 if the new event replaces the undelivered old event */
+static int mng_if_event_supersedes(T_mng_event const *old_event, T_mng_event const *new_event)
+{
+  /* Only the latest state matters; alarms are never coalesced */
+  if((old_event->type != new_event->type) || (new_event->type == E_mng_event_type_alarm)) {
+    return 0;
+  }
+
+  return (old_event->clk_idx == new_event->clk_idx) && !strcmp(old_event->port_name, new_event->port_name);
+}
+
+/* Must be called with g_mng_if_event_mutex locked */
+static void mng_if_subscriber_push(T_mng_if_subscriber *subscriber, T_mng_event const *event)
+{
+  T_mng_if_event_entry *entry;
+  int i;
+
+  /* Coalesce with an undelivered event from the same source (a slow client skips intermediate states) */
+  for(i = 0; i < subscriber->num_events; i++) {
+    entry = &subscriber->queue[(subscriber->head + i) % MNG_IF_EVENT_QUEUE_SIZE];
+    if(mng_if_event_supersedes(&entry->event, event)) {
+      entry->event = *event;
+      return;
+    }
+  }
+
+  if(subscriber->num_events == MNG_IF_EVENT_QUEUE_SIZE) {
+    /* Drop the oldest event; the client detects the sequence number gap and resyncs */
+    subscriber->head = (subscriber->head + 1) % MNG_IF_EVENT_QUEUE_SIZE;
+    subscriber->num_events--;
+    subscriber->num_dropped++;
+  }
+
+  entry = &subscriber->queue[(subscriber->head + subscriber->num_events) % MNG_IF_EVENT_QUEUE_SIZE];
+  entry->seq = ++subscriber->last_seq;
+  entry->event = *event;
+  subscriber->num_events++;
+}
+
+/* Return 1 if an event was popped and 0 if the queue is empty */
+static int mng_if_subscriber_pop(T_mng_if_subscriber *subscriber, unsigned int *seq, T_mng_event *event)
+{
+  T_mng_if_event_entry *entry;
+  unsigned int num_dropped;
+
+  os_mutex_lock(&g_mng_if_event_mutex);
+
+  if(subscriber->num_events == 0) {
+    os_mutex_unlock(&g_mng_if_event_mutex);
+    return 0;
+  }
+
+  entry = &subscriber->queue[subscriber->head];
+  *seq = entry->seq;
+  *event = entry->event;
+  subscriber->head = (subscriber->head + 1) % MNG_IF_EVENT_QUEUE_SIZE;
+  subscriber->num_events--;
+
+  num_dropped = subscriber->num_dropped;
+  subscriber->num_dropped = 0;
+
+  os_mutex_unlock(&g_mng_if_event_mutex);
+
+  if(num_dropped > 0) {
+    pr_warning("Management interface dropped %u events for a slow subscriber", num_dropped);
+  }
+
+  return 1;
+}
+
+static int mng_if_client_queue_event(T_mng_if_client *client, unsigned int seq, T_mng_event const *event)
+{
+  T_mng_tlv_writer writer;
+  int frame_len;
+
+  mng_tlv_begin_frame(&writer, g_mng_if_tlv_buff, sizeof(g_mng_if_tlv_buff), E_mng_tlv_frame_type_event);
+  mng_tlv_encode_event(&writer, seq, event);
+  frame_len = mng_tlv_end_frame(&writer);
+  if(frame_len < 0) {
+    pr_err("Management interface event does not fit into a frame");
+    return -1;
+  }
+
+  return mng_if_client_queue(client, g_mng_if_tlv_buff, (size_t)frame_len);
+}
+
+/*
+ * Move pending events of a subscribed client to its transmit buffer.
+ * Unless drain_all_flag is set, events stay in the bounded event queue while the client is not reading.
+ * Return 0 if client is still connected and -1 otherwise.
+ */
+static int mng_if_client_queue_events(T_mng_if_client *client, int drain_all_flag)
+{
+  T_mng_if_subscriber *subscriber = &g_mng_if_subscribers[client - g_mng_if_clients];
+  T_mng_event event;
+  unsigned int seq;
+
+  if(!client->subscribed_flag) {
+    return 0;
+  }
+
+  while(drain_all_flag || ((client->tx_len - client->tx_pos) < MNG_IF_MAX_TX_PENDING)) {
+    if(!mng_if_subscriber_pop(subscriber, &seq, &event)) {
       break;
+    }
+
+    if(mng_if_client_queue_event(client, seq, &event) < 0) {
+      mng_if_client_close(client);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+/* Return 0 if client is still connected and -1 otherwise */
+static int mng_if_client_subscribe(T_mng_if_client *client, unsigned int event_mask)
+{
+  T_mng_if_subscriber *subscriber = &g_mng_if_subscribers[client - g_mng_if_clients];
+  T_mng_event event;
+  unsigned int seq;
+
+  event_mask &= MNG_EVENT_MASK_ALL;
+
+  /* Events queued for a previous subscription are discarded; the client resyncs after the acknowledgment */
+  os_mutex_lock(&g_mng_if_event_mutex);
+  subscriber->event_mask = event_mask;
+  subscriber->head = 0;
+  subscriber->num_events = 0;
+  subscriber->num_dropped = 0;
+  seq = subscriber->last_seq;
+  os_mutex_unlock(&g_mng_if_event_mutex);
+
+  client->subscribed_flag = (event_mask != 0);
+
+  pr_info("Management interface connection %d subscribed to events 0x%X", client->fd, event_mask);
+
+  /* The acknowledgment carries the sequence number of the last event before the subscription */
+  memset(&event, 0, sizeof(event));
+  event.type = E_mng_event_type_subscribed;
+  event.event_mask = event_mask;
+  event.clk_idx = -1;
+
+  if(mng_if_client_queue_event(client, seq, &event) < 0) {
+    mng_if_client_close(client);
+    return -1;
+  }
+
+  return 0;
+}
+
+static void mng_if_publish_wake_up(void)
+{
+  uint64_t wake_up_event;
+
+  /* Clear the publish event */
+  if((read(g_mng_if_event_fd, &wake_up_event, sizeof(wake_up_event)) < 0) && (errno != EAGAIN)) {
+    pr_err("%s: %s", __func__, strerror(errno));
+  }
+}
+
+/* Unix domain socket peers are authorized by their credentials: root, the user of synced, or the configured group */
+static int mng_if_authorize_peer(int conn_fd)
+{
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+
+  if(getsockopt(conn_fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  if((cred.uid == 0) || (cred.uid == geteuid()) || ((g_mng_if_unix_gid >= 0) && (cred.gid == (gid_t)g_mng_if_unix_gid))) {
+    return 0;
+  }
+
+  pr_warning("Management interface rejected connection %d from pid %d (uid %u, gid %u)",
+             conn_fd, (int)cred.pid, (unsigned int)cred.uid, (unsigned int)cred.gid);
+  return -1;
+}
+
+static void mng_if_accept_clients(int listen_fd, int seqpacket_flag)
+{
+  int sndbuf_size = MNG_IF_UNIX_SNDBUF_SIZE;
+  int conn_fd;
+  int i;
 
-      case E_mng_api_set_pri:
-      {
-        int print_flag = req_msg.request_set_pri.print_flag;
-        const char *port_name = req_msg.request_set_pri.port_name;
-        int pri = req_msg.request_set_pri.pri;
-        rsp_msg.response = management_set_pri(print_flag,
-                                              port_name,
-                                              pri);
+  while(1) {
+    conn_fd = accept(listen_fd, NULL, NULL);
+    if(conn_fd < 0) {
+      if((errno != EWOULDBLOCK) && (errno != EAGAIN) && (errno != EINTR)) {
+        pr_err("%s: %s", __func__, strerror(errno));
       }
-      break;
+      return;
+    }
 
-      case E_mng_api_set_max_msg_lvl:
-      {
-        int print_flag = req_msg.request_set_max_msg_lvl.print_flag;
-        int max_msg_level = req_msg.request_set_max_msg_lvl.max_msg_lvl;
-        rsp_msg.response = management_set_max_msg_level(print_flag,
-                                                      max_msg_level);
+    for(i = 0; i < MNG_IF_MAX_NUM_OF_CLIENTS; i++) {
+      if(g_mng_if_clients[i].fd == UNINITIALIZED_FD) {
+        break;
       }
-      break;
+    }
+
+    if(i == MNG_IF_MAX_NUM_OF_CLIENTS) {
+      pr_warning("Management interface rejected connection %d (maximum of %d connections)", conn_fd, MNG_IF_MAX_NUM_OF_CLIENTS);
+      close(conn_fd);
+      continue;
+    }
+
+    if(seqpacket_flag) {
+      if(mng_if_authorize_peer(conn_fd) < 0) {
+        close(conn_fd);
+        continue;
+      }
+      /* Limited by net.core.wmem_max; larger responses fail with EMSGSIZE */
+      if(setsockopt(conn_fd, SOL_SOCKET, SO_SNDBUF, (void const *)&sndbuf_size, sizeof(sndbuf_size)) < 0) {
+        pr_warning("%s: %s", __func__, strerror(errno));
+      }
+    }
+
+    if((mng_if_set_nonblocking(conn_fd) < 0) || (mng_if_epoll_add(conn_fd, EPOLLIN, (uint32_t)i) < 0)) {
+      close(conn_fd);
+      continue;
+    }
+
+    g_mng_if_clients[i].fd = conn_fd;
+    g_mng_if_clients[i].seqpacket_flag = seqpacket_flag;
+    g_mng_if_clients[i].events = EPOLLIN;
+
+    pr_info("Management interface thread accepted connection %d", conn_fd);
+  }
+}
+
+/* Return 0 if client is still connected and -1 otherwise */
+static int mng_if_client_receive(T_mng_if_client *client)
+{
+  T_mng_if_request req;
+  ssize_t status;
+  size_t offset = 0;
 
-      default:
+  /* Read until the socket is drained or the buffer is full; a packet is only read into an empty buffer, so it is never truncated */
+  while((client->rx_len < sizeof(client->rx_buff)) && !(client->seqpacket_flag && (client->rx_len > 0))) {
+    status = recv(client->fd, &client->rx_buff[client->rx_len], sizeof(client->rx_buff) - client->rx_len,
+                  client->seqpacket_flag ? MSG_TRUNC : 0);
+    if(status < 0) {
+      if((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
         break;
+      } else if(errno == EINTR) {
+        continue;
+      }
+
+      pr_err("Management interface connection %d failed: %s", client->fd, strerror(errno));
+      mng_if_client_close(client);
+      return -1;
+    } else if(status == 0) {
+      mng_if_client_close(client);
+      return -1;
+    } else if((size_t)status > sizeof(client->rx_buff)) {
+      pr_err("Management interface connection %d sent too long packet (%zd bytes)", client->fd, status);
+      mng_if_client_close(client);
+      return -1;
+    }
+    client->rx_len += status;
+  }
+
+  client->rx_blocked_flag = 0;
+
+  /* Answer every complete request in the order received */
+  while((status = mng_if_client_parse_request(client, offset, &req)) > 0) {
+    offset += req.len;
+
+    if(req.type == E_mng_if_request_type_subscribe) {
+      if(mng_if_client_subscribe(client, req.event_mask) < 0) {
+        return -1;
+      }
+      continue;
     }
 
-    send(conn_fd, &rsp_msg, sizeof(rsp_msg), 0);
+    /* Events raised before the request go first, so a response never precedes an older event */
+    if(mng_if_client_queue_events(client, 1) < 0) {
+      return -1;
+    }
+
+    if(req.type == E_mng_if_request_type_batch) {
+      status = mng_if_client_queue_batch_response(client, &req);
+    } else {
+      trace_begin();
+      mng_if_process_request(client, &req.api_msg, &g_mng_if_rsp_msg);
+      trace_end(E_trace_span_mng_request, (req.api_msg.api_code < E_mng_api_max) ? conv_api_code_to_str(req.api_msg.api_code) : NULL);
+      status = mng_if_client_queue_response(client, &g_mng_if_rsp_msg);
+    }
+    if(status < 0) {
+      mng_if_client_close(client);
+      return -1;
+    }
+
+    if((client->tx_len - client->tx_pos) >= MNG_IF_MAX_TX_PENDING) {
+      /* Leave remaining requests until the client reads its responses */
+      client->rx_blocked_flag = 1;
+      break;
+    }
+  }
+
+  if((status == 0) && client->seqpacket_flag && (offset < client->rx_len)) {
+    pr_err("Management interface connection %d sent incomplete packet", client->fd);
+    status = -1;
+  }
+
+  if(status < 0) {
+    mng_if_client_close(client);
+    return -1;
+  }
+
+  /* Keep partial request for the next read */
+  if(offset > 0) {
+    memmove(client->rx_buff, &client->rx_buff[offset], client->rx_len - offset);
+    client->rx_len -= offset;
   }
 
-  return conn_fd;
+  return 0;
+}
+
+/* Answer requests when the client is readable, and requests left in rx_buff once its responses were sent */
+/* Return 0 if client is still connected and -1 otherwise */
+static int mng_if_client_serve(T_mng_if_client *client, int readable_flag)
+{
+  /* No new EPOLLIN arrives for requests that were already received, so do not wait for one */
+  while(readable_flag ||
+        (client->rx_blocked_flag && ((client->tx_len - client->tx_pos) < MNG_IF_MAX_TX_PENDING))) {
+    readable_flag = 0;
+
+    if(mng_if_client_receive(client) < 0) {
+      return -1;
+    }
+    if(mng_if_client_flush(client) < 0) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void mng_if_close_all_clients(void)
+{
+  int i;
+
+  for(i = 0; i < MNG_IF_MAX_NUM_OF_CLIENTS; i++) {
+    if(g_mng_if_clients[i].fd != UNINITIALIZED_FD) {
+      mng_if_client_close(&g_mng_if_clients[i]);
+    }
+  }
 }
 
 static void *mng_if_thread(void *arg)
 {
   volatile T_mng_if_thread_data *thread_data = (volatile T_mng_if_thread_data *)arg;
-  int conn_fd = UNINITIALIZED_FD;
+  struct epoll_event events[MNG_IF_MAX_EPOLL_EVENTS];
+  T_mng_if_client *client;
+  int num_events;
+  int i;
+  int j;
 
   thread_data->thread_state = E_mng_if_thread_state_started;
 
-  while(1) {
-    if(thread_data->thread_state == E_mng_if_thread_state_stopping) {
-      if(conn_fd != UNINITIALIZED_FD) {
-        close(conn_fd);
+  trace_set_thread_name("management");
+
+  while(thread_data->thread_state != E_mng_if_thread_state_stopping) {
+    /* Sleep until a connection, request, published event, or stop event arrives */
+    num_events = epoll_wait(g_mng_if_epoll_fd, events, MNG_IF_MAX_EPOLL_EVENTS, -1);
+    if(num_events < 0) {
+      if(errno != EINTR) {
+        pr_err("%s: %s", __func__, strerror(errno));
       }
-      thread_data->thread_state = E_mng_if_thread_state_stopped;
-      break;
+      continue;
     }
 
-    if(conn_fd == UNINITIALIZED_FD) {
-      conn_fd = create_new_connection();
-    } else {
-      conn_fd = respond_to_request(conn_fd);
+    for(i = 0; i < num_events; i++) {
+      if(events[i].data.u32 == MNG_IF_EPOLL_ID_STOP) {
+        continue;
+      }
+
+      if(events[i].data.u32 == MNG_IF_EPOLL_ID_LISTEN) {
+        mng_if_accept_clients(g_mng_if_fd, 0);
+        continue;
+      }
+
+      if(events[i].data.u32 == MNG_IF_EPOLL_ID_LISTEN_UNIX) {
+        mng_if_accept_clients(g_mng_if_unix_fd, 1);
+        continue;
+      }
+
+      if(events[i].data.u32 == MNG_IF_EPOLL_ID_EVENT) {
+        mng_if_publish_wake_up();
+        for(j = 0; j < MNG_IF_MAX_NUM_OF_CLIENTS; j++) {
+          client = &g_mng_if_clients[j];
+          if((client->fd == UNINITIALIZED_FD) || !client->subscribed_flag) {
+            continue;
+          }
+          if((mng_if_client_queue_events(client, 0) < 0) || (mng_if_client_flush(client) < 0)) {
+            continue;
+          }
+          if(mng_if_client_serve(client, 0) < 0) {
+            continue;
+          }
+          mng_if_client_update_events(client);
+        }
+        continue;
+      }
+
+      client = &g_mng_if_clients[events[i].data.u32];
+      if(client->fd == UNINITIALIZED_FD) {
+        /* Closed earlier in this batch of events */
+        continue;
+      }
+
+      if(events[i].events & (EPOLLERR | EPOLLHUP)) {
+        mng_if_client_close(client);
+        continue;
+      }
+
+      if(events[i].events & EPOLLOUT) {
+        if(mng_if_client_flush(client) < 0) {
+          continue;
+        }
+      }
+
+      if(mng_if_client_serve(client, (events[i].events & EPOLLIN) != 0) < 0) {
+        continue;
+      }
+
+      /* Refill from the event queue once the client has read its backlog */
+      if((mng_if_client_queue_events(client, 0) < 0) || (mng_if_client_flush(client) < 0)) {
+        continue;
+      }
+
+      mng_if_client_update_events(client);
     }
   }
 
+  mng_if_close_all_clients();
+
+  thread_data->thread_state = E_mng_if_thread_state_stopped;
+
   pthread_exit(NULL);
 }
 
@@ -269,11 +1247,17 @@ static void mng_if_thread_stop_wait(T_mng_if_thread_state *state)
 
   unsigned long long stop_time_ms;
   int time_diff_ms;
+  uint64_t stop_event = 1;
 
   stop_time_ms = os_get_monotonic_milliseconds();
 
   *state = E_mng_if_thread_state_stopping;
 
+  /* Wake the management interface thread up from epoll_wait() */
+  if(write(g_mng_if_stop_fd, &stop_event, sizeof(stop_event)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+  }
+
   while(count-- && (*(volatile T_mng_if_thread_state*)state != E_mng_if_thread_state_stopped)) {
     usleep(poll_interval_us);
   }
@@ -282,32 +1266,24 @@ static void mng_if_thread_stop_wait(T_mng_if_thread_state *state)
   pr_info("Management interface stopped in %d milliseconds", time_diff_ms);
 }
 
-/* Global functions */
-
-int mng_if_start(const char *mng_if_ip_addr, int mng_if_port_num)
+static int mng_if_listen_tcp(const char *mng_if_ip_addr, int mng_if_port_num)
 {
-  struct timeval tval;
   int reuse_addr_flag = 1;
   struct sockaddr_in cli_addr;
 
-  /* Set up socket interface */
   if((g_mng_if_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0) {
     pr_err("%s: %s", __func__, strerror(errno));
     g_mng_if_fd = UNINITIALIZED_FD;
     return -1;
   }
 
-  /* Set receive timeout to 50 ms */
-  tval.tv_sec = 0;
-  tval.tv_usec = 50000;
-  if(setsockopt(g_mng_if_fd, SOL_SOCKET, SO_RCVTIMEO, (void const *)&tval, sizeof(struct timeval)) < 0) {
+  if(setsockopt(g_mng_if_fd, SOL_SOCKET, SO_REUSEADDR, (void const *)&reuse_addr_flag, sizeof(int)) < 0) {
     pr_err("%s: %s", __func__, strerror(errno));
-    goto err;
+    return -1;
   }
 
-  if(setsockopt(g_mng_if_fd, SOL_SOCKET, SO_REUSEADDR, (void const *)&reuse_addr_flag, sizeof(int)) < 0) {
-    pr_err("%s: %s", __func__, strerror(errno));
-    goto err;
+  if(mng_if_set_nonblocking(g_mng_if_fd) < 0) {
+    return -1;
   }
 
   memset(&cli_addr, 0, sizeof(cli_addr));
@@ -317,11 +1293,135 @@ int mng_if_start(const char *mng_if_ip_addr, int mng_if_port_num)
 
   if(bind(g_mng_if_fd, (struct sockaddr*)&cli_addr, sizeof(struct sockaddr_in)) < 0) {
     pr_err("%s: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  if(listen(g_mng_if_fd, MNG_IF_LISTEN_BACKLOG) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  return 0;
+}
+
+static int mng_if_listen_unix(const char *mng_if_unix_path)
+{
+  struct sockaddr_un cli_addr;
+
+  if(strlen(mng_if_unix_path) >= sizeof(cli_addr.sun_path)) {
+    pr_err("Management interface socket path %s is too long", mng_if_unix_path);
+    return -1;
+  }
+
+  if((g_mng_if_unix_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_mng_if_unix_fd = UNINITIALIZED_FD;
+    return -1;
+  }
+
+  if(mng_if_set_nonblocking(g_mng_if_unix_fd) < 0) {
+    return -1;
+  }
+
+  memset(&cli_addr, 0, sizeof(cli_addr));
+  cli_addr.sun_family = AF_UNIX;
+  strcpy(cli_addr.sun_path, mng_if_unix_path);
+
+  /* Remove the socket file left by a previous run */
+  unlink(mng_if_unix_path);
+
+  if(bind(g_mng_if_unix_fd, (struct sockaddr*)&cli_addr, sizeof(cli_addr)) < 0) {
+    pr_err("%s: %s: %s", __func__, mng_if_unix_path, strerror(errno));
+    return -1;
+  }
+  strcpy(g_mng_if_unix_path, mng_if_unix_path);
+
+  /* Connections are authorized with SO_PEERCRED; the file mode only keeps other users from connecting at all */
+  if(((g_mng_if_unix_gid >= 0) && (chown(mng_if_unix_path, (uid_t)-1, (gid_t)g_mng_if_unix_gid) < 0)) ||
+     (chmod(mng_if_unix_path, (g_mng_if_unix_gid >= 0) ? MNG_IF_UNIX_SOCKET_MODE : (MNG_IF_UNIX_SOCKET_MODE & S_IRWXU)) < 0)) {
+    pr_err("%s: %s: %s", __func__, mng_if_unix_path, strerror(errno));
+    return -1;
+  }
+
+  if(listen(g_mng_if_unix_fd, MNG_IF_LISTEN_BACKLOG) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  return 0;
+}
+
+static void mng_if_close_listeners(void)
+{
+  if(g_mng_if_fd != UNINITIALIZED_FD) {
+    close(g_mng_if_fd);
+    g_mng_if_fd = UNINITIALIZED_FD;
+  }
+
+  if(g_mng_if_unix_fd != UNINITIALIZED_FD) {
+    close(g_mng_if_unix_fd);
+    g_mng_if_unix_fd = UNINITIALIZED_FD;
+  }
+
+  if(g_mng_if_unix_path[0] != '\0') {
+    unlink(g_mng_if_unix_path);
+    g_mng_if_unix_path[0] = '\0';
+  }
+}
+
+/* Global functions */
+
+int mng_if_start(const char *mng_if_ip_addr, int mng_if_port_num, const char *mng_if_unix_path, int mng_if_unix_gid)
+{
+  int tcp_en = (mng_if_ip_addr != NULL) && (mng_if_ip_addr[0] != '\0');
+  int unix_en = (mng_if_unix_path != NULL) && (mng_if_unix_path[0] != '\0');
+  int i;
+
+  for(i = 0; i < MNG_IF_MAX_NUM_OF_CLIENTS; i++) {
+    memset(&g_mng_if_clients[i], 0, sizeof(g_mng_if_clients[i]));
+    g_mng_if_clients[i].fd = UNINITIALIZED_FD;
+  }
+
+  if(!tcp_en && !unix_en) {
+    pr_err("Management interface requires an IP address or a Unix domain socket path");
+    return -1;
+  }
+
+  /* Set up socket interfaces */
+  if(tcp_en && (mng_if_listen_tcp(mng_if_ip_addr, mng_if_port_num) < 0)) {
+    goto err;
+  }
+
+  g_mng_if_unix_gid = mng_if_unix_gid;
+  if(unix_en && (mng_if_listen_unix(mng_if_unix_path) < 0)) {
     goto err;
   }
 
-  /* Listen to one connection */
-  listen(g_mng_if_fd, 1);
+  /* Set up epoll with the listening sockets and the stop event */
+  if((g_mng_if_epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_mng_if_epoll_fd = UNINITIALIZED_FD;
+    goto err;
+  }
+
+  if((g_mng_if_stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_mng_if_stop_fd = UNINITIALIZED_FD;
+    goto err;
+  }
+
+  if((g_mng_if_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_mng_if_event_fd = UNINITIALIZED_FD;
+    goto err;
+  }
+
+  if((tcp_en && (mng_if_epoll_add(g_mng_if_fd, EPOLLIN, MNG_IF_EPOLL_ID_LISTEN) < 0)) ||
+     (unix_en && (mng_if_epoll_add(g_mng_if_unix_fd, EPOLLIN, MNG_IF_EPOLL_ID_LISTEN_UNIX) < 0)) ||
+     (mng_if_epoll_add(g_mng_if_stop_fd, EPOLLIN, MNG_IF_EPOLL_ID_STOP) < 0) ||
+     (mng_if_epoll_add(g_mng_if_event_fd, EPOLLIN, MNG_IF_EPOLL_ID_EVENT) < 0)) {
+    goto err;
+  }
 
   /* Create management interface thread */
   if(os_thread_create(&g_mng_if_thread_data.thread_id, mng_if_thread, (void*)&g_mng_if_thread_data) < 0) {
@@ -333,18 +1433,66 @@ int mng_if_start(const char *mng_if_ip_addr, int mng_if_port_num)
   return 0;
 
 err:
-  close(g_mng_if_fd);
-  g_mng_if_fd = UNINITIALIZED_FD;
+  if(g_mng_if_event_fd != UNINITIALIZED_FD) {
+    close(g_mng_if_event_fd);
+    g_mng_if_event_fd = UNINITIALIZED_FD;
+  }
+  if(g_mng_if_stop_fd != UNINITIALIZED_FD) {
+    close(g_mng_if_stop_fd);
+    g_mng_if_stop_fd = UNINITIALIZED_FD;
+  }
+  if(g_mng_if_epoll_fd != UNINITIALIZED_FD) {
+    close(g_mng_if_epoll_fd);
+    g_mng_if_epoll_fd = UNINITIALIZED_FD;
+  }
+  mng_if_close_listeners();
   return -1;
 }
 
 void mng_if_stop(void)
 {
-  if(g_mng_if_fd != UNINITIALIZED_FD) {
+  if(g_mng_if_epoll_fd != UNINITIALIZED_FD) {
     mng_if_thread_stop_wait(&g_mng_if_thread_data.thread_state);
-    pthread_cancel(g_mng_if_thread_data.thread_id);
-    close(g_mng_if_fd);
+    if(g_mng_if_thread_data.thread_state != E_mng_if_thread_state_stopped) {
+      pthread_cancel(g_mng_if_thread_data.thread_id);
+    }
+    close(g_mng_if_stop_fd);
+    close(g_mng_if_epoll_fd);
+    mng_if_close_listeners();
+
+    /* Publishing threads may still be running */
+    os_mutex_lock(&g_mng_if_event_mutex);
+    memset(g_mng_if_subscribers, 0, sizeof(g_mng_if_subscribers));
+    close(g_mng_if_event_fd);
+    g_mng_if_event_fd = UNINITIALIZED_FD;
+    os_mutex_unlock(&g_mng_if_event_mutex);
+  }
+
+  g_mng_if_stop_fd = UNINITIALIZED_FD;
+  g_mng_if_epoll_fd = UNINITIALIZED_FD;
+}
+
+void mng_if_publish_event(T_mng_event const *event)
+{
+  uint64_t wake_up_event = 1;
+  int wake_up_flag = 0;
+  int i;
+
+  os_mutex_lock(&g_mng_if_event_mutex);
+
+  for(i = 0; i < MNG_IF_MAX_NUM_OF_CLIENTS; i++) {
+    if(g_mng_if_subscribers[i].event_mask & MNG_EVENT_MASK(event->type)) {
+      mng_if_subscriber_push(&g_mng_if_subscribers[i], event);
+      wake_up_flag = 1;
+    }
+  }
+
+  /* Wake the management interface thread up to send the events */
+  if(wake_up_flag && (g_mng_if_event_fd != UNINITIALIZED_FD)) {
+    if((write(g_mng_if_event_fd, &wake_up_event, sizeof(wake_up_event)) < 0) && (errno != EAGAIN)) {
+      pr_err("%s: %s", __func__, strerror(errno));
+    }
   }
 
-  g_mng_if_fd = UNINITIALIZED_FD;
+  os_mutex_unlock(&g_mng_if_event_mutex);
 }
@@ -23,6 +23,9 @@
 #ifndef MNG_IF_H
 #define MNG_IF_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "../common/common.h"
 #include "management.h"
 
@@ -78,8 +81,41 @@ typedef struct {
 typedef struct {
   int print_flag;
   int max_msg_lvl;
+  int module_flag;   /* 0 (as sent by clients without per-module levels) sets the level of all modules */
+  int module;        /* T_print_module */
 } T_mng_api_request_set_max_msg_lvl;
 
+typedef struct {
+  int print_flag;
+} T_mng_api_request_begin_transaction;
+
+typedef struct {
+  int print_flag;
+} T_mng_api_request_commit_transaction;
+
+typedef struct {
+  int print_flag;
+} T_mng_api_request_abort_transaction;
+
+typedef struct {
+  int print_flag;
+  char port_name[INTERFACE_MAX_NAME_LEN];
+} T_mng_api_request_get_port_stats;
+
+typedef struct {
+  int print_flag;
+} T_mng_api_request_get_latency_stats;
+
+typedef struct {
+  int print_flag;
+} T_mng_api_request_get_mutex_stats;
+
+typedef struct {
+  int print_flag;
+  uint32_t since_seq_low;   /* 64-bit since_seq as two halves, so the fixed-size request message keeps its size */
+  uint32_t since_seq_high;
+} T_mng_api_request_get_journal;
+
 /* CLI request message */
 typedef struct {
   T_mng_api api_code;
@@ -94,6 +130,13 @@ typedef struct {
     T_mng_api_request_assign_new_synce_clk_port    request_assign_new_synce_clk_port;
     T_mng_api_request_set_pri                      request_set_pri;
     T_mng_api_request_set_max_msg_lvl              request_set_max_msg_lvl;
+    T_mng_api_request_begin_transaction            request_begin_transaction;
+    T_mng_api_request_commit_transaction           request_commit_transaction;
+    T_mng_api_request_abort_transaction            request_abort_transaction;
+    T_mng_api_request_get_port_stats               request_get_port_stats;
+    T_mng_api_request_get_latency_stats            request_get_latency_stats;
+    T_mng_api_request_get_mutex_stats              request_get_mutex_stats;
+    T_mng_api_request_get_journal                  request_get_journal;
   };
 } T_mng_api_request_msg;
 
@@ -111,6 +154,22 @@ typedef struct {
   T_management_sync_info sync_info;
 } T_mng_api_response_get_sync_info;
 
+typedef struct {
+  T_management_port_stats port_stats;
+} T_mng_api_response_get_port_stats;
+
+typedef struct {
+  T_management_latency_stats latency_stats;
+} T_mng_api_response_get_latency_stats;
+
+typedef struct {
+  T_os_mutex_prof_report *mutex_stats; /* TLV encoding only; points to storage of the sender or receiver */
+} T_mng_api_response_get_mutex_stats;
+
+typedef struct {
+  T_management_journal journal;
+} T_mng_api_response_get_journal;
+
 /* CLI response message */
 typedef struct {
   T_mng_api api_code;
@@ -119,6 +178,10 @@ typedef struct {
     T_mng_api_response_get_sync_info_list           response_get_sync_info_list;
     T_mng_api_response_get_current_status           response_get_current_status;
     T_mng_api_response_get_sync_info                response_get_sync_info;
+    T_mng_api_response_get_port_stats               response_get_port_stats;
+    T_mng_api_response_get_latency_stats            response_get_latency_stats;
+    T_mng_api_response_get_mutex_stats              response_get_mutex_stats;
+    T_mng_api_response_get_journal                  response_get_journal;
 
     /* No data for following APIs:
      *   - set_forced_ql
@@ -127,11 +190,61 @@ typedef struct {
      *   - assign_new_synce_clk_port
      *   - set_pri
      *   - set_max_msg_lvl
+     *   - begin_transaction
+     *   - commit_transaction
+     *   - abort_transaction
      */
   };
 } T_mng_api_response_msg;
 
-int mng_if_start(const char *mng_if_ip_addr, int mng_if_port_num);
+/*
+ * Fixed-size (legacy) messages are frozen at the layout of release 2-0-8: requests are sizeof(T_mng_api_request_msg)
+ * (28 bytes) and responses are MNG_API_LEGACY_RESPONSE_MSG_LEN (8716 bytes) with sync info entries of
+ * MNG_API_LEGACY_SYNC_INFO_LEN bytes. Fields added to a sync info since (degrading flag) are only sent with TLV encoding.
+ */
+#define MNG_API_LEGACY_REQUEST_MSG_LEN    28
+#define MNG_API_LEGACY_SYNC_INFO_LEN      offsetof(T_management_sync_info, synce_clk_info.degrading_flag)
+#define MNG_API_LEGACY_RESPONSE_MSG_LEN   (offsetof(T_mng_api_response_msg, response_get_sync_info_list.sync_info_list) + \
+                                           (MAX_SYNC_INFO_STRUCTURES * MNG_API_LEGACY_SYNC_INFO_LEN))
+
+/* Subscription events */
+typedef enum {
+  E_mng_event_type_subscribed,          /* Subscription acknowledgment (always sent; cannot be subscribed to) */
+  E_mng_event_type_current_ql,
+  E_mng_event_type_sync_current_ql,
+  E_mng_event_type_synce_dpll_state,
+  E_mng_event_type_sync_clk_state,
+  E_mng_event_type_sync_state,
+  E_mng_event_type_alarm,
+  E_mng_event_type_max
+} T_mng_event_type;
+
+#define MNG_EVENT_MASK(event_type)   (1U << (event_type))
+#define MNG_EVENT_MASK_ALL           (MNG_EVENT_MASK(E_mng_event_type_max) - MNG_EVENT_MASK(E_mng_event_type_current_ql))
+
+typedef struct {
+  T_mng_event_type type;
+  unsigned int event_mask;                  /* Subscription acknowledgment events */
+  char port_name[INTERFACE_MAX_NAME_LEN];   /* Empty if event is not associated with a port */
+  int clk_idx;                              /* Sync clock state and alarm events */
+  T_esmc_ql current_ql;                     /* Current QL and sync current QL events */
+  int rank;                                 /* Sync current QL events */
+  T_device_dpll_state dpll_state;           /* Sync-E DPLL state events */
+  T_sync_clk_state clk_state;               /* Sync clock state events */
+  T_sync_state state;                       /* Sync state events */
+  T_alarm_type alarm_type;                  /* Alarm events */
+  T_timing_loop_type loop_type;             /* Timing loop alarm events */
+  unsigned char mac_addr[ETH_ALEN];         /* Timing loop alarm events */
+  int degrading_flag;                       /* Reference degradation alarm events */
+} T_mng_event;
+
+/*
+ * Start the management interface on a TCP socket, a Unix domain socket (SOCK_SEQPACKET), or both
+ * (an empty IP address or path disables the socket). Unix domain socket peers must be root,
+ * the user of synced, or members of group mng_if_unix_gid (-1 for none).
+ */
+int mng_if_start(const char *mng_if_ip_addr, int mng_if_port_num, const char *mng_if_unix_path, int mng_if_unix_gid);
 void mng_if_stop(void);
+void mng_if_publish_event(T_mng_event const *event);
 
 #endif  /* MNG_IF_H */
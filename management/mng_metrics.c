@@ -0,0 +1,657 @@
+/**
+ * @file mng_metrics.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#define PRINT_MODULE E_print_module_management
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mng_metrics.h"
+#include "../common/common.h"
+#include "../common/latency.h"
+#include "../common/os.h"
+#include "../common/print.h"
+#include "../common/stats.h"
+#include "../control/control.h"
+
+#define MNG_METRICS_MAX_NUM_OF_CLIENTS    8
+#define MNG_METRICS_LISTEN_BACKLOG        MNG_METRICS_MAX_NUM_OF_CLIENTS
+#define MNG_METRICS_REQUEST_BUFF_SIZE     2048
+#define MNG_METRICS_BODY_BUFF_SIZE        (256 * 1024)
+#define MNG_METRICS_CLIENT_TIMEOUT_MS     5000
+#define MNG_METRICS_POLL_INTERVAL_MS      1000
+
+#define MNG_METRICS_CONTENT_TYPE          "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+typedef enum  {
+  E_mng_metrics_thread_state_not_started,
+  E_mng_metrics_thread_state_started,
+  E_mng_metrics_thread_state_stopping,
+  E_mng_metrics_thread_state_stopped
+} T_mng_metrics_thread_state;
+
+typedef struct {
+  pthread_t thread_id;
+  T_mng_metrics_thread_state thread_state;
+} T_mng_metrics_thread_data;
+
+typedef struct {
+  int fd;
+  unsigned long long accept_time_ms;
+  char req_buff[MNG_METRICS_REQUEST_BUFF_SIZE];
+  size_t req_len;
+  char *rsp_buff;                           /* NULL until the request is complete */
+  size_t rsp_len;
+  size_t rsp_pos;
+} T_mng_metrics_client;
+
+typedef struct {
+  char *buff;
+  size_t size;
+  size_t len;
+  int overflow_flag;
+} T_mng_metrics_writer;
+
+typedef struct {
+  const char *name;
+  const char *help;
+  size_t offset;                            /* Offset of the counter in T_esmc_port_dir_stats */
+  int rx_only_flag;
+} T_mng_metrics_esmc_counter;
+
+/* Static data */
+
+static int g_mng_metrics_fd = UNINITIALIZED_FD;
+static int g_mng_metrics_stop_fd = UNINITIALIZED_FD;
+static T_mng_metrics_thread_data g_mng_metrics_thread_data;
+
+/* Only used by metrics thread */
+static T_mng_metrics_client g_mng_metrics_clients[MNG_METRICS_MAX_NUM_OF_CLIENTS];
+static char g_mng_metrics_body[MNG_METRICS_BODY_BUFF_SIZE];
+
+/* See T_stats_port_counter */
+static const char *g_mng_metrics_port_counter_help[] = {
+  "Received QL changes",
+  "ESMC RX timeouts",
+  "Link down transitions"
+};
+COMPILE_TIME_ASSERT((sizeof(g_mng_metrics_port_counter_help)/sizeof(g_mng_metrics_port_counter_help[0])) == E_stats_port_counter_max, "Invalid array size for g_mng_metrics_port_counter_help!")
+
+static const T_mng_metrics_esmc_counter g_mng_metrics_esmc_counters[] = {
+  {"synced_port_esmc_pdus", "ESMC PDUs sent or received", offsetof(T_esmc_port_dir_stats, pdus), 0},
+  {"synced_port_esmc_event_pdus", "ESMC event PDUs sent or received", offsetof(T_esmc_port_dir_stats, event_pdus), 0},
+  {"synced_port_esmc_information_pdus", "ESMC information PDUs sent or received", offsetof(T_esmc_port_dir_stats, information_pdus), 0},
+  {"synced_port_esmc_errors", "ESMC PDUs that failed to send or parse", offsetof(T_esmc_port_dir_stats, errors), 0},
+  {"synced_port_esmc_invalid_length_pdus", "Received ESMC PDUs with invalid length", offsetof(T_esmc_port_dir_stats, invalid_len_pdus), 1},
+  {"synced_port_timing_loops", "Detected timing loops", offsetof(T_esmc_port_dir_stats, timing_loops), 1},
+  {"synced_port_socket_drops", "Packets dropped by the kernel on the port socket", offsetof(T_esmc_port_dir_stats, socket_drops), 1}
+};
+
+/* Static functions */
+
+static void mng_metrics_printf(T_mng_metrics_writer *writer, const char *format, ...)
+{
+  va_list args;
+  int len;
+
+  if(writer->overflow_flag) {
+    return;
+  }
+
+  va_start(args, format);
+  len = vsnprintf(&writer->buff[writer->len], writer->size - writer->len, format, args);
+  va_end(args);
+
+  if((len < 0) || ((size_t)len >= writer->size - writer->len)) {
+    writer->overflow_flag = 1;
+    return;
+  }
+
+  writer->len += len;
+}
+
+static void mng_metrics_family(T_mng_metrics_writer *writer, const char *name, const char *type, const char *unit, const char *help)
+{
+  mng_metrics_printf(writer, "# TYPE %s %s\n", name, type);
+  if(unit != NULL) {
+    mng_metrics_printf(writer, "# UNIT %s %s\n", name, unit);
+  }
+  mng_metrics_printf(writer, "# HELP %s %s.\n", name, help);
+}
+
+static int mng_metrics_get_port_ql_and_rank(T_management_sync_info const *sync_info, T_esmc_ql *current_ql, int *rank)
+{
+  switch(sync_info->type) {
+    case E_sync_type_synce:
+      *current_ql = sync_info->synce_clk_info.current_ql;
+      *rank = sync_info->synce_clk_info.rank;
+      return 0;
+
+    case E_sync_type_monitoring:
+      *current_ql = sync_info->synce_mon_info.current_ql;
+      *rank = sync_info->synce_mon_info.rank;
+      return 0;
+
+    case E_sync_type_external:
+      *current_ql = sync_info->ext_clk_info.current_ql;
+      *rank = sync_info->ext_clk_info.rank;
+      return 0;
+
+    default:
+      return -1;
+  }
+}
+
+/* Render all metrics into g_mng_metrics_body; return the length or -1 if it does not fit */
+static int mng_metrics_render(void)
+{
+  static T_management_sync_info sync_info_list[MAX_NUM_OF_SYNC_ENTRIES];
+  static T_management_port_stats port_stats_list[MAX_NUM_OF_SYNC_ENTRIES];
+  T_mng_metrics_esmc_counter const *counter;
+  T_esmc_port_stats const *esmc_stats;
+  T_mng_metrics_writer writer;
+  T_management_status status;
+  T_stats_device_op_latency latency;
+  T_latency_stage_stats stage_stats;
+  T_esmc_ql current_ql;
+  char name[64];
+  int num_syncs;
+  int rank;
+  int i;
+  int j;
+
+  writer.buff = g_mng_metrics_body;
+  writer.size = sizeof(g_mng_metrics_body);
+  writer.len = 0;
+  writer.overflow_flag = 0;
+
+  for(num_syncs = 0; num_syncs < MAX_NUM_OF_SYNC_ENTRIES; num_syncs++) {
+    if(control_get_sync_info_by_index(num_syncs, &sync_info_list[num_syncs]) < 0) {
+      break;
+    }
+  }
+
+  for(i = 0; i < num_syncs; i++) {
+    if(control_get_port_stats(sync_info_list[i].name, &port_stats_list[i]) < 0) {
+      port_stats_list[i].esmc_stats.tx_flag = 0;
+      port_stats_list[i].esmc_stats.rx_flag = 0;
+    }
+  }
+
+  /* Per-port ESMC counters */
+  for(j = 0; j < (int)(sizeof(g_mng_metrics_esmc_counters) / sizeof(g_mng_metrics_esmc_counters[0])); j++) {
+    counter = &g_mng_metrics_esmc_counters[j];
+    mng_metrics_family(&writer, counter->name, "counter", NULL, counter->help);
+    for(i = 0; i < num_syncs; i++) {
+      esmc_stats = &port_stats_list[i].esmc_stats;
+      if(esmc_stats->tx_flag && !counter->rx_only_flag) {
+        mng_metrics_printf(&writer, "%s_total{port=\"%s\",direction=\"tx\"} %llu\n",
+                           counter->name,
+                           sync_info_list[i].name,
+                           *(unsigned long long const *)((char const *)&esmc_stats->tx + counter->offset));
+      }
+      if(esmc_stats->rx_flag) {
+        mng_metrics_printf(&writer, "%s_total{port=\"%s\",direction=\"rx\"} %llu\n",
+                           counter->name,
+                           sync_info_list[i].name,
+                           *(unsigned long long const *)((char const *)&esmc_stats->rx + counter->offset));
+      }
+    }
+  }
+
+  mng_metrics_family(&writer, "synced_port_esmc_last_pdu_age_seconds", "gauge", "seconds", "Time since the last ESMC PDU was sent or received");
+  for(i = 0; i < num_syncs; i++) {
+    esmc_stats = &port_stats_list[i].esmc_stats;
+    if(esmc_stats->tx_flag && (esmc_stats->tx.last_pdu_age_ms >= 0)) {
+      mng_metrics_printf(&writer, "synced_port_esmc_last_pdu_age_seconds{port=\"%s\",direction=\"tx\"} %.3f\n",
+                         sync_info_list[i].name, esmc_stats->tx.last_pdu_age_ms / 1000.0);
+    }
+    if(esmc_stats->rx_flag && (esmc_stats->rx.last_pdu_age_ms >= 0)) {
+      mng_metrics_printf(&writer, "synced_port_esmc_last_pdu_age_seconds{port=\"%s\",direction=\"rx\"} %.3f\n",
+                         sync_info_list[i].name, esmc_stats->rx.last_pdu_age_ms / 1000.0);
+    }
+  }
+
+  /* Per-port control event counters */
+  for(j = 0; j < E_stats_port_counter_max; j++) {
+    snprintf(name, sizeof(name), "synced_port_%s", stats_port_counter_to_str(j));
+    mng_metrics_family(&writer, name, "counter", NULL, g_mng_metrics_port_counter_help[j]);
+    for(i = 0; i < num_syncs; i++) {
+      mng_metrics_printf(&writer, "%s_total{port=\"%s\"} %llu\n",
+                         name,
+                         sync_info_list[i].name,
+                         (unsigned long long)stats_get_port_counter(j, i));
+    }
+  }
+
+  /* Per-port QL and rank */
+  mng_metrics_family(&writer, "synced_port_current_ql", "gauge", NULL, "Current QL of the port (T_esmc_ql value)");
+  for(i = 0; i < num_syncs; i++) {
+    if(mng_metrics_get_port_ql_and_rank(&sync_info_list[i], &current_ql, &rank) == 0) {
+      mng_metrics_printf(&writer, "synced_port_current_ql{port=\"%s\",ql=\"%s\"} %d\n",
+                         sync_info_list[i].name, conv_ql_enum_to_str(current_ql), current_ql);
+    }
+  }
+
+  mng_metrics_family(&writer, "synced_port_rank", "gauge", NULL, "Rank of the port (lower is better)");
+  for(i = 0; i < num_syncs; i++) {
+    if(mng_metrics_get_port_ql_and_rank(&sync_info_list[i], &current_ql, &rank) == 0) {
+      mng_metrics_printf(&writer, "synced_port_rank{port=\"%s\"} %d\n", sync_info_list[i].name, rank);
+    }
+  }
+
+  /* Current status */
+  management_get_current_status(0, &status);
+
+  mng_metrics_family(&writer, "synced_current_ql", "gauge", NULL, "Current QL of the node (T_esmc_ql value)");
+  mng_metrics_printf(&writer, "synced_current_ql{ql=\"%s\"} %d\n", conv_ql_enum_to_str(status.current_ql), status.current_ql);
+
+  mng_metrics_family(&writer, "synced_dpll_state", "stateset", NULL, "Sync-E DPLL state");
+  for(i = 0; i < E_device_dpll_state_max; i++) {
+    mng_metrics_printf(&writer, "synced_dpll_state{synced_dpll_state=\"%s\"} %d\n",
+                       conv_synce_dpll_state_enum_to_str(i), (status.dpll_state == (T_device_dpll_state)i) ? 1 : 0);
+  }
+
+  mng_metrics_family(&writer, "synced_holdover_remaining_seconds", "gauge", "seconds", "Remaining holdover time");
+  mng_metrics_printf(&writer, "synced_holdover_remaining_seconds %.3f\n", status.holdover_remaining_time_ms / 1000.0);
+
+  /* Device operation latencies */
+  mng_metrics_family(&writer, "synced_device_op_latency_seconds", "summary", "seconds", "Latency of device operations");
+  for(i = 0; i < E_stats_device_op_max; i++) {
+    stats_get_device_op_latency(i, &latency);
+    mng_metrics_printf(&writer, "synced_device_op_latency_seconds_count{op=\"%s\"} %llu\n",
+                       stats_device_op_to_str(i), (unsigned long long)latency.count);
+    mng_metrics_printf(&writer, "synced_device_op_latency_seconds_sum{op=\"%s\"} %.9f\n",
+                       stats_device_op_to_str(i), latency.total_time_ns / 1e9);
+  }
+
+  /* QL propagation latencies (omitted if not built in) */
+  if(latency_get_stage_stats(0, &stage_stats) == 0) {
+    mng_metrics_family(&writer, "synced_ql_propagation_latency_seconds", "summary", "seconds", "Latency of QL propagation stages");
+    for(i = 0; i < E_latency_stage_max; i++) {
+      latency_get_stage_stats(i, &stage_stats);
+      mng_metrics_printf(&writer, "synced_ql_propagation_latency_seconds{stage=\"%s\",quantile=\"0.5\"} %.9f\n",
+                         conv_latency_stage_enum_to_str(i), stage_stats.p50_ns / 1e9);
+      mng_metrics_printf(&writer, "synced_ql_propagation_latency_seconds{stage=\"%s\",quantile=\"0.9\"} %.9f\n",
+                         conv_latency_stage_enum_to_str(i), stage_stats.p90_ns / 1e9);
+      mng_metrics_printf(&writer, "synced_ql_propagation_latency_seconds{stage=\"%s\",quantile=\"0.99\"} %.9f\n",
+                         conv_latency_stage_enum_to_str(i), stage_stats.p99_ns / 1e9);
+      mng_metrics_printf(&writer, "synced_ql_propagation_latency_seconds{stage=\"%s\",quantile=\"0.999\"} %.9f\n",
+                         conv_latency_stage_enum_to_str(i), stage_stats.p999_ns / 1e9);
+      mng_metrics_printf(&writer, "synced_ql_propagation_latency_seconds_count{stage=\"%s\"} %llu\n",
+                         conv_latency_stage_enum_to_str(i), stage_stats.count);
+      /* Sum is rebuilt from the mean, so it is exact to within count nanoseconds */
+      mng_metrics_printf(&writer, "synced_ql_propagation_latency_seconds_sum{stage=\"%s\"} %.9f\n",
+                         conv_latency_stage_enum_to_str(i), (stage_stats.mean_ns * stage_stats.count) / 1e9);
+    }
+  }
+
+  /* Messages dropped by asynchronous logging */
+  mng_metrics_family(&writer, "synced_log_dropped_messages", "counter", NULL, "Log messages dropped because the log queue was full");
+  mng_metrics_printf(&writer, "synced_log_dropped_messages_total %llu\n", print_get_dropped_count());
+
+  mng_metrics_printf(&writer, "# EOF\n");
+
+  if(writer.overflow_flag) {
+    return -1;
+  }
+
+  return (int)writer.len;
+}
+
+static void mng_metrics_client_close(T_mng_metrics_client *client)
+{
+  close(client->fd);
+  free(client->rsp_buff);
+  memset(client, 0, sizeof(*client));
+  client->fd = UNINITIALIZED_FD;
+}
+
+static int mng_metrics_client_set_response(T_mng_metrics_client *client, const char *status_line, const char *content_type, const char *body, int body_len)
+{
+  int header_len;
+  char header[256];
+
+  header_len = snprintf(header, sizeof(header),
+                        "HTTP/1.1 %s\r\n"
+                        "Content-Type: %s\r\n"
+                        "Content-Length: %d\r\n"
+                        "Connection: close\r\n"
+                        "\r\n",
+                        status_line, content_type, body_len);
+
+  client->rsp_buff = malloc(header_len + body_len);
+  if(client->rsp_buff == NULL) {
+    pr_err("Failed to allocate memory for metrics response");
+    return -1;
+  }
+
+  memcpy(client->rsp_buff, header, header_len);
+  memcpy(&client->rsp_buff[header_len], body, body_len);
+  client->rsp_len = header_len + body_len;
+  client->rsp_pos = 0;
+
+  return 0;
+}
+
+/* Return 0 if client is still connected and -1 otherwise */
+static int mng_metrics_client_receive(T_mng_metrics_client *client)
+{
+  ssize_t status;
+  int body_len;
+
+  status = recv(client->fd, &client->req_buff[client->req_len], sizeof(client->req_buff) - client->req_len - 1, 0);
+  if(status < 0) {
+    if((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINTR)) {
+      return 0;
+    }
+    mng_metrics_client_close(client);
+    return -1;
+  } else if(status == 0) {
+    mng_metrics_client_close(client);
+    return -1;
+  }
+
+  client->req_len += status;
+  client->req_buff[client->req_len] = '\0';
+
+  /* Wait for the end of the request header */
+  if(strstr(client->req_buff, "\r\n\r\n") == NULL) {
+    if(client->req_len >= sizeof(client->req_buff) - 1) {
+      mng_metrics_client_close(client);
+      return -1;
+    }
+    return 0;
+  }
+
+  if(strncmp(client->req_buff, "GET ", 4) != 0) {
+    status = mng_metrics_client_set_response(client, "405 Method Not Allowed", "text/plain", "", 0);
+  } else if((strncmp(&client->req_buff[4], "/metrics ", 9) != 0) && (strncmp(&client->req_buff[4], "/ ", 2) != 0)) {
+    status = mng_metrics_client_set_response(client, "404 Not Found", "text/plain", "", 0);
+  } else {
+    body_len = mng_metrics_render();
+    if(body_len < 0) {
+      pr_err("Metrics do not fit into %d bytes", MNG_METRICS_BODY_BUFF_SIZE);
+      status = mng_metrics_client_set_response(client, "500 Internal Server Error", "text/plain", "", 0);
+    } else {
+      status = mng_metrics_client_set_response(client, "200 OK", MNG_METRICS_CONTENT_TYPE, g_mng_metrics_body, body_len);
+    }
+  }
+
+  if(status < 0) {
+    mng_metrics_client_close(client);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* Return 0 if client is still connected and -1 otherwise */
+static int mng_metrics_client_send(T_mng_metrics_client *client)
+{
+  ssize_t status;
+
+  status = send(client->fd, &client->rsp_buff[client->rsp_pos], client->rsp_len - client->rsp_pos, MSG_NOSIGNAL);
+  if(status < 0) {
+    if((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINTR)) {
+      return 0;
+    }
+    mng_metrics_client_close(client);
+    return -1;
+  }
+
+  client->rsp_pos += status;
+  if(client->rsp_pos == client->rsp_len) {
+    /* Response complete */
+    mng_metrics_client_close(client);
+    return -1;
+  }
+
+  return 0;
+}
+
+static void mng_metrics_accept_clients(void)
+{
+  int conn_fd;
+  int flags;
+  int i;
+
+  while(1) {
+    conn_fd = accept(g_mng_metrics_fd, NULL, NULL);
+    if(conn_fd < 0) {
+      return;
+    }
+
+    for(i = 0; i < MNG_METRICS_MAX_NUM_OF_CLIENTS; i++) {
+      if(g_mng_metrics_clients[i].fd == UNINITIALIZED_FD) {
+        break;
+      }
+    }
+
+    flags = fcntl(conn_fd, F_GETFL, 0);
+    if((i == MNG_METRICS_MAX_NUM_OF_CLIENTS) || (flags < 0) || (fcntl(conn_fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+      close(conn_fd);
+      continue;
+    }
+
+    g_mng_metrics_clients[i].fd = conn_fd;
+    g_mng_metrics_clients[i].accept_time_ms = os_get_monotonic_milliseconds();
+  }
+}
+
+static void *mng_metrics_thread(void *arg)
+{
+  volatile T_mng_metrics_thread_data *thread_data = (volatile T_mng_metrics_thread_data *)arg;
+  struct pollfd poll_fds[MNG_METRICS_MAX_NUM_OF_CLIENTS + 2];
+  T_mng_metrics_client *client_of_fd[MNG_METRICS_MAX_NUM_OF_CLIENTS + 2];
+  T_mng_metrics_client *client;
+  unsigned long long current_time_ms;
+  int num_fds;
+  int i;
+
+  thread_data->thread_state = E_mng_metrics_thread_state_started;
+
+  while(thread_data->thread_state != E_mng_metrics_thread_state_stopping) {
+    memset(poll_fds, 0, sizeof(poll_fds));
+    poll_fds[0].fd = g_mng_metrics_stop_fd;
+    poll_fds[0].events = POLLIN;
+    poll_fds[1].fd = g_mng_metrics_fd;
+    poll_fds[1].events = POLLIN;
+    num_fds = 2;
+
+    current_time_ms = os_get_monotonic_milliseconds();
+
+    for(i = 0; i < MNG_METRICS_MAX_NUM_OF_CLIENTS; i++) {
+      client = &g_mng_metrics_clients[i];
+      if(client->fd == UNINITIALIZED_FD) {
+        continue;
+      }
+      if(current_time_ms - client->accept_time_ms > MNG_METRICS_CLIENT_TIMEOUT_MS) {
+        mng_metrics_client_close(client);
+        continue;
+      }
+      poll_fds[num_fds].fd = client->fd;
+      poll_fds[num_fds].events = (client->rsp_buff == NULL) ? POLLIN : POLLOUT;
+      client_of_fd[num_fds] = client;
+      num_fds++;
+    }
+
+    if(poll(poll_fds, num_fds, MNG_METRICS_POLL_INTERVAL_MS) <= 0) {
+      continue;
+    }
+
+    if(poll_fds[1].revents & POLLIN) {
+      mng_metrics_accept_clients();
+    }
+
+    for(i = 2; i < num_fds; i++) {
+      client = client_of_fd[i];
+      if(poll_fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        mng_metrics_client_close(client);
+      } else if(poll_fds[i].revents & POLLIN) {
+        mng_metrics_client_receive(client);
+      } else if(poll_fds[i].revents & POLLOUT) {
+        mng_metrics_client_send(client);
+      }
+    }
+  }
+
+  for(i = 0; i < MNG_METRICS_MAX_NUM_OF_CLIENTS; i++) {
+    if(g_mng_metrics_clients[i].fd != UNINITIALIZED_FD) {
+      mng_metrics_client_close(&g_mng_metrics_clients[i]);
+    }
+  }
+
+  thread_data->thread_state = E_mng_metrics_thread_state_stopped;
+
+  pthread_exit(NULL);
+}
+
+static void mng_metrics_thread_start_wait(T_mng_metrics_thread_state *state)
+{
+  const int timeout_us = 2000000;
+  const int poll_interval_us = 50000;
+  int count = (timeout_us / poll_interval_us) + 1;
+
+  while(count-- && (*(volatile T_mng_metrics_thread_state*)state == E_mng_metrics_thread_state_not_started)) {
+    usleep(poll_interval_us);
+  }
+}
+
+static void mng_metrics_thread_stop_wait(T_mng_metrics_thread_state *state)
+{
+  const int timeout_us = 2000000;
+  const int poll_interval_us = 50000;
+  int count = (timeout_us / poll_interval_us) + 1;
+  uint64_t stop_event = 1;
+
+  *state = E_mng_metrics_thread_state_stopping;
+
+  /* Wake the metrics thread up from poll() */
+  if(write(g_mng_metrics_stop_fd, &stop_event, sizeof(stop_event)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+  }
+
+  while(count-- && (*(volatile T_mng_metrics_thread_state*)state != E_mng_metrics_thread_state_stopped)) {
+    usleep(poll_interval_us);
+  }
+}
+
+/* Global functions */
+
+int mng_metrics_start(const char *metrics_ip_addr, int metrics_port_num)
+{
+  int reuse_addr_flag = 1;
+  struct sockaddr_in addr;
+  int flags;
+  int i;
+
+  for(i = 0; i < MNG_METRICS_MAX_NUM_OF_CLIENTS; i++) {
+    memset(&g_mng_metrics_clients[i], 0, sizeof(g_mng_metrics_clients[i]));
+    g_mng_metrics_clients[i].fd = UNINITIALIZED_FD;
+  }
+
+  if((g_mng_metrics_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_mng_metrics_fd = UNINITIALIZED_FD;
+    return -1;
+  }
+
+  if(setsockopt(g_mng_metrics_fd, SOL_SOCKET, SO_REUSEADDR, (void const *)&reuse_addr_flag, sizeof(int)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    goto err;
+  }
+
+  flags = fcntl(g_mng_metrics_fd, F_GETFL, 0);
+  if((flags < 0) || (fcntl(g_mng_metrics_fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    goto err;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_addr.s_addr = inet_addr(metrics_ip_addr);
+  addr.sin_port = htons(metrics_port_num);
+  addr.sin_family = AF_INET;
+
+  if(bind(g_mng_metrics_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    goto err;
+  }
+
+  if(listen(g_mng_metrics_fd, MNG_METRICS_LISTEN_BACKLOG) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    goto err;
+  }
+
+  if((g_mng_metrics_stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_mng_metrics_stop_fd = UNINITIALIZED_FD;
+    goto err;
+  }
+
+  if(os_thread_create(&g_mng_metrics_thread_data.thread_id, mng_metrics_thread, (void*)&g_mng_metrics_thread_data) < 0) {
+    goto err;
+  }
+
+  mng_metrics_thread_start_wait(&g_mng_metrics_thread_data.thread_state);
+
+  pr_info("Metrics endpoint listening on %s:%d", metrics_ip_addr, metrics_port_num);
+
+  return 0;
+
+err:
+  if(g_mng_metrics_stop_fd != UNINITIALIZED_FD) {
+    close(g_mng_metrics_stop_fd);
+    g_mng_metrics_stop_fd = UNINITIALIZED_FD;
+  }
+  close(g_mng_metrics_fd);
+  g_mng_metrics_fd = UNINITIALIZED_FD;
+  return -1;
+}
+
+void mng_metrics_stop(void)
+{
+  if(g_mng_metrics_fd == UNINITIALIZED_FD) {
+    return;
+  }
+
+  mng_metrics_thread_stop_wait(&g_mng_metrics_thread_data.thread_state);
+  if(g_mng_metrics_thread_data.thread_state != E_mng_metrics_thread_state_stopped) {
+    pthread_cancel(g_mng_metrics_thread_data.thread_id);
+  }
+
+  close(g_mng_metrics_stop_fd);
+  g_mng_metrics_stop_fd = UNINITIALIZED_FD;
+  close(g_mng_metrics_fd);
+  g_mng_metrics_fd = UNINITIALIZED_FD;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file mng_metrics.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#ifndef MNG_METRICS_H
+#define MNG_METRICS_H
+
+/* Serve OpenMetrics text on http://<metrics_ip_addr>:<metrics_port_num>/metrics from a single non-blocking thread */
+int mng_metrics_start(const char *metrics_ip_addr, int metrics_port_num);
+void mng_metrics_stop(void);
+
+#endif /* MNG_METRICS_H */
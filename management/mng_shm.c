@@ -0,0 +1,212 @@
+/**
+ * @file mng_shm.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#define PRINT_MODULE E_print_module_management
+
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mng_shm.h"
+#include "../common/os.h"
+#include "../common/print.h"
+#include "../control/control.h"
+
+#define MNG_SHM_FILE_MODE   0644
+
+/* Static data */
+
+static T_mng_shm_page *g_mng_shm_page = NULL;
+static char g_mng_shm_path[PATH_MAX];
+
+/* Only used by the main thread: last published data and the data being collected */
+static T_mng_shm_data g_mng_shm_data;
+static T_mng_shm_data g_mng_shm_next_data;
+
+/* Static functions */
+
+static void mng_shm_fill_sync(T_mng_shm_sync *sync, T_management_sync_info const *sync_info)
+{
+  strncpy(sync->name, sync_info->name, sizeof(sync->name) - 1);
+  sync->type = sync_info->type;
+  sync->clk_idx = -1;
+
+  switch(sync_info->type) {
+    case E_sync_type_synce:
+    {
+      T_management_synce_clk_info const *info = &sync_info->synce_clk_info;
+      sync->state = info->state;
+      sync->current_ql = info->current_ql;
+      sync->rank = info->rank;
+      sync->config_pri = info->config_pri;
+      sync->clk_idx = info->clk_idx;
+      sync->clk_state = info->clk_state;
+      sync->flags = (info->degrading_flag ? MNG_SHM_SYNC_FLAG_DEGRADING : 0) |
+                    (info->rx_timeout_flag ? MNG_SHM_SYNC_FLAG_RX_TIMEOUT : 0) |
+                    (info->port_link_down_flag ? MNG_SHM_SYNC_FLAG_LINK_DOWN : 0);
+    }
+    break;
+
+    case E_sync_type_monitoring:
+    {
+      T_management_synce_mon_info const *info = &sync_info->synce_mon_info;
+      sync->state = info->state;
+      sync->current_ql = info->current_ql;
+      sync->rank = info->rank;
+      sync->config_pri = info->config_pri;
+      sync->flags = (info->rx_timeout_flag ? MNG_SHM_SYNC_FLAG_RX_TIMEOUT : 0) |
+                    (info->port_link_down_flag ? MNG_SHM_SYNC_FLAG_LINK_DOWN : 0);
+    }
+    break;
+
+    case E_sync_type_external:
+    {
+      T_management_ext_clk_info const *info = &sync_info->ext_clk_info;
+      sync->state = info->state;
+      sync->current_ql = info->current_ql;
+      sync->rank = info->rank;
+      sync->config_pri = info->config_pri;
+      sync->clk_idx = info->clk_idx;
+      sync->clk_state = info->clk_state;
+      sync->flags = info->degrading_flag ? MNG_SHM_SYNC_FLAG_DEGRADING : 0;
+    }
+    break;
+
+    case E_sync_type_tx_only:
+      sync->flags = sync_info->synce_tx_only_info.port_link_down_flag ? MNG_SHM_SYNC_FLAG_LINK_DOWN : 0;
+      break;
+
+    default:
+      break;
+  }
+}
+
+/* Collect the current status into data; padding is zeroed so snapshots can be compared with memcmp() */
+static void mng_shm_collect(T_mng_shm_data *data)
+{
+  T_management_sync_info sync_info;
+  int i;
+
+  memset(data, 0, sizeof(*data));
+
+  management_get_current_status(0, &data->status);
+
+  for(i = 0; i < MNG_SHM_MAX_NUM_SYNCS; i++) {
+    if(control_get_sync_info_by_index(i, &sync_info) < 0) {
+      break;
+    }
+    mng_shm_fill_sync(&data->syncs[i], &sync_info);
+  }
+  data->num_syncs = i;
+}
+
+/* Global functions */
+
+int mng_shm_init(const char *path)
+{
+  int fd;
+
+  if(strlen(path) >= sizeof(g_mng_shm_path)) {
+    pr_err("Status page path %s is too long", path);
+    return -1;
+  }
+
+  /* Readers of a previous run keep their mapping of the old file */
+  unlink(path);
+
+  fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, MNG_SHM_FILE_MODE);
+  if(fd < 0) {
+    pr_err("%s: %s: %s", __func__, path, strerror(errno));
+    return -1;
+  }
+
+  if(ftruncate(fd, sizeof(T_mng_shm_page)) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    close(fd);
+    unlink(path);
+    return -1;
+  }
+
+  g_mng_shm_page = mmap(NULL, sizeof(T_mng_shm_page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(g_mng_shm_page == MAP_FAILED) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    g_mng_shm_page = NULL;
+    unlink(path);
+    return -1;
+  }
+
+  strcpy(g_mng_shm_path, path);
+
+  /* The file is zero-filled, so readers reject it until the magic number is set */
+  memset(&g_mng_shm_data, 0, sizeof(g_mng_shm_data));
+  g_mng_shm_page->version = MNG_SHM_VERSION;
+  g_mng_shm_page->size = sizeof(T_mng_shm_page);
+  g_mng_shm_page->seq = 0;
+  __atomic_store_n(&g_mng_shm_page->magic, MNG_SHM_MAGIC, __ATOMIC_RELEASE);
+
+  mng_shm_update();
+
+  return 0;
+}
+
+void mng_shm_deinit(void)
+{
+  if(g_mng_shm_page == NULL) {
+    return;
+  }
+
+  munmap(g_mng_shm_page, sizeof(T_mng_shm_page));
+  g_mng_shm_page = NULL;
+
+  unlink(g_mng_shm_path);
+}
+
+/* Publish the current status if it changed since the last call */
+void mng_shm_update(void)
+{
+  T_mng_shm_data *data = &g_mng_shm_next_data;
+  uint32_t seq;
+
+  if(g_mng_shm_page == NULL) {
+    return;
+  }
+
+  mng_shm_collect(data);
+
+  data->update_time_ms = g_mng_shm_data.update_time_ms;
+  if(memcmp(data, &g_mng_shm_data, sizeof(*data)) == 0) {
+    return;
+  }
+  data->update_time_ms = os_get_monotonic_milliseconds();
+  memcpy(&g_mng_shm_data, data, sizeof(*data));
+
+  /* Sequence lock: readers retry while the sequence number is odd or changed during their copy */
+  seq = g_mng_shm_page->seq;
+  __atomic_store_n(&g_mng_shm_page->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(&g_mng_shm_page->data, data, sizeof(*data));
+  __atomic_store_n(&g_mng_shm_page->seq, seq + 2, __ATOMIC_RELEASE);
+}
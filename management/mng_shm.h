@@ -0,0 +1,91 @@
+/**
+ * @file mng_shm.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#ifndef MNG_SHM_H
+#define MNG_SHM_H
+
+#include <stdint.h>
+
+#include "mng_if.h"
+
+/*
+ * Status page: a read-only shared memory file (e.g., /dev/shm/synced) holding the current status and a compact
+ * per-sync array. synced rewrites it under a sequence lock whenever the status changes, so local readers get a
+ * consistent snapshot without system calls and without contending for the control mutex.
+ *
+ * Readers only need this header and mng_shm_reader.c.
+ */
+
+#define MNG_SHM_MAGIC             0x53594E53 /* "SYNS" */
+#define MNG_SHM_VERSION           1
+#define MNG_SHM_MAX_NUM_SYNCS     MAX_SYNC_INFO_STRUCTURES
+
+/* T_mng_shm_sync flags */
+#define MNG_SHM_SYNC_FLAG_DEGRADING   (1 << 0)
+#define MNG_SHM_SYNC_FLAG_RX_TIMEOUT  (1 << 1)
+#define MNG_SHM_SYNC_FLAG_LINK_DOWN   (1 << 2)
+
+typedef struct {
+  char name[INTERFACE_MAX_NAME_LEN];
+  T_sync_type type;
+  T_sync_state state;                       /* Not applicable for Sync-E TX only ports */
+  T_esmc_ql current_ql;                     /* Not applicable for Sync-E TX only ports */
+  int rank;                                 /* Not applicable for Sync-E TX only ports */
+  int config_pri;                           /* Not applicable for Sync-E TX only ports */
+  int clk_idx;                              /* -1 unless Sync-E clock port or external clock port */
+  T_sync_clk_state clk_state;               /* Only applicable if clk_idx is valid */
+  unsigned int flags;                       /* MNG_SHM_SYNC_FLAG_* */
+} T_mng_shm_sync;
+
+typedef struct {
+  unsigned long long update_time_ms;        /* Monotonic time of the last change */
+  T_management_status status;
+  int num_syncs;
+  T_mng_shm_sync syncs[MNG_SHM_MAX_NUM_SYNCS];
+} T_mng_shm_data;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;                            /* sizeof(T_mng_shm_page) */
+  uint32_t seq;                             /* Odd while the data is being written */
+  T_mng_shm_data data;
+} T_mng_shm_page;
+
+typedef struct {
+  T_mng_shm_page const *page;
+} T_mng_shm_reader;
+
+/* Writer (synced) */
+int mng_shm_init(const char *path);
+void mng_shm_deinit(void);
+void mng_shm_update(void);
+
+/* Reader */
+int mng_shm_reader_open(T_mng_shm_reader *reader, const char *path);
+void mng_shm_reader_close(T_mng_shm_reader *reader);
+/* Copy a consistent snapshot; returns -1 if no snapshot could be taken (e.g., synced stopped while writing) */
+int mng_shm_reader_read(T_mng_shm_reader const *reader, T_mng_shm_data *data);
+/* Milliseconds since the snapshot last changed */
+unsigned long long mng_shm_reader_get_age_ms(T_mng_shm_data const *data);
+
+#endif /* MNG_SHM_H */
@@ -0,0 +1,118 @@
+/**
+ * @file mng_shm_reader.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mng_shm.h"
+
+#define MNG_SHM_READER_MAX_RETRIES  1000 /* synced rewrites the page in microseconds */
+
+/* Global functions */
+
+int mng_shm_reader_open(T_mng_shm_reader *reader, const char *path)
+{
+  struct stat st;
+  void *page;
+  int fd;
+
+  reader->page = NULL;
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if(fd < 0) {
+    return -1;
+  }
+
+  if((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(T_mng_shm_page))) {
+    close(fd);
+    return -1;
+  }
+
+  page = mmap(NULL, sizeof(T_mng_shm_page), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if(page == MAP_FAILED) {
+    return -1;
+  }
+
+  reader->page = page;
+
+  if((__atomic_load_n(&reader->page->magic, __ATOMIC_ACQUIRE) != MNG_SHM_MAGIC) ||
+     (reader->page->version != MNG_SHM_VERSION) ||
+     (reader->page->size != sizeof(T_mng_shm_page))) {
+    mng_shm_reader_close(reader);
+    return -1;
+  }
+
+  return 0;
+}
+
+void mng_shm_reader_close(T_mng_shm_reader *reader)
+{
+  if(reader->page != NULL) {
+    munmap((void *)reader->page, sizeof(T_mng_shm_page));
+    reader->page = NULL;
+  }
+}
+
+int mng_shm_reader_read(T_mng_shm_reader const *reader, T_mng_shm_data *data)
+{
+  uint32_t seq_begin;
+  uint32_t seq_end;
+  int retries;
+
+  if(reader->page == NULL) {
+    return -1;
+  }
+
+  for(retries = 0; retries < MNG_SHM_READER_MAX_RETRIES; retries++) {
+    seq_begin = __atomic_load_n(&reader->page->seq, __ATOMIC_ACQUIRE);
+    if(seq_begin & 1) {
+      continue;
+    }
+
+    memcpy(data, (void const *)&reader->page->data, sizeof(*data));
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    seq_end = __atomic_load_n(&reader->page->seq, __ATOMIC_RELAXED);
+    if(seq_begin == seq_end) {
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+unsigned long long mng_shm_reader_get_age_ms(T_mng_shm_data const *data)
+{
+  struct timespec current_time;
+  unsigned long long current_time_ms;
+
+  /* Same clock as os_get_monotonic_milliseconds() in synced */
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  current_time_ms = ((current_time.tv_sec * 1000ULL) + (current_time.tv_nsec / 1000000));
+
+  return current_time_ms - data->update_time_ms;
+}
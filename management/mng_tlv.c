@@ -0,0 +1,1752 @@
+/**
+ * @file mng_tlv.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#include <arpa/inet.h>
+#include <string.h>
+
+#include "mng_tlv.h"
+#include "../common/print.h"
+
+/* Static data */
+
+static T_os_mutex_prof_report g_mng_tlv_mutex_stats; /* Decoded mutex statistics of the last response */
+
+/* Static functions */
+
+static void mng_tlv_put_u16(unsigned char *buff, uint16_t val)
+{
+  val = htons(val);
+  memcpy(buff, &val, sizeof(val));
+}
+
+static void mng_tlv_put_u32(unsigned char *buff, uint32_t val)
+{
+  val = htonl(val);
+  memcpy(buff, &val, sizeof(val));
+}
+
+static void mng_tlv_put_u64(T_mng_tlv_writer *writer, T_mng_tlv_type type, uint64_t val)
+{
+  unsigned char buff[sizeof(uint64_t)];
+
+  mng_tlv_put_u32(buff, (uint32_t)(val >> 32));
+  mng_tlv_put_u32(buff + sizeof(uint32_t), (uint32_t)val);
+  mng_tlv_put_bytes(writer, type, buff, sizeof(buff));
+}
+
+static uint16_t mng_tlv_get_u16(const unsigned char *buff)
+{
+  uint16_t val;
+
+  memcpy(&val, buff, sizeof(val));
+  return ntohs(val);
+}
+
+static uint32_t mng_tlv_get_u32(const unsigned char *buff)
+{
+  uint32_t val;
+
+  memcpy(&val, buff, sizeof(val));
+  return ntohl(val);
+}
+
+/* Return 0 on success and -1 if the value is not 8 bytes */
+static int mng_tlv_get_u64(const unsigned char *val, uint16_t len, uint64_t *result)
+{
+  if(len != sizeof(uint64_t)) {
+    return -1;
+  }
+
+  *result = ((uint64_t)mng_tlv_get_u32(val) << 32) | mng_tlv_get_u32(val + sizeof(uint32_t));
+
+  return 0;
+}
+
+static unsigned char *mng_tlv_reserve(T_mng_tlv_writer *writer, size_t len)
+{
+  unsigned char *ptr;
+
+  if(writer->overflow_flag || (writer->len + len > writer->size)) {
+    writer->overflow_flag = 1;
+    return NULL;
+  }
+
+  ptr = &writer->buff[writer->len];
+  writer->len += len;
+
+  return ptr;
+}
+
+static unsigned int mng_tlv_conv_ref_mon_status_to_bits(T_device_clk_reference_monitor_status const *ref_mon_status)
+{
+  return (ref_mon_status->loss_of_signal_alarm_status << 0) |
+         (ref_mon_status->no_activity_alarm_status << 1) |
+         (ref_mon_status->frequency_offset_alarm_status << 2);
+}
+
+static void mng_tlv_conv_bits_to_ref_mon_status(unsigned int bits, T_device_clk_reference_monitor_status *ref_mon_status)
+{
+  ref_mon_status->loss_of_signal_alarm_status = (bits >> 0) & 1;
+  ref_mon_status->no_activity_alarm_status = (bits >> 1) & 1;
+  ref_mon_status->frequency_offset_alarm_status = (bits >> 2) & 1;
+}
+
+static void mng_tlv_put_flag(T_mng_tlv_writer *writer, T_mng_tlv_type type, int flag)
+{
+  /* Flags are only encoded when set */
+  if(flag) {
+    mng_tlv_put_int(writer, type, flag);
+  }
+}
+
+static void mng_tlv_encode_sync_info(T_mng_tlv_writer *writer, T_management_sync_info const *sync_info)
+{
+  size_t offset;
+
+  offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_sync_info);
+
+  mng_tlv_put_string(writer, E_mng_tlv_type_port_name, sync_info->name);
+  mng_tlv_put_int(writer, E_mng_tlv_type_sync_type, sync_info->type);
+
+  switch(sync_info->type) {
+    case E_sync_type_synce:
+      mng_tlv_put_int(writer, E_mng_tlv_type_config_pri, sync_info->synce_clk_info.config_pri);
+      mng_tlv_put_int(writer, E_mng_tlv_type_current_ql, sync_info->synce_clk_info.current_ql);
+      mng_tlv_put_int(writer, E_mng_tlv_type_sync_state, sync_info->synce_clk_info.state);
+      if(sync_info->synce_clk_info.tx_bundle_num >= 0) {
+        mng_tlv_put_int(writer, E_mng_tlv_type_tx_bundle_num, sync_info->synce_clk_info.tx_bundle_num);
+      }
+      mng_tlv_put_int(writer, E_mng_tlv_type_clk_idx, sync_info->synce_clk_info.clk_idx);
+      mng_tlv_put_flag(writer, E_mng_tlv_type_remaining_time_ms, (int)sync_info->synce_clk_info.remaining_time_ms);
+      mng_tlv_put_int(writer, E_mng_tlv_type_current_num_hops, sync_info->synce_clk_info.current_num_hops);
+      mng_tlv_put_int(writer, E_mng_tlv_type_rank, sync_info->synce_clk_info.rank);
+      mng_tlv_put_int(writer, E_mng_tlv_type_clk_state, sync_info->synce_clk_info.clk_state);
+      mng_tlv_put_flag(writer, E_mng_tlv_type_ref_mon_status, mng_tlv_conv_ref_mon_status_to_bits(&sync_info->synce_clk_info.ref_mon_status));
+      mng_tlv_put_flag(writer, E_mng_tlv_type_degrading, sync_info->synce_clk_info.degrading_flag);
+      mng_tlv_put_flag(writer, E_mng_tlv_type_rx_timeout, sync_info->synce_clk_info.rx_timeout_flag);
+      mng_tlv_put_flag(writer, E_mng_tlv_type_port_link_down, sync_info->synce_clk_info.port_link_down_flag);
+      break;
+
+    case E_sync_type_monitoring:
+      mng_tlv_put_int(writer, E_mng_tlv_type_config_pri, sync_info->synce_mon_info.config_pri);
+      mng_tlv_put_int(writer, E_mng_tlv_type_current_ql, sync_info->synce_mon_info.current_ql);
+      mng_tlv_put_int(writer, E_mng_tlv_type_sync_state, sync_info->synce_mon_info.state);
+      if(sync_info->synce_mon_info.tx_bundle_num >= 0) {
+        mng_tlv_put_int(writer, E_mng_tlv_type_tx_bundle_num, sync_info->synce_mon_info.tx_bundle_num);
+      }
+      mng_tlv_put_flag(writer, E_mng_tlv_type_remaining_time_ms, (int)sync_info->synce_mon_info.remaining_time_ms);
+      mng_tlv_put_int(writer, E_mng_tlv_type_current_num_hops, sync_info->synce_mon_info.current_num_hops);
+      mng_tlv_put_int(writer, E_mng_tlv_type_rank, sync_info->synce_mon_info.rank);
+      mng_tlv_put_flag(writer, E_mng_tlv_type_rx_timeout, sync_info->synce_mon_info.rx_timeout_flag);
+      mng_tlv_put_flag(writer, E_mng_tlv_type_port_link_down, sync_info->synce_mon_info.port_link_down_flag);
+      break;
+
+    case E_sync_type_external:
+      mng_tlv_put_int(writer, E_mng_tlv_type_config_pri, sync_info->ext_clk_info.config_pri);
+      mng_tlv_put_int(writer, E_mng_tlv_type_current_ql, sync_info->ext_clk_info.current_ql);
+      mng_tlv_put_int(writer, E_mng_tlv_type_sync_state, sync_info->ext_clk_info.state);
+      mng_tlv_put_int(writer, E_mng_tlv_type_clk_idx, sync_info->ext_clk_info.clk_idx);
+      mng_tlv_put_int(writer, E_mng_tlv_type_rank, sync_info->ext_clk_info.rank);
+      mng_tlv_put_int(writer, E_mng_tlv_type_clk_state, sync_info->ext_clk_info.clk_state);
+      mng_tlv_put_flag(writer, E_mng_tlv_type_ref_mon_status, mng_tlv_conv_ref_mon_status_to_bits(&sync_info->ext_clk_info.ref_mon_status));
+      mng_tlv_put_flag(writer, E_mng_tlv_type_degrading, sync_info->ext_clk_info.degrading_flag);
+      break;
+
+    case E_sync_type_tx_only:
+      if(sync_info->synce_tx_only_info.tx_bundle_num >= 0) {
+        mng_tlv_put_int(writer, E_mng_tlv_type_tx_bundle_num, sync_info->synce_tx_only_info.tx_bundle_num);
+      }
+      mng_tlv_put_flag(writer, E_mng_tlv_type_port_link_down, sync_info->synce_tx_only_info.port_link_down_flag);
+      break;
+
+    default:
+      break;
+  }
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_sync_info(const unsigned char *buff, size_t len, T_management_sync_info *sync_info)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int num;
+  int config_pri = 0;
+  int current_ql = E_esmc_ql_max;
+  int state = E_sync_state_max;
+  int tx_bundle_num = -1;
+  int clk_idx = -1;
+  int remaining_time_ms = 0;
+  int current_num_hops = 0;
+  int rank = 0;
+  int clk_state = E_sync_clk_state_max;
+  int ref_mon_status = 0;
+  int degrading_flag = 0;
+  int rx_timeout_flag = 0;
+  int port_link_down_flag = 0;
+  int sync_type = E_sync_type_max;
+
+  memset(sync_info, 0, sizeof(*sync_info));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type == E_mng_tlv_type_port_name) {
+      if(mng_tlv_get_string(val, val_len, sync_info->name, sizeof(sync_info->name)) < 0) {
+        return -1;
+      }
+      continue;
+    }
+
+    if(mng_tlv_get_int(val, val_len, &num) < 0) {
+      /* Unknown non-integer TLV */
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_sync_type:
+        sync_type = num;
+        break;
+      case E_mng_tlv_type_config_pri:
+        config_pri = num;
+        break;
+      case E_mng_tlv_type_current_ql:
+        current_ql = num;
+        break;
+      case E_mng_tlv_type_sync_state:
+        state = num;
+        break;
+      case E_mng_tlv_type_tx_bundle_num:
+        tx_bundle_num = num;
+        break;
+      case E_mng_tlv_type_clk_idx:
+        clk_idx = num;
+        break;
+      case E_mng_tlv_type_remaining_time_ms:
+        remaining_time_ms = num;
+        break;
+      case E_mng_tlv_type_current_num_hops:
+        current_num_hops = num;
+        break;
+      case E_mng_tlv_type_rank:
+        rank = num;
+        break;
+      case E_mng_tlv_type_clk_state:
+        clk_state = num;
+        break;
+      case E_mng_tlv_type_ref_mon_status:
+        ref_mon_status = num;
+        break;
+      case E_mng_tlv_type_degrading:
+        degrading_flag = num;
+        break;
+      case E_mng_tlv_type_rx_timeout:
+        rx_timeout_flag = num;
+        break;
+      case E_mng_tlv_type_port_link_down:
+        port_link_down_flag = num;
+        break;
+      default:
+        break;
+    }
+  }
+  if(ret < 0) {
+    return -1;
+  }
+
+  sync_info->type = (T_sync_type)sync_type;
+  switch(sync_info->type) {
+    case E_sync_type_synce:
+      sync_info->synce_clk_info.config_pri = config_pri;
+      sync_info->synce_clk_info.current_ql = (T_esmc_ql)current_ql;
+      sync_info->synce_clk_info.state = (T_sync_state)state;
+      sync_info->synce_clk_info.tx_bundle_num = tx_bundle_num;
+      sync_info->synce_clk_info.clk_idx = clk_idx;
+      sync_info->synce_clk_info.remaining_time_ms = (unsigned int)remaining_time_ms;
+      sync_info->synce_clk_info.current_num_hops = current_num_hops;
+      sync_info->synce_clk_info.rank = rank;
+      sync_info->synce_clk_info.clk_state = (T_sync_clk_state)clk_state;
+      mng_tlv_conv_bits_to_ref_mon_status(ref_mon_status, &sync_info->synce_clk_info.ref_mon_status);
+      sync_info->synce_clk_info.degrading_flag = degrading_flag;
+      sync_info->synce_clk_info.rx_timeout_flag = rx_timeout_flag;
+      sync_info->synce_clk_info.port_link_down_flag = port_link_down_flag;
+      break;
+
+    case E_sync_type_monitoring:
+      sync_info->synce_mon_info.config_pri = config_pri;
+      sync_info->synce_mon_info.current_ql = (T_esmc_ql)current_ql;
+      sync_info->synce_mon_info.state = (T_sync_state)state;
+      sync_info->synce_mon_info.tx_bundle_num = tx_bundle_num;
+      sync_info->synce_mon_info.remaining_time_ms = (unsigned int)remaining_time_ms;
+      sync_info->synce_mon_info.current_num_hops = current_num_hops;
+      sync_info->synce_mon_info.rank = rank;
+      sync_info->synce_mon_info.rx_timeout_flag = rx_timeout_flag;
+      sync_info->synce_mon_info.port_link_down_flag = port_link_down_flag;
+      break;
+
+    case E_sync_type_external:
+      sync_info->ext_clk_info.config_pri = config_pri;
+      sync_info->ext_clk_info.current_ql = (T_esmc_ql)current_ql;
+      sync_info->ext_clk_info.state = (T_sync_state)state;
+      sync_info->ext_clk_info.clk_idx = clk_idx;
+      sync_info->ext_clk_info.rank = rank;
+      sync_info->ext_clk_info.clk_state = (T_sync_clk_state)clk_state;
+      mng_tlv_conv_bits_to_ref_mon_status(ref_mon_status, &sync_info->ext_clk_info.ref_mon_status);
+      sync_info->ext_clk_info.degrading_flag = degrading_flag;
+      break;
+
+    case E_sync_type_tx_only:
+      sync_info->synce_tx_only_info.tx_bundle_num = tx_bundle_num;
+      sync_info->synce_tx_only_info.port_link_down_flag = port_link_down_flag;
+      break;
+
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+static void mng_tlv_encode_current_status(T_mng_tlv_writer *writer, T_management_status const *status)
+{
+  size_t offset;
+
+  offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_current_status);
+
+  mng_tlv_put_int(writer, E_mng_tlv_type_current_ql, status->current_ql);
+  if(status->port_name[0] != 0) {
+    mng_tlv_put_string(writer, E_mng_tlv_type_port_name, status->port_name);
+  }
+  mng_tlv_put_int(writer, E_mng_tlv_type_clk_idx, status->clk_idx);
+  mng_tlv_put_int(writer, E_mng_tlv_type_dpll_state, status->dpll_state);
+  mng_tlv_put_flag(writer, E_mng_tlv_type_holdover_remaining_time_ms, (int)status->holdover_remaining_time_ms);
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_current_status(const unsigned char *buff, size_t len, T_management_status *status)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int num;
+
+  memset(status, 0, sizeof(*status));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type == E_mng_tlv_type_port_name) {
+      if(mng_tlv_get_string(val, val_len, status->port_name, sizeof(status->port_name)) < 0) {
+        return -1;
+      }
+      continue;
+    }
+
+    if(mng_tlv_get_int(val, val_len, &num) < 0) {
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_current_ql:
+        status->current_ql = (T_esmc_ql)num;
+        break;
+      case E_mng_tlv_type_clk_idx:
+        status->clk_idx = num;
+        break;
+      case E_mng_tlv_type_dpll_state:
+        status->dpll_state = (T_device_dpll_state)num;
+        break;
+      case E_mng_tlv_type_holdover_remaining_time_ms:
+        status->holdover_remaining_time_ms = (unsigned int)num;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+static void mng_tlv_encode_port_dir_stats(T_mng_tlv_writer *writer, T_mng_tlv_type type, T_esmc_port_dir_stats const *stats)
+{
+  size_t offset;
+
+  offset = mng_tlv_begin_nested(writer, type);
+
+  mng_tlv_put_u64(writer, E_mng_tlv_type_pdus, stats->pdus);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_event_pdus, stats->event_pdus);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_information_pdus, stats->information_pdus);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_errors, stats->errors);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_invalid_len_pdus, stats->invalid_len_pdus);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_timing_loops, stats->timing_loops);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_socket_drops, stats->socket_drops);
+  if(stats->last_pdu_age_ms >= 0) {
+    mng_tlv_put_u64(writer, E_mng_tlv_type_last_pdu_age_ms, (uint64_t)stats->last_pdu_age_ms);
+  }
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_port_dir_stats(const unsigned char *buff, size_t len, T_esmc_port_dir_stats *stats)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  uint64_t num;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->last_pdu_age_ms = -1;
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(mng_tlv_get_u64(val, val_len, &num) < 0) {
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_pdus:
+        stats->pdus = num;
+        break;
+      case E_mng_tlv_type_event_pdus:
+        stats->event_pdus = num;
+        break;
+      case E_mng_tlv_type_information_pdus:
+        stats->information_pdus = num;
+        break;
+      case E_mng_tlv_type_errors:
+        stats->errors = num;
+        break;
+      case E_mng_tlv_type_invalid_len_pdus:
+        stats->invalid_len_pdus = num;
+        break;
+      case E_mng_tlv_type_timing_loops:
+        stats->timing_loops = num;
+        break;
+      case E_mng_tlv_type_socket_drops:
+        stats->socket_drops = num;
+        break;
+      case E_mng_tlv_type_last_pdu_age_ms:
+        stats->last_pdu_age_ms = (long long)num;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+static void mng_tlv_encode_port_stats(T_mng_tlv_writer *writer, T_management_port_stats const *port_stats)
+{
+  size_t offset;
+
+  offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_port_stats);
+
+  mng_tlv_put_string(writer, E_mng_tlv_type_port_name, port_stats->name);
+  if(port_stats->esmc_stats.tx_flag) {
+    mng_tlv_encode_port_dir_stats(writer, E_mng_tlv_type_port_tx_stats, &port_stats->esmc_stats.tx);
+  }
+  if(port_stats->esmc_stats.rx_flag) {
+    mng_tlv_encode_port_dir_stats(writer, E_mng_tlv_type_port_rx_stats, &port_stats->esmc_stats.rx);
+  }
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_port_stats(const unsigned char *buff, size_t len, T_management_port_stats *port_stats)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+
+  memset(port_stats, 0, sizeof(*port_stats));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    switch(type) {
+      case E_mng_tlv_type_port_name:
+        if(mng_tlv_get_string(val, val_len, port_stats->name, sizeof(port_stats->name)) < 0) {
+          return -1;
+        }
+        break;
+
+      case E_mng_tlv_type_port_tx_stats:
+        if(mng_tlv_decode_port_dir_stats(val, val_len, &port_stats->esmc_stats.tx) < 0) {
+          return -1;
+        }
+        port_stats->esmc_stats.tx_flag = 1;
+        break;
+
+      case E_mng_tlv_type_port_rx_stats:
+        if(mng_tlv_decode_port_dir_stats(val, val_len, &port_stats->esmc_stats.rx) < 0) {
+          return -1;
+        }
+        port_stats->esmc_stats.rx_flag = 1;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+static void mng_tlv_encode_latency_stats(T_mng_tlv_writer *writer, T_management_latency_stats const *latency_stats)
+{
+  T_latency_stage_stats const *stats;
+  size_t offset;
+  size_t stage_offset;
+  int stage;
+
+  offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_latency_stats);
+
+  for(stage = 0; stage < E_latency_stage_max; stage++) {
+    stats = &latency_stats->stages[stage];
+    if(stats->count == 0) {
+      continue;
+    }
+
+    stage_offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_latency_stage);
+
+    mng_tlv_put_int(writer, E_mng_tlv_type_stage, stage);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_count, stats->count);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_min_ns, stats->min_ns);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_mean_ns, stats->mean_ns);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_p50_ns, stats->p50_ns);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_p90_ns, stats->p90_ns);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_p99_ns, stats->p99_ns);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_p999_ns, stats->p999_ns);
+    mng_tlv_put_u64(writer, E_mng_tlv_type_max_ns, stats->max_ns);
+
+    mng_tlv_end_nested(writer, stage_offset);
+  }
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_latency_stage(const unsigned char *buff, size_t len, T_management_latency_stats *latency_stats)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int stage = -1;
+  uint64_t num;
+  T_latency_stage_stats stats;
+
+  memset(&stats, 0, sizeof(stats));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type == E_mng_tlv_type_stage) {
+      if(mng_tlv_get_int(val, val_len, &stage) < 0) {
+        return -1;
+      }
+      continue;
+    }
+
+    if(mng_tlv_get_u64(val, val_len, &num) < 0) {
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_count:
+        stats.count = num;
+        break;
+      case E_mng_tlv_type_min_ns:
+        stats.min_ns = num;
+        break;
+      case E_mng_tlv_type_mean_ns:
+        stats.mean_ns = num;
+        break;
+      case E_mng_tlv_type_p50_ns:
+        stats.p50_ns = num;
+        break;
+      case E_mng_tlv_type_p90_ns:
+        stats.p90_ns = num;
+        break;
+      case E_mng_tlv_type_p99_ns:
+        stats.p99_ns = num;
+        break;
+      case E_mng_tlv_type_p999_ns:
+        stats.p999_ns = num;
+        break;
+      case E_mng_tlv_type_max_ns:
+        stats.max_ns = num;
+        break;
+      default:
+        break;
+    }
+  }
+
+  if(ret < 0) {
+    return -1;
+  }
+
+  /* Skip stages unknown to this version */
+  if((stage >= 0) && (stage < E_latency_stage_max)) {
+    latency_stats->stages[stage] = stats;
+  }
+
+  return 0;
+}
+
+static int mng_tlv_decode_latency_stats(const unsigned char *buff, size_t len, T_management_latency_stats *latency_stats)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+
+  memset(latency_stats, 0, sizeof(*latency_stats));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type == E_mng_tlv_type_latency_stage) {
+      if(mng_tlv_decode_latency_stage(val, val_len, latency_stats) < 0) {
+        return -1;
+      }
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+static void mng_tlv_encode_mutex_prof_stats(T_mng_tlv_writer *writer, T_mng_tlv_type type, T_os_mutex_prof_stats const *stats)
+{
+  size_t offset;
+
+  offset = mng_tlv_begin_nested(writer, type);
+
+  mng_tlv_put_string(writer, E_mng_tlv_type_mutex_name, stats->name);
+  if(type == E_mng_tlv_type_mutex_site) {
+    mng_tlv_put_string(writer, E_mng_tlv_type_func, stats->func);
+    mng_tlv_put_string(writer, E_mng_tlv_type_site, stats->site);
+  }
+  mng_tlv_put_u64(writer, E_mng_tlv_type_acquisitions, stats->acquisitions);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_contended, stats->contended);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_total_wait_ns, stats->total_wait_ns);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_max_wait_ns, stats->max_wait_ns);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_total_hold_ns, stats->total_hold_ns);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_max_hold_ns, stats->max_hold_ns);
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_mutex_prof_stats(const unsigned char *buff, size_t len, T_os_mutex_prof_stats *stats)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  uint64_t num;
+
+  memset(stats, 0, sizeof(*stats));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    switch(type) {
+      case E_mng_tlv_type_mutex_name:
+        if(mng_tlv_get_string(val, val_len, stats->name, sizeof(stats->name)) < 0) {
+          return -1;
+        }
+        continue;
+      case E_mng_tlv_type_func:
+        if(mng_tlv_get_string(val, val_len, stats->func, sizeof(stats->func)) < 0) {
+          return -1;
+        }
+        continue;
+      case E_mng_tlv_type_site:
+        if(mng_tlv_get_string(val, val_len, stats->site, sizeof(stats->site)) < 0) {
+          return -1;
+        }
+        continue;
+      default:
+        break;
+    }
+
+    if(mng_tlv_get_u64(val, val_len, &num) < 0) {
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_acquisitions:
+        stats->acquisitions = num;
+        break;
+      case E_mng_tlv_type_contended:
+        stats->contended = num;
+        break;
+      case E_mng_tlv_type_total_wait_ns:
+        stats->total_wait_ns = num;
+        break;
+      case E_mng_tlv_type_max_wait_ns:
+        stats->max_wait_ns = num;
+        break;
+      case E_mng_tlv_type_total_hold_ns:
+        stats->total_hold_ns = num;
+        break;
+      case E_mng_tlv_type_max_hold_ns:
+        stats->max_hold_ns = num;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+static void mng_tlv_encode_mutex_stats(T_mng_tlv_writer *writer, T_os_mutex_prof_report const *report)
+{
+  size_t offset;
+  int i;
+
+  offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_mutex_stats);
+
+  for(i = 0; i < report->num_mutexes; i++) {
+    mng_tlv_encode_mutex_prof_stats(writer, E_mng_tlv_type_mutex, &report->mutexes[i]);
+  }
+  for(i = 0; i < report->num_sites; i++) {
+    mng_tlv_encode_mutex_prof_stats(writer, E_mng_tlv_type_mutex_site, &report->sites[i]);
+  }
+  if(report->num_dropped_sites > 0) {
+    mng_tlv_put_int(writer, E_mng_tlv_type_num_dropped_sites, report->num_dropped_sites);
+  }
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_mutex_stats(const unsigned char *buff, size_t len, T_os_mutex_prof_report *report)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+
+  memset(report, 0, sizeof(*report));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    switch(type) {
+      case E_mng_tlv_type_mutex:
+        if(report->num_mutexes < OS_MUTEX_PROF_REPORT_MAX_NUM_OF_MUTEXES) {
+          if(mng_tlv_decode_mutex_prof_stats(val, val_len, &report->mutexes[report->num_mutexes]) < 0) {
+            return -1;
+          }
+          report->num_mutexes++;
+        }
+        break;
+
+      case E_mng_tlv_type_mutex_site:
+        if(report->num_sites < OS_MUTEX_PROF_REPORT_MAX_NUM_OF_SITES) {
+          if(mng_tlv_decode_mutex_prof_stats(val, val_len, &report->sites[report->num_sites]) < 0) {
+            return -1;
+          }
+          report->num_sites++;
+        } else {
+          report->num_dropped_sites++;
+        }
+        break;
+
+      case E_mng_tlv_type_num_dropped_sites:
+        {
+          int num_dropped_sites;
+          if(mng_tlv_get_int(val, val_len, &num_dropped_sites) < 0) {
+            return -1;
+          }
+          report->num_dropped_sites += num_dropped_sites;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+static void mng_tlv_encode_journal_entry(T_mng_tlv_writer *writer, T_management_journal_entry const *journal_entry)
+{
+  T_journal_entry const *entry = &journal_entry->entry;
+  size_t offset;
+
+  offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_journal_entry);
+
+  mng_tlv_put_u64(writer, E_mng_tlv_type_journal_seq, entry->seq);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_time_ns, entry->time_ns);
+  mng_tlv_put_int(writer, E_mng_tlv_type_journal_event_type, entry->type);
+  mng_tlv_put_int(writer, E_mng_tlv_type_sync_idx, entry->sync_idx);
+  mng_tlv_put_int(writer, E_mng_tlv_type_val0, entry->val[0]);
+  mng_tlv_put_int(writer, E_mng_tlv_type_val1, entry->val[1]);
+  mng_tlv_put_int(writer, E_mng_tlv_type_val2, entry->val[2]);
+  if(journal_entry->port_name[0] != '\0') {
+    mng_tlv_put_string(writer, E_mng_tlv_type_port_name, journal_entry->port_name);
+  }
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_journal_entry(const unsigned char *buff, size_t len, T_management_journal_entry *journal_entry)
+{
+  T_journal_entry *entry = &journal_entry->entry;
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int num;
+  uint64_t num64;
+
+  memset(journal_entry, 0, sizeof(*journal_entry));
+  entry->sync_idx = JOURNAL_NO_SYNC_IDX;
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    switch(type) {
+      case E_mng_tlv_type_port_name:
+        if(mng_tlv_get_string(val, val_len, journal_entry->port_name, sizeof(journal_entry->port_name)) < 0) {
+          return -1;
+        }
+        continue;
+      case E_mng_tlv_type_journal_seq:
+        if(mng_tlv_get_u64(val, val_len, &num64) < 0) {
+          return -1;
+        }
+        entry->seq = num64;
+        continue;
+      case E_mng_tlv_type_time_ns:
+        if(mng_tlv_get_u64(val, val_len, &num64) < 0) {
+          return -1;
+        }
+        entry->time_ns = num64;
+        continue;
+      default:
+        break;
+    }
+
+    if(mng_tlv_get_int(val, val_len, &num) < 0) {
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_journal_event_type:
+        entry->type = (short)num;
+        break;
+      case E_mng_tlv_type_sync_idx:
+        entry->sync_idx = (short)num;
+        break;
+      case E_mng_tlv_type_val0:
+        entry->val[0] = num;
+        break;
+      case E_mng_tlv_type_val1:
+        entry->val[1] = num;
+        break;
+      case E_mng_tlv_type_val2:
+        entry->val[2] = num;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+static void mng_tlv_encode_journal(T_mng_tlv_writer *writer, T_management_journal const *journal)
+{
+  size_t offset;
+  int i;
+
+  offset = mng_tlv_begin_nested(writer, E_mng_tlv_type_journal);
+
+  mng_tlv_put_u64(writer, E_mng_tlv_type_last_seq, journal->last_seq);
+  mng_tlv_put_u64(writer, E_mng_tlv_type_num_lost, journal->num_lost);
+  for(i = 0; (i < journal->num_entries) && (i < MAX_JOURNAL_ENTRIES_PER_RESPONSE); i++) {
+    mng_tlv_encode_journal_entry(writer, &journal->entries[i]);
+  }
+
+  mng_tlv_end_nested(writer, offset);
+}
+
+static int mng_tlv_decode_journal(const unsigned char *buff, size_t len, T_management_journal *journal)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  uint64_t num64;
+
+  memset(journal, 0, sizeof(*journal));
+
+  mng_tlv_reader_init(&reader, buff, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    switch(type) {
+      case E_mng_tlv_type_last_seq:
+        if(mng_tlv_get_u64(val, val_len, &num64) < 0) {
+          return -1;
+        }
+        journal->last_seq = num64;
+        break;
+
+      case E_mng_tlv_type_num_lost:
+        if(mng_tlv_get_u64(val, val_len, &num64) < 0) {
+          return -1;
+        }
+        journal->num_lost = num64;
+        break;
+
+      case E_mng_tlv_type_journal_entry:
+        if(journal->num_entries < MAX_JOURNAL_ENTRIES_PER_RESPONSE) {
+          if(mng_tlv_decode_journal_entry(val, val_len, &journal->entries[journal->num_entries]) < 0) {
+            return -1;
+          }
+          journal->num_entries++;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  return (ret < 0) ? -1 : 0;
+}
+
+/* Global functions */
+
+/* Return 1 if buffer starts with TLV frame magic, 0 if more bytes are needed, and -1 otherwise */
+int mng_tlv_is_frame(const unsigned char *buff, size_t len)
+{
+  if(len < sizeof(uint32_t)) {
+    return 0;
+  }
+
+  return (mng_tlv_get_u32(buff) == MNG_TLV_MAGIC) ? 1 : -1;
+}
+
+/* Return 1 if header was parsed, 0 if more bytes are needed, and -1 if header is invalid */
+int mng_tlv_parse_frame_header(const unsigned char *buff, size_t len, T_mng_tlv_frame_header *header)
+{
+  if(len < MNG_TLV_FRAME_HEADER_LEN) {
+    return 0;
+  }
+
+  header->magic = mng_tlv_get_u32(buff);
+  header->version = buff[4];
+  header->type = buff[5];
+  header->payload_len = mng_tlv_get_u32(buff + 8);
+
+  if((header->magic != MNG_TLV_MAGIC) || (header->payload_len > (MNG_TLV_MAX_FRAME_LEN - MNG_TLV_FRAME_HEADER_LEN))) {
+    return -1;
+  }
+
+  return 1;
+}
+
+void mng_tlv_begin_frame(T_mng_tlv_writer *writer, unsigned char *buff, size_t size, T_mng_tlv_frame_type type)
+{
+  unsigned char *ptr;
+
+  writer->buff = buff;
+  writer->size = size;
+  writer->len = 0;
+  writer->overflow_flag = 0;
+
+  ptr = mng_tlv_reserve(writer, MNG_TLV_FRAME_HEADER_LEN);
+  if(ptr == NULL) {
+    return;
+  }
+
+  mng_tlv_put_u32(ptr, MNG_TLV_MAGIC);
+  ptr[4] = MNG_TLV_VERSION;
+  ptr[5] = (unsigned char)type;
+  mng_tlv_put_u16(ptr + 6, 0);
+  mng_tlv_put_u32(ptr + 8, 0);
+}
+
+/* Return frame length or -1 if the frame did not fit */
+int mng_tlv_end_frame(T_mng_tlv_writer *writer)
+{
+  if(writer->overflow_flag) {
+    return -1;
+  }
+
+  mng_tlv_put_u32(writer->buff + 8, (uint32_t)(writer->len - MNG_TLV_FRAME_HEADER_LEN));
+
+  return (int)writer->len;
+}
+
+void mng_tlv_put_int(T_mng_tlv_writer *writer, T_mng_tlv_type type, int val)
+{
+  unsigned char buff[sizeof(uint32_t)];
+
+  mng_tlv_put_u32(buff, (uint32_t)val);
+  mng_tlv_put_bytes(writer, type, buff, sizeof(buff));
+}
+
+void mng_tlv_put_bytes(T_mng_tlv_writer *writer, T_mng_tlv_type type, const void *val, size_t len)
+{
+  unsigned char *ptr;
+
+  if(len > UINT16_MAX) {
+    writer->overflow_flag = 1;
+    return;
+  }
+
+  ptr = mng_tlv_reserve(writer, MNG_TLV_HEADER_LEN + len);
+  if(ptr == NULL) {
+    return;
+  }
+
+  mng_tlv_put_u16(ptr, (uint16_t)type);
+  mng_tlv_put_u16(ptr + 2, (uint16_t)len);
+  memcpy(ptr + MNG_TLV_HEADER_LEN, val, len);
+}
+
+void mng_tlv_put_string(T_mng_tlv_writer *writer, T_mng_tlv_type type, const char *str)
+{
+  mng_tlv_put_bytes(writer, type, str, strlen(str));
+}
+
+/* Return offset of nested TLV to be passed to mng_tlv_end_nested() */
+size_t mng_tlv_begin_nested(T_mng_tlv_writer *writer, T_mng_tlv_type type)
+{
+  size_t offset = writer->len;
+  unsigned char *ptr;
+
+  ptr = mng_tlv_reserve(writer, MNG_TLV_HEADER_LEN);
+  if(ptr != NULL) {
+    mng_tlv_put_u16(ptr, (uint16_t)type);
+    mng_tlv_put_u16(ptr + 2, 0);
+  }
+
+  return offset;
+}
+
+void mng_tlv_end_nested(T_mng_tlv_writer *writer, size_t offset)
+{
+  size_t len;
+
+  if(writer->overflow_flag) {
+    return;
+  }
+
+  len = writer->len - offset - MNG_TLV_HEADER_LEN;
+  if(len > UINT16_MAX) {
+    writer->overflow_flag = 1;
+    return;
+  }
+
+  mng_tlv_put_u16(writer->buff + offset + 2, (uint16_t)len);
+}
+
+void mng_tlv_reader_init(T_mng_tlv_reader *reader, const unsigned char *buff, size_t len)
+{
+  reader->buff = buff;
+  reader->len = len;
+  reader->pos = 0;
+}
+
+/* Return 1 if a TLV was read, 0 at the end of the buffer, and -1 if the TLV is truncated */
+int mng_tlv_next(T_mng_tlv_reader *reader, uint16_t *type, const unsigned char **val, uint16_t *len)
+{
+  if(reader->pos == reader->len) {
+    return 0;
+  }
+
+  if(reader->len - reader->pos < MNG_TLV_HEADER_LEN) {
+    return -1;
+  }
+
+  *type = mng_tlv_get_u16(&reader->buff[reader->pos]);
+  *len = mng_tlv_get_u16(&reader->buff[reader->pos + 2]);
+
+  if(reader->len - reader->pos - MNG_TLV_HEADER_LEN < *len) {
+    return -1;
+  }
+
+  *val = &reader->buff[reader->pos + MNG_TLV_HEADER_LEN];
+  reader->pos += MNG_TLV_HEADER_LEN + *len;
+
+  return 1;
+}
+
+int mng_tlv_get_int(const unsigned char *val, uint16_t len, int *result)
+{
+  if(len != sizeof(uint32_t)) {
+    return -1;
+  }
+
+  *result = (int)mng_tlv_get_u32(val);
+
+  return 0;
+}
+
+int mng_tlv_get_string(const unsigned char *val, uint16_t len, char *str, size_t size)
+{
+  if(len >= size) {
+    return -1;
+  }
+
+  memcpy(str, val, len);
+  str[len] = 0;
+
+  return 0;
+}
+
+void mng_tlv_encode_request(T_mng_tlv_writer *writer, T_mng_api_request_msg const *req_msg)
+{
+  uint64_t since_seq;
+
+  mng_tlv_put_int(writer, E_mng_tlv_type_api_code, req_msg->api_code);
+
+  switch(req_msg->api_code) {
+    case E_mng_api_get_sync_info_list:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_get_sync_info_list.print_flag);
+      mng_tlv_put_int(writer, E_mng_tlv_type_max_num_syncs, req_msg->request_get_sync_info_list.max_num_syncs);
+      break;
+
+    case E_mng_api_get_current_status:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_get_current_status.print_flag);
+      break;
+
+    case E_mng_api_get_sync_info:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_get_sync_info.print_flag);
+      mng_tlv_put_string(writer, E_mng_tlv_type_port_name, req_msg->request_get_sync_info.port_name);
+      break;
+
+    case E_mng_api_set_forced_ql:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_set_forced_ql.print_flag);
+      mng_tlv_put_string(writer, E_mng_tlv_type_port_name, req_msg->request_set_forced_ql.port_name);
+      mng_tlv_put_int(writer, E_mng_tlv_type_forced_ql, req_msg->request_set_forced_ql.forced_ql);
+      break;
+
+    case E_mng_api_clear_forced_ql:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_clear_forced_ql.print_flag);
+      mng_tlv_put_string(writer, E_mng_tlv_type_port_name, req_msg->request_clear_forced_ql.port_name);
+      break;
+
+    case E_mng_api_clear_holdover_timer:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_clear_holdover_timer.print_flag);
+      break;
+
+    case E_mng_api_clear_synce_clk_wtr_timer:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_clear_synce_clk_wtr_timer.print_flag);
+      mng_tlv_put_string(writer, E_mng_tlv_type_port_name, req_msg->request_clear_synce_clk_wtr_timer.port_name);
+      break;
+
+    case E_mng_api_assign_new_synce_clk_port:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_assign_new_synce_clk_port.print_flag);
+      mng_tlv_put_string(writer, E_mng_tlv_type_port_name, req_msg->request_assign_new_synce_clk_port.port_name);
+      mng_tlv_put_int(writer, E_mng_tlv_type_clk_idx, req_msg->request_assign_new_synce_clk_port.clk_idx);
+      break;
+
+    case E_mng_api_set_pri:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_set_pri.print_flag);
+      mng_tlv_put_string(writer, E_mng_tlv_type_port_name, req_msg->request_set_pri.port_name);
+      mng_tlv_put_int(writer, E_mng_tlv_type_pri, req_msg->request_set_pri.pri);
+      break;
+
+    case E_mng_api_set_max_msg_lvl:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_set_max_msg_lvl.print_flag);
+      mng_tlv_put_int(writer, E_mng_tlv_type_max_msg_lvl, req_msg->request_set_max_msg_lvl.max_msg_lvl);
+      if(req_msg->request_set_max_msg_lvl.module_flag) {
+        mng_tlv_put_int(writer, E_mng_tlv_type_print_module, req_msg->request_set_max_msg_lvl.module);
+      }
+      break;
+
+    case E_mng_api_begin_transaction:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_begin_transaction.print_flag);
+      break;
+
+    case E_mng_api_commit_transaction:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_commit_transaction.print_flag);
+      break;
+
+    case E_mng_api_abort_transaction:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_abort_transaction.print_flag);
+      break;
+
+    case E_mng_api_get_port_stats:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_get_port_stats.print_flag);
+      mng_tlv_put_string(writer, E_mng_tlv_type_port_name, req_msg->request_get_port_stats.port_name);
+      break;
+
+    case E_mng_api_get_latency_stats:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_get_latency_stats.print_flag);
+      break;
+
+    case E_mng_api_get_mutex_stats:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_get_mutex_stats.print_flag);
+      break;
+
+    case E_mng_api_get_journal:
+      mng_tlv_put_flag(writer, E_mng_tlv_type_print_flag, req_msg->request_get_journal.print_flag);
+      since_seq = ((uint64_t)req_msg->request_get_journal.since_seq_high << 32) | req_msg->request_get_journal.since_seq_low;
+      if(since_seq > 0) {
+        mng_tlv_put_u64(writer, E_mng_tlv_type_since_seq, since_seq);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/* Return 0 on success and -1 if the payload is malformed or has no API code */
+int mng_tlv_decode_request(const unsigned char *payload, size_t len, T_mng_api_request_msg *req_msg)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int num;
+  int api_code = -1;
+  int print_flag = 0;
+  char port_name[INTERFACE_MAX_NAME_LEN] = {0};
+  int forced_ql = E_esmc_ql_max;
+  int clk_idx = -1;
+  int pri = -1;
+  int max_msg_lvl = -1;
+  int module_flag = 0;
+  int module = PRINT_MODULE_ALL;
+  int max_num_syncs = MAX_SYNC_INFO_STRUCTURES;
+  unsigned long long since_seq = 0;
+  uint64_t num64;
+
+  memset(req_msg, 0, sizeof(*req_msg));
+
+  mng_tlv_reader_init(&reader, payload, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type == E_mng_tlv_type_port_name) {
+      if(mng_tlv_get_string(val, val_len, port_name, sizeof(port_name)) < 0) {
+        return -1;
+      }
+      continue;
+    }
+
+    if(type == E_mng_tlv_type_since_seq) {
+      if(mng_tlv_get_u64(val, val_len, &num64) < 0) {
+        return -1;
+      }
+      since_seq = num64;
+      continue;
+    }
+
+    if(mng_tlv_get_int(val, val_len, &num) < 0) {
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_api_code:
+        api_code = num;
+        break;
+      case E_mng_tlv_type_print_flag:
+        print_flag = num;
+        break;
+      case E_mng_tlv_type_forced_ql:
+        forced_ql = num;
+        break;
+      case E_mng_tlv_type_clk_idx:
+        clk_idx = num;
+        break;
+      case E_mng_tlv_type_pri:
+        pri = num;
+        break;
+      case E_mng_tlv_type_max_msg_lvl:
+        max_msg_lvl = num;
+        break;
+      case E_mng_tlv_type_print_module:
+        module_flag = 1;
+        module = num;
+        break;
+      case E_mng_tlv_type_max_num_syncs:
+        max_num_syncs = num;
+        break;
+      default:
+        break;
+    }
+  }
+  if((ret < 0) || (api_code < 0)) {
+    return -1;
+  }
+
+  req_msg->api_code = (T_mng_api)api_code;
+
+  switch(req_msg->api_code) {
+    case E_mng_api_get_sync_info_list:
+      req_msg->request_get_sync_info_list.print_flag = print_flag;
+      req_msg->request_get_sync_info_list.max_num_syncs = max_num_syncs;
+      break;
+
+    case E_mng_api_get_current_status:
+      req_msg->request_get_current_status.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_sync_info:
+      req_msg->request_get_sync_info.print_flag = print_flag;
+      strcpy(req_msg->request_get_sync_info.port_name, port_name);
+      break;
+
+    case E_mng_api_set_forced_ql:
+      req_msg->request_set_forced_ql.print_flag = print_flag;
+      strcpy(req_msg->request_set_forced_ql.port_name, port_name);
+      req_msg->request_set_forced_ql.forced_ql = (T_esmc_ql)forced_ql;
+      break;
+
+    case E_mng_api_clear_forced_ql:
+      req_msg->request_clear_forced_ql.print_flag = print_flag;
+      strcpy(req_msg->request_clear_forced_ql.port_name, port_name);
+      break;
+
+    case E_mng_api_clear_holdover_timer:
+      req_msg->request_clear_holdover_timer.print_flag = print_flag;
+      break;
+
+    case E_mng_api_clear_synce_clk_wtr_timer:
+      req_msg->request_clear_synce_clk_wtr_timer.print_flag = print_flag;
+      strcpy(req_msg->request_clear_synce_clk_wtr_timer.port_name, port_name);
+      break;
+
+    case E_mng_api_assign_new_synce_clk_port:
+      req_msg->request_assign_new_synce_clk_port.print_flag = print_flag;
+      strcpy(req_msg->request_assign_new_synce_clk_port.port_name, port_name);
+      req_msg->request_assign_new_synce_clk_port.clk_idx = clk_idx;
+      break;
+
+    case E_mng_api_set_pri:
+      req_msg->request_set_pri.print_flag = print_flag;
+      strcpy(req_msg->request_set_pri.port_name, port_name);
+      req_msg->request_set_pri.pri = pri;
+      break;
+
+    case E_mng_api_set_max_msg_lvl:
+      req_msg->request_set_max_msg_lvl.print_flag = print_flag;
+      req_msg->request_set_max_msg_lvl.max_msg_lvl = max_msg_lvl;
+      req_msg->request_set_max_msg_lvl.module_flag = module_flag;
+      req_msg->request_set_max_msg_lvl.module = module;
+      break;
+
+    case E_mng_api_begin_transaction:
+      req_msg->request_begin_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_commit_transaction:
+      req_msg->request_commit_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_abort_transaction:
+      req_msg->request_abort_transaction.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_port_stats:
+      req_msg->request_get_port_stats.print_flag = print_flag;
+      strcpy(req_msg->request_get_port_stats.port_name, port_name);
+      break;
+
+    case E_mng_api_get_latency_stats:
+      req_msg->request_get_latency_stats.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_mutex_stats:
+      req_msg->request_get_mutex_stats.print_flag = print_flag;
+      break;
+
+    case E_mng_api_get_journal:
+      req_msg->request_get_journal.print_flag = print_flag;
+      req_msg->request_get_journal.since_seq_low = (uint32_t)since_seq;
+      req_msg->request_get_journal.since_seq_high = (uint32_t)(since_seq >> 32);
+      break;
+
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+void mng_tlv_encode_response(T_mng_tlv_writer *writer, T_mng_api_response_msg const *rsp_msg)
+{
+  int i;
+
+  mng_tlv_put_int(writer, E_mng_tlv_type_api_code, rsp_msg->api_code);
+  mng_tlv_put_int(writer, E_mng_tlv_type_response, rsp_msg->response);
+
+  if(rsp_msg->response != E_management_api_response_ok) {
+    return;
+  }
+
+  switch(rsp_msg->api_code) {
+    case E_mng_api_get_sync_info_list:
+      for(i = 0; (i < rsp_msg->response_get_sync_info_list.num_syncs) && (i < MAX_SYNC_INFO_STRUCTURES); i++) {
+        mng_tlv_encode_sync_info(writer, &rsp_msg->response_get_sync_info_list.sync_info_list[i]);
+      }
+      break;
+
+    case E_mng_api_get_current_status:
+      mng_tlv_encode_current_status(writer, &rsp_msg->response_get_current_status.current_status);
+      break;
+
+    case E_mng_api_get_sync_info:
+      mng_tlv_encode_sync_info(writer, &rsp_msg->response_get_sync_info.sync_info);
+      break;
+
+    case E_mng_api_get_port_stats:
+      mng_tlv_encode_port_stats(writer, &rsp_msg->response_get_port_stats.port_stats);
+      break;
+
+    case E_mng_api_get_latency_stats:
+      mng_tlv_encode_latency_stats(writer, &rsp_msg->response_get_latency_stats.latency_stats);
+      break;
+
+    case E_mng_api_get_mutex_stats:
+      if(rsp_msg->response_get_mutex_stats.mutex_stats != NULL) {
+        mng_tlv_encode_mutex_stats(writer, rsp_msg->response_get_mutex_stats.mutex_stats);
+      }
+      break;
+
+    case E_mng_api_get_journal:
+      mng_tlv_encode_journal(writer, &rsp_msg->response_get_journal.journal);
+      break;
+
+    default:
+      /* No data */
+      break;
+  }
+}
+
+/* Return 0 on success and -1 if the payload is malformed */
+int mng_tlv_decode_response(const unsigned char *payload, size_t len, T_mng_api_response_msg *rsp_msg)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int num;
+  int api_code_flag = 0;
+  T_management_sync_info *sync_info;
+
+  memset(rsp_msg, 0, sizeof(*rsp_msg));
+
+  mng_tlv_reader_init(&reader, payload, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    switch(type) {
+      case E_mng_tlv_type_api_code:
+        if(mng_tlv_get_int(val, val_len, &num) < 0) {
+          return -1;
+        }
+        rsp_msg->api_code = (T_mng_api)num;
+        api_code_flag = 1;
+        break;
+
+      case E_mng_tlv_type_response:
+        if(mng_tlv_get_int(val, val_len, &num) < 0) {
+          return -1;
+        }
+        rsp_msg->response = (T_management_api_response)num;
+        break;
+
+      case E_mng_tlv_type_sync_info:
+        if(rsp_msg->api_code == E_mng_api_get_sync_info) {
+          sync_info = &rsp_msg->response_get_sync_info.sync_info;
+        } else if(rsp_msg->response_get_sync_info_list.num_syncs < MAX_SYNC_INFO_STRUCTURES) {
+          sync_info = &rsp_msg->response_get_sync_info_list.sync_info_list[rsp_msg->response_get_sync_info_list.num_syncs];
+          rsp_msg->response_get_sync_info_list.num_syncs++;
+        } else {
+          break;
+        }
+        if(mng_tlv_decode_sync_info(val, val_len, sync_info) < 0) {
+          return -1;
+        }
+        break;
+
+      case E_mng_tlv_type_current_status:
+        if(mng_tlv_decode_current_status(val, val_len, &rsp_msg->response_get_current_status.current_status) < 0) {
+          return -1;
+        }
+        break;
+
+      case E_mng_tlv_type_port_stats:
+        if(mng_tlv_decode_port_stats(val, val_len, &rsp_msg->response_get_port_stats.port_stats) < 0) {
+          return -1;
+        }
+        break;
+
+      case E_mng_tlv_type_latency_stats:
+        if(mng_tlv_decode_latency_stats(val, val_len, &rsp_msg->response_get_latency_stats.latency_stats) < 0) {
+          return -1;
+        }
+        break;
+
+      case E_mng_tlv_type_mutex_stats:
+        rsp_msg->response_get_mutex_stats.mutex_stats = &g_mng_tlv_mutex_stats;
+        if(mng_tlv_decode_mutex_stats(val, val_len, rsp_msg->response_get_mutex_stats.mutex_stats) < 0) {
+          return -1;
+        }
+        break;
+
+      case E_mng_tlv_type_journal:
+        if(mng_tlv_decode_journal(val, val_len, &rsp_msg->response_get_journal.journal) < 0) {
+          return -1;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  return ((ret < 0) || !api_code_flag) ? -1 : 0;
+}
+
+void mng_tlv_encode_subscribe(T_mng_tlv_writer *writer, unsigned int event_mask)
+{
+  mng_tlv_put_int(writer, E_mng_tlv_type_event_mask, (int)event_mask);
+}
+
+/* Return 0 on success and -1 if the payload is malformed or has no event mask */
+int mng_tlv_decode_subscribe(const unsigned char *payload, size_t len, unsigned int *event_mask)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int num;
+  int event_mask_flag = 0;
+
+  mng_tlv_reader_init(&reader, payload, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if((type == E_mng_tlv_type_event_mask) && (mng_tlv_get_int(val, val_len, &num) == 0)) {
+      *event_mask = (unsigned int)num;
+      event_mask_flag = 1;
+    }
+  }
+
+  return ((ret < 0) || !event_mask_flag) ? -1 : 0;
+}
+
+void mng_tlv_encode_event(T_mng_tlv_writer *writer, unsigned int seq, T_mng_event const *event)
+{
+  mng_tlv_put_int(writer, E_mng_tlv_type_event_seq, (int)seq);
+  mng_tlv_put_int(writer, E_mng_tlv_type_event_type, event->type);
+  if(event->port_name[0] != 0) {
+    mng_tlv_put_string(writer, E_mng_tlv_type_port_name, event->port_name);
+  }
+
+  switch(event->type) {
+    case E_mng_event_type_subscribed:
+      mng_tlv_put_int(writer, E_mng_tlv_type_event_mask, (int)event->event_mask);
+      break;
+
+    case E_mng_event_type_current_ql:
+      mng_tlv_put_int(writer, E_mng_tlv_type_current_ql, event->current_ql);
+      break;
+
+    case E_mng_event_type_sync_current_ql:
+      mng_tlv_put_int(writer, E_mng_tlv_type_current_ql, event->current_ql);
+      mng_tlv_put_int(writer, E_mng_tlv_type_rank, event->rank);
+      break;
+
+    case E_mng_event_type_synce_dpll_state:
+      mng_tlv_put_int(writer, E_mng_tlv_type_dpll_state, event->dpll_state);
+      break;
+
+    case E_mng_event_type_sync_clk_state:
+      mng_tlv_put_int(writer, E_mng_tlv_type_clk_idx, event->clk_idx);
+      mng_tlv_put_int(writer, E_mng_tlv_type_clk_state, event->clk_state);
+      break;
+
+    case E_mng_event_type_sync_state:
+      mng_tlv_put_int(writer, E_mng_tlv_type_sync_state, event->state);
+      break;
+
+    case E_mng_event_type_alarm:
+      mng_tlv_put_int(writer, E_mng_tlv_type_alarm_type, event->alarm_type);
+      if(event->alarm_type == E_alarm_type_timing_loop) {
+        mng_tlv_put_int(writer, E_mng_tlv_type_loop_type, event->loop_type);
+        mng_tlv_put_bytes(writer, E_mng_tlv_type_mac_addr, event->mac_addr, sizeof(event->mac_addr));
+      } else if(event->alarm_type == E_alarm_type_reference_degradation) {
+        mng_tlv_put_int(writer, E_mng_tlv_type_clk_idx, event->clk_idx);
+        mng_tlv_put_int(writer, E_mng_tlv_type_degrading, event->degrading_flag);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/* Return 0 on success and -1 if the payload is malformed or has no event type */
+int mng_tlv_decode_event(const unsigned char *payload, size_t len, unsigned int *seq, T_mng_event *event)
+{
+  T_mng_tlv_reader reader;
+  uint16_t type;
+  const unsigned char *val;
+  uint16_t val_len;
+  int ret;
+  int num;
+  int event_type_flag = 0;
+
+  memset(event, 0, sizeof(*event));
+  event->clk_idx = -1;
+  *seq = 0;
+
+  mng_tlv_reader_init(&reader, payload, len);
+  while((ret = mng_tlv_next(&reader, &type, &val, &val_len)) > 0) {
+    if(type == E_mng_tlv_type_port_name) {
+      if(mng_tlv_get_string(val, val_len, event->port_name, sizeof(event->port_name)) < 0) {
+        return -1;
+      }
+      continue;
+    }
+
+    if(type == E_mng_tlv_type_mac_addr) {
+      if(val_len != sizeof(event->mac_addr)) {
+        return -1;
+      }
+      memcpy(event->mac_addr, val, sizeof(event->mac_addr));
+      continue;
+    }
+
+    if(mng_tlv_get_int(val, val_len, &num) < 0) {
+      continue;
+    }
+
+    switch(type) {
+      case E_mng_tlv_type_event_seq:
+        *seq = (unsigned int)num;
+        break;
+      case E_mng_tlv_type_event_type:
+        event->type = (T_mng_event_type)num;
+        event_type_flag = 1;
+        break;
+      case E_mng_tlv_type_event_mask:
+        event->event_mask = (unsigned int)num;
+        break;
+      case E_mng_tlv_type_current_ql:
+        event->current_ql = (T_esmc_ql)num;
+        break;
+      case E_mng_tlv_type_rank:
+        event->rank = num;
+        break;
+      case E_mng_tlv_type_dpll_state:
+        event->dpll_state = (T_device_dpll_state)num;
+        break;
+      case E_mng_tlv_type_clk_idx:
+        event->clk_idx = num;
+        break;
+      case E_mng_tlv_type_clk_state:
+        event->clk_state = (T_sync_clk_state)num;
+        break;
+      case E_mng_tlv_type_sync_state:
+        event->state = (T_sync_state)num;
+        break;
+      case E_mng_tlv_type_alarm_type:
+        event->alarm_type = (T_alarm_type)num;
+        break;
+      case E_mng_tlv_type_loop_type:
+        event->loop_type = (T_timing_loop_type)num;
+        break;
+      case E_mng_tlv_type_degrading:
+        event->degrading_flag = num;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return ((ret < 0) || !event_type_flag) ? -1 : 0;
+}
+
+COMPILE_TIME_ASSERT(sizeof(T_mng_api_request_msg) == MNG_API_LEGACY_REQUEST_MSG_LEN, "Fixed-size request message layout changed")
+COMPILE_TIME_ASSERT(MNG_API_LEGACY_RESPONSE_MSG_LEN == 8716, "Fixed-size response message layout changed")
+
+/* Write response in the fixed-size (legacy) layout of MNG_API_LEGACY_RESPONSE_MSG_LEN bytes */
+void mng_tlv_pack_legacy_response(T_mng_api_response_msg const *rsp_msg, unsigned char *buff)
+{
+  size_t offset = offsetof(T_mng_api_response_msg, response_get_sync_info_list);
+  size_t list_offset = offsetof(T_mng_api_response_msg, response_get_sync_info_list.sync_info_list);
+  int i;
+
+  memset(buff, 0, MNG_API_LEGACY_RESPONSE_MSG_LEN);
+  memcpy(buff, rsp_msg, offset);
+
+  if(rsp_msg->api_code != E_mng_api_get_sync_info_list) {
+    /* Every other response is shorter than the legacy sync info list */
+    memcpy(&buff[offset], (const unsigned char *)rsp_msg + offset, MNG_API_LEGACY_RESPONSE_MSG_LEN - offset);
+    return;
+  }
+
+  memcpy(&buff[offset], (const unsigned char *)rsp_msg + offset, list_offset - offset);
+  for(i = 0; i < MAX_SYNC_INFO_STRUCTURES; i++) {
+    memcpy(&buff[list_offset + (i * MNG_API_LEGACY_SYNC_INFO_LEN)],
+           &rsp_msg->response_get_sync_info_list.sync_info_list[i],
+           MNG_API_LEGACY_SYNC_INFO_LEN);
+  }
+}
+
+/* Read response in the fixed-size (legacy) layout of MNG_API_LEGACY_RESPONSE_MSG_LEN bytes */
+void mng_tlv_unpack_legacy_response(const unsigned char *buff, T_mng_api_response_msg *rsp_msg)
+{
+  size_t offset = offsetof(T_mng_api_response_msg, response_get_sync_info_list);
+  size_t list_offset = offsetof(T_mng_api_response_msg, response_get_sync_info_list.sync_info_list);
+  T_mng_api api_code;
+  int i;
+
+  memset(rsp_msg, 0, sizeof(*rsp_msg));
+  memcpy(rsp_msg, buff, offset);
+
+  memcpy(&api_code, buff, sizeof(api_code));
+  if(api_code != E_mng_api_get_sync_info_list) {
+    memcpy((unsigned char *)rsp_msg + offset, &buff[offset], MNG_API_LEGACY_RESPONSE_MSG_LEN - offset);
+    if(api_code == E_mng_api_get_mutex_stats) {
+      /* Only sent with TLV encoding */
+      rsp_msg->response_get_mutex_stats.mutex_stats = NULL;
+    }
+    return;
+  }
+
+  memcpy((unsigned char *)rsp_msg + offset, &buff[offset], list_offset - offset);
+  for(i = 0; i < MAX_SYNC_INFO_STRUCTURES; i++) {
+    memcpy(&rsp_msg->response_get_sync_info_list.sync_info_list[i],
+           &buff[list_offset + (i * MNG_API_LEGACY_SYNC_INFO_LEN)],
+           MNG_API_LEGACY_SYNC_INFO_LEN);
+  }
+}
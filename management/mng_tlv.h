@@ -0,0 +1,220 @@
+/**
+ * @file mng_tlv.h
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+#ifndef MNG_TLV_H
+#define MNG_TLV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mng_if.h"
+
+/*
+ * Management message encoding (all fields in network byte order):
+ *
+ *   Frame header:
+ *   +--------------------+---------+---------+----------+--------------------+
+ *   | magic (4)          | ver (1) | type(1) | rsvd (2) | payload length (4) |
+ *   +--------------------+---------+---------+----------+--------------------+
+ *   Payload: sequence of TLVs
+ *   +----------+------------+---------------------+
+ *   | type (2) | length (2) | value (length bytes)|
+ *   +----------+------------+---------------------+
+ *
+ * Integers are 4 bytes (8 bytes for counters), strings are not null-terminated, and nested TLVs (e.g. sync info) carry TLVs as value.
+ * Only populated entries and fields are encoded; decoders skip unknown TLVs.
+ * A batch request frame carries up to MNG_TLV_MAX_BATCH_SIZE nested requests; the batch response frame carries
+ * one nested response per request, in the same order.
+ * A subscribe frame selects the event classes pushed to the client as event frames. Event frames may be
+ * interleaved with response frames at any point of the stream.
+ * The magic value cannot be a valid legacy API code, so the server can tell a TLV frame from a legacy
+ * fixed-size request message by its first 4 bytes.
+ */
+
+#define MNG_TLV_MAGIC               0x53594E44 /* "SYND" */
+#define MNG_TLV_VERSION             1
+#define MNG_TLV_FRAME_HEADER_LEN    12
+#define MNG_TLV_HEADER_LEN          4
+#define MNG_TLV_MAX_FRAME_LEN       (1024 * 1024)
+#define MNG_TLV_MAX_BATCH_SIZE      64    /* Further requests in a batch are answered as not supported */
+
+typedef enum {
+  E_mng_tlv_frame_type_request = 1,
+  E_mng_tlv_frame_type_response = 2,
+  E_mng_tlv_frame_type_subscribe = 3,
+  E_mng_tlv_frame_type_event = 4,
+  E_mng_tlv_frame_type_batch_request = 5,
+  E_mng_tlv_frame_type_batch_response = 6
+} T_mng_tlv_frame_type;
+
+typedef enum {
+  /* Request and response */
+  E_mng_tlv_type_api_code = 1,
+  E_mng_tlv_type_response = 2,
+  E_mng_tlv_type_print_flag = 3,
+  E_mng_tlv_type_port_name = 4,
+  E_mng_tlv_type_forced_ql = 5,
+  E_mng_tlv_type_clk_idx = 6,
+  E_mng_tlv_type_pri = 7,
+  E_mng_tlv_type_max_msg_lvl = 8,
+  E_mng_tlv_type_max_num_syncs = 9,
+  E_mng_tlv_type_sync_info = 10,         /* Nested */
+  E_mng_tlv_type_current_status = 11,    /* Nested */
+  E_mng_tlv_type_batch_request = 12,     /* Nested (same TLVs as request frame payload) */
+  E_mng_tlv_type_batch_response = 13,    /* Nested (same TLVs as response frame payload) */
+  E_mng_tlv_type_port_stats = 14,        /* Nested */
+  E_mng_tlv_type_latency_stats = 15,     /* Nested */
+  E_mng_tlv_type_mutex_stats = 16,       /* Nested */
+  E_mng_tlv_type_print_module = 17,      /* T_print_module; absent for all modules */
+  E_mng_tlv_type_since_seq = 18,         /* 8 bytes; absent for the oldest journal entry kept */
+  E_mng_tlv_type_journal = 19,           /* Nested */
+
+  /* Sync info */
+  E_mng_tlv_type_sync_type = 20,
+  E_mng_tlv_type_config_pri = 21,
+  E_mng_tlv_type_current_ql = 22,
+  E_mng_tlv_type_sync_state = 23,
+  E_mng_tlv_type_tx_bundle_num = 24,
+  E_mng_tlv_type_remaining_time_ms = 25,
+  E_mng_tlv_type_current_num_hops = 26,
+  E_mng_tlv_type_rank = 27,
+  E_mng_tlv_type_clk_state = 28,
+  E_mng_tlv_type_ref_mon_status = 29,    /* Bit 0: LOS, bit 1: no activity, bit 2: frequency offset */
+  E_mng_tlv_type_degrading = 30,
+  E_mng_tlv_type_rx_timeout = 31,
+  E_mng_tlv_type_port_link_down = 32,
+
+  /* Current status */
+  E_mng_tlv_type_dpll_state = 40,
+  E_mng_tlv_type_holdover_remaining_time_ms = 41,
+
+  /* Port statistics (counters are 8 bytes) */
+  E_mng_tlv_type_port_tx_stats = 60,     /* Nested */
+  E_mng_tlv_type_port_rx_stats = 61,     /* Nested */
+  E_mng_tlv_type_pdus = 62,
+  E_mng_tlv_type_event_pdus = 63,
+  E_mng_tlv_type_information_pdus = 64,
+  E_mng_tlv_type_errors = 65,
+  E_mng_tlv_type_invalid_len_pdus = 66,
+  E_mng_tlv_type_timing_loops = 67,
+  E_mng_tlv_type_socket_drops = 68,
+  E_mng_tlv_type_last_pdu_age_ms = 69,   /* Absent if no PDU yet */
+
+  /* Latency statistics (values are 8 bytes, in nanoseconds) */
+  E_mng_tlv_type_latency_stage = 70,     /* Nested (absent if stage has no samples) */
+  E_mng_tlv_type_stage = 71,             /* 4 bytes (see T_latency_stage) */
+  E_mng_tlv_type_count = 72,
+  E_mng_tlv_type_min_ns = 73,
+  E_mng_tlv_type_mean_ns = 74,
+  E_mng_tlv_type_p50_ns = 75,
+  E_mng_tlv_type_p90_ns = 76,
+  E_mng_tlv_type_p99_ns = 77,
+  E_mng_tlv_type_p999_ns = 78,
+  E_mng_tlv_type_max_ns = 79,
+
+  /* Mutex statistics (values are 8 bytes, in nanoseconds) */
+  E_mng_tlv_type_mutex = 80,             /* Nested */
+  E_mng_tlv_type_mutex_site = 81,        /* Nested */
+  E_mng_tlv_type_mutex_name = 82,
+  E_mng_tlv_type_func = 83,
+  E_mng_tlv_type_site = 84,
+  E_mng_tlv_type_acquisitions = 85,
+  E_mng_tlv_type_contended = 86,
+  E_mng_tlv_type_total_wait_ns = 87,
+  E_mng_tlv_type_max_wait_ns = 88,
+  E_mng_tlv_type_total_hold_ns = 89,
+  E_mng_tlv_type_max_hold_ns = 90,
+  E_mng_tlv_type_num_dropped_sites = 91, /* 4 bytes */
+
+  /* Journal (sequence numbers and times are 8 bytes) */
+  E_mng_tlv_type_journal_entry = 100,    /* Nested (port name is absent if the event is not specific to a sync) */
+  E_mng_tlv_type_journal_seq = 101,
+  E_mng_tlv_type_time_ns = 102,          /* CLOCK_MONOTONIC */
+  E_mng_tlv_type_journal_event_type = 103,
+  E_mng_tlv_type_sync_idx = 104,
+  E_mng_tlv_type_val0 = 105,             /* Meaning depends on the event type (see T_journal_event_type) */
+  E_mng_tlv_type_val1 = 106,
+  E_mng_tlv_type_val2 = 107,
+  E_mng_tlv_type_last_seq = 108,
+  E_mng_tlv_type_num_lost = 109,
+
+  /* Subscription and events */
+  E_mng_tlv_type_event_mask = 50,        /* Bit N selects event type N (see T_mng_event_type) */
+  E_mng_tlv_type_event_seq = 51,         /* Per-connection sequence number; a gap means events were dropped */
+  E_mng_tlv_type_event_type = 52,
+  E_mng_tlv_type_alarm_type = 53,
+  E_mng_tlv_type_loop_type = 54,
+  E_mng_tlv_type_mac_addr = 55
+} T_mng_tlv_type;
+
+typedef struct {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t type;
+  uint32_t payload_len;
+} T_mng_tlv_frame_header;
+
+typedef struct {
+  unsigned char *buff;
+  size_t size;
+  size_t len;
+  int overflow_flag;
+} T_mng_tlv_writer;
+
+typedef struct {
+  const unsigned char *buff;
+  size_t len;
+  size_t pos;
+} T_mng_tlv_reader;
+
+/* Frame functions */
+int mng_tlv_is_frame(const unsigned char *buff, size_t len);
+int mng_tlv_parse_frame_header(const unsigned char *buff, size_t len, T_mng_tlv_frame_header *header);
+void mng_tlv_begin_frame(T_mng_tlv_writer *writer, unsigned char *buff, size_t size, T_mng_tlv_frame_type type);
+int mng_tlv_end_frame(T_mng_tlv_writer *writer);
+
+/* TLV functions */
+void mng_tlv_put_int(T_mng_tlv_writer *writer, T_mng_tlv_type type, int val);
+void mng_tlv_put_bytes(T_mng_tlv_writer *writer, T_mng_tlv_type type, const void *val, size_t len);
+void mng_tlv_put_string(T_mng_tlv_writer *writer, T_mng_tlv_type type, const char *str);
+size_t mng_tlv_begin_nested(T_mng_tlv_writer *writer, T_mng_tlv_type type);
+void mng_tlv_end_nested(T_mng_tlv_writer *writer, size_t offset);
+void mng_tlv_reader_init(T_mng_tlv_reader *reader, const unsigned char *buff, size_t len);
+int mng_tlv_next(T_mng_tlv_reader *reader, uint16_t *type, const unsigned char **val, uint16_t *len);
+int mng_tlv_get_int(const unsigned char *val, uint16_t len, int *result);
+int mng_tlv_get_string(const unsigned char *val, uint16_t len, char *str, size_t size);
+
+/* Management message functions */
+void mng_tlv_encode_request(T_mng_tlv_writer *writer, T_mng_api_request_msg const *req_msg);
+int mng_tlv_decode_request(const unsigned char *payload, size_t len, T_mng_api_request_msg *req_msg);
+void mng_tlv_encode_response(T_mng_tlv_writer *writer, T_mng_api_response_msg const *rsp_msg);
+int mng_tlv_decode_response(const unsigned char *payload, size_t len, T_mng_api_response_msg *rsp_msg);
+void mng_tlv_encode_subscribe(T_mng_tlv_writer *writer, unsigned int event_mask);
+int mng_tlv_decode_subscribe(const unsigned char *payload, size_t len, unsigned int *event_mask);
+void mng_tlv_encode_event(T_mng_tlv_writer *writer, unsigned int seq, T_mng_event const *event);
+int mng_tlv_decode_event(const unsigned char *payload, size_t len, unsigned int *seq, T_mng_event *event);
+
+/* Fixed-size (legacy) message functions */
+void mng_tlv_pack_legacy_response(T_mng_api_response_msg const *rsp_msg, unsigned char *buff);
+void mng_tlv_unpack_legacy_response(const unsigned char *buff, T_mng_api_response_msg *rsp_msg);
+
+#endif /* MNG_TLV_H */
@@ -20,11 +20,16 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_management
+
+#define _GNU_SOURCE /* struct ucred */
+
 #include <arpa/inet.h>
 #include <pthread.h>
 #include <stdarg.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include "pcm4l_if.h"
@@ -41,7 +46,8 @@ typedef enum  {
 typedef struct {
   int enabled;
   pthread_t thread_id;
-  struct sockaddr_in pcm4l_server;
+  struct sockaddr_storage pcm4l_server;     /* TCP or Unix domain socket (SOCK_SEQPACKET) address */
+  socklen_t pcm4l_server_len;
   T_pcm4l_if_thread_state thread_state;
 } T_pcm4l_if_thread_data;
 
@@ -53,9 +59,35 @@ static T_pcm4l_if_thread_data g_pcm4l_if_thread_data;
 
 /* Static functions */
 
+/* A Unix domain socket may be bound by anyone who can write to its directory, so pcm4l must run as root or the user of synced */
+static int authorize_pcm4l(void)
+{
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+
+  if(getsockopt(g_pcm4l_if_fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+    pr_err("%s: %s", __func__, strerror(errno));
+    return -1;
+  }
+
+  if((cred.uid != 0) && (cred.uid != geteuid())) {
+    pr_warning("pcm4l interface rejected pid %d (uid %u)", (int)cred.pid, (unsigned int)cred.uid);
+    return -1;
+  }
+
+  return 0;
+}
+
 static int connect_to_pcm4l(void)
 {
-  if(connect(g_pcm4l_if_fd, (struct sockaddr *)&g_pcm4l_if_thread_data.pcm4l_server, sizeof(struct sockaddr_in)) < 0 ) {
+  if(connect(g_pcm4l_if_fd, (struct sockaddr *)&g_pcm4l_if_thread_data.pcm4l_server, g_pcm4l_if_thread_data.pcm4l_server_len) < 0 ) {
+    return -1;
+  }
+
+  if((g_pcm4l_if_thread_data.pcm4l_server.ss_family == AF_UNIX) && (authorize_pcm4l() < 0)) {
+    /* Disconnect and retry later */
+    close(g_pcm4l_if_fd);
+    g_pcm4l_if_fd = UNINITIALIZED_FD;
     return -1;
   }
 
@@ -111,7 +143,12 @@ static void *pcm4l_if_thread(void *arg)
     if(thread_data->thread_state == E_pcm4l_if_thread_state_started) {
       if(g_pcm4l_if_fd == UNINITIALIZED_FD) {
         /* Set up socket interface */
-        if((g_pcm4l_if_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0) {
+        if(g_pcm4l_if_thread_data.pcm4l_server.ss_family == AF_UNIX) {
+          g_pcm4l_if_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        } else {
+          g_pcm4l_if_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        }
+        if(g_pcm4l_if_fd < 0) {
           pr_err("%s: %s", __func__, strerror(errno));
           g_pcm4l_if_fd = UNINITIALIZED_FD;
         }
@@ -201,12 +238,26 @@ static void pcm4l_if_thread_stop_wait(T_pcm4l_if_thread_state *state)
 
 /* Global functions */
 
-int pcm4l_if_start(const char *pcm4l_if_ip_addr, int pcm4l_if_port_num)
+int pcm4l_if_start(const char *pcm4l_if_ip_addr, int pcm4l_if_port_num, const char *pcm4l_if_unix_path)
 {
-  memset(&g_pcm4l_if_thread_data.pcm4l_server, 0, sizeof(struct sockaddr_in));
-  g_pcm4l_if_thread_data.pcm4l_server.sin_addr.s_addr = inet_addr(pcm4l_if_ip_addr);
-  g_pcm4l_if_thread_data.pcm4l_server.sin_port = htons(pcm4l_if_port_num);
-  g_pcm4l_if_thread_data.pcm4l_server.sin_family = AF_INET;
+  struct sockaddr_in *inet_server = (struct sockaddr_in *)&g_pcm4l_if_thread_data.pcm4l_server;
+  struct sockaddr_un *unix_server = (struct sockaddr_un *)&g_pcm4l_if_thread_data.pcm4l_server;
+
+  memset(&g_pcm4l_if_thread_data.pcm4l_server, 0, sizeof(g_pcm4l_if_thread_data.pcm4l_server));
+  if((pcm4l_if_unix_path != NULL) && (pcm4l_if_unix_path[0] != '\0')) {
+    if(strlen(pcm4l_if_unix_path) >= sizeof(unix_server->sun_path)) {
+      pr_err("pcm4l interface socket path %s is too long", pcm4l_if_unix_path);
+      return -1;
+    }
+    strcpy(unix_server->sun_path, pcm4l_if_unix_path);
+    unix_server->sun_family = AF_UNIX;
+    g_pcm4l_if_thread_data.pcm4l_server_len = sizeof(struct sockaddr_un);
+  } else {
+    inet_server->sin_addr.s_addr = inet_addr(pcm4l_if_ip_addr);
+    inet_server->sin_port = htons(pcm4l_if_port_num);
+    inet_server->sin_family = AF_INET;
+    g_pcm4l_if_thread_data.pcm4l_server_len = sizeof(struct sockaddr_in);
+  }
 
   /* Create pcm4l interface thread */
   if(os_thread_create(&g_pcm4l_if_thread_data.thread_id, pcm4l_if_thread, (void*)&g_pcm4l_if_thread_data) < 0) {
@@ -34,7 +34,8 @@ typedef enum
   E_pcm4l_error_code_not_sent = 3
 } T_pcm4l_error_code;
 
-int pcm4l_if_start(const char *pcm4l_if_ip_addr, int pcm4l_if_port_num);
+/* Connect to pcm4l over TCP, or over a Unix domain socket (SOCK_SEQPACKET) if a path is given */
+int pcm4l_if_start(const char *pcm4l_if_ip_addr, int pcm4l_if_port_num, const char *pcm4l_if_unix_path);
 void pcm4l_if_stop(void);
 
 T_pcm4l_error_code pcm4l_if_send(const unsigned char *req_buff, unsigned int req_len, unsigned char *rsp_buff, unsigned int rsp_len);
@@ -20,6 +20,8 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_management
+
 #include "pcm4l_msg.h"
 #include "../common/print.h"
 
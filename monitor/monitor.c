@@ -20,48 +20,334 @@
 * Commit Hash: 62f27b58
 ********************************************************************************************************************/
 
+#define PRINT_MODULE E_print_module_monitor
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "management.h"
 #include "monitor.h"
 #include "pcm4l_if.h"
 #include "../common/common.h"
+#include "../common/journal.h"
 #include "../common/print.h"
+#include "../common/probes.h"
 #include "../control/control.h"
 #include "../device/device_adaptor/device_adaptor.h"
 #include "../esmc/esmc_adaptor/esmc_adaptor.h"
 
 /* Static data */
 
-static pthread_mutex_t g_monitor_mutex;
 static T_monitor_data g_monitor_data;
 
-/* Global functions */
+/* Static functions */
 
-int monitor_init(T_monitor_config const *monitor_config)
+/* Events go to the journal of the control instance */
+static void monitor_journal_record(T_monitor_data const *monitor, T_journal_event_type type, int sync_idx, int val0, int val1, int val2)
 {
-  /* Initialize mutex */
-  if(os_mutex_init(&g_monitor_mutex) < 0) {
+  monitor->control->journal_sink->record(monitor->control->journal_sink->ctx, type, sync_idx, val0, val1, val2);
+}
+
+static unsigned long long monitor_get_monotonic_milliseconds(T_monitor_data const *monitor)
+{
+  return monitor->device_ops->get_monotonic_milliseconds(monitor->device_ops->ctx);
+}
+
+static void monitor_drift_reset(T_monitor_drift_estimator *estimator)
+{
+  estimator->num_samples = 0;
+  estimator->oldest_idx = 0;
+  estimator->ref_ffo_ppb = 0;
+  estimator->sum_y = 0;
+  estimator->sum_yy = 0;
+  estimator->sum_iy = 0;
+  estimator->next_sample_monotonic_time_ms = 0;
+}
+
+static void monitor_drift_recalculate_sums(T_monitor_drift_estimator *estimator)
+{
+  unsigned int i;
+  double y;
+
+  /* Recalculate the sums from scratch to discard rounding errors accumulated while sliding the window */
+  estimator->sum_y = 0;
+  estimator->sum_yy = 0;
+  estimator->sum_iy = 0;
+  for(i = 0; i < estimator->num_samples; i++) {
+    y = estimator->sample[(estimator->oldest_idx + i) % estimator->window_size];
+    estimator->sum_y += y;
+    estimator->sum_yy += y * y;
+    estimator->sum_iy += i * y;
+  }
+}
+
+static void monitor_drift_add_sample(T_monitor_data *monitor)
+{
+  T_monitor_drift_estimator *estimator = &monitor->drift_estimator;
+  unsigned long long monotonic_time_now_ms;
+  double ffo_ppb;
+  double y;
+  int err;
+
+  if(estimator->unsupported_flag) {
+    return;
+  }
+
+  monotonic_time_now_ms = monitor_get_monotonic_milliseconds(monitor);
+  if(monotonic_time_now_ms < estimator->next_sample_monotonic_time_ms) {
+    return;
+  }
+
+  err = monitor->device_ops->get_synce_dpll_ffo(monitor->device_ops->ctx, &ffo_ppb);
+  if(err == -2) {
+    pr_warning("Sync-E DPLL frequency offset not supported by device; adaptive holdover falls back to holdover timer");
+    estimator->unsupported_flag = 1;
+    monitor_drift_reset(estimator);
+    return;
+  } else if(err < 0) {
+    /* A missing sample breaks the fixed sample interval; start over */
+    pr_err_ratelimited("Failed to get Sync-E DPLL frequency offset");
+    monitor_drift_reset(estimator);
+    return;
+  }
+
+  if(estimator->num_samples == 0) {
+    estimator->ref_ffo_ppb = ffo_ppb;
+    estimator->next_sample_monotonic_time_ms = monotonic_time_now_ms;
+  }
+  estimator->next_sample_monotonic_time_ms += MONITOR_DRIFT_SAMPLE_INTERVAL_MS;
+
+  if(estimator->num_samples == estimator->window_size) {
+    /* Drop oldest sample; remaining samples move down one index */
+    y = estimator->sample[estimator->oldest_idx];
+    estimator->sum_y -= y;
+    estimator->sum_yy -= y * y;
+    estimator->sum_iy -= estimator->sum_y;
+    estimator->num_samples--;
+    estimator->oldest_idx = (estimator->oldest_idx + 1) % estimator->window_size;
+    if(estimator->oldest_idx == 0) {
+      monitor_drift_recalculate_sums(estimator);
+    }
+  }
+
+  y = ffo_ppb - estimator->ref_ffo_ppb;
+  estimator->sample[(estimator->oldest_idx + estimator->num_samples) % estimator->window_size] = y;
+  estimator->sum_y += y;
+  estimator->sum_yy += y * y;
+  estimator->sum_iy += estimator->num_samples * y;
+  estimator->num_samples++;
+}
+
+/*
+ * Estimate how long holdover can last before the accumulated time error exceeds budget_ns.
+ * The frequency drift is the slope of the fit and the uncertainty of the frequency at holdover entry is the
+ * residual standard deviation of the fit, so the projected time error after t seconds is
+ * e0 * t + |drift| * t^2 / 2 (ppb * s = ns).
+ */
+static int monitor_drift_get_holdover_time_ms(T_monitor_drift_estimator const *estimator,
+                                              unsigned int budget_ns,
+                                              unsigned long long *holdover_time_ms)
+{
+  double n = estimator->num_samples;
+  double sum_i;
+  double sum_ii;
+  double denominator;
+  double slope;
+  double intercept;
+  double sum_squared_residuals;
+  double drift_ppb_per_s;
+  double e0_ppb;
+  double holdover_time_s;
+
+  if(estimator->num_samples < MONITOR_DRIFT_MIN_NUM_SAMPLES) {
     return -1;
   }
 
-  memset(&g_monitor_data, 0, sizeof(g_monitor_data));
+  sum_i = n * (n - 1) / 2;
+  sum_ii = (n - 1) * n * (2 * n - 1) / 6;
+  denominator = n * sum_ii - sum_i * sum_i;
+
+  slope = (n * estimator->sum_iy - sum_i * estimator->sum_y) / denominator;
+  intercept = (estimator->sum_y - slope * sum_i) / n;
+
+  sum_squared_residuals = estimator->sum_yy - intercept * estimator->sum_y - slope * estimator->sum_iy;
+  if((sum_squared_residuals < 0) || (estimator->num_samples <= 2)) {
+    sum_squared_residuals = 0;
+  }
+
+  drift_ppb_per_s = fabs(slope) * 1000 / MONITOR_DRIFT_SAMPLE_INTERVAL_MS;
+  e0_ppb = (estimator->num_samples > 2) ? sqrt(sum_squared_residuals / (n - 2)) : 0;
 
-  g_monitor_data.lo_ql = monitor_config->lo_ql;
-  g_monitor_data.holdover_ql = monitor_config->holdover_ql;
-  g_monitor_data.holdover_timer_s = monitor_config->holdover_timer_s;
-  g_monitor_data.advanced_holdover_en = monitor_config->advanced_holdover_en;
+  denominator = e0_ppb + sqrt((e0_ppb * e0_ppb) + (2 * drift_ppb_per_s * budget_ns));
+  if(denominator <= 0) {
+    /* Perfectly stable oscillator; the budget is never exhausted */
+    *holdover_time_ms = ULLONG_MAX;
+  } else {
+    holdover_time_s = (2 * (double)budget_ns) / denominator;
+    *holdover_time_ms = (holdover_time_s * 1000 >= (double)ULLONG_MAX) ? ULLONG_MAX : (unsigned long long)(holdover_time_s * 1000);
+  }
 
-  g_monitor_data.holdover_monotonic_time_ms = 0;
-  g_monitor_data.current_synce_dpll_state = E_device_dpll_state_max;
-  g_monitor_data.current_ql = E_esmc_ql_max;
-  g_monitor_data.current_clk_idx = INVALID_CLK_IDX;
-  g_monitor_data.current_sync_idx = INVALID_SYNC_IDX;
+  pr_debug("Drift estimate: %.6f ppb/s, frequency uncertainty: %.6f ppb, %u samples",
+           drift_ppb_per_s,
+           e0_ppb,
+           estimator->num_samples);
 
   return 0;
 }
 
-void monitor_determine_ql(void)
+static unsigned long long monitor_get_holdover_time_ms(T_monitor_data const *monitor)
+{
+  unsigned long long holdover_time_ms = (unsigned long long)monitor->holdover_timer_s * 1000;
+  unsigned long long adaptive_holdover_time_ms;
+
+  if(!monitor->adaptive_holdover_en) {
+    return holdover_time_ms;
+  }
+
+  if(monitor_drift_get_holdover_time_ms(&monitor->drift_estimator,
+                                        monitor->adaptive_holdover_budget_ns,
+                                        &adaptive_holdover_time_ms) < 0) {
+    pr_warning("Not enough frequency samples to estimate holdover time; using holdover timer");
+    return holdover_time_ms;
+  }
+
+  /* The holdover timer caps the adaptive holdover time */
+  if(adaptive_holdover_time_ms < holdover_time_ms) {
+    holdover_time_ms = adaptive_holdover_time_ms;
+  }
+  pr_info("Adaptive holdover time set to %llu milliseconds", holdover_time_ms);
+
+  return holdover_time_ms;
+}
+
+static int monitor_default_set_tx_ql(void *ctx,
+                                     T_esmc_ql ql,
+                                     int best_sync_idx,
+                                     T_sync_tx_bundle_info *sync_tx_bundle_info,
+                                     T_latency_trace const *latency_trace)
+{
+  (void)ctx;
+
+  return esmc_adaptor_set_tx_ql(ql, best_sync_idx, sync_tx_bundle_info, latency_trace);
+}
+
+static int monitor_init_data(T_monitor_data *monitor,
+                             T_monitor_config const *monitor_config,
+                             T_device_ops const *device_ops,
+                             T_control_data *control,
+                             T_monitor_set_tx_ql_cb set_tx_ql,
+                             void *set_tx_ql_ctx)
+{
+  memset(monitor, 0, sizeof(*monitor));
+
+  /* Initialize mutex */
+  if(os_mutex_init(&monitor->mutex) < 0) {
+    return -1;
+  }
+
+  monitor->device_ops = device_ops;
+  monitor->control = control;
+  monitor->set_tx_ql = set_tx_ql;
+  monitor->set_tx_ql_ctx = set_tx_ql_ctx;
+
+  monitor->lo_ql = monitor_config->lo_ql;
+  monitor->holdover_ql = monitor_config->holdover_ql;
+  monitor->holdover_timer_s = monitor_config->holdover_timer_s;
+  monitor->advanced_holdover_en = monitor_config->advanced_holdover_en;
+  monitor->adaptive_holdover_en = monitor_config->adaptive_holdover_en;
+  monitor->adaptive_holdover_budget_ns = monitor_config->adaptive_holdover_budget_ns;
+
+  monitor->drift_estimator.window_size = monitor_config->adaptive_holdover_window_s * 1000 / MONITOR_DRIFT_SAMPLE_INTERVAL_MS;
+  if(monitor->drift_estimator.window_size > MONITOR_DRIFT_MAX_NUM_SAMPLES) {
+    monitor->drift_estimator.window_size = MONITOR_DRIFT_MAX_NUM_SAMPLES;
+  } else if(monitor->drift_estimator.window_size < MONITOR_DRIFT_MIN_NUM_SAMPLES) {
+    monitor->drift_estimator.window_size = MONITOR_DRIFT_MIN_NUM_SAMPLES;
+  }
+  monitor_drift_reset(&monitor->drift_estimator);
+  if(monitor->adaptive_holdover_en) {
+    /* Samples are only kept when adaptive holdover is enabled */
+    monitor->drift_estimator.sample = calloc(monitor->drift_estimator.window_size, sizeof(*monitor->drift_estimator.sample));
+    if(monitor->drift_estimator.sample == NULL) {
+      os_mutex_deinit(&monitor->mutex);
+      return -1;
+    }
+  }
+
+  monitor->holdover_monotonic_time_ms = 0;
+  monitor->current_synce_dpll_state = E_device_dpll_state_max;
+  monitor->current_ql = E_esmc_ql_max;
+  monitor->current_clk_idx = INVALID_CLK_IDX;
+  monitor->current_sync_idx = INVALID_SYNC_IDX;
+
+  return 0;
+}
+
+static void monitor_deinit_data(T_monitor_data *monitor)
+{
+  /* Deinitialize mutex */
+  os_mutex_deinit(&monitor->mutex);
+
+  monitor->lo_ql = E_esmc_ql_max;
+  monitor->holdover_ql = E_esmc_ql_max;
+  monitor->holdover_timer_s = 0;
+  monitor->advanced_holdover_en = 0;
+  monitor->adaptive_holdover_en = 0;
+  monitor->adaptive_holdover_budget_ns = 0;
+
+  monitor_drift_reset(&monitor->drift_estimator);
+  free(monitor->drift_estimator.sample);
+  monitor->drift_estimator.sample = NULL;
+
+  monitor->holdover_monotonic_time_ms = 0;
+  monitor->current_synce_dpll_state = E_device_dpll_state_max;
+  monitor->current_ql = E_esmc_ql_max;
+}
+
+/* Global functions */
+
+T_monitor_data *monitor_instance_create(T_monitor_config const *monitor_config,
+                                        T_device_ops const *device_ops,
+                                        T_control_data *control,
+                                        T_monitor_set_tx_ql_cb set_tx_ql,
+                                        void *set_tx_ql_ctx)
+{
+  T_monitor_data *monitor = malloc(sizeof(*monitor));
+
+  if(monitor == NULL) {
+    return NULL;
+  }
+
+  if(monitor_init_data(monitor, monitor_config, device_ops, control, set_tx_ql, set_tx_ql_ctx) < 0) {
+    free(monitor);
+    return NULL;
+  }
+
+  return monitor;
+}
+
+void monitor_instance_destroy(T_monitor_data *monitor)
+{
+  if(monitor == NULL) {
+    return;
+  }
+
+  monitor_deinit_data(monitor);
+  free(monitor);
+}
+
+int monitor_init(T_monitor_config const *monitor_config)
+{
+  return monitor_init_data(&g_monitor_data,
+                           monitor_config,
+                           device_adaptor_get_ops(),
+                           control_get_instance(),
+                           monitor_default_set_tx_ql,
+                           NULL);
+}
+
+void monitor_instance_determine_ql(T_monitor_data *monitor)
 {
   int err;
   T_device_dpll_state synce_dpll_state;
@@ -75,65 +361,81 @@ void monitor_determine_ql(void)
   T_sync_tx_bundle_info sync_tx_bundle_info;
   T_alarm_data alarm_data;
   char port_name[INTERFACE_MAX_NAME_LEN];
+  T_latency_trace latency_trace;
+
+  /* A rank change that does not change the TX QL in this pass ends its trace */
+  control_instance_take_latency_trace(monitor->control, &latency_trace);
 
   /* Get status of Sync-E DPLL */
-  err = device_adaptor_call_get_synce_dpll_state_cb(&synce_dpll_state);
+  err = monitor->device_ops->get_synce_dpll_state(monitor->device_ops->ctx, &synce_dpll_state);
   if(err < 0) {
-    pr_err("Failed to get Sync-E DPLL state");
+    pr_err_ratelimited("Failed to get Sync-E DPLL state");
   }
   if(synce_dpll_state >= E_device_dpll_state_max) {
-    pr_warning("Sync-E DPLL is in unsupported state");
+    pr_warning_ratelimited("Sync-E DPLL is in unsupported state");
     return;
   }
 
-  old_synce_dpll_state = g_monitor_data.current_synce_dpll_state;
-  old_clk_idx = g_monitor_data.current_clk_idx;
-  old_ql = g_monitor_data.current_ql;
-  old_sync_idx = g_monitor_data.current_sync_idx;
+  old_synce_dpll_state = monitor->current_synce_dpll_state;
+  old_clk_idx = monitor->current_clk_idx;
+  old_ql = monitor->current_ql;
+  old_sync_idx = monitor->current_sync_idx;
 
   if((synce_dpll_state == E_device_dpll_state_lock_acquisition_recovery) ||
      (synce_dpll_state == E_device_dpll_state_locked)) {
     /* Sync-E DPLL is in lock acquisition, lock recovery, or locked state and is tracking a clock */
 
     /* Get clock index of current clock */
-    err = device_adaptor_call_get_current_clk_idx_cb(&clk_idx);
+    err = monitor->device_ops->get_current_clk_idx(monitor->device_ops->ctx, &clk_idx);
     if(err < 0) {
-      pr_err("Failed to get current clock index");
+      pr_err_ratelimited("Failed to get current clock index");
     }
     if(clk_idx == INVALID_CLK_IDX) {
       alarm_data.alarm_type = E_alarm_type_invalid_clock_idx;
+      monitor_journal_record(monitor, E_journal_event_type_alarm, JOURNAL_NO_SYNC_IDX, alarm_data.alarm_type, 0, clk_idx);
       management_call_notify_alarm_cb(&alarm_data);
       return;
     }
 
     /* Get the selected sync index */
-    sync_idx = control_get_sync_idx(clk_idx);
+    sync_idx = control_instance_get_sync_idx(monitor->control, clk_idx);
     if(sync_idx == INVALID_SYNC_IDX) {
       alarm_data.alarm_type = E_alarm_type_invalid_sync_idx;
+      monitor_journal_record(monitor, E_journal_event_type_alarm, JOURNAL_NO_SYNC_IDX, alarm_data.alarm_type, 0, clk_idx);
       management_call_notify_alarm_cb(&alarm_data);
       return;
     }
 
     /* Get QL of current clock */
-    ql = control_get_ql(sync_idx);
+    ql = control_instance_get_ql(monitor->control, sync_idx);
     if(ql >= E_esmc_ql_max) {
       /* Should not happen */
       return;
     }
 
-    if(ql > g_monitor_data.lo_ql) {
+    if(ql > monitor->lo_ql) {
       /* Should not happen */
-      pr_warning("%s (%d) is worse than LO QL %s (%d)", conv_ql_enum_to_str(ql), ql, conv_ql_enum_to_str(g_monitor_data.lo_ql), g_monitor_data.lo_ql);
+      pr_warning("%s (%d) is worse than LO QL %s (%d)", conv_ql_enum_to_str(ql), ql, conv_ql_enum_to_str(monitor->lo_ql), monitor->lo_ql);
       return;
     }
 
+    if(monitor->adaptive_holdover_en) {
+      if(synce_dpll_state == E_device_dpll_state_locked) {
+        /* Track the frequency trend used to estimate the holdover time */
+        monitor_drift_add_sample(monitor);
+      } else {
+        /* Frequency is still settling; discard the trend */
+        monitor_drift_reset(&monitor->drift_estimator);
+      }
+    }
+
     /* Update the monitor data */
-    os_mutex_lock(&g_monitor_mutex);
-    g_monitor_data.current_synce_dpll_state = synce_dpll_state;
-    g_monitor_data.current_clk_idx = clk_idx;
-    g_monitor_data.current_ql = ql;
-    g_monitor_data.current_sync_idx = sync_idx;
-    os_mutex_unlock(&g_monitor_mutex);
+    os_mutex_lock(&monitor->mutex);
+    monitor->current_synce_dpll_state = synce_dpll_state;
+    monitor->current_clk_idx = clk_idx;
+    monitor->current_ql = ql;
+    monitor->current_sync_idx = sync_idx;
+    os_mutex_unlock(&monitor->mutex);
 
     if(ql != old_ql) {
       /* Change in current QL */
@@ -156,49 +458,53 @@ void monitor_determine_ql(void)
     sync_idx = INVALID_SYNC_IDX;
 
     /* Update the monitor data */
-    os_mutex_lock(&g_monitor_mutex);
+    os_mutex_lock(&monitor->mutex);
+    if(monitor->adaptive_holdover_en && (old_synce_dpll_state != E_device_dpll_state_locked)) {
+      /* The trend only applies to the holdover entered directly from locked state */
+      monitor_drift_reset(&monitor->drift_estimator);
+    }
     if(synce_dpll_state == E_device_dpll_state_freerun) {
       /* Sync-E DPLL is in freerun state (set QL to LO QL) */
-      ql = g_monitor_data.lo_ql;
+      ql = monitor->lo_ql;
     } else {
       /* Sync-E DPLL is in holdover state */
       if(old_synce_dpll_state == E_device_dpll_state_locked) {
         /* Just entered holdover state from locked state. Start the holdover timer */
-        g_monitor_data.holdover_monotonic_time_ms = os_get_monotonic_milliseconds() + (g_monitor_data.holdover_timer_s * 1000);
+        monitor->holdover_monotonic_time_ms = monitor_get_monotonic_milliseconds(monitor) + monitor_get_holdover_time_ms(monitor);
         /* The new QL is the worst between the previous QL and the holdover QL */
-        ql = (old_ql > g_monitor_data.holdover_ql) ? old_ql : g_monitor_data.holdover_ql;
+        ql = (old_ql > monitor->holdover_ql) ? old_ql : monitor->holdover_ql;
       } else if(old_synce_dpll_state == E_device_dpll_state_holdover) {
         /* QL will be changed to LO QL when the holdover timer expires */
         ql = old_ql;
       } else {
         /* Sync-E DPLL transitioned from lock acquisition-recovery state to holdover state. */
-        if(g_monitor_data.advanced_holdover_en) {
+        if(monitor->advanced_holdover_en) {
           /*
            * Do not stop the holdover timer if already running.
            * The new QL is the worst between the previous QL and the holdover QL until the holdover timer expires.
            */
-          ql = (old_ql > g_monitor_data.holdover_ql) ? old_ql : g_monitor_data.holdover_ql;
+          ql = (old_ql > monitor->holdover_ql) ? old_ql : monitor->holdover_ql;
         } else {
           /* Stop the holdover timer to change QL to LO QL immediately */
-          g_monitor_data.holdover_monotonic_time_ms = 0;
+          monitor->holdover_monotonic_time_ms = 0;
         }
       }
 
-      if(os_get_monotonic_milliseconds() > g_monitor_data.holdover_monotonic_time_ms) {
+      if(monitor_get_monotonic_milliseconds(monitor) > monitor->holdover_monotonic_time_ms) {
         /* Advertise LO QL and freerun state instead of holdover state because holdover timer expired */
         synce_dpll_state = E_device_dpll_state_freerun;
-        ql = g_monitor_data.lo_ql;
+        ql = monitor->lo_ql;
       }
     }
-    g_monitor_data.current_synce_dpll_state = synce_dpll_state;
-    g_monitor_data.current_clk_idx = clk_idx;
-    g_monitor_data.current_ql = ql;
-    g_monitor_data.current_sync_idx = sync_idx;
-    os_mutex_unlock(&g_monitor_mutex);
+    monitor->current_synce_dpll_state = synce_dpll_state;
+    monitor->current_clk_idx = clk_idx;
+    monitor->current_ql = ql;
+    monitor->current_sync_idx = sync_idx;
+    os_mutex_unlock(&monitor->mutex);
 
     if(ql != old_ql) {
       /* Change in current QL */
-      if(ql == g_monitor_data.lo_ql) {
+      if(ql == monitor->lo_ql) {
         pr_info("Current QL is set to LO QL %s (%d)", conv_ql_enum_to_str(ql), ql);
       } else {
         pr_info("Current QL is set to temporary holdover QL %s (%d)", conv_ql_enum_to_str(ql), ql);
@@ -208,70 +514,80 @@ void monitor_determine_ql(void)
 
   if((ql != old_ql) || (clk_idx != old_clk_idx) || (sync_idx != old_sync_idx)) {
     /* If QL, clock index or sync index has changed, then update ESMC TX QL */
-    control_get_tx_bundle_info(sync_idx, &sync_tx_bundle_info);
-    esmc_adaptor_set_tx_ql(ql, sync_idx, &sync_tx_bundle_info);
+    control_instance_get_tx_bundle_info(monitor->control, sync_idx, &sync_tx_bundle_info);
+    monitor->set_tx_ql(monitor->set_tx_ql_ctx, ql, sync_idx, &sync_tx_bundle_info, &latency_trace);
   }
 
   if(synce_dpll_state != old_synce_dpll_state) {
+    monitor_journal_record(monitor, E_journal_event_type_dpll_state, JOURNAL_NO_SYNC_IDX, old_synce_dpll_state, synce_dpll_state, 0);
+    synced_probe2(dpll_state_change, old_synce_dpll_state, synce_dpll_state);
     management_call_notify_synce_dpll_current_state_cb(synce_dpll_state);
   }
 
   if((ql != old_ql) || (sync_idx != old_sync_idx)) {
-    control_get_sync_name(sync_idx, port_name);
+    monitor_journal_record(monitor, E_journal_event_type_current_ql, sync_idx, old_ql, ql, clk_idx);
+    control_instance_get_sync_name(monitor->control, sync_idx, port_name);
     management_call_notify_current_ql_cb(port_name, ql);
   }
 }
 
-void monitor_get_current_status(T_esmc_ql *current_ql,
-                                char *port_name,
-                                int *clk_idx,
-                                T_device_dpll_state *dpll_state,
-                                unsigned int *holdover_remaining_time_ms)
+void monitor_determine_ql(void)
+{
+  monitor_instance_determine_ql(&g_monitor_data);
+}
+
+void monitor_instance_get_current_status(T_monitor_data *monitor,
+                                         T_esmc_ql *current_ql,
+                                         char *port_name,
+                                         int *clk_idx,
+                                         T_device_dpll_state *dpll_state,
+                                         unsigned int *holdover_remaining_time_ms)
 {
   unsigned long long monotonic_time_now_ms;
 
-  os_mutex_lock(&g_monitor_mutex);
-  *current_ql = g_monitor_data.current_ql;
-  control_get_sync_name(g_monitor_data.current_sync_idx, port_name);
-  *clk_idx = g_monitor_data.current_clk_idx;
-  *dpll_state = g_monitor_data.current_synce_dpll_state;
+  os_mutex_lock(&monitor->mutex);
+  *current_ql = monitor->current_ql;
+  control_instance_get_sync_name(monitor->control, monitor->current_sync_idx, port_name);
+  *clk_idx = monitor->current_clk_idx;
+  *dpll_state = monitor->current_synce_dpll_state;
   *holdover_remaining_time_ms = 0;
   if(*dpll_state == E_device_dpll_state_holdover) {
-    monotonic_time_now_ms = os_get_monotonic_milliseconds();
-    if(monotonic_time_now_ms >= g_monitor_data.holdover_monotonic_time_ms) {
+    monotonic_time_now_ms = monitor_get_monotonic_milliseconds(monitor);
+    if(monotonic_time_now_ms >= monitor->holdover_monotonic_time_ms) {
       *dpll_state = E_device_dpll_state_freerun;
     } else {
-      *holdover_remaining_time_ms = (unsigned int)(g_monitor_data.holdover_monotonic_time_ms - monotonic_time_now_ms);
+      *holdover_remaining_time_ms = (unsigned int)(monitor->holdover_monotonic_time_ms - monotonic_time_now_ms);
     }
   }
-  os_mutex_unlock(&g_monitor_mutex);
+  os_mutex_unlock(&monitor->mutex);
+}
+
+void monitor_get_current_status(T_esmc_ql *current_ql,
+                                char *port_name,
+                                int *clk_idx,
+                                T_device_dpll_state *dpll_state,
+                                unsigned int *holdover_remaining_time_ms)
+{
+  monitor_instance_get_current_status(&g_monitor_data, current_ql, port_name, clk_idx, dpll_state, holdover_remaining_time_ms);
 }
 
 void monitor_clear_holdover_timer(void)
 {
-  if(g_monitor_data.holdover_timer_s == 0) {
+  T_monitor_data *monitor = &g_monitor_data;
+
+  if(monitor->holdover_timer_s == 0) {
     pr_warning("Holdover timer is already configured to 0 milliseconds");
     return;
   }
-  os_mutex_lock(&g_monitor_mutex);
-  g_monitor_data.holdover_monotonic_time_ms = 0;
-  os_mutex_unlock(&g_monitor_mutex);
+  os_mutex_lock(&monitor->mutex);
+  monitor->holdover_monotonic_time_ms = 0;
+  os_mutex_unlock(&monitor->mutex);
   pr_info("Cleared holdover timer");
 }
 
 int monitor_deinit(void)
 {
-  /* Deinitialize mutex */
-  os_mutex_deinit(&g_monitor_mutex);
-
-  g_monitor_data.lo_ql = E_esmc_ql_max;
-  g_monitor_data.holdover_ql = E_esmc_ql_max;
-  g_monitor_data.holdover_timer_s = 0;
-  g_monitor_data.advanced_holdover_en = 0;
-
-  g_monitor_data.holdover_monotonic_time_ms = 0;
-  g_monitor_data.current_synce_dpll_state = E_device_dpll_state_max;
-  g_monitor_data.current_ql = E_esmc_ql_max;
+  monitor_deinit_data(&g_monitor_data);
 
   return 0;
 }
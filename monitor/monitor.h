@@ -26,24 +26,67 @@
 #include "../common/common.h"
 #include "../common/os.h"
 #include "../common/types.h"
+#include "../control/control.h"
+#include "../device/device_adaptor/device_adaptor.h"
+
+#define MONITOR_DRIFT_SAMPLE_INTERVAL_MS   1000
+#define MONITOR_DRIFT_MAX_NUM_SAMPLES      3600
+#define MONITOR_DRIFT_MIN_NUM_SAMPLES      2
 
 typedef struct {
   T_esmc_ql lo_ql;
   T_esmc_ql holdover_ql;
-  unsigned int holdover_timer_s; /* Seconds */
+  unsigned int holdover_timer_s;           /* Seconds */
   int advanced_holdover_en;
+  int adaptive_holdover_en;
+  unsigned int adaptive_holdover_budget_ns; /* Nanoseconds */
+  unsigned int adaptive_holdover_window_s;  /* Seconds */
 } T_monitor_config;
 
+/*
+ * Sliding-window least-squares fit of the Sync-E DPLL frequency offset while locked.
+ * Samples are taken every MONITOR_DRIFT_SAMPLE_INTERVAL_MS, so the sample index is used as the abscissa and
+ * only the sums depending on the samples have to be maintained when the window slides.
+ * Samples are stored relative to the first sample after a reset to keep the sums well-conditioned.
+ */
+typedef struct {
+  double *sample;                /* Parts per billion, relative to ref_ffo_ppb; window_size entries */
+  unsigned int window_size;
+  unsigned int num_samples;
+  unsigned int oldest_idx;
+  double ref_ffo_ppb;
+  double sum_y;
+  double sum_yy;
+  double sum_iy;
+  unsigned long long next_sample_monotonic_time_ms;
+  int unsupported_flag;
+} T_monitor_drift_estimator;
+
+/* Advertises the new TX QL; esmc_adaptor_set_tx_ql() for the daemon instance */
+typedef int (*T_monitor_set_tx_ql_cb)(void *ctx,
+                                      T_esmc_ql ql,
+                                      int best_sync_idx,
+                                      T_sync_tx_bundle_info *sync_tx_bundle_info,
+                                      T_latency_trace const *latency_trace);
+
 typedef struct {
+  pthread_mutex_t mutex;
+  T_device_ops const *device_ops;
+  T_control_data *control;
+  T_monitor_set_tx_ql_cb set_tx_ql;
+  void *set_tx_ql_ctx;
   T_esmc_ql lo_ql;
   T_esmc_ql holdover_ql;
   unsigned int holdover_timer_s;                 /* Seconds */
   int advanced_holdover_en;
+  int adaptive_holdover_en;
+  unsigned int adaptive_holdover_budget_ns;      /* Nanoseconds */
   unsigned long long holdover_monotonic_time_ms;
   T_device_dpll_state current_synce_dpll_state;
   T_esmc_ql current_ql;
   int current_clk_idx;
   int current_sync_idx;
+  T_monitor_drift_estimator drift_estimator;
 } T_monitor_data;
 
 int monitor_init(T_monitor_config const *monitor_config);
@@ -57,4 +100,19 @@ void monitor_get_current_status(T_esmc_ql *current_ql,
 void monitor_clear_holdover_timer(void);
 int monitor_deinit(void);
 
+/* Instance API used to run several independent monitor instances in one process (e.g. network simulation) */
+T_monitor_data *monitor_instance_create(T_monitor_config const *monitor_config,
+                                        T_device_ops const *device_ops,
+                                        T_control_data *control,
+                                        T_monitor_set_tx_ql_cb set_tx_ql,
+                                        void *set_tx_ql_ctx);
+void monitor_instance_determine_ql(T_monitor_data *monitor);
+void monitor_instance_get_current_status(T_monitor_data *monitor,
+                                         T_esmc_ql *current_ql,
+                                         char *port_name,
+                                         int *clk_idx,
+                                         T_device_dpll_state *dpll_state,
+                                         unsigned int *holdover_remaining_time_ms);
+void monitor_instance_destroy(T_monitor_data *monitor);
+
 #endif /* MONITOR_H */
@@ -32,17 +32,22 @@
 #include <sys/time.h>
 #include <unistd.h>
 
+#include "common/common.h"
 #include "common/config.h"
 #include "common/interface.h"
+#include "common/journal.h"
 #include "common/missing.h"
 #include "common/os.h"
 #include "common/print.h"
+#include "common/trace.h"
 #include "control/sync.h"
 #include "control/control.h"
 #include "device/device_adaptor/device_adaptor.h"
 #include "esmc/esmc_adaptor/esmc_adaptor.h"
 #include "management/management.h"
 #include "management/mng_if.h"
+#include "management/mng_metrics.h"
+#include "management/mng_shm.h"
 #include "management/pcm4l_if.h"
 #include "monitor/monitor.h"
 
@@ -67,6 +72,7 @@ static const char *g_pipeline = PIPELINE_ID;
 static const char *g_commit = COMMIT_ID;
 
 static int g_prog_running = 1;
+static volatile sig_atomic_t g_trace_export_flag = 0;
 
 /* Static functions */
 
@@ -96,6 +102,13 @@ static void sig_handler(int sig_num)
   g_prog_running = 0;
 }
 
+static void trace_sig_handler(int sig_num)
+{
+  (void)sig_num;
+
+  g_trace_export_flag = 1;
+}
+
 static int set_sig_action(int sig, const struct sigaction *new_action)
 {
   struct sigaction old_action;
@@ -136,6 +149,17 @@ static int register_all_prog_term_sig_handlers(void)
   return 0;
 }
 
+static int register_trace_export_sig_handler(void)
+{
+  struct sigaction new_action;
+
+  new_action.sa_handler = trace_sig_handler;
+  sigemptyset(&new_action.sa_mask);
+  new_action.sa_flags = SA_RESTART;
+
+  return set_sig_action(SIGUSR1, &new_action);
+}
+
 static int get_port_info(struct config *cfg, T_esmc_network_option net_opt, int no_ql_en, int *num_tx_ports, int *num_rx_ports, int *num_syncs)
 {
   struct interface *iface;
@@ -150,6 +174,10 @@ static int get_port_info(struct config *cfg, T_esmc_network_option net_opt, int
   char mac_addr_str[MAX_MAC_ADDR_STR_LEN];
   const char *ql_str;
   T_esmc_ql ql;
+  int pcap_en = (config_get_string(cfg, "global", "pcap_in")[0] != '\0');
+  int pcap_port_counter = 0;
+  const char *pcap_mac_addr_str;
+  unsigned char pcap_mac_addr[ETH_ALEN];
 
   STAILQ_FOREACH(iface, &cfg->interfaces, list) {
     port_name = interface_get_name(iface);
@@ -195,7 +223,21 @@ static int get_port_info(struct config *cfg, T_esmc_network_option net_opt, int
         return -1;
       }
 
-      if(interface_config_idx_and_mac_addr(iface) < 0) {
+      if(pcap_en) {
+        /* Replayed ports get synthetic indexes and locally administered MAC addresses unless configured */
+        pcap_port_counter++;
+        pcap_mac_addr_str = config_get_string(cfg, port_name, "pcap_mac_addr");
+        if(pcap_mac_addr_str[0] == '\0') {
+          memset(pcap_mac_addr, 0, sizeof(pcap_mac_addr));
+          pcap_mac_addr[0] = 0x02;
+          pcap_mac_addr[4] = (pcap_port_counter >> 8) & 0xFF;
+          pcap_mac_addr[5] = pcap_port_counter & 0xFF;
+        } else if(mac_addr_str_to_arr(pcap_mac_addr_str, pcap_mac_addr) < 0) {
+          pr_err("Invalid pcap MAC address %s for port %s", pcap_mac_addr_str, port_name);
+          return -1;
+        }
+        interface_config_virtual_idx_and_mac_addr(iface, pcap_port_counter, pcap_mac_addr);
+      } else if(interface_config_idx_and_mac_addr(iface) < 0) {
         pr_err("Failed to get index and MAC address for port %s", port_name);
         return -1;
       }
@@ -302,6 +344,14 @@ static int create_esmc_config(struct config *cfg, T_esmc_network_option net_opt,
   esmc_config->num_tx_ports = num_tx_ports;
   esmc_config->num_rx_ports = num_rx_ports;
 
+  esmc_config->pcap.in_path = config_get_string(cfg, "global", "pcap_in");
+  esmc_config->pcap.out_path = config_get_string(cfg, "global", "pcap_out");
+  esmc_config->pcap.speed = config_get_int(cfg, "global", "pcap_speed");
+  esmc_config->pcap.exit_delay_s = config_get_int(cfg, "global", "pcap_exit_delay");
+  if((esmc_config->pcap.in_path[0] == '\0') && (esmc_config->pcap.out_path[0] != '\0')) {
+    pr_warning("Ignoring pcap output %s because no pcap input is configured", esmc_config->pcap.out_path);
+  }
+
   return 0;
 }
 
@@ -337,6 +387,21 @@ static int create_control_config(struct config *cfg, T_esmc_network_option net_o
   control_config->wait_to_restore_timer_s = config_get_int(cfg, "global", "wtr_tmr");
   pr_info("Set wait-to-restore timer to %u seconds", control_config->wait_to_restore_timer_s);
 
+  control_config->degradation_config.en = config_get_int(cfg, "global", "degradation_detection_en");
+  pr_info("Reference degradation detection is %s", control_config->degradation_config.en ? "enabled" : "disabled");
+
+  control_config->degradation_config.ewma_weight = config_get_double(cfg, "global", "degradation_ewma_weight");
+  pr_info("Set reference degradation EWMA weight to %f", control_config->degradation_config.ewma_weight);
+
+  control_config->degradation_config.cusum_drift_ppb = config_get_double(cfg, "global", "degradation_cusum_drift_ppb");
+  pr_info("Set reference degradation CUSUM drift to %f ppb", control_config->degradation_config.cusum_drift_ppb);
+
+  control_config->degradation_config.cusum_threshold_ppb = config_get_double(cfg, "global", "degradation_cusum_threshold_ppb");
+  pr_info("Set reference degradation CUSUM threshold to %f ppb", control_config->degradation_config.cusum_threshold_ppb);
+
+  control_config->degradation_config.rank_penalty = config_get_int(cfg, "global", "degradation_rank_penalty");
+  pr_info("Set reference degradation rank penalty to %d", control_config->degradation_config.rank_penalty);
+
   control_config->num_syncs = num_syncs;
   pr_debug("Set number of syncs to %d", control_config->num_syncs);
 
@@ -374,6 +439,15 @@ static int create_monitor_config(struct config *cfg, T_esmc_network_option net_o
   monitor_config->advanced_holdover_en = config_get_int(cfg, "global", "advanced_holdover_en");
   pr_info("Set advanced holdover enable to %u", monitor_config->advanced_holdover_en);
 
+  monitor_config->adaptive_holdover_en = config_get_int(cfg, "global", "adaptive_holdover_en");
+  pr_info("Adaptive holdover is %s", monitor_config->adaptive_holdover_en ? "enabled" : "disabled");
+
+  monitor_config->adaptive_holdover_budget_ns = config_get_int(cfg, "global", "adaptive_holdover_budget_ns");
+  pr_info("Set adaptive holdover time error budget to %u nanoseconds", monitor_config->adaptive_holdover_budget_ns);
+
+  monitor_config->adaptive_holdover_window_s = config_get_int(cfg, "global", "adaptive_holdover_window_s");
+  pr_info("Set adaptive holdover frequency trend window to %u seconds", monitor_config->adaptive_holdover_window_s);
+
   return 0;
 }
 
@@ -406,6 +480,24 @@ int dump_cfg_file(char *cfg_file_dump, long cfg_file_dump_size)
   return -1;
 }
 
+#if (SYNCED_MUTEX_PROFILING == 1)
+static void print_mutex_profile(void)
+{
+  T_os_mutex_prof_report *report;
+
+  report = malloc(sizeof(*report));
+  if(report == NULL) {
+    return;
+  }
+
+  pr_info("Mutex contention over the whole run:");
+  management_get_mutex_stats(0, report);
+  print_mutex_stats(report);
+
+  free(report);
+}
+#endif
+
 /* Global functions */
 
 int main(int argc, char *argv[])
@@ -427,6 +519,7 @@ int main(int argc, char *argv[])
 
   /* Message logging */
   int print_level;
+  char module_max_msg_lvl_name[32];
 
   int num_tx_ports = 0;
   int num_rx_ports = 0;
@@ -469,6 +562,11 @@ int main(int argc, char *argv[])
   int management_init_flag = 0;
   int pcm4l_if_en = 0;
   int mng_if_en = 0;
+  int status_page_en = 0;
+  int flight_recorder_en = 0;
+  int trace_en = 0;
+  const char *trace_path = NULL;
+  int metrics_en = 0;
 
   if(prog_name)
     prog_name++;
@@ -571,8 +669,23 @@ int main(int argc, char *argv[])
   print_set_prog_name(prog_name);
   print_set_msg_tag(config_get_string(cfg, "global", "msg_tag"));
   print_set_max_msg_level(config_get_int(cfg, "global", "max_msg_lvl"));
+  for(idx = E_print_module_general + 1; idx < E_print_module_max; idx++) {
+    snprintf(module_max_msg_lvl_name, sizeof(module_max_msg_lvl_name), "max_msg_lvl_%s", print_module_to_str(idx));
+    print_level = config_get_int(cfg, "global", module_max_msg_lvl_name);
+    if(print_level >= 0) {
+      print_set_module_max_msg_level(idx, print_level);
+    }
+  }
   print_set_stdout_en(config_get_int(cfg, "global", "stdout_en"));
   print_set_syslog_en(config_get_int(cfg, "global", "syslog_en"));
+  print_set_ratelimit(config_get_int(cfg, "global", "log_ratelimit_interval_ms"),
+                      config_get_int(cfg, "global", "log_ratelimit_burst"));
+  if(config_get_int(cfg, "global", "async_log_en") == 1) {
+    if(print_async_start(config_get_int(cfg, "global", "async_log_queue_len")) < 0) {
+      pr_err("Failed to start asynchronous logging");
+      goto quick_end;
+    }
+  }
 
   /* Register signal handlers used to end application */
   if(register_all_prog_term_sig_handlers() < 0) {
@@ -649,6 +762,7 @@ int main(int argc, char *argv[])
       mac_addr = interface_get_mac_addr(iface);
       memcpy(rx_port->mac_addr, mac_addr.sll_addr, ETH_ALEN);
       rx_port->sync_idx = sync_idx;
+      rx_port->pcap_if = config_get_string(cfg, name, "pcap_if");
       rx_port++;
     }
 
@@ -692,6 +806,37 @@ int main(int argc, char *argv[])
   }
   pr_info("Created monitor configuration");
 
+  /* Start flight recorder before the modules so that it holds all events */
+  flight_recorder_en = config_get_int(cfg, "global", "flight_recorder_en");
+  if(flight_recorder_en == 1) {
+    if(journal_recorder_init(config_get_string(cfg, "global", "flight_recorder_path"),
+                             config_get_int(cfg, "global", "flight_recorder_num_entries"),
+                             config_get_int(cfg, "global", "flight_recorder_sync_interval_ms")) < 0) {
+      pr_err("Failed to start the flight recorder");
+      goto end;
+    }
+    for(idx = 0; idx < num_syncs; idx++) {
+      journal_recorder_set_sync_name(idx, init_sync_config[idx].name);
+    }
+    pr_info("Started flight recorder %s", config_get_string(cfg, "global", "flight_recorder_path"));
+  }
+
+  /* Start thread activity tracing before the threads are created */
+  trace_en = config_get_int(cfg, "global", "trace_en");
+  if(trace_en == 1) {
+    trace_path = config_get_string(cfg, "global", "trace_path");
+    if(trace_start(config_get_int(cfg, "global", "trace_buffer_len")) < 0) {
+      pr_err("Failed to start thread activity tracing");
+      goto end;
+    }
+    if(register_trace_export_sig_handler() < 0) {
+      pr_err("Failed to register trace export signal handler");
+      goto end;
+    }
+    trace_set_thread_name("main");
+    pr_info("Started thread activity tracing; send SIGUSR1 to write %s", trace_path);
+  }
+
   /* Initialize management, device, ESMC stack, control, and monitor */
   if(management_init() == 0) {
     pr_info("Initialized management");
@@ -724,6 +869,8 @@ int main(int argc, char *argv[])
   if(esmc_adaptor_init(&esmc_config) == 0) {
     pr_info("Initialized ESMC");
     esmc_init_flag = 1;
+    /* Control and monitor timers run on the clock of the ESMC ports */
+    device_adaptor_set_clock(esmc_adaptor_get_monotonic_milliseconds);
   } else {
     pr_err("Failed to initialize ESMC");
     goto end;
@@ -739,7 +886,8 @@ int main(int argc, char *argv[])
   pcm4l_if_en = config_get_int(cfg, "global", "pcm4l_if_en");
   if(pcm4l_if_en == 1) {
     if(pcm4l_if_start(config_get_string(cfg, "global", "pcm4l_if_ip_addr"),
-                      config_get_int(cfg, "global", "pcm4l_if_port_num")) < 0) {
+                      config_get_int(cfg, "global", "pcm4l_if_port_num"),
+                      config_get_string(cfg, "global", "pcm4l_if_unix_path")) < 0) {
       pr_err("Failed to start the pcm4l interface");
       goto end;
     }
@@ -749,33 +897,80 @@ int main(int argc, char *argv[])
   mng_if_en = config_get_int(cfg, "global", "mng_if_en");
   if(mng_if_en == 1) {
     if(mng_if_start(config_get_string(cfg, "global", "mng_if_ip_addr"),
-                    config_get_int(cfg, "global", "mng_if_port_num")) < 0) {
+                    config_get_int(cfg, "global", "mng_if_port_num"),
+                    config_get_string(cfg, "global", "mng_if_unix_path"),
+                    config_get_int(cfg, "global", "mng_if_unix_gid")) < 0) {
       pr_err("Failed to start the management interface");
       goto end;
     }
   }
 
+  /* Start metrics endpoint */
+  metrics_en = config_get_int(cfg, "global", "metrics_en");
+  if(metrics_en == 1) {
+    if(mng_metrics_start(config_get_string(cfg, "global", "metrics_ip_addr"),
+                         config_get_int(cfg, "global", "metrics_port_num")) < 0) {
+      pr_err("Failed to start the metrics endpoint");
+      goto end;
+    }
+  }
+
+  /* Start status page */
+  status_page_en = config_get_int(cfg, "global", "status_page_en");
+  if(status_page_en == 1) {
+    if(mng_shm_init(config_get_string(cfg, "global", "status_page_path")) < 0) {
+      pr_err("Failed to start the status page");
+      goto end;
+    }
+  }
+
   err = 0;
 
   while(g_prog_running) {
     /* Run Sync-E DPLL monitor to retrieve current QL and clock index */
+    trace_begin();
     monitor_determine_ql();
+    trace_end(E_trace_span_monitor, NULL);
     /* Run control state machine and update device reference priority table */
+    trace_begin();
     control_update_sync_table();
-    /* Wait */
-    usleep(MAIN_LOOP_INTERVAL_MS * 1000);
+    trace_end(E_trace_span_sync_update, NULL);
+    /* Publish changed status to the status page */
+    mng_shm_update();
+    /* Report repeats of rate-limited messages */
+    print_ratelimit_flush(0);
+    /* Write flight recorder pages back if due */
+    journal_recorder_sync();
+    /* Write the thread activity trace if requested */
+    if(g_trace_export_flag) {
+      g_trace_export_flag = 0;
+      trace_export(trace_path);
+    }
+    /* Wait (on the capture time while replaying a capture) */
+    esmc_adaptor_sleep(MAIN_LOOP_INTERVAL_MS);
   }
 
   /* Stop ESMC stack */
   esmc_adaptor_stop();
 
 end:
+  /* Stop the status page */
+  mng_shm_deinit();
+
+  /* Stop the metrics endpoint */
+  mng_metrics_stop();
+
   /* Stop the management interface */
   mng_if_stop();
 
   /* Stop the pcm4l interface */
   pcm4l_if_stop();
 
+#if (SYNCED_MUTEX_PROFILING == 1)
+  /* All threads that take mutexes have stopped */
+  print_mutex_profile();
+#endif
+
   /* Deinitialize management, monitor, control, ESMC stack, and device */
   if(management_init_flag) {
     management_deinit();
@@ -793,6 +988,14 @@ end:
     device_adaptor_deinit();
   }
 
+  /* Stop the flight recorder after the modules that record events; the file is kept */
+  journal_recorder_deinit();
+
+  /* Write the thread activity trace after all threads have stopped */
+  if(trace_en == 1) {
+    trace_export(trace_path);
+  }
+
   /* Free sync and TX/RX port configurations */
   if(init_sync_config) {
     free(init_sync_config);
@@ -814,7 +1017,13 @@ quick_end:
     config_destroy(cfg);
   }
 
+  /* Report what was suppressed in the last interval too */
+  print_ratelimit_flush(1);
+
   pr_info("---Ended %s---", prog_name);
 
+  /* Write out queued messages */
+  print_async_stop();
+
   return err;
 }
@@ -0,0 +1,1551 @@
+/**
+ * @file synced_netsim.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../common/common.h"
+#include "../../common/config.h"
+#include "../../common/journal.h"
+#include "../../common/print.h"
+#include "../../common/stats.h"
+#include "../../control/control.h"
+#include "../../device/device_adaptor/device_adaptor.h"
+#include "../../esmc/renesas/esmc.h"
+#include "../../esmc/renesas/port.h"
+#include "../../monitor/monitor.h"
+
+/*
+ * In-process Sync-E network simulator
+ *
+ * Runs one control, monitor and ESMC stack instance per node on a virtual clock, to study how the clock selection
+ * converges in large networks without threads, sockets or hardware. Nodes are joined by in-memory links with a
+ * configurable delay, jitter and loss, and exchange real ESMC PDUs composed and parsed by the ESMC stack. The
+ * receive side of every port runs the RX step of port.c (QL changes only, RX timeout, extended QL TLV cascade and
+ * timing loop checks) on the virtual clock, and the Sync-E DPLL of each node is modelled: it locks to the first qualified clock of the priority table set by
+ * control, and goes to holdover when that clock is lost. Like the main loop of synced, every node runs the monitor
+ * and then control every SYNCED_NETSIM_TICK_PERIOD_US, each with its own phase.
+ *
+ * A node has converged when its TX QL and selected sync no longer change; a run ends when no node changed for the
+ * quiet window. Runs are deterministic for a given seed.
+ */
+
+#define NETSIM_TICK_PERIOD_US          100000ULL  /* Main loop interval of synced */
+#define NETSIM_INFO_PERIOD_US          (ESMC_TX_HEARTBEAT_PERIOD_MS * 1000ULL)
+#define NETSIM_US_PER_S                1000000ULL
+#define NETSIM_MAX_NUM_OF_NODES        (1 << 24) /* Node index is carried in three bytes of the MAC address */
+#define NETSIM_NO_NODE                 -1
+#define NETSIM_DEFAULT_NUM_OF_NODES    100
+
+typedef enum {
+  E_netsim_topology_chain,
+  E_netsim_topology_ring,
+  E_netsim_topology_grid,
+  E_netsim_topology_max
+} T_netsim_topology;
+
+typedef enum {
+  E_netsim_scenario_startup,
+  E_netsim_scenario_gm_fail,
+  E_netsim_scenario_link_cut,
+  E_netsim_scenario_max
+} T_netsim_scenario;
+
+typedef enum {
+  E_netsim_event_type_tick,
+  E_netsim_event_type_tx_info,
+  E_netsim_event_type_rx_pdu,
+  E_netsim_event_type_max
+} T_netsim_event_type;
+
+typedef struct {
+  uint64_t time_us;
+  uint64_t seq;                       /* Orders events of the same time, so runs are deterministic */
+  T_netsim_event_type type;
+  int node_idx;
+  int port_idx;
+  unsigned int generation;            /* Information PDU timer generation (TX) */
+  int pdu_idx;                        /* PDU pool slot (RX) */
+} T_netsim_event;
+
+typedef struct {
+  int node_idx[2];
+  int port_idx[2];
+  int up_flag;
+} T_netsim_link;
+
+typedef struct {
+  char name[INTERFACE_MAX_NAME_LEN];
+  int link_idx;
+  int peer_node_idx;
+  int peer_port_idx;
+  unsigned char mac_addr[ETH_ALEN];
+
+  /* TX */
+  unsigned int tx_generation;         /* Restarts the information PDU timer when an event PDU is sent */
+
+  /* RX */
+  T_port_rx_state rx_state;
+} T_netsim_port;
+
+typedef struct {
+  int num_ports;
+  T_netsim_port *ports;
+  int gm_flag;                        /* Node has an external clock */
+  int gm_up_flag;
+  T_esmc_ql gm_ql;
+
+  T_sync_config *sync_config;
+  T_device_ops device_ops;
+  T_port_rx_ops rx_ops;
+  T_journal_sink journal_sink;
+  T_stats_sink stats_sink;
+  T_control_data *control;
+  T_monitor_data *monitor;
+  T_esmc esmc;
+
+  /* Journal and port event counters of the control and monitor instances */
+  int num_syncs;
+  unsigned long long num_journal_entries[E_journal_event_type_max];
+  uint64_t (*port_counters)[E_stats_port_counter_max];
+
+  /* Modelled Sync-E DPLL */
+  T_device_clock_priority_entry priorities[MAX_NUM_OF_CLOCKS];
+  int num_priorities;
+  T_device_dpll_state dpll_state;
+  int dpll_clk_idx;
+  uint64_t dpll_lock_time_us;
+
+  /* Convergence */
+  T_esmc_ql tx_ql;
+  int best_sync_idx;
+  uint64_t last_change_time_us;
+  unsigned int num_changes;
+} T_netsim_node;
+
+typedef struct {
+  unsigned long long events;
+  unsigned long long pdus;
+  unsigned long long lost_pdus;
+} T_netsim_counters;
+
+/* Static data */
+
+static T_esmc_network_option g_net_opt = E_esmc_network_option_1;
+static T_netsim_topology g_topology = E_netsim_topology_ring;
+static T_netsim_scenario g_scenario = E_netsim_scenario_startup;
+static int g_num_nodes = NETSIM_DEFAULT_NUM_OF_NODES;
+static int g_backup_gm_node_idx = NETSIM_NO_NODE;
+static int g_cut_link_idx = 0;
+static uint64_t g_delay_us = 100;
+static uint64_t g_jitter_us = 0;
+static double g_loss_percent = 0;
+static uint64_t g_lock_time_us = 0;
+static T_esmc_ql g_gm_ql;
+static T_esmc_ql g_backup_gm_ql;
+static T_esmc_ql g_lo_ql;
+static T_esmc_ql g_holdover_ql;
+static T_esmc_ql g_do_not_use_ql;
+static unsigned int g_holdover_timer_s = 300;
+static unsigned int g_hold_off_timer_ms = 300;
+static unsigned int g_wait_to_restore_timer_s = 300;
+static uint64_t g_quiet_window_us = 30 * NETSIM_US_PER_S;
+static uint64_t g_max_time_us = 3600 * NETSIM_US_PER_S;
+
+static T_netsim_node *g_nodes;
+static T_netsim_link *g_links;
+static int g_num_links;
+
+static T_netsim_event *g_events;
+static int g_num_events;
+static int g_max_events;
+static uint64_t g_event_seq;
+
+static T_esmc_pdu *g_pdus;
+static int *g_free_pdus;
+static int g_num_free_pdus;
+static int g_max_pdus;
+
+static uint64_t g_now_us;
+static uint64_t g_last_change_time_us;
+static uint64_t g_rng_state;
+static T_netsim_counters g_counters;
+
+static const char *g_topology_names[E_netsim_topology_max] = {"chain", "ring", "grid"};
+static const char *g_scenario_names[E_netsim_scenario_max] = {"startup", "gm-fail", "link-cut"};
+
+/* Static functions */
+
+static void usage(char *prog_name)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "options:\n"
+          "  -1 Use network option 1 QLs (default).\n"
+          "  -2 Use network option 2 QLs.\n"
+          "  -3 Use network option 3 QLs.\n"
+          "  -b [node] Give 'node' a backup external clock with the backup QL of -q (default: none).\n"
+          "  -c [link] Cut 'link' in the link-cut scenario (default: 0, a link of node 0).\n"
+          "  -C [file] Write the convergence time of every node and run to 'file' as CSV.\n"
+          "  -d [ms] Set the link delay (default: 0.1).\n"
+          "  -h Display command-line options (i.e. print this message).\n"
+          "  -H [seconds] Set the holdover timer (default: 300).\n"
+          "  -j [ms] Add a uniformly distributed link jitter of up to 'ms' (default: 0).\n"
+          "  -k [ms] Set the time the Sync-E DPLL takes to lock to a new clock (default: 0).\n"
+          "  -l [ql] Set the LO QL (default: SEC for network option 1, ST3 for 2 and SEC for 3).\n"
+          "  -L [percent] Lose 'percent' of the PDUs (default: 0).\n"
+          "  -m [seconds] Stop a run after 'seconds' of virtual time (default: 3600).\n"
+          "  -n [nodes] Simulate 'nodes' nodes (default: %d).\n"
+          "  -o [ms] Set the hold-off timer (default: 300).\n"
+          "  -Q [ql] Set the holdover QL (default: the LO QL).\n"
+          "  -q [ql[,ql]] Set the QL of the external clock of node 0 and of the backup (default: PRC,SSUA for\n"
+          "     network option 1, PRS,ST2 for 2 and PRC,SSUA for 3).\n"
+          "  -r [runs] Repeat the scenario 'runs' times with consecutive seeds (default: 1).\n"
+          "  -s [scenario] Run 'scenario': startup (convergence from power-up), gm-fail (external clock of node 0 lost\n"
+          "     after convergence) or link-cut (link of -c cut after convergence) (default: startup).\n"
+          "  -S [seed] Set the seed of the first run (default: 1).\n"
+          "  -t [topology] Join the nodes as a chain, ring or grid (default: ring).\n"
+          "  -v Print the messages of the control, monitor and RX port instances up to informational level.\n"
+          "  -w [seconds] Set the wait-to-restore timer (default: 300).\n"
+          "  -W [seconds] End a run when no node changed for 'seconds' (default: 30).\n",
+          prog_name, NETSIM_DEFAULT_NUM_OF_NODES);
+}
+
+static uint64_t netsim_random(void)
+{
+  /* xorshift64* */
+  g_rng_state ^= g_rng_state >> 12;
+  g_rng_state ^= g_rng_state << 25;
+  g_rng_state ^= g_rng_state >> 27;
+  return g_rng_state * 2685821657736338717ULL;
+}
+
+static uint64_t netsim_random_range(uint64_t range)
+{
+  return (range == 0) ? 0 : (netsim_random() % range);
+}
+
+static int parse_ql(const char *str, T_esmc_ql *ql)
+{
+  /* Accept both SSUB and QL-SSUB */
+  if(!strncmp(str, "QL-", 3)) {
+    str += 3;
+  }
+
+  if((config_ql_str_to_enum_conv(g_net_opt, str, ql) < 0) || (check_ql_setting(g_net_opt, *ql) < 0)) {
+    fprintf(stderr, "Invalid QL %s for network option %d\n", str, g_net_opt);
+    return -1;
+  }
+
+  return 0;
+}
+
+static int parse_name(const char *str, const char **names, int num_names)
+{
+  int i;
+
+  for(i = 0; i < num_names; i++) {
+    if(!strcmp(str, names[i])) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/* Event queue (binary min-heap ordered by time and sequence number) */
+
+static int netsim_event_before(T_netsim_event const *a, T_netsim_event const *b)
+{
+  return (a->time_us < b->time_us) || ((a->time_us == b->time_us) && (a->seq < b->seq));
+}
+
+static int netsim_push_event(T_netsim_event *event)
+{
+  T_netsim_event *events;
+  int i;
+  int parent;
+
+  if(g_num_events == g_max_events) {
+    events = realloc(g_events, 2 * g_max_events * sizeof(*g_events));
+    if(events == NULL) {
+      return -1;
+    }
+    g_events = events;
+    g_max_events *= 2;
+  }
+
+  event->seq = g_event_seq++;
+
+  i = g_num_events++;
+  while(i > 0) {
+    parent = (i - 1) / 2;
+    if(!netsim_event_before(event, &g_events[parent])) {
+      break;
+    }
+    g_events[i] = g_events[parent];
+    i = parent;
+  }
+  g_events[i] = *event;
+
+  return 0;
+}
+
+static void netsim_pop_event(T_netsim_event *event)
+{
+  T_netsim_event last;
+  int i = 0;
+  int child;
+
+  *event = g_events[0];
+  last = g_events[--g_num_events];
+
+  while((child = 2 * i + 1) < g_num_events) {
+    if(((child + 1) < g_num_events) && netsim_event_before(&g_events[child + 1], &g_events[child])) {
+      child++;
+    }
+    if(!netsim_event_before(&g_events[child], &last)) {
+      break;
+    }
+    g_events[i] = g_events[child];
+    i = child;
+  }
+  g_events[i] = last;
+}
+
+static int netsim_schedule(uint64_t time_us, T_netsim_event_type type, int node_idx, int port_idx, unsigned int generation, int pdu_idx)
+{
+  T_netsim_event event;
+
+  memset(&event, 0, sizeof(event));
+  event.time_us = time_us;
+  event.type = type;
+  event.node_idx = node_idx;
+  event.port_idx = port_idx;
+  event.generation = generation;
+  event.pdu_idx = pdu_idx;
+
+  return netsim_push_event(&event);
+}
+
+/* PDU pool for PDUs in flight */
+
+static int netsim_alloc_pdu(void)
+{
+  T_esmc_pdu *pdus;
+  int *free_pdus;
+  int max_pdus;
+  int i;
+
+  if(g_num_free_pdus == 0) {
+    max_pdus = (g_max_pdus == 0) ? 1024 : (2 * g_max_pdus);
+    pdus = realloc(g_pdus, max_pdus * sizeof(*g_pdus));
+    if(pdus == NULL) {
+      return -1;
+    }
+    g_pdus = pdus;
+    free_pdus = realloc(g_free_pdus, max_pdus * sizeof(*g_free_pdus));
+    if(free_pdus == NULL) {
+      return -1;
+    }
+    g_free_pdus = free_pdus;
+    for(i = g_max_pdus; i < max_pdus; i++) {
+      g_free_pdus[g_num_free_pdus++] = i;
+    }
+    g_max_pdus = max_pdus;
+  }
+
+  return g_free_pdus[--g_num_free_pdus];
+}
+
+static void netsim_free_pdu(int pdu_idx)
+{
+  g_free_pdus[g_num_free_pdus++] = pdu_idx;
+}
+
+/* Modelled Sync-E DPLL */
+
+static int netsim_check_clk_qualified(T_netsim_node const *node, int clk_idx)
+{
+  if(clk_idx < node->num_ports) {
+    return g_links[node->ports[clk_idx].link_idx].up_flag;
+  }
+
+  return node->gm_flag && node->gm_up_flag && (clk_idx == node->num_ports);
+}
+
+static void netsim_dpll_update(T_netsim_node *node)
+{
+  int clk_idx = INVALID_CLK_IDX;
+  int i;
+
+  for(i = 0; i < node->num_priorities; i++) {
+    if(netsim_check_clk_qualified(node, node->priorities[i].clk_idx)) {
+      clk_idx = node->priorities[i].clk_idx;
+      break;
+    }
+  }
+
+  if(clk_idx == INVALID_CLK_IDX) {
+    if((node->dpll_state == E_device_dpll_state_locked) ||
+       (node->dpll_state == E_device_dpll_state_lock_acquisition_recovery)) {
+      node->dpll_state = E_device_dpll_state_holdover;
+    }
+    node->dpll_clk_idx = INVALID_CLK_IDX;
+    return;
+  }
+
+  if((clk_idx != node->dpll_clk_idx) ||
+     ((node->dpll_state != E_device_dpll_state_locked) && (node->dpll_state != E_device_dpll_state_lock_acquisition_recovery))) {
+    node->dpll_clk_idx = clk_idx;
+    node->dpll_lock_time_us = g_now_us + g_lock_time_us;
+    node->dpll_state = E_device_dpll_state_lock_acquisition_recovery;
+  }
+
+  if((node->dpll_state == E_device_dpll_state_lock_acquisition_recovery) && (g_now_us >= node->dpll_lock_time_us)) {
+    node->dpll_state = E_device_dpll_state_locked;
+  }
+}
+
+/* Journal and statistics of a node */
+
+static void netsim_journal_record(void *ctx, T_journal_event_type type, int sync_idx, int val0, int val1, int val2)
+{
+  T_netsim_node *node = ctx;
+
+  (void)sync_idx;
+  (void)val0;
+  (void)val1;
+  (void)val2;
+
+  if(type < E_journal_event_type_max) {
+    node->num_journal_entries[type]++;
+  }
+}
+
+static void netsim_inc_port_counter(void *ctx, T_stats_port_counter counter, int sync_idx)
+{
+  T_netsim_node *node = ctx;
+
+  if((counter < E_stats_port_counter_max) && (sync_idx >= 0) && (sync_idx < node->num_syncs)) {
+    node->port_counters[sync_idx][counter]++;
+  }
+}
+
+static unsigned long long netsim_get_monotonic_milliseconds(void *ctx)
+{
+  (void)ctx;
+
+  return g_now_us / 1000;
+}
+
+static int netsim_get_current_clk_idx(void *ctx, int *clk_idx)
+{
+  T_netsim_node *node = ctx;
+
+  *clk_idx = node->dpll_clk_idx;
+
+  return 0;
+}
+
+static int netsim_set_clock_priorities(void *ctx, T_device_clock_priority_table const *table)
+{
+  T_netsim_node *node = ctx;
+
+  node->num_priorities = table->num_entries;
+  memcpy(node->priorities, table->clock_priority_table, table->num_entries * sizeof(*table->clock_priority_table));
+  netsim_dpll_update(node);
+
+  return 0;
+}
+
+static int netsim_get_reference_monitor_status(void *ctx, int clk_idx, T_device_clk_reference_monitor_status *ref_mon_status)
+{
+  T_netsim_node *node = ctx;
+
+  memset(ref_mon_status, 0, sizeof(*ref_mon_status));
+  ref_mon_status->loss_of_signal_alarm_status = !netsim_check_clk_qualified(node, clk_idx);
+
+  return 0;
+}
+
+static int netsim_get_ffo(void *ctx, int clk_idx, double *ffo_ppb)
+{
+  (void)ctx;
+  (void)clk_idx;
+  (void)ffo_ppb;
+
+  /* Not modelled */
+  return -2;
+}
+
+static int netsim_get_synce_dpll_state(void *ctx, T_device_dpll_state *synce_dpll_state)
+{
+  T_netsim_node *node = ctx;
+
+  *synce_dpll_state = node->dpll_state;
+
+  return 0;
+}
+
+static int netsim_get_synce_dpll_ffo(void *ctx, double *ffo_ppb)
+{
+  return netsim_get_ffo(ctx, INVALID_CLK_IDX, ffo_ppb);
+}
+
+/* Links and ESMC PDUs */
+
+static void netsim_send_pdu(int node_idx, int port_idx, T_esmc_pdu_type msg_type)
+{
+  T_netsim_node *node = &g_nodes[node_idx];
+  T_netsim_port *port = &node->ports[port_idx];
+  T_esmc_ql composed_ql;
+  uint64_t time_us;
+  int pdu_idx;
+
+  if(!g_links[port->link_idx].up_flag) {
+    /* No need to compose and send the PDU */
+    return;
+  }
+
+  pdu_idx = netsim_alloc_pdu();
+  if(pdu_idx < 0) {
+    pr_err("Failed to allocate PDU");
+    return;
+  }
+
+  memset(&g_pdus[pdu_idx], 0, sizeof(g_pdus[pdu_idx]));
+  if(esmc_instance_compose_pdu(&node->esmc, &g_pdus[pdu_idx], msg_type, port->mac_addr, &node->esmc.best_ext_ql_tlv_data, port_idx + 1, &composed_ql) != ESMC_PDU_LEN) {
+    netsim_free_pdu(pdu_idx);
+    return;
+  }
+  g_counters.pdus++;
+
+  if((g_loss_percent > 0) && ((double)netsim_random_range(1000000) < (g_loss_percent * 10000))) {
+    g_counters.lost_pdus++;
+    netsim_free_pdu(pdu_idx);
+    return;
+  }
+
+  time_us = g_now_us + g_delay_us + netsim_random_range(g_jitter_us + 1);
+  if(netsim_schedule(time_us, E_netsim_event_type_rx_pdu, port->peer_node_idx, port->peer_port_idx, 0, pdu_idx) < 0) {
+    netsim_free_pdu(pdu_idx);
+  }
+}
+
+static void netsim_send_event_pdus(int node_idx)
+{
+  T_netsim_node *node = &g_nodes[node_idx];
+  T_netsim_port *port;
+  int i;
+
+  /* TX threads wake up on a best QL change and restart their heartbeat */
+  for(i = 0; i < node->num_ports; i++) {
+    port = &node->ports[i];
+    port->tx_generation++;
+    netsim_send_pdu(node_idx, i, E_esmc_pdu_type_event);
+    netsim_schedule(g_now_us + NETSIM_INFO_PERIOD_US, E_netsim_event_type_tx_info, node_idx, i, port->tx_generation, 0);
+  }
+}
+
+static int netsim_set_tx_ql(void *ctx,
+                            T_esmc_ql ql,
+                            int best_sync_idx,
+                            T_sync_tx_bundle_info *sync_tx_bundle_info,
+                            T_latency_trace const *latency_trace)
+{
+  T_netsim_node *node = ctx;
+  T_port_tx_bundle_info port_tx_bundle_info;
+  T_port_ext_ql_tlv_data ext_ql_tlv_data;
+  T_netsim_port *best_port = NULL;
+  T_port_num best_port_num = INVALID_PORT_NUM;
+  int entry;
+  int sync_idx;
+
+  (void)latency_trace;
+
+  port_tx_bundle_info.entries = 0;
+
+  if(best_sync_idx != INVALID_SYNC_IDX) {
+    /* Ports are sync indices 0 to num_ports - 1 and port number is sync index + 1 (see netsim_create_node()) */
+    for(entry = 0; entry < sync_tx_bundle_info->entries; entry++) {
+      sync_idx = sync_tx_bundle_info->sync_indices[entry];
+      if(sync_idx < node->num_ports) {
+        port_tx_bundle_info.port_nums[port_tx_bundle_info.entries++] = sync_idx + 1;
+      }
+    }
+    if(best_sync_idx < node->num_ports) {
+      best_port_num = best_sync_idx + 1;
+      best_port = &node->ports[best_sync_idx];
+    }
+  }
+
+  if(best_port != NULL) {
+    port_rx_state_get_ext_ql_tlv_data(&best_port->rx_state, &ext_ql_tlv_data);
+  }
+
+  esmc_instance_set_best_ql(&node->esmc, ql, best_port_num, &port_tx_bundle_info, (best_port != NULL) ? &ext_ql_tlv_data : NULL, NULL);
+
+  if((ql != node->tx_ql) || (best_sync_idx != node->best_sync_idx)) {
+    node->tx_ql = ql;
+    node->best_sync_idx = best_sync_idx;
+    node->last_change_time_us = g_now_us;
+    node->num_changes++;
+    g_last_change_time_us = g_now_us;
+  }
+
+  netsim_send_event_pdus(node - g_nodes);
+
+  return 0;
+}
+
+static int netsim_check_own_mac_addr(void *ctx, const unsigned char mac_addr[ETH_ALEN])
+{
+  T_netsim_node const *node = ctx;
+
+  /* All ports of a node share the first five bytes of their MAC address (see netsim_create_node()) */
+  return (memcmp(mac_addr, node->ports[0].mac_addr, ETH_ALEN - 1) == 0) && (mac_addr[ETH_ALEN - 1] < node->num_ports);
+}
+
+static void netsim_rx_event(void *ctx, T_esmc_rx_event_cb_data *cb_data)
+{
+  T_netsim_node *node = ctx;
+  T_esmc_adaptor_rx_event_cb_data generic_cb_data;
+
+  /* Same as the ESMC adaptor; port number is sync index + 1 (see netsim_create_node()) */
+  memset(&generic_cb_data, 0, sizeof(generic_cb_data));
+  generic_cb_data.event_type = cb_data->event_type;
+  generic_cb_data.sync_idx = cb_data->port_num - 1;
+  generic_cb_data.rx_time_ns = cb_data->rx_time_ns;
+
+  switch(cb_data->event_type) {
+    case E_esmc_event_type_ql_change:
+      generic_cb_data.event_data.ql_change = cb_data->event_data.ql_change;
+      break;
+    case E_esmc_event_type_immediate_timing_loop:
+    case E_esmc_event_type_originator_timing_loop:
+      generic_cb_data.event_data.timing_loop = cb_data->event_data.timing_loop;
+      break;
+    default:
+      break;
+  }
+
+  control_instance_rx_event(node->control, &generic_cb_data);
+}
+
+static void netsim_receive_pdu(int node_idx, int port_idx, T_esmc_pdu *msg)
+{
+  T_netsim_port *port = &g_nodes[node_idx].ports[port_idx];
+
+  if(!g_links[port->link_idx].up_flag) {
+    /* Lost on the cut link */
+    return;
+  }
+
+  port_rx_state_process_pdu(&port->rx_state, msg, ESMC_PDU_LEN, msg->eth_hdr.h_source, 0);
+}
+
+static void netsim_check_ports(int node_idx)
+{
+  T_netsim_node *node = &g_nodes[node_idx];
+  T_netsim_port *port;
+  int i;
+
+  /* Link and RX timeout checks of the RX threads */
+  for(i = 0; i < node->num_ports; i++) {
+    port = &node->ports[i];
+    port_rx_state_check_link(&port->rx_state, g_links[port->link_idx].up_flag);
+    port_rx_state_check_timeout(&port->rx_state);
+  }
+}
+
+static void netsim_tick(int node_idx)
+{
+  T_netsim_node *node = &g_nodes[node_idx];
+
+  netsim_check_ports(node_idx);
+  netsim_dpll_update(node);
+
+  /* Same order as the main loop of synced */
+  monitor_instance_determine_ql(node->monitor);
+  control_instance_update_sync_table(node->control);
+}
+
+/* Network */
+
+static int netsim_add_link(int node_idx_a, int node_idx_b)
+{
+  T_netsim_link *link = &g_links[g_num_links];
+  int node_idx[2] = {node_idx_a, node_idx_b};
+  int i;
+
+  for(i = 0; i < 2; i++) {
+    if(g_nodes[node_idx[i]].num_ports == ESMC_MAX_NUMBER_OF_PORTS) {
+      return -1;
+    }
+    link->node_idx[i] = node_idx[i];
+    link->port_idx[i] = g_nodes[node_idx[i]].num_ports++;
+  }
+  link->up_flag = 1;
+
+  g_num_links++;
+
+  return 0;
+}
+
+static int netsim_create_links(void)
+{
+  int width;
+  int i;
+
+  width = 1;
+  while((width * width) < g_num_nodes) {
+    width++;
+  }
+
+  /* At most two links per node */
+  g_links = calloc(2 * g_num_nodes, sizeof(*g_links));
+  if(g_links == NULL) {
+    return -1;
+  }
+
+  for(i = 0; i < g_num_nodes; i++) {
+    switch(g_topology) {
+      case E_netsim_topology_chain:
+        if((i + 1) < g_num_nodes) {
+          netsim_add_link(i, i + 1);
+        }
+        break;
+      case E_netsim_topology_ring:
+        if((i + 1) < g_num_nodes) {
+          netsim_add_link(i, i + 1);
+        } else if(g_num_nodes > 2) {
+          netsim_add_link(i, 0);
+        }
+        break;
+      case E_netsim_topology_grid:
+        if((((i + 1) % width) != 0) && ((i + 1) < g_num_nodes)) {
+          netsim_add_link(i, i + 1);
+        }
+        if((i + width) < g_num_nodes) {
+          netsim_add_link(i, i + width);
+        }
+        break;
+      default:
+        return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int netsim_create_node(int node_idx)
+{
+  T_netsim_node *node = &g_nodes[node_idx];
+  T_control_config control_config;
+  T_monitor_config monitor_config;
+  T_sync_config *sync_config;
+  T_netsim_port *port;
+  T_netsim_link *link;
+  void *ports;
+  int num_syncs;
+  int side;
+  int i;
+
+  node->gm_flag = (node_idx == 0) || (node_idx == g_backup_gm_node_idx);
+  node->gm_up_flag = node->gm_flag;
+  node->gm_ql = (node_idx == 0) ? g_gm_ql : g_backup_gm_ql;
+
+  /* Ports hold cache line aligned RX counters */
+  if(posix_memalign(&ports, PORT_CACHE_LINE_SIZE, node->num_ports * sizeof(*node->ports)) != 0) {
+    return -1;
+  }
+  memset(ports, 0, node->num_ports * sizeof(*node->ports));
+  node->ports = ports;
+  num_syncs = node->num_ports + (node->gm_flag ? 1 : 0);
+  node->num_syncs = num_syncs;
+  node->sync_config = calloc(num_syncs, sizeof(*node->sync_config));
+  node->port_counters = calloc(num_syncs, sizeof(*node->port_counters));
+  if((node->sync_config == NULL) || (node->port_counters == NULL)) {
+    return -1;
+  }
+
+  node->rx_ops.ctx = node;
+  node->rx_ops.get_monotonic_milliseconds = netsim_get_monotonic_milliseconds;
+  node->rx_ops.check_mac_addr = netsim_check_own_mac_addr;
+  node->rx_ops.rx_event = netsim_rx_event;
+
+  for(i = 0; i < g_num_links; i++) {
+    link = &g_links[i];
+    for(side = 0; side < 2; side++) {
+      if(link->node_idx[side] == node_idx) {
+        port = &node->ports[link->port_idx[side]];
+        port->link_idx = i;
+        port->peer_node_idx = link->node_idx[1 - side];
+        port->peer_port_idx = link->port_idx[1 - side];
+      }
+    }
+  }
+
+  for(i = 0; i < node->num_ports; i++) {
+    port = &node->ports[i];
+    /* Locally administered address: node index in bytes 1 to 3 and port index in byte 5 */
+    port->mac_addr[0] = 0x02;
+    port->mac_addr[1] = (node_idx >> 16) & 0xFF;
+    port->mac_addr[2] = (node_idx >> 8) & 0xFF;
+    port->mac_addr[3] = node_idx & 0xFF;
+    port->mac_addr[4] = 0;
+    port->mac_addr[5] = i;
+    snprintf(port->name, sizeof(port->name), "port%d", i);
+    port_rx_state_init(&port->rx_state, port->name, i + 1, &node->esmc, &node->rx_ops);
+
+    /* Sync index and clock index of a port are the port index */
+    sync_config = &node->sync_config[i];
+    sync_config->name = port->name;
+    sync_config->type = E_sync_type_synce;
+    sync_config->clk_idx = i;
+    sync_config->config_pri = 1;
+    sync_config->init_ql = g_do_not_use_ql;
+    sync_config->tx_bundle_num = NO_TX_BUNDLE_NUM;
+  }
+
+  if(node->gm_flag) {
+    sync_config = &node->sync_config[node->num_ports];
+    sync_config->name = "gm";
+    sync_config->type = E_sync_type_external;
+    sync_config->clk_idx = node->num_ports;
+    sync_config->config_pri = 1;
+    sync_config->init_ql = node->gm_ql;
+    sync_config->tx_bundle_num = NO_TX_BUNDLE_NUM;
+  }
+
+  node->device_ops.ctx = node;
+  node->device_ops.get_monotonic_milliseconds = netsim_get_monotonic_milliseconds;
+  node->device_ops.get_current_clk_idx = netsim_get_current_clk_idx;
+  node->device_ops.set_clock_priorities = netsim_set_clock_priorities;
+  node->device_ops.get_reference_monitor_status = netsim_get_reference_monitor_status;
+  node->device_ops.get_reference_ffo = netsim_get_ffo;
+  node->device_ops.get_synce_dpll_state = netsim_get_synce_dpll_state;
+  node->device_ops.get_synce_dpll_ffo = netsim_get_synce_dpll_ffo;
+
+  node->journal_sink.ctx = node;
+  node->journal_sink.record = netsim_journal_record;
+  node->stats_sink.ctx = node;
+  node->stats_sink.inc_port_counter = netsim_inc_port_counter;
+
+  node->dpll_state = E_device_dpll_state_freerun;
+  node->dpll_clk_idx = INVALID_CLK_IDX;
+  node->tx_ql = E_esmc_ql_max;
+  node->best_sync_idx = INVALID_SYNC_IDX;
+
+  if(esmc_instance_init(&node->esmc, g_net_opt, g_lo_ql, g_do_not_use_ql) < 0) {
+    return -1;
+  }
+
+  memset(&control_config, 0, sizeof(control_config));
+  control_config.net_opt = g_net_opt;
+  control_config.lo_ql = g_lo_ql;
+  control_config.lo_pri = 255;
+  control_config.do_not_use_ql = g_do_not_use_ql;
+  control_config.hold_off_timer_ms = g_hold_off_timer_ms;
+  control_config.wait_to_restore_timer_s = g_wait_to_restore_timer_s;
+  control_config.num_syncs = num_syncs;
+  control_config.sync_config_array = node->sync_config;
+
+  node->control = control_instance_create(&control_config, &node->device_ops, &node->journal_sink, &node->stats_sink);
+  if(node->control == NULL) {
+    return -1;
+  }
+
+  memset(&monitor_config, 0, sizeof(monitor_config));
+  monitor_config.lo_ql = g_lo_ql;
+  monitor_config.holdover_ql = g_holdover_ql;
+  monitor_config.holdover_timer_s = g_holdover_timer_s;
+
+  node->monitor = monitor_instance_create(&monitor_config, &node->device_ops, node->control, netsim_set_tx_ql, node);
+  if(node->monitor == NULL) {
+    return -1;
+  }
+
+  return 0;
+}
+
+static void netsim_destroy_network(void)
+{
+  T_netsim_node *node;
+  int i;
+
+  for(i = 0; (g_nodes != NULL) && (i < g_num_nodes); i++) {
+    node = &g_nodes[i];
+    monitor_instance_destroy(node->monitor);
+    control_instance_destroy(node->control);
+    if(node->esmc.state != E_esmc_state_unknown) {
+      esmc_instance_deinit(&node->esmc);
+    }
+    free(node->sync_config);
+    free(node->port_counters);
+    free(node->ports);
+  }
+
+  free(g_nodes);
+  g_nodes = NULL;
+  free(g_links);
+  g_links = NULL;
+  g_num_links = 0;
+  g_num_events = 0;
+  g_num_free_pdus = 0;
+  for(i = 0; i < g_max_pdus; i++) {
+    g_free_pdus[g_num_free_pdus++] = i;
+  }
+}
+
+static int netsim_create_network(uint64_t seed)
+{
+  int i;
+  int j;
+
+  g_rng_state = (seed == 0) ? 1 : (seed * 0x9E3779B97F4A7C15ULL);
+  g_now_us = 0;
+  g_last_change_time_us = 0;
+  g_event_seq = 0;
+  memset(&g_counters, 0, sizeof(g_counters));
+
+  g_nodes = calloc(g_num_nodes, sizeof(*g_nodes));
+  if((g_nodes == NULL) || (netsim_create_links() < 0)) {
+    return -1;
+  }
+
+  for(i = 0; i < g_num_nodes; i++) {
+    if(netsim_create_node(i) < 0) {
+      fprintf(stderr, "Failed to create node %d\n", i);
+      return -1;
+    }
+
+    /* Every node runs its main loop with its own phase, and every port its own heartbeat */
+    if(netsim_schedule(netsim_random_range(NETSIM_TICK_PERIOD_US), E_netsim_event_type_tick, i, 0, 0, 0) < 0) {
+      return -1;
+    }
+    for(j = 0; j < g_nodes[i].num_ports; j++) {
+      if(netsim_schedule(netsim_random_range(NETSIM_INFO_PERIOD_US), E_netsim_event_type_tx_info, i, j, 0, 0) < 0) {
+        return -1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static void netsim_process_event(T_netsim_event const *event)
+{
+  T_netsim_node *node = &g_nodes[event->node_idx];
+
+  g_now_us = event->time_us;
+  g_counters.events++;
+
+  switch(event->type) {
+    case E_netsim_event_type_tick:
+      netsim_tick(event->node_idx);
+      netsim_schedule(g_now_us + NETSIM_TICK_PERIOD_US, E_netsim_event_type_tick, event->node_idx, 0, 0, 0);
+      break;
+    case E_netsim_event_type_tx_info:
+      if(event->generation != node->ports[event->port_idx].tx_generation) {
+        /* Restarted by an event PDU */
+        break;
+      }
+      netsim_send_pdu(event->node_idx, event->port_idx, E_esmc_pdu_type_information);
+      netsim_schedule(g_now_us + NETSIM_INFO_PERIOD_US, E_netsim_event_type_tx_info, event->node_idx, event->port_idx, event->generation, 0);
+      break;
+    case E_netsim_event_type_rx_pdu:
+      netsim_receive_pdu(event->node_idx, event->port_idx, &g_pdus[event->pdu_idx]);
+      netsim_free_pdu(event->pdu_idx);
+      break;
+    default:
+      break;
+  }
+}
+
+/* Return 0 when the network converged and -1 when the maximum time after start_time_us was reached */
+static int netsim_run_until_quiet(uint64_t start_time_us)
+{
+  T_netsim_event event;
+  uint64_t quiet_start_time_us;
+
+  while(g_num_events > 0) {
+    quiet_start_time_us = (g_last_change_time_us > start_time_us) ? g_last_change_time_us : start_time_us;
+    if(g_events[0].time_us >= (quiet_start_time_us + g_quiet_window_us)) {
+      g_now_us = quiet_start_time_us + g_quiet_window_us;
+      return 0;
+    }
+    if(g_events[0].time_us > (start_time_us + g_max_time_us)) {
+      g_now_us = start_time_us + g_max_time_us;
+      return -1;
+    }
+
+    netsim_pop_event(&event);
+    netsim_process_event(&event);
+  }
+
+  return 0;
+}
+
+static void netsim_start_scenario(void)
+{
+  T_netsim_link *link;
+  int i;
+
+  switch(g_scenario) {
+    case E_netsim_scenario_gm_fail:
+      g_nodes[0].gm_up_flag = 0;
+      netsim_dpll_update(&g_nodes[0]);
+      break;
+    case E_netsim_scenario_link_cut:
+      link = &g_links[g_cut_link_idx];
+      link->up_flag = 0;
+      for(i = 0; i < 2; i++) {
+        netsim_dpll_update(&g_nodes[link->node_idx[i]]);
+      }
+      break;
+    default:
+      break;
+  }
+
+  for(i = 0; i < g_num_nodes; i++) {
+    g_nodes[i].num_changes = 0;
+  }
+}
+
+static int netsim_get_next_node_idx(int node_idx)
+{
+  int sync_idx = g_nodes[node_idx].best_sync_idx;
+
+  if((sync_idx == INVALID_SYNC_IDX) || (sync_idx >= g_nodes[node_idx].num_ports)) {
+    /* Tracks an external clock or LO */
+    return NETSIM_NO_NODE;
+  }
+
+  return g_nodes[node_idx].ports[sync_idx].peer_node_idx;
+}
+
+/* Return the number of nodes on timing loops (i.e. whose selected clocks lead back to themselves) */
+static int netsim_count_looped_nodes(void)
+{
+  /* 0: not visited, 1: on current path, 2: done */
+  unsigned char *state;
+  int *path;
+  int path_len;
+  int node_idx;
+  int num_looped = 0;
+  int i;
+  int j;
+
+  state = calloc(g_num_nodes, sizeof(*state));
+  path = calloc(g_num_nodes, sizeof(*path));
+  if((state == NULL) || (path == NULL)) {
+    free(state);
+    free(path);
+    return -1;
+  }
+
+  for(i = 0; i < g_num_nodes; i++) {
+    path_len = 0;
+    node_idx = i;
+    while((node_idx != NETSIM_NO_NODE) && (state[node_idx] == 0)) {
+      state[node_idx] = 1;
+      path[path_len++] = node_idx;
+      node_idx = netsim_get_next_node_idx(node_idx);
+    }
+
+    if((node_idx != NETSIM_NO_NODE) && (state[node_idx] == 1)) {
+      /* Path runs into itself; the nodes from node_idx on form a loop */
+      for(j = path_len - 1; path[j] != node_idx; j--) {
+        num_looped++;
+      }
+      num_looped++;
+    }
+
+    for(j = 0; j < path_len; j++) {
+      state[path[j]] = 2;
+    }
+  }
+
+  free(state);
+  free(path);
+
+  return num_looped;
+}
+
+/* Immediate and originator timing loops detected by the RX ports */
+static unsigned long long netsim_count_timing_loops(void)
+{
+  unsigned long long timing_loops = 0;
+  int i;
+  int j;
+
+  for(i = 0; i < g_num_nodes; i++) {
+    for(j = 0; j < g_nodes[i].num_ports; j++) {
+      timing_loops += g_nodes[i].ports[j].rx_state.counters.timing_loops;
+    }
+  }
+
+  return timing_loops;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+static double percentile(double const *sorted, int num, double p)
+{
+  int idx;
+
+  if(num == 0) {
+    return 0;
+  }
+
+  /* Nearest rank */
+  idx = (int)((p / 100) * num + 0.999999) - 1;
+  if(idx < 0) {
+    idx = 0;
+  } else if(idx >= num) {
+    idx = num - 1;
+  }
+
+  return sorted[idx];
+}
+
+static void print_distribution(const char *label, double *values, int num)
+{
+  qsort(values, num, sizeof(*values), compare_double);
+  printf("%s (%d): p50 %.3f s, p90 %.3f s, p99 %.3f s, max %.3f s\n",
+         label,
+         num,
+         percentile(values, num, 50),
+         percentile(values, num, 90),
+         percentile(values, num, 99),
+         (num > 0) ? values[num - 1] : 0);
+}
+
+static uint64_t get_wall_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void print_final_qls(void)
+{
+  unsigned int num_nodes_per_ql[E_esmc_ql_max + 1];
+  int ql;
+  int i;
+
+  memset(num_nodes_per_ql, 0, sizeof(num_nodes_per_ql));
+  for(i = 0; i < g_num_nodes; i++) {
+    num_nodes_per_ql[g_nodes[i].tx_ql]++;
+  }
+
+  printf("  Final QL:");
+  for(ql = 0; ql < E_esmc_ql_max; ql++) {
+    if(num_nodes_per_ql[ql] > 0) {
+      printf(" %s %u", conv_ql_enum_to_str(ql), num_nodes_per_ql[ql]);
+    }
+  }
+  if(num_nodes_per_ql[E_esmc_ql_max] > 0) {
+    printf(" none %u", num_nodes_per_ql[E_esmc_ql_max]);
+  }
+  printf("\n");
+}
+
+/* Totals of the journals and port event counters of the nodes */
+static void print_control_events(void)
+{
+  unsigned long long num_journal_entries = 0;
+  unsigned long long port_counters[E_stats_port_counter_max];
+  T_netsim_node const *node;
+  int counter;
+  int type;
+  int i;
+  int j;
+
+  memset(port_counters, 0, sizeof(port_counters));
+  for(i = 0; i < g_num_nodes; i++) {
+    node = &g_nodes[i];
+    for(type = 0; type < E_journal_event_type_max; type++) {
+      num_journal_entries += node->num_journal_entries[type];
+    }
+    for(j = 0; j < node->num_syncs; j++) {
+      for(counter = 0; counter < E_stats_port_counter_max; counter++) {
+        port_counters[counter] += node->port_counters[j][counter];
+      }
+    }
+  }
+
+  printf("  Control: %llu journal events", num_journal_entries);
+  for(counter = 0; counter < E_stats_port_counter_max; counter++) {
+    printf(", %s %llu", stats_port_counter_to_str(counter), port_counters[counter]);
+  }
+  printf("\n");
+}
+
+/* Run the scenario once and add the convergence times to the distributions; return -1 on failure */
+static int run(int run_idx, uint64_t seed, FILE *csv_file, double *run_times_s, double *node_times_s, int *num_node_times)
+{
+  uint64_t start_wall_time_ns;
+  uint64_t wall_time_ns;
+  uint64_t start_time_us = 0;
+  double *times_s = &node_times_s[*num_node_times];
+  T_netsim_node *node;
+  int converged_flag;
+  int num_changed = 0;
+  unsigned long long num_changes = 0;
+  int num_looped;
+  int i;
+
+  start_wall_time_ns = get_wall_time_ns();
+
+  if(netsim_create_network(seed) < 0) {
+    fprintf(stderr, "Failed to create network\n");
+    netsim_destroy_network();
+    return -1;
+  }
+
+  converged_flag = (netsim_run_until_quiet(0) == 0);
+  if(g_scenario != E_netsim_scenario_startup) {
+    if(!converged_flag) {
+      fprintf(stderr, "Run %d: network did not converge before the %s\n", run_idx + 1, g_scenario_names[g_scenario]);
+    }
+    start_time_us = g_now_us;
+    netsim_start_scenario();
+    converged_flag = (netsim_run_until_quiet(start_time_us) == 0);
+  }
+
+  wall_time_ns = get_wall_time_ns() - start_wall_time_ns;
+
+  for(i = 0; i < g_num_nodes; i++) {
+    node = &g_nodes[i];
+    if(node->num_changes == 0) {
+      continue;
+    }
+    times_s[num_changed++] = (double)(node->last_change_time_us - start_time_us) / NETSIM_US_PER_S;
+    num_changes += node->num_changes;
+  }
+  *num_node_times += num_changed;
+
+  if(csv_file != NULL) {
+    for(i = 0; i < g_num_nodes; i++) {
+      node = &g_nodes[i];
+      fprintf(csv_file, "%d,%llu,%d,%u,%.6f,%s\n",
+              run_idx + 1,
+              (unsigned long long)seed,
+              i,
+              node->num_changes,
+              (node->num_changes > 0) ? (double)(node->last_change_time_us - start_time_us) / NETSIM_US_PER_S : 0.0,
+              (node->tx_ql < E_esmc_ql_max) ? conv_ql_enum_to_str(node->tx_ql) : "none");
+    }
+  }
+
+  num_looped = netsim_count_looped_nodes();
+
+  run_times_s[run_idx] = (num_changed > 0) ? (double)(g_last_change_time_us - start_time_us) / NETSIM_US_PER_S : 0;
+
+  printf("Run %d (seed %llu): %s in %.3f s of virtual time, %d of %d nodes changed %llu times\n",
+         run_idx + 1,
+         (unsigned long long)seed,
+         converged_flag ? "converged" : "did not converge",
+         run_times_s[run_idx],
+         num_changed,
+         g_num_nodes,
+         num_changes);
+  print_distribution("  Node convergence time", times_s, num_changed);
+  print_final_qls();
+  printf("  %llu PDUs sent, %llu lost, %llu timing loops detected, %d nodes on timing loops at the end\n",
+         g_counters.pdus,
+         g_counters.lost_pdus,
+         netsim_count_timing_loops(),
+         num_looped);
+  print_control_events();
+  printf("  %llu events in %.3f s of wall time (%.0f events/s, %.0fx real time)\n",
+         g_counters.events,
+         (double)wall_time_ns / 1e9,
+         (double)g_counters.events * 1e9 / (wall_time_ns + 1),
+         (double)g_now_us * 1000 / (wall_time_ns + 1));
+
+  netsim_destroy_network();
+
+  return 0;
+}
+
+/* Global functions */
+
+int main(int argc, char *argv[])
+{
+  char *prog_name = strrchr(argv[0], '/');
+  const char *gm_qls_str = NULL;
+  const char *lo_ql_str = NULL;
+  const char *holdover_ql_str = NULL;
+  const char *csv_file_name = NULL;
+  char gm_qls[64];
+  char *backup_ql_str;
+  FILE *csv_file = NULL;
+  double *run_times_s = NULL;
+  double *node_times_s = NULL;
+  int num_node_times = 0;
+  int num_runs = 1;
+  uint64_t seed = 1;
+  int verbose_flag = 0;
+  int err = -1;
+  int c;
+  int i;
+
+  if(prog_name)
+    prog_name++;
+  else
+    prog_name = argv[0];
+
+  while(EOF != (c = getopt(argc, argv, "123b:c:C:d:hH:j:k:l:L:m:n:o:Q:q:r:s:S:t:vw:W:"))) {
+    switch(c) {
+      case '1':
+        g_net_opt = E_esmc_network_option_1;
+        break;
+      case '2':
+        g_net_opt = E_esmc_network_option_2;
+        break;
+      case '3':
+        g_net_opt = E_esmc_network_option_3;
+        break;
+      case 'b':
+        g_backup_gm_node_idx = atoi(optarg);
+        break;
+      case 'c':
+        g_cut_link_idx = atoi(optarg);
+        break;
+      case 'C':
+        csv_file_name = optarg;
+        break;
+      case 'd':
+        if(atof(optarg) < 0) {
+          fprintf(stderr, "Link delay must not be negative\n");
+          return -1;
+        }
+        g_delay_us = (uint64_t)(atof(optarg) * 1000);
+        break;
+      case 'H':
+        g_holdover_timer_s = atoi(optarg);
+        break;
+      case 'j':
+        if(atof(optarg) < 0) {
+          fprintf(stderr, "Link jitter must not be negative\n");
+          return -1;
+        }
+        g_jitter_us = (uint64_t)(atof(optarg) * 1000);
+        break;
+      case 'k':
+        if(atof(optarg) < 0) {
+          fprintf(stderr, "Lock time must not be negative\n");
+          return -1;
+        }
+        g_lock_time_us = (uint64_t)(atof(optarg) * 1000);
+        break;
+      case 'l':
+        lo_ql_str = optarg;
+        break;
+      case 'L':
+        g_loss_percent = atof(optarg);
+        if((g_loss_percent < 0) || (g_loss_percent > 100)) {
+          fprintf(stderr, "Loss percentage must be between 0 and 100\n");
+          return -1;
+        }
+        break;
+      case 'm':
+        if(atof(optarg) <= 0) {
+          fprintf(stderr, "Maximum time must be positive\n");
+          return -1;
+        }
+        g_max_time_us = (uint64_t)(atof(optarg) * NETSIM_US_PER_S);
+        break;
+      case 'n':
+        g_num_nodes = atoi(optarg);
+        if((g_num_nodes < 1) || (g_num_nodes > NETSIM_MAX_NUM_OF_NODES)) {
+          fprintf(stderr, "Number of nodes must be between 1 and %d\n", NETSIM_MAX_NUM_OF_NODES);
+          return -1;
+        }
+        break;
+      case 'o':
+        g_hold_off_timer_ms = atoi(optarg);
+        break;
+      case 'Q':
+        holdover_ql_str = optarg;
+        break;
+      case 'q':
+        gm_qls_str = optarg;
+        break;
+      case 'r':
+        num_runs = atoi(optarg);
+        if(num_runs < 1) {
+          fprintf(stderr, "Number of runs must be positive\n");
+          return -1;
+        }
+        break;
+      case 's':
+        g_scenario = parse_name(optarg, g_scenario_names, E_netsim_scenario_max);
+        if((int)g_scenario < 0) {
+          fprintf(stderr, "Invalid scenario %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'S':
+        seed = strtoull(optarg, NULL, 0);
+        break;
+      case 't':
+        g_topology = parse_name(optarg, g_topology_names, E_netsim_topology_max);
+        if((int)g_topology < 0) {
+          fprintf(stderr, "Invalid topology %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'v':
+        verbose_flag = 1;
+        break;
+      case 'w':
+        g_wait_to_restore_timer_s = atoi(optarg);
+        break;
+      case 'W':
+        if(atof(optarg) <= 0) {
+          fprintf(stderr, "Quiet window must be positive\n");
+          return -1;
+        }
+        g_quiet_window_us = (uint64_t)(atof(optarg) * NETSIM_US_PER_S);
+        break;
+      case 'h':
+        usage(prog_name);
+        return 0;
+      default:
+        usage(prog_name);
+        return -1;
+    }
+  }
+
+  if(optind < argc) {
+    usage(prog_name);
+    return -1;
+  }
+
+  if((g_backup_gm_node_idx != NETSIM_NO_NODE) && ((g_backup_gm_node_idx < 1) || (g_backup_gm_node_idx >= g_num_nodes))) {
+    fprintf(stderr, "Backup external clock node must be between 1 and %d\n", g_num_nodes - 1);
+    return -1;
+  }
+
+  /* QLs default to the network option */
+  if(gm_qls_str == NULL) {
+    gm_qls_str = (g_net_opt == E_esmc_network_option_2) ? "PRS,ST2" : "PRC,SSUA";
+  }
+  if(lo_ql_str == NULL) {
+    lo_ql_str = (g_net_opt == E_esmc_network_option_2) ? "ST3" : "SEC";
+  }
+  snprintf(gm_qls, sizeof(gm_qls), "%s", gm_qls_str);
+  backup_ql_str = strchr(gm_qls, ',');
+  if(backup_ql_str != NULL) {
+    *backup_ql_str++ = '\0';
+  }
+  if((parse_ql(gm_qls, &g_gm_ql) < 0) ||
+     ((backup_ql_str != NULL) && (parse_ql(backup_ql_str, &g_backup_gm_ql) < 0)) ||
+     (parse_ql(lo_ql_str, &g_lo_ql) < 0) ||
+     (parse_ql((holdover_ql_str != NULL) ? holdover_ql_str : lo_ql_str, &g_holdover_ql) < 0) ||
+     (conv_net_opt_to_do_not_use_ql(g_net_opt, &g_do_not_use_ql) < 0)) {
+    return -1;
+  }
+  if(backup_ql_str == NULL) {
+    g_backup_gm_ql = g_gm_ql;
+  }
+  if(g_holdover_ql > g_lo_ql) {
+    fprintf(stderr, "Holdover QL must be equal to or better than LO QL\n");
+    return -1;
+  }
+
+  print_set_prog_name(prog_name);
+  print_set_stdout_en(1);
+  print_set_max_msg_level(verbose_flag ? LOG_INFO : LOG_ERR);
+
+  g_max_events = 1024;
+  g_events = malloc(g_max_events * sizeof(*g_events));
+  run_times_s = calloc(num_runs, sizeof(*run_times_s));
+  node_times_s = calloc((size_t)num_runs * g_num_nodes, sizeof(*node_times_s));
+  if((g_events == NULL) || (run_times_s == NULL) || (node_times_s == NULL)) {
+    fprintf(stderr, "Failed to allocate memory\n");
+    goto out;
+  }
+
+  if(csv_file_name != NULL) {
+    csv_file = fopen(csv_file_name, "w");
+    if(csv_file == NULL) {
+      fprintf(stderr, "Failed to open %s\n", csv_file_name);
+      goto out;
+    }
+    fprintf(csv_file, "run,seed,node,changes,convergence_s,ql\n");
+  }
+
+  printf("Simulating %s of %d nodes (network option %d), scenario %s, %d run(s)\n",
+         g_topology_names[g_topology], g_num_nodes, g_net_opt, g_scenario_names[g_scenario], num_runs);
+
+  for(i = 0; i < num_runs; i++) {
+    if(g_scenario == E_netsim_scenario_link_cut) {
+      /* Links are only known once created; netsim_create_links() makes fewer than 2 links per node */
+      if((g_cut_link_idx < 0) || (g_cut_link_idx >= ((g_topology == E_netsim_topology_ring) ? g_num_nodes : (g_num_nodes - 1)))) {
+        fprintf(stderr, "Link to cut must be between 0 and the number of links - 1\n");
+        goto out;
+      }
+    }
+    if(run(i, seed + i, csv_file, run_times_s, node_times_s, &num_node_times) < 0) {
+      goto out;
+    }
+  }
+
+  if(num_runs > 1) {
+    printf("Summary:\n");
+    print_distribution("  Network convergence time per run", run_times_s, num_runs);
+    print_distribution("  Node convergence time over all runs", node_times_s, num_node_times);
+  }
+
+  err = 0;
+
+out:
+  if(csv_file != NULL) {
+    fclose(csv_file);
+  }
+  free(run_times_s);
+  free(node_times_s);
+  free(g_events);
+  free(g_pdus);
+  free(g_free_pdus);
+
+  return err;
+}
@@ -0,0 +1,684 @@
+/**
+ * @file synced_pdugen.c
+ * @note Copyright (C) [2021-2024] Renesas Electronics Corporation and/or its affiliates
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+/********************************************************************************************************************
+* Release Tag: 2-0-8
+* Pipeline ID: 426834
+* Commit Hash: 62f27b58
+********************************************************************************************************************/
+
+
+#define _GNU_SOURCE /* sendmmsg() */
+
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../common/common.h"
+#include "../../common/config.h"
+#include "../../common/interface.h"
+#include "../../common/print.h"
+#include "../../common/stats.h"
+#include "../../esmc/renesas/esmc.h"
+#include "../../esmc/renesas/raw_socket.h"
+
+/*
+ * ESMC PDU generator
+ *
+ * Emulates upstream peers sending ESMC PDUs on one or more interfaces, to load and stress the RX, control and timing
+ * loop paths of synced on veth pairs or real NICs. PDUs are composed with esmc_compose_pdu() ahead of time for every
+ * peer and QL of the QL sequence, so the send loop only copies them into a batch and sends the batch with
+ * sendmmsg(). Peers are spread evenly over the information and flap periods, and malformed PDUs are picked by
+ * sequence number, so runs are deterministic.
+ */
+
+#define PDUGEN_MAX_NUM_OF_PEERS      256   /* Per interface */
+#define PDUGEN_MAX_QL_SEQ_LEN        16
+#define PDUGEN_MAX_BATCH_SIZE        1024
+#define PDUGEN_DEFAULT_BATCH_SIZE    64
+#define PDUGEN_TRUNCATED_PDU_LEN     40
+#define PDUGEN_NS_PER_S              1000000000ULL
+
+/* Information and event PDU (see T_esmc_pdu_type) */
+#define PDUGEN_NUM_OF_PDU_TYPES   2
+
+/* Best port number handed to esmc_compose_pdu() so it keeps the configured originator clock ID */
+#define PDUGEN_BEST_PORT_NUM   1
+
+/* Malformed PDU kinds, used in turn */
+typedef enum {
+  E_pdugen_malformed_slow_proto_subtype,
+  E_pdugen_malformed_itu_oui,
+  E_pdugen_malformed_itu_subtype,
+  E_pdugen_malformed_version,
+  E_pdugen_malformed_ql_tlv_type,
+  E_pdugen_malformed_ext_ql_tlv_type,
+  E_pdugen_malformed_truncated,
+  E_pdugen_malformed_max
+} T_pdugen_malformed;
+
+typedef struct {
+  T_esmc_pdu pdus[PDUGEN_MAX_QL_SEQ_LEN][PDUGEN_NUM_OF_PDU_TYPES];
+  int seq_pos;
+  uint64_t next_info_time_ns;
+  uint64_t next_flap_time_ns;
+} T_pdugen_peer;
+
+typedef struct {
+  const char *name;
+  int fd;
+  struct sockaddr_ll dst_addr;
+  T_pdugen_peer *peers;
+
+  /* Batch being filled */
+  int batch_len;
+  T_esmc_pdu *batch_pdus;
+  struct iovec *batch_iovs;
+  struct mmsghdr *batch_msgs;
+} T_pdugen_iface;
+
+typedef struct {
+  uint64_t pdus;
+  uint64_t events;
+  uint64_t malformed;
+  uint64_t errors;
+} T_pdugen_counters;
+
+/* Static data */
+
+static volatile sig_atomic_t g_prog_running = 1;
+
+static T_esmc_network_option g_net_opt = E_esmc_network_option_1;
+static T_esmc_ql g_ql_seq[PDUGEN_MAX_QL_SEQ_LEN];
+static int g_ql_seq_len = 0;
+static int g_num_peers = 1;
+static double g_info_rate_hz = 1.0;
+static double g_flap_rate_hz = 0.0;
+static int g_num_cascaded_eEEC = 1;
+static int g_num_cascaded_EEC = 0;
+static unsigned char g_originator_clock_id[MAX_CLK_ID_LEN];
+static int g_loop_flag = 0;
+static unsigned char g_loop_mac_addr[ETH_ALEN];
+static int g_malformed_percent = 0;
+static int g_basic_flag = 0;
+static int g_batch_size = PDUGEN_DEFAULT_BATCH_SIZE;
+
+static T_pdugen_iface g_ifaces[ESMC_MAX_NUMBER_OF_PORTS];
+static int g_num_ifaces = 0;
+
+static T_pdugen_counters g_counters;
+static uint64_t g_seq_num = 0;
+
+/* Static functions */
+
+static void usage(char *prog_name)
+{
+  fprintf(stderr,
+          "usage: %s [options] -i [interface] [-i [interface] ...]\n"
+          "options:\n"
+          "  -1 Compose network option 1 QLs (default).\n"
+          "  -2 Compose network option 2 QLs.\n"
+          "  -3 Compose network option 3 QLs.\n"
+          "  -b [size] Send up to 'size' PDUs per sendmmsg() call (default: %d).\n"
+          "  -d [seconds] Stop after 'seconds' (default: 0, i.e. run until interrupted).\n"
+          "  -e [eEEC,EEC] Set the number of cascaded eEECs and EECs of the extended QL TLV (default: 1,0).\n"
+          "  -f [rate] Move every peer to the next QL of the sequence 'rate' times per second with an event PDU\n"
+          "     (default: 0, i.e. no QL changes).\n"
+          "  -h Display command-line options (i.e. print this message).\n"
+          "  -i [interface] Send on 'interface' (up to %d interfaces).\n"
+          "  -l [mac] Create timing loops to the node with MAC address 'mac': even peers use it as source MAC address\n"
+          "     (immediate timing loop), odd peers use its clock ID as originator clock ID (originator timing loop).\n"
+          "  -m [percent] Send 'percent' of the PDUs malformed, cycling through the malformed PDU kinds.\n"
+          "  -o [id] Set the originator clock ID to 'id' (16 hexadecimal digits, or a MAC address to derive it from;\n"
+          "     default: derived from the source MAC address of each peer).\n"
+          "  -p [peers] Emulate 'peers' peers per interface, each with its own source MAC address (default: 1).\n"
+          "  -q [qls] Send the comma-separated QL sequence 'qls' (e.g. PRC,SSUB; default: PRC).\n"
+          "  -r [rate] Send 'rate' information PDUs per second per peer (default: 1).\n"
+          "  -x Leave out the extended QL TLV (i.e. emulate peers that are not enhanced).\n",
+          prog_name, PDUGEN_DEFAULT_BATCH_SIZE, ESMC_MAX_NUMBER_OF_PORTS);
+}
+
+static void sig_handler(int sig_num)
+{
+  (void)sig_num;
+
+  g_prog_running = 0;
+}
+
+static int parse_mac_addr(const char *str, unsigned char mac_addr[ETH_ALEN])
+{
+  unsigned int bytes[ETH_ALEN];
+  char end;
+  int i;
+
+  if(sscanf(str, "%x:%x:%x:%x:%x:%x%c", &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5], &end) != ETH_ALEN) {
+    return -1;
+  }
+
+  for(i = 0; i < ETH_ALEN; i++) {
+    if(bytes[i] > 0xFF) {
+      return -1;
+    }
+    mac_addr[i] = (unsigned char)bytes[i];
+  }
+
+  return 0;
+}
+
+static int parse_clock_id(const char *str, unsigned char clock_id[MAX_CLK_ID_LEN])
+{
+  unsigned char mac_addr[ETH_ALEN];
+  unsigned int byte;
+  int i;
+
+  if(parse_mac_addr(str, mac_addr) == 0) {
+    generate_clock_id(mac_addr, clock_id);
+    return 0;
+  }
+
+  if(strlen(str) != (2 * MAX_CLK_ID_LEN)) {
+    return -1;
+  }
+
+  for(i = 0; i < MAX_CLK_ID_LEN; i++) {
+    if(sscanf(&str[2 * i], "%2x", &byte) != 1) {
+      return -1;
+    }
+    clock_id[i] = (unsigned char)byte;
+  }
+
+  return 0;
+}
+
+static int parse_ql_seq(char *str)
+{
+  char *save_ptr = NULL;
+  char *ql_str;
+
+  g_ql_seq_len = 0;
+
+  for(ql_str = strtok_r(str, ",", &save_ptr); ql_str != NULL; ql_str = strtok_r(NULL, ",", &save_ptr)) {
+    if(g_ql_seq_len == PDUGEN_MAX_QL_SEQ_LEN) {
+      fprintf(stderr, "QL sequence is longer than %d QLs\n", PDUGEN_MAX_QL_SEQ_LEN);
+      return -1;
+    }
+
+    /* Accept both SSUB and QL-SSUB */
+    if(!strncmp(ql_str, "QL-", 3)) {
+      ql_str += 3;
+    }
+
+    if((config_ql_str_to_enum_conv(g_net_opt, ql_str, &g_ql_seq[g_ql_seq_len]) < 0) ||
+       (check_ql_setting(g_net_opt, g_ql_seq[g_ql_seq_len]) < 0)) {
+      fprintf(stderr, "Invalid QL %s for network option %d\n", ql_str, g_net_opt);
+      return -1;
+    }
+    g_ql_seq_len++;
+  }
+
+  return (g_ql_seq_len > 0) ? 0 : -1;
+}
+
+static void get_peer_mac_addr(struct sockaddr_ll const *iface_mac_addr, int peer_idx, unsigned char mac_addr[ETH_ALEN])
+{
+  memcpy(mac_addr, iface_mac_addr->sll_addr, ETH_ALEN);
+
+  /* The first peer uses the interface MAC address; the others use locally administered addresses derived from it */
+  if(peer_idx > 0) {
+    mac_addr[0] |= 0x02;
+    mac_addr[5] ^= (unsigned char)peer_idx;
+  }
+}
+
+static int compose_peer_pdus(T_pdugen_peer *peer, int global_peer_idx, struct sockaddr_ll const *iface_mac_addr, int peer_idx)
+{
+  T_port_tx_bundle_info port_tx_bundle_info;
+  T_port_ext_ql_tlv_data ext_ql_tlv_data;
+  unsigned char src_mac_addr[ETH_ALEN];
+  T_esmc_ql composed_ql;
+  int pdu_type;
+  int i;
+
+  get_peer_mac_addr(iface_mac_addr, peer_idx, src_mac_addr);
+
+  memset(&ext_ql_tlv_data, 0, sizeof(ext_ql_tlv_data));
+  memcpy(ext_ql_tlv_data.originator_clock_id, g_originator_clock_id, MAX_CLK_ID_LEN);
+  ext_ql_tlv_data.num_cascaded_eEEC = g_num_cascaded_eEEC;
+  ext_ql_tlv_data.num_cascaded_EEC = g_num_cascaded_EEC;
+
+  if(g_loop_flag) {
+    if((global_peer_idx % 2) == 0) {
+      memcpy(src_mac_addr, g_loop_mac_addr, ETH_ALEN);
+    } else {
+      generate_clock_id(g_loop_mac_addr, ext_ql_tlv_data.originator_clock_id);
+    }
+  }
+
+  /* Without an originator clock ID, esmc_compose_pdu() derives it from the source MAC address */
+  if(CHECK_CLOCK_ID_NULL(ext_ql_tlv_data.originator_clock_id)) {
+    generate_clock_id(src_mac_addr, ext_ql_tlv_data.originator_clock_id);
+  }
+
+  memset(&port_tx_bundle_info, 0, sizeof(port_tx_bundle_info));
+
+  for(i = 0; i < g_ql_seq_len; i++) {
+    esmc_set_best_ql(g_ql_seq[i], PDUGEN_BEST_PORT_NUM, &port_tx_bundle_info, NULL);
+
+    for(pdu_type = 0; pdu_type < PDUGEN_NUM_OF_PDU_TYPES; pdu_type++) {
+      memset(&peer->pdus[i][pdu_type], 0, sizeof(peer->pdus[i][pdu_type]));
+      if(esmc_compose_pdu(&peer->pdus[i][pdu_type], pdu_type, src_mac_addr, &ext_ql_tlv_data, 0, &composed_ql) != ESMC_PDU_LEN) {
+        fprintf(stderr, "Failed to compose ESMC PDU for %s\n", conv_ql_enum_to_str(g_ql_seq[i]));
+        return -1;
+      }
+      if(g_basic_flag) {
+        memset(&peer->pdus[i][pdu_type].ext_ql_tlv, 0, sizeof(peer->pdus[i][pdu_type].ext_ql_tlv));
+      }
+    }
+  }
+
+  return 0;
+}
+
+static int open_iface(T_pdugen_iface *iface, int first_global_peer_idx)
+{
+  const unsigned char slow_proto_mcast_addr[ETH_ALEN] = ESMC_PDU_IEEE_SLOW_PROTO_MCAST_ADDR;
+  struct interface *interface;
+  struct sockaddr_ll mac_addr;
+  int port_num;
+  int i;
+
+  interface = interface_create(iface->name);
+  if(interface == NULL) {
+    return -1;
+  }
+  if(interface_config_idx_and_mac_addr(interface) < 0) {
+    fprintf(stderr, "Failed to get index and MAC address of interface %s\n", iface->name);
+    interface_destroy(interface);
+    return -1;
+  }
+  port_num = interface_get_idx(interface);
+  mac_addr = interface_get_mac_addr(interface);
+  interface_destroy(interface);
+
+  iface->fd = raw_socket_open(iface->name, port_num, &mac_addr);
+  if(iface->fd == UNINITIALIZED_FD) {
+    fprintf(stderr, "Failed to open raw socket on interface %s\n", iface->name);
+    return -1;
+  }
+
+  memset(&iface->dst_addr, 0, sizeof(iface->dst_addr));
+  iface->dst_addr.sll_family = AF_PACKET;
+  iface->dst_addr.sll_ifindex = port_num;
+  iface->dst_addr.sll_halen = ETH_ALEN;
+  iface->dst_addr.sll_pkttype = PACKET_MULTICAST;
+  memcpy(iface->dst_addr.sll_addr, slow_proto_mcast_addr, ETH_ALEN);
+
+  iface->batch_pdus = calloc(g_batch_size, sizeof(*iface->batch_pdus));
+  iface->batch_iovs = calloc(g_batch_size, sizeof(*iface->batch_iovs));
+  iface->batch_msgs = calloc(g_batch_size, sizeof(*iface->batch_msgs));
+  if((iface->batch_pdus == NULL) || (iface->batch_iovs == NULL) || (iface->batch_msgs == NULL)) {
+    return -1;
+  }
+
+  for(i = 0; i < g_batch_size; i++) {
+    iface->batch_iovs[i].iov_base = &iface->batch_pdus[i];
+    iface->batch_msgs[i].msg_hdr.msg_iov = &iface->batch_iovs[i];
+    iface->batch_msgs[i].msg_hdr.msg_iovlen = 1;
+    iface->batch_msgs[i].msg_hdr.msg_name = &iface->dst_addr;
+    iface->batch_msgs[i].msg_hdr.msg_namelen = sizeof(iface->dst_addr);
+  }
+
+  for(i = 0; i < g_num_peers; i++) {
+    if(compose_peer_pdus(&iface->peers[i], first_global_peer_idx + i, &mac_addr, i) < 0) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void close_iface(T_pdugen_iface *iface)
+{
+  if(iface->fd != UNINITIALIZED_FD) {
+    raw_socket_close(iface->fd);
+  }
+  free(iface->batch_pdus);
+  free(iface->batch_iovs);
+  free(iface->batch_msgs);
+  free(iface->peers);
+}
+
+static void flush_batch(T_pdugen_iface *iface)
+{
+  int num_sent = 0;
+  int ret;
+
+  while(num_sent < iface->batch_len) {
+    ret = sendmmsg(iface->fd, &iface->batch_msgs[num_sent], iface->batch_len - num_sent, 0);
+    if(ret < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      pr_err_ratelimited("Failed to send on interface %s: %s", iface->name, strerror(errno));
+      /* Drop the rest of the batch */
+      g_counters.errors += iface->batch_len - num_sent;
+      break;
+    }
+    num_sent += ret;
+  }
+
+  g_counters.pdus += num_sent;
+  iface->batch_len = 0;
+}
+
+static void malform_pdu(T_esmc_pdu *msg, struct iovec *iov, T_pdugen_malformed kind)
+{
+  switch(kind) {
+    case E_pdugen_malformed_slow_proto_subtype:
+      msg->slow_proto_subtype ^= 0xFF;
+      break;
+    case E_pdugen_malformed_itu_oui:
+      msg->itu_oui[0] ^= 0xFF;
+      break;
+    case E_pdugen_malformed_itu_subtype:
+      msg->itu_subtype[1] ^= 0xFF;
+      break;
+    case E_pdugen_malformed_version:
+      msg->version_event_flag_reserved ^= 0xF0;
+      break;
+    case E_pdugen_malformed_ql_tlv_type:
+      msg->ql_tlv.type ^= 0xFF;
+      break;
+    case E_pdugen_malformed_ext_ql_tlv_type:
+      /* Only detected if the enhanced SSM code is not zero */
+      msg->ext_ql_tlv.type ^= 0xFF;
+      break;
+    case E_pdugen_malformed_truncated:
+      iov->iov_len = PDUGEN_TRUNCATED_PDU_LEN;
+      break;
+    default:
+      break;
+  }
+}
+
+static void queue_pdu(T_pdugen_iface *iface, T_esmc_pdu const *msg)
+{
+  T_esmc_pdu *batch_pdu = &iface->batch_pdus[iface->batch_len];
+  struct iovec *iov = &iface->batch_iovs[iface->batch_len];
+
+  *batch_pdu = *msg;
+  iov->iov_len = ESMC_PDU_LEN;
+
+  /* Spread malformed PDUs evenly over the sequence numbers */
+  if(((g_seq_num * g_malformed_percent) / 100) != (((g_seq_num + 1) * g_malformed_percent) / 100)) {
+    malform_pdu(batch_pdu, iov, (T_pdugen_malformed)(g_counters.malformed % E_pdugen_malformed_max));
+    g_counters.malformed++;
+  }
+  g_seq_num++;
+
+  if(++iface->batch_len == g_batch_size) {
+    flush_batch(iface);
+  }
+}
+
+static void sleep_until(uint64_t time_ns)
+{
+  struct timespec ts;
+
+  ts.tv_sec = time_ns / PDUGEN_NS_PER_S;
+  ts.tv_nsec = time_ns % PDUGEN_NS_PER_S;
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static void run(uint64_t duration_ns)
+{
+  uint64_t info_period_ns = (g_info_rate_hz > 0) ? (uint64_t)(PDUGEN_NS_PER_S / g_info_rate_hz) : 0;
+  uint64_t flap_period_ns = (g_flap_rate_hz > 0) ? (uint64_t)(PDUGEN_NS_PER_S / g_flap_rate_hz) : 0;
+  uint64_t start_time_ns = stats_get_time_ns();
+  uint64_t end_time_ns = (duration_ns > 0) ? (start_time_ns + duration_ns) : UINT64_MAX;
+  uint64_t current_time_ns;
+  uint64_t next_time_ns;
+  int num_peers = g_num_ifaces * g_num_peers;
+  T_pdugen_iface *iface;
+  T_pdugen_peer *peer;
+  int i;
+  int j;
+
+  /* Spread the peers evenly over the periods */
+  for(i = 0; i < g_num_ifaces; i++) {
+    for(j = 0; j < g_num_peers; j++) {
+      peer = &g_ifaces[i].peers[j];
+      peer->next_info_time_ns = (info_period_ns > 0) ?
+                                (start_time_ns + ((info_period_ns * ((i * g_num_peers) + j)) / num_peers)) : UINT64_MAX;
+      peer->next_flap_time_ns = (flap_period_ns > 0) ?
+                                (start_time_ns + flap_period_ns + ((flap_period_ns * ((i * g_num_peers) + j)) / num_peers)) : UINT64_MAX;
+    }
+  }
+
+  while(g_prog_running) {
+    current_time_ns = stats_get_time_ns();
+    if(current_time_ns >= end_time_ns) {
+      break;
+    }
+    next_time_ns = end_time_ns;
+
+    for(i = 0; i < g_num_ifaces; i++) {
+      iface = &g_ifaces[i];
+      for(j = 0; j < g_num_peers; j++) {
+        peer = &iface->peers[j];
+        /* At most one PDU of each type per pass, so a peer that falls behind does not hold up the others */
+        if(peer->next_flap_time_ns <= current_time_ns) {
+          peer->seq_pos = (peer->seq_pos + 1) % g_ql_seq_len;
+          queue_pdu(iface, &peer->pdus[peer->seq_pos][E_esmc_pdu_type_event]);
+          g_counters.events++;
+          peer->next_flap_time_ns += flap_period_ns;
+        }
+        if(peer->next_info_time_ns <= current_time_ns) {
+          queue_pdu(iface, &peer->pdus[peer->seq_pos][E_esmc_pdu_type_information]);
+          peer->next_info_time_ns += info_period_ns;
+        }
+        if(peer->next_flap_time_ns < next_time_ns) {
+          next_time_ns = peer->next_flap_time_ns;
+        }
+        if(peer->next_info_time_ns < next_time_ns) {
+          next_time_ns = peer->next_info_time_ns;
+        }
+      }
+      if(iface->batch_len > 0) {
+        flush_batch(iface);
+      }
+    }
+
+    sleep_until(next_time_ns);
+  }
+
+  current_time_ns = stats_get_time_ns();
+  printf("Sent %llu PDUs (%llu event, %llu malformed) in %.3f s (%.0f PDUs/s), %llu send errors\n",
+         (unsigned long long)g_counters.pdus,
+         (unsigned long long)g_counters.events,
+         (unsigned long long)g_counters.malformed,
+         (double)(current_time_ns - start_time_ns) / PDUGEN_NS_PER_S,
+         (double)g_counters.pdus * PDUGEN_NS_PER_S / (current_time_ns - start_time_ns),
+         (unsigned long long)g_counters.errors);
+}
+
+/* Global functions */
+
+int main(int argc, char *argv[])
+{
+  char *prog_name = strrchr(argv[0], '/');
+  char default_ql_seq[] = "PRC";
+  char *ql_seq_str = default_ql_seq;
+  double duration_s = 0;
+  struct sigaction new_action;
+  int err = -1;
+  int c;
+  int i;
+
+  if(prog_name)
+    prog_name++;
+  else
+    prog_name = argv[0];
+
+  while(EOF != (c = getopt(argc, argv, "123b:d:e:f:hi:l:m:o:p:q:r:x"))) {
+    switch(c) {
+      case '1':
+        g_net_opt = E_esmc_network_option_1;
+        break;
+      case '2':
+        g_net_opt = E_esmc_network_option_2;
+        break;
+      case '3':
+        g_net_opt = E_esmc_network_option_3;
+        break;
+      case 'b':
+        g_batch_size = atoi(optarg);
+        if((g_batch_size < 1) || (g_batch_size > PDUGEN_MAX_BATCH_SIZE)) {
+          fprintf(stderr, "Batch size must be between 1 and %d\n", PDUGEN_MAX_BATCH_SIZE);
+          return -1;
+        }
+        break;
+      case 'd':
+        duration_s = atof(optarg);
+        if(duration_s < 0) {
+          fprintf(stderr, "Duration must not be negative\n");
+          return -1;
+        }
+        break;
+      case 'e':
+        if((sscanf(optarg, "%d,%d", &g_num_cascaded_eEEC, &g_num_cascaded_EEC) < 1) ||
+           (g_num_cascaded_eEEC < 0) || (g_num_cascaded_eEEC > 0xFF) ||
+           (g_num_cascaded_EEC < 0) || (g_num_cascaded_EEC > 0xFF)) {
+          fprintf(stderr, "Numbers of cascaded eEECs and EECs must be between 0 and 255\n");
+          return -1;
+        }
+        break;
+      case 'f':
+        g_flap_rate_hz = atof(optarg);
+        if(g_flap_rate_hz < 0) {
+          fprintf(stderr, "Flap rate must not be negative\n");
+          return -1;
+        }
+        break;
+      case 'i':
+        if(g_num_ifaces == ESMC_MAX_NUMBER_OF_PORTS) {
+          fprintf(stderr, "At most %d interfaces are supported\n", ESMC_MAX_NUMBER_OF_PORTS);
+          return -1;
+        }
+        g_ifaces[g_num_ifaces].name = optarg;
+        g_ifaces[g_num_ifaces].fd = UNINITIALIZED_FD;
+        g_num_ifaces++;
+        break;
+      case 'l':
+        if(parse_mac_addr(optarg, g_loop_mac_addr) < 0) {
+          fprintf(stderr, "Invalid MAC address %s\n", optarg);
+          return -1;
+        }
+        g_loop_flag = 1;
+        break;
+      case 'm':
+        g_malformed_percent = atoi(optarg);
+        if((g_malformed_percent < 0) || (g_malformed_percent > 100)) {
+          fprintf(stderr, "Malformed PDU percentage must be between 0 and 100\n");
+          return -1;
+        }
+        break;
+      case 'o':
+        if(parse_clock_id(optarg, g_originator_clock_id) < 0) {
+          fprintf(stderr, "Invalid originator clock ID %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'p':
+        g_num_peers = atoi(optarg);
+        if((g_num_peers < 1) || (g_num_peers > PDUGEN_MAX_NUM_OF_PEERS)) {
+          fprintf(stderr, "Number of peers must be between 1 and %d\n", PDUGEN_MAX_NUM_OF_PEERS);
+          return -1;
+        }
+        break;
+      case 'q':
+        ql_seq_str = optarg;
+        break;
+      case 'r':
+        g_info_rate_hz = atof(optarg);
+        if(g_info_rate_hz < 0) {
+          fprintf(stderr, "Information PDU rate must not be negative\n");
+          return -1;
+        }
+        break;
+      case 'x':
+        g_basic_flag = 1;
+        break;
+      case 'h':
+        usage(prog_name);
+        return 0;
+      default:
+        usage(prog_name);
+        return -1;
+    }
+  }
+
+  if(g_num_ifaces == 0) {
+    usage(prog_name);
+    return -1;
+  }
+
+  if(parse_ql_seq(ql_seq_str) < 0) {
+    return -1;
+  }
+
+  print_set_prog_name(prog_name);
+  print_set_stdout_en(1);
+  print_set_max_msg_level(LOG_WARNING);
+
+  new_action.sa_handler = sig_handler;
+  sigemptyset(&new_action.sa_mask);
+  new_action.sa_flags = 0;
+  sigaction(SIGINT, &new_action, NULL);
+  sigaction(SIGTERM, &new_action, NULL);
+
+  /* esmc_compose_pdu() reads the network option and best QL from the ESMC stack */
+  if((esmc_create_stack() < 0) ||
+     (esmc_init_stack(g_net_opt, g_ql_seq[0], g_ql_seq[0]) < 0)) {
+    fprintf(stderr, "Failed to initialize the ESMC stack\n");
+    return -1;
+  }
+
+  for(i = 0; i < g_num_ifaces; i++) {
+    g_ifaces[i].peers = calloc(g_num_peers, sizeof(*g_ifaces[i].peers));
+    if((g_ifaces[i].peers == NULL) || (open_iface(&g_ifaces[i], i * g_num_peers) < 0)) {
+      goto out;
+    }
+  }
+
+  run((uint64_t)(duration_s * PDUGEN_NS_PER_S));
+  err = 0;
+
+out:
+  for(i = 0; i < g_num_ifaces; i++) {
+    close_iface(&g_ifaces[i]);
+  }
+  esmc_destroy_stack();
+
+  return err;
+}